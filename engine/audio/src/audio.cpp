@@ -26,6 +26,8 @@
 #include "audiodecoder.h"
 #include "audiorenderer.h"
 #include "audioplugincache.h"
+#include "audiowaveform.h"
+#include "audiopcmcache.h"
 
 #if QT_VERSION < QT_VERSION_CHECK(5, 0, 0)
 
@@ -54,6 +56,8 @@ Audio::Audio(Doc* doc)
   : Function(doc, Function::AudioType)
   , m_doc(doc)
   , m_decoder(NULL)
+  , m_cachedDecoder(NULL)
+  , m_waveform(NULL)
   , m_audio_out(NULL)
   , m_audioDevice(QString())
   , m_sourceFileName("")
@@ -74,6 +78,8 @@ Audio::~Audio()
         m_audio_out->stop();
         delete m_audio_out;
     }
+    delete m_waveform;
+    delete m_cachedDecoder;
     if (m_decoder != NULL)
         delete m_decoder;
 }
@@ -149,6 +155,10 @@ bool Audio::setSourceFileName(QString filename)
             delete m_decoder;
             m_decoder = NULL;
         }
+        delete m_waveform;
+        m_waveform = NULL;
+        delete m_cachedDecoder;
+        m_cachedDecoder = NULL;
     }
 
     m_sourceFileName = filename;
@@ -172,6 +182,9 @@ bool Audio::setSourceFileName(QString filename)
 
     setTotalDuration(m_decoder->totalTime());
 
+    // decode the whole file in the background, if the cache is enabled
+    m_doc->audioPluginCache()->pcmCache()->request(m_sourceFileName);
+
     emit changed(id());
 
     return true;
@@ -187,6 +200,18 @@ AudioDecoder *Audio::getAudioDecoder()
     return m_decoder;
 }
 
+AudioWaveform *Audio::waveform()
+{
+    if (m_waveform == NULL && m_decoder != NULL)
+    {
+        m_waveform = new AudioWaveform(m_doc->audioPluginCache(), m_sourceFileName, this);
+        connect(m_waveform, SIGNAL(ready()), this, SIGNAL(waveformReady()));
+        m_waveform->start(QThread::LowPriority);
+    }
+
+    return m_waveform;
+}
+
 void Audio::setAudioDevice(QString dev)
 {
     m_audioDevice = dev;
@@ -213,7 +238,10 @@ void Audio::slotEndOfStream()
     {
         m_audio_out->stop();
         m_audio_out->deleteLater();
-        m_audio_out = NULL;
+        {
+            QMutexLocker locker(&m_rendererMutex);
+            m_audio_out = NULL;
+        }
         m_decoder->seek(0);
     }
     if (!stopped())
@@ -317,8 +345,14 @@ void Audio::preRun(MasterTimer* timer)
 {
     if (m_decoder != NULL)
     {
-        m_decoder->seek(elapsed());
-        AudioParameters ap = m_decoder->audioParameters();
+        // play the pre-decoded audio when available, so that
+        // starting and seeking don't need to decode anything
+        if (m_cachedDecoder == NULL)
+            m_cachedDecoder = m_doc->audioPluginCache()->pcmCache()->createDecoder(m_sourceFileName);
+        AudioDecoder *decoder = m_cachedDecoder != NULL ? m_cachedDecoder : m_decoder;
+
+        decoder->seek(elapsed());
+        AudioParameters ap = decoder->audioParameters();
 #if QT_VERSION < QT_VERSION_CHECK(5, 0, 0)
  #if defined(__APPLE__) || defined(Q_OS_MAC)
         //m_audio_out = new AudioRendererCoreAudio();
@@ -332,7 +366,8 @@ void Audio::preRun(MasterTimer* timer)
 #else
         m_audio_out = new AudioRendererQt(m_audioDevice);
 #endif
-        m_audio_out->setDecoder(m_decoder);
+        m_audio_out->setDecoder(decoder);
+        m_audio_out->setStartPosition(elapsed());
         m_audio_out->initialize(ap.sampleRate(), ap.channels(), ap.format());
         m_audio_out->adjustIntensity(getAttributeValue(Intensity));
         m_audio_out->setFadeIn(fadeInSpeed());
@@ -382,5 +417,20 @@ void Audio::postRun(MasterTimer* timer, QList<Universe*> universes)
 {
     slotEndOfStream();
 
+    // the renderer is stopped, so the decoder can go. Its data is shared
+    // with the cache, so the next run gets a new one cheaply
+    delete m_cachedDecoder;
+    m_cachedDecoder = NULL;
+
     Function::postRun(timer, universes);
 }
+
+qint64 Audio::playbackPosition() const
+{
+    QMutexLocker locker(&m_rendererMutex);
+
+    if (m_audio_out == NULL)
+        return -1;
+
+    return m_audio_out->playbackPosition();
+}
@@ -21,12 +21,14 @@
 #define AUDIO_H
 
 #include <QColor>
+#include <QMutex>
 
 #include "audiorenderer.h"
 #include "audiodecoder.h"
 #include "function.h"
 
 class QXmlStreamReader;
+class AudioWaveform;
 
 /** @addtogroup engine_functions Functions
  * @{
@@ -103,6 +105,14 @@ public:
      */
     AudioDecoder* getAudioDecoder();
 
+    /**
+     * Retrieve the peaks of the source audio file, to draw its waveform.
+     * They are computed (or loaded from the cache) in the background on
+     * the first call, and waveformReady() is emitted when available.
+     * Returns NULL if the source file cannot be decoded.
+     */
+    AudioWaveform *waveform();
+
     /**
      * Set a specific audio device for rendering. If empty
      * the QLC+ global device will be used
@@ -118,6 +128,7 @@ public:
 
 signals:
     void sourceFilenameChanged();
+    void waveformReady();
 
 protected slots:
     void slotEndOfStream();
@@ -125,8 +136,14 @@ protected slots:
 private:
     /** Instance of an AudioDecoder to perform actual audio decoding */
     AudioDecoder *m_decoder;
+    /** Decoder of the pre-decoded audio, used for playback when available */
+    AudioDecoder *m_cachedDecoder;
+    /** The peaks of the source audio file, created on demand */
+    AudioWaveform *m_waveform;
     /** output interface to render audio data got from m_decoder */
     AudioRenderer *m_audio_out;
+    /** Mutex guarding m_audio_out against playbackPosition() */
+    mutable QMutex m_rendererMutex;
     /** Audio device to use for rendering */
     QString m_audioDevice;
     /** Absolute start time of Audio over a timeline (in milliseconds) */
@@ -168,6 +185,14 @@ public:
 
     /** @reimpl */
     void postRun(MasterTimer* timer, QList<Universe *> universes);
+
+    /**
+     * Get the position in milliseconds of the audio being heard right now,
+     * relative to the start of the function, or -1 if nothing is playing.
+     * It follows the samples played by the audio device, so it can be used
+     * as a clock. This method is thread safe.
+     */
+    qint64 playbackPosition() const;
 };
 
 /** @} */
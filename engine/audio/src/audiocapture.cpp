@@ -21,6 +21,7 @@
 #include <QSettings>
 #include <QDebug>
 #include <qmath.h>
+#include <string.h>
 
 #include "audiocapture.h"
 
@@ -43,6 +44,14 @@ AudioCapture::AudioCapture (QObject* parent)
     , m_audioBuffer(NULL)
     , m_fftInputBuffer(NULL)
     , m_fftOutputBuffer(NULL)
+    , m_fftPlan(NULL)
+    , m_fftPlanSize(0)
+    , m_registeredCount(0)
+    , m_beatTrackerCount(0)
+    , m_beatTrackerReset(0)
+    , m_beatPlan(NULL)
+    , m_beatInputBuffer(NULL)
+    , m_beatOutputBuffer(NULL)
 {
     int bufferSize = AUDIO_DEFAULT_BUFFER_SIZE;
     m_sampleRate = AUDIO_DEFAULT_SAMPLE_RATE;
@@ -67,6 +76,10 @@ AudioCapture::AudioCapture (QObject* parent)
     m_fftInputBuffer = new double[m_captureSize];
 #ifdef HAS_FFTW3
     m_fftOutputBuffer = fftw_malloc(sizeof(fftw_complex) * m_captureSize);
+#endif
+    m_beatInputBuffer = new double[BEAT_FRAME_SIZE];
+#ifdef HAS_FFTW3
+    m_beatOutputBuffer = fftw_malloc(sizeof(fftw_complex) * (BEAT_FRAME_SIZE / 2 + 1));
 #endif
 }
 
@@ -75,11 +88,16 @@ AudioCapture::~AudioCapture()
     // stop() has to be called from the implementation class
     Q_ASSERT(!this->isRunning());
 
+    releaseFFT();
+
     delete[] m_audioBuffer;
     delete[] m_fftInputBuffer;
+    delete[] m_beatInputBuffer;
 #ifdef HAS_FFTW3
     if (m_fftOutputBuffer)
         fftw_free(m_fftOutputBuffer);
+    if (m_beatOutputBuffer)
+        fftw_free(m_beatOutputBuffer);
 #endif
 }
 
@@ -94,20 +112,17 @@ void AudioCapture::registerBandsNumber(int number)
 
     QMutexLocker locker(&m_mutex);
 
-    bool firstBand = m_fftMagnitudeMap.isEmpty();
     if (number > 0 && number <= FREQ_SUBBANDS_MAX_NUMBER)
     {
-        if (m_fftMagnitudeMap.contains(number) == false)
-        {
-            BandsData newBands;
-            newBands.m_registerCounter = 1;
-            newBands.m_fftMagnitudeBuffer = QVector<double>(number);
-            m_fftMagnitudeMap[number] = newBands;
-        }
-        else
-            m_fftMagnitudeMap[number].m_registerCounter++;
+        BandsData &bands = m_bandsData[number];
+
+        // don't serve the frames of a previous registration
+        if (bands.m_registerCounter.loadAcquire() == 0)
+            bands.m_sequence.storeRelease(0);
+        bands.m_registerCounter.ref();
 
-        if (firstBand)
+        m_registeredCount++;
+        if (m_registeredCount == 1)
         {
             locker.unlock();
             start();
@@ -121,13 +136,49 @@ void AudioCapture::unregisterBandsNumber(int number)
 
     QMutexLocker locker(&m_mutex);
 
-    if (m_fftMagnitudeMap.contains(number))
+    if (number > 0 && number <= FREQ_SUBBANDS_MAX_NUMBER &&
+        m_bandsData[number].m_registerCounter.loadAcquire() > 0)
+    {
+        m_bandsData[number].m_registerCounter.deref();
+
+        m_registeredCount--;
+        if (m_registeredCount == 0)
+        {
+            locker.unlock();
+            stop();
+        }
+    }
+}
+
+void AudioCapture::registerBeatTracker()
+{
+    qDebug() << "[AudioCapture] registering beat tracker";
+
+    QMutexLocker locker(&m_mutex);
+
+    if (m_beatTrackerCount.fetchAndAddOrdered(1) == 0)
+        m_beatTrackerReset.storeRelease(1);
+
+    m_registeredCount++;
+    if (m_registeredCount == 1)
+    {
+        locker.unlock();
+        start();
+    }
+}
+
+void AudioCapture::unregisterBeatTracker()
+{
+    qDebug() << "[AudioCapture] unregistering beat tracker";
+
+    QMutexLocker locker(&m_mutex);
+
+    if (m_beatTrackerCount.loadAcquire() > 0)
     {
-        m_fftMagnitudeMap[number].m_registerCounter--;
-        if (m_fftMagnitudeMap[number].m_registerCounter == 0)
-            m_fftMagnitudeMap.remove(number);
+        m_beatTrackerCount.deref();
 
-        if (m_fftMagnitudeMap.isEmpty())
+        m_registeredCount--;
+        if (m_registeredCount == 0)
         {
             locker.unlock();
             stop();
@@ -135,6 +186,31 @@ void AudioCapture::unregisterBandsNumber(int number)
     }
 }
 
+bool AudioCapture::latestSpectrum(int number, double *bands, double &maxMagnitude, quint32 &power) const
+{
+    if (number <= 0 || number > FREQ_SUBBANDS_MAX_NUMBER)
+        return false;
+
+    const BandsData &data = m_bandsData[number];
+
+    forever
+    {
+        int sequence = data.m_sequence.loadAcquire();
+        if (sequence == 0)
+            return false;
+
+        const SpectrumFrame &frame = data.m_frames[sequence % SPECTRUM_RING_SIZE];
+        memcpy(bands, frame.m_bands, number * sizeof(double));
+        maxMagnitude = frame.m_maxMagnitude;
+        power = frame.m_power;
+
+        // the frame is rewritten only after SPECTRUM_RING_SIZE - 1 more
+        // frames have been published: if that happened, read again
+        if (data.m_sequence.loadAcquire() - sequence < SPECTRUM_RING_SIZE - 1)
+            return true;
+    }
+}
+
 void AudioCapture::stop()
 {
     qDebug() << "[AudioCapture] stop capture";
@@ -145,36 +221,98 @@ void AudioCapture::stop()
     }
 }
 
-double AudioCapture::fillBandsData(int number)
+void AudioCapture::prepareFFT()
 {
-    // m_fftOutputBuffer contains the real and imaginary data of a spectrum
-    // representing all the frequencies from 0 to m_sampleRate Hz.
-    // I will just consider 0 to 5000Hz and will calculate average magnitude
-    // for the number of desired bands.
-    double maxMagnitude = 0;
 #ifdef HAS_FFTW3
-    unsigned int i = 0;
-    int subBandWidth = ((m_captureSize * SPECTRUM_MAX_FREQUENCY) / m_sampleRate) / number;
+    if (m_fftPlan != NULL && m_fftPlanSize == m_captureSize)
+        return;
 
-    for (int b = 0; b < number; b++)
+    releaseFFT();
+
+    // planning is expensive, but it's done only once per capture size
+    m_fftPlan = fftw_plan_dft_r2c_1d(m_captureSize, m_fftInputBuffer,
+                                     (fftw_complex*)m_fftOutputBuffer, FFTW_MEASURE);
+    m_fftPlanSize = m_captureSize;
+
+    m_window.resize(m_captureSize);
+    for (unsigned int i = 0; i < m_captureSize; i++)
     {
-        quint64 magnitudeSum = 0;
-        for (int s = 0; s < subBandWidth; s++, i++)
-        {
-            if (i == m_captureSize)
-                break;
-            magnitudeSum += qSqrt((((fftw_complex*)m_fftOutputBuffer)[i][0] * ((fftw_complex*)m_fftOutputBuffer)[i][0]) +
-                                  (((fftw_complex*)m_fftOutputBuffer)[i][1] * ((fftw_complex*)m_fftOutputBuffer)[i][1]));
-        }
-        double bandMagnitude = (magnitudeSum / subBandWidth);
-        m_fftMagnitudeMap[number].m_fftMagnitudeBuffer[b] = bandMagnitude;
-        if (maxMagnitude < bandMagnitude)
-            maxMagnitude = bandMagnitude;
+#ifdef USE_BLACKMAN
+        double a0 = (1-0.16)/2;
+        double a1 = 0.5;
+        double a2 = 0.16/2;
+        m_window[i] = a0 - a1 * qCos((M_2PI * i) / (m_captureSize - 1)) +
+                      a2 * qCos((2 * M_2PI * i) / (m_captureSize - 1));
+#endif
+#ifdef USE_HANNING
+        m_window[i] = 0.5 * (1.00 - qCos((M_2PI * i) / (m_captureSize - 1)));
+#endif
+#ifdef USE_NO_WINDOW
+        m_window[i] = 1.0;
+#endif
+    }
+
+    // only the bins up to SPECTRUM_MAX_FREQUENCY are used by the bands
+    unsigned int binsCount = qMin((m_captureSize * SPECTRUM_MAX_FREQUENCY) / m_sampleRate,
+                                  m_captureSize / 2 + 1);
+    m_magnitude.resize(binsCount);
+
+    if (m_beatPlan == NULL)
+    {
+        m_beatPlan = fftw_plan_dft_r2c_1d(BEAT_FRAME_SIZE, m_beatInputBuffer,
+                                          (fftw_complex*)m_beatOutputBuffer, FFTW_MEASURE);
+        m_beatWindow.resize(BEAT_FRAME_SIZE);
+        for (int i = 0; i < BEAT_FRAME_SIZE; i++)
+            m_beatWindow[i] = 0.5 * (1.00 - qCos((M_2PI * i) / (BEAT_FRAME_SIZE - 1)));
+        m_beatMagnitude.resize(BEAT_FRAME_SIZE / 2 + 1);
     }
-#else
-    Q_UNUSED(number)
 #endif
-    return maxMagnitude;
+}
+
+void AudioCapture::releaseFFT()
+{
+#ifdef HAS_FFTW3
+    if (m_fftPlan != NULL)
+        fftw_destroy_plan((fftw_plan)m_fftPlan);
+    if (m_beatPlan != NULL)
+        fftw_destroy_plan((fftw_plan)m_beatPlan);
+#endif
+    m_fftPlan = NULL;
+    m_fftPlanSize = 0;
+    m_beatPlan = NULL;
+}
+
+void AudioCapture::fillBandsData(int number)
+{
+    // m_magnitude contains the magnitude of the spectrum frequencies
+    // from 0 to 5000Hz. Calculate the average magnitude
+    // for the number of desired bands.
+    BandsData &data = m_bandsData[number];
+    int sequence = data.m_sequence.loadAcquire() + 1;
+    SpectrumFrame &frame = data.m_frames[sequence % SPECTRUM_RING_SIZE];
+    const double *magnitude = m_magnitude.constData();
+    int binsCount = m_magnitude.size();
+    int subBandWidth = binsCount / number;
+    int i = 0;
+
+    frame.m_maxMagnitude = 0;
+    frame.m_power = m_signalPower;
+
+    for (int b = 0; b < number; b++)
+    {
+        double magnitudeSum = 0;
+        for (int s = 0; s < subBandWidth && i < binsCount; s++, i++)
+            magnitudeSum += magnitude[i];
+
+        double bandMagnitude = subBandWidth ? magnitudeSum / subBandWidth : 0;
+        frame.m_bands[b] = bandMagnitude;
+        if (frame.m_maxMagnitude < bandMagnitude)
+            frame.m_maxMagnitude = bandMagnitude;
+    }
+
+    data.m_sequence.storeRelease(sequence);
+
+    emit dataProcessed(frame.m_bands, number, frame.m_maxMagnitude, frame.m_power);
 }
 
 void AudioCapture::processData()
@@ -183,12 +321,12 @@ void AudioCapture::processData()
     unsigned int i;
     quint64 pwrSum = 0;
 
-    // 1 ********* Initialize FFTW
-    fftw_plan plan_forward;
-    plan_forward = fftw_plan_dft_r2c_1d(m_captureSize, m_fftInputBuffer, (fftw_complex*)m_fftOutputBuffer , 0);
+    // 1 ********* Make sure the FFT plan is ready
+    prepareFFT();
 
     // 2 ********* Apply a window to audio data
     // *********** and convert it to doubles
+    const double *window = m_window.constData();
 
     for (i = 0; i < m_captureSize; i++)
     {
@@ -197,24 +335,11 @@ void AudioCapture::processData()
         else
             pwrSum += m_audioBuffer[i];
 
-#ifdef USE_BLACKMAN
-        double a0 = (1-0.16)/2;
-        double a1 = 0.5;
-        double a2 = 0.16/2;
-        m_fftInputBuffer[i] = m_audioBuffer[i]  * (a0 - a1 * qCos((M_2PI * i) / (m_captureSize - 1)) +
-                              a2 * qCos((2 * M_2PI * i) / (m_captureSize - 1)));
-#endif
-#ifdef USE_HANNING
-        m_fftInputBuffer[i] = m_audioBuffer[i] * (0.5 * (1.00 - qCos((M_2PI * i) / (m_captureSize - 1))));
-#endif
-#ifdef USE_NO_WINDOW
-        m_fftInputBuffer[i] = (double)m_audioBuffer[i];
-#endif
+        m_fftInputBuffer[i] = m_audioBuffer[i] * window[i];
     }
 
     // 3 ********* Perform FFT
-    fftw_execute(plan_forward);
-    fftw_destroy_plan(plan_forward);
+    fftw_execute((fftw_plan)m_fftPlan);
 
     // 4 ********* Clear FFT noise
 #ifdef CLEAR_FFT_NOISE
@@ -229,13 +354,70 @@ void AudioCapture::processData()
     // 5 ********* Calculate the average signal power
     m_signalPower = pwrSum / m_captureSize;
 
-    // 6 ********* Calculate vector magnitude
-    foreach(int barsNumber, m_fftMagnitudeMap.keys())
+    // 6 ********* Calculate the magnitude spectrum, once for all the bands
+    const fftw_complex *output = (const fftw_complex*)m_fftOutputBuffer;
+    for (i = 0; i < (unsigned int)m_magnitude.size(); i++)
+        m_magnitude[i] = qSqrt((output[i][0] * output[i][0]) + (output[i][1] * output[i][1]));
+
+    // 7 ********* Publish the bands of each registered client
+    for (int barsNumber = 1; barsNumber <= FREQ_SUBBANDS_MAX_NUMBER; barsNumber++)
+    {
+        if (m_bandsData[barsNumber].m_registerCounter.loadAcquire() > 0)
+            fillBandsData(barsNumber);
+    }
+
+    // 8 ********* Track the beats
+    if (m_beatTrackerCount.loadAcquire() > 0)
+        processBeats();
+#endif
+}
+
+void AudioCapture::processBeats()
+{
+#ifdef HAS_FFTW3
+    // the duration of a beat frame, in microseconds
+    qint64 framePeriod = (qint64(BEAT_FRAME_SIZE) * 1000000) / m_sampleRate;
+
+    if (m_beatTrackerReset.testAndSetOrdered(1, 0) || m_beatClock.isValid() == false)
+    {
+        m_beatTracker.reset(framePeriod);
+        m_beatClock.start();
+    }
+
+    // the last sample of the buffer has been heard latency() ms ago: use the
+    // time the audio has been heard, so that the predicted beats are on time
+    qint64 now = m_beatClock.nsecsElapsed() / 1000;
+    qint64 bufferEnd = now - latency() * 1000;
+    unsigned int frameSamples = BEAT_FRAME_SIZE * m_channels;
+    unsigned int framesCount = m_captureSize / frameSamples;
+    const double *window = m_beatWindow.constData();
+    const fftw_complex *output = (const fftw_complex*)m_beatOutputBuffer;
+
+    for (unsigned int f = 0; f < framesCount; f++)
+    {
+        // mix the channels down to mono
+        const int16_t *samples = m_audioBuffer + f * frameSamples;
+        for (int i = 0; i < BEAT_FRAME_SIZE; i++)
+        {
+            double sum = 0;
+            for (unsigned int c = 0; c < m_channels; c++)
+                sum += *samples++;
+            m_beatInputBuffer[i] = (sum / m_channels) * window[i];
+        }
+
+        fftw_execute((fftw_plan)m_beatPlan);
+
+        for (int i = 0; i < m_beatMagnitude.size(); i++)
+            m_beatMagnitude[i] = qSqrt((output[i][0] * output[i][0]) + (output[i][1] * output[i][1]));
+
+        qint64 frameTime = bufferEnd - qint64(framesCount - f) * framePeriod + framePeriod / 2;
+        m_beatTracker.processSpectrum(m_beatMagnitude.constData(), m_beatMagnitude.size(), frameTime);
+    }
+
+    if (m_beatTracker.isLocked())
     {
-        double maxMagnitude = fillBandsData(barsNumber);
-        emit dataProcessed(m_fftMagnitudeMap[barsNumber].m_fftMagnitudeBuffer.data(),
-                           m_fftMagnitudeMap[barsNumber].m_fftMagnitudeBuffer.size(),
-                           maxMagnitude, m_signalPower);
+        qint64 nextBeat = m_beatTracker.nextBeatTime(now);
+        emit beatTracked(m_beatTracker.bpm(), int((nextBeat - now) / 1000));
     }
 #endif
 }
@@ -258,7 +440,6 @@ void AudioCapture::run()
         {
             if (readAudio(m_captureSize) == true)
             {
-                QMutexLocker locker(&m_mutex);
                 processData();
             }
             else
@@ -22,10 +22,13 @@
 #define AUDIOCAPTURE_H
 
 #include <stdint.h>
+#include <QElapsedTimer>
+#include <QAtomicInt>
 #include <QThread>
 #include <QVector>
 #include <QMutex>
-#include <QMap>
+
+#include "beattracker.h"
 
 #define SETTINGS_AUDIO_INPUT_DEVICE   "audio/input"
 #define SETTINGS_AUDIO_INPUT_SRATE    "audio/samplerate"
@@ -39,14 +42,32 @@
 #define FREQ_SUBBANDS_DEFAULT_NUMBER    16
 #define SPECTRUM_MAX_FREQUENCY          5000
 
+/** Number of spectrum frames kept for each number of bands */
+#define SPECTRUM_RING_SIZE              4
+
+/** Number of samples per channel analyzed at once by the beat tracker */
+#define BEAT_FRAME_SIZE                 512
+
 /** @addtogroup engine_audio Audio
  * @{
  */
 
+typedef struct
+{
+    double m_bands[FREQ_SUBBANDS_MAX_NUMBER]; //! Magnitude of each band
+    double m_maxMagnitude;                    //! Highest magnitude of the bands
+    quint32 m_power;                          //! Average signal power
+} SpectrumFrame;
+
 struct BandsData
 {
-    int m_registerCounter;
-    QVector<double> m_fftMagnitudeBuffer;
+    /** Number of clients that requested this number of bands */
+    QAtomicInt m_registerCounter;
+
+    /** Number of the last frame published. Frame n is stored at n % SPECTRUM_RING_SIZE */
+    QAtomicInt m_sequence;
+
+    SpectrumFrame m_frames[SPECTRUM_RING_SIZE];
 };
 
 class AudioCapture : public QThread
@@ -75,8 +96,26 @@ public:
     void unregisterBandsNumber(int number);
     //int bandsNumber();
 
+    /**
+     * Copy the latest spectrum computed for $number bands into $bands,
+     * which must hold $number values. This never blocks the capture thread.
+     * Return false if no spectrum has been computed yet.
+     */
+    bool latestSpectrum(int number, double *bands, double &maxMagnitude, quint32 &power) const;
+
     static int maxFrequency() { return SPECTRUM_MAX_FREQUENCY; }
 
+    /**
+     * Request the tracking of the beats of the audio input.
+     * The results are emitted with beatTracked()
+     */
+    void registerBeatTracker();
+
+    /**
+     * Cancel a previous request of beat tracking
+     */
+    void unregisterBeatTracker();
+
     protected:
     /*!
      * Prepares object for usage and setups required audio parameters.
@@ -120,21 +159,44 @@ protected:
     void stop();
 
 private:
-    /** This is called at every processData to fill a single BandsData structure */
-    double fillBandsData(int number);
+    /** Create the FFT plan and the window for the current capture size */
+    void prepareFFT();
+
+    /** Release the FFT plan */
+    void releaseFFT();
+
+    /** This is called at every processData to publish a frame of $number bands */
+    void fillBandsData(int number);
 
     /** This is the method where captured audio data is processed in this order
      *  1) calculates the signal power, which will be the volume bar
      *  2) perform the FFT
-     *  3) retrieve the signal magnitude for each registered number of bands
+     *  3) calculate the magnitude spectrum
+     *  4) publish the magnitude of each registered number of bands
      */
     void processData();
 
+    /** Feed the beat tracker with the captured audio data, in frames of
+     *  BEAT_FRAME_SIZE samples, and emit the next predicted beat */
+    void processBeats();
+
     bool m_userStop, m_pause;
 
 signals:
+    /**
+     * Emitted when a spectrum has been computed. $spectrumBands points to
+     * a frame of the ring, which stays valid for SPECTRUM_RING_SIZE - 1
+     * further buffers.
+     */
     void dataProcessed(double *spectrumBands, int size, double maxMagnitude, quint32 power);
 
+    /**
+     * Emitted from the capture thread when the beat tracker is locked on
+     * a tempo of $bpm. The next beat is predicted in $nextBeatDelay
+     * milliseconds, already compensated for the capture latency.
+     */
+    void beatTracked(int bpm, int nextBeatDelay);
+
 protected:
     /*!
      * Reads up to \b maxSize uint16 from \b the input interface device.
@@ -156,8 +218,39 @@ protected:
     double *m_fftInputBuffer;
     void *m_fftOutputBuffer;
 
-    /** Map of the registered clients (key is the number of bands) */
-    QMap <int, BandsData> m_fftMagnitudeMap;
+    /** The FFT plan, created once for m_fftPlanSize samples */
+    void *m_fftPlan;
+    unsigned int m_fftPlanSize;
+
+    /** The window applied to the audio data, precomputed for m_fftPlanSize samples */
+    QVector<double> m_window;
+
+    /** The magnitude of the spectrum bins up to SPECTRUM_MAX_FREQUENCY,
+     *  shared by all the numbers of bands */
+    QVector<double> m_magnitude;
+
+    /** The registered clients and their spectrum frames, indexed by number of bands */
+    BandsData m_bandsData[FREQ_SUBBANDS_MAX_NUMBER + 1];
+
+    /** Number of the registered clients, of any number of bands */
+    int m_registeredCount;
+
+    /** **************** Beat tracking variables ********************** */
+    /** Number of the beat tracking requests, and flag to start tracking afresh */
+    QAtomicInt m_beatTrackerCount;
+    QAtomicInt m_beatTrackerReset;
+
+    BeatTracker m_beatTracker;
+
+    /** The FFT plan and buffers of the beat tracker frames */
+    void *m_beatPlan;
+    double *m_beatInputBuffer;
+    void *m_beatOutputBuffer;
+    QVector<double> m_beatWindow;
+    QVector<double> m_beatMagnitude;
+
+    /** The time reference of the beat tracker */
+    QElapsedTimer m_beatClock;
 };
 
 /** @} */
@@ -0,0 +1,319 @@
+/*
+  Q Light Controller Plus
+  audiopcmcache.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QDebug>
+#include <string.h>
+#include <limits.h>
+
+#include "audioplugincache.h"
+#include "audiopcmcache.h"
+
+/** Bytes decoded at once */
+#define DECODE_CHUNK_SIZE 65536
+
+/****************************************************************************
+ * AudioDecoderPCMCache
+ ****************************************************************************/
+
+AudioDecoderPCMCache::AudioDecoderPCMCache(const QByteArray &data, const AudioParameters &parameters)
+    : AudioDecoder()
+    , m_data(data)
+    , m_frameSize(parameters.channels() * parameters.sampleSize())
+    , m_position(0)
+{
+    configure(parameters.sampleRate(), parameters.channels(), parameters.format());
+}
+
+AudioDecoderPCMCache::~AudioDecoderPCMCache()
+{
+}
+
+AudioDecoder *AudioDecoderPCMCache::createCopy()
+{
+    return new AudioDecoderPCMCache(m_data, audioParameters());
+}
+
+int AudioDecoderPCMCache::priority() const
+{
+    return 0;
+}
+
+QStringList AudioDecoderPCMCache::supportedFormats()
+{
+    return QStringList();
+}
+
+bool AudioDecoderPCMCache::initialize(const QString &path)
+{
+    Q_UNUSED(path)
+    m_position = 0;
+    return true;
+}
+
+qint64 AudioDecoderPCMCache::totalTime()
+{
+    quint32 sampleRate = audioParameters().sampleRate();
+    if (sampleRate == 0 || m_frameSize == 0)
+        return 0;
+
+    return (m_data.size() / m_frameSize) * 1000 / sampleRate;
+}
+
+void AudioDecoderPCMCache::seek(qint64 time)
+{
+    qint64 frame = time * audioParameters().sampleRate() / 1000;
+    m_position = qBound(qint64(0), frame * m_frameSize, qint64(m_data.size()));
+}
+
+qint64 AudioDecoderPCMCache::read(char *data, qint64 maxSize)
+{
+    qint64 size = qMin(maxSize, qint64(m_data.size()) - m_position);
+    if (size <= 0)
+        return 0;
+
+    memcpy(data, m_data.constData() + m_position, size);
+    m_position += size;
+
+    return size;
+}
+
+int AudioDecoderPCMCache::bitrate()
+{
+    return int(audioParameters().sampleRate() * m_frameSize * 8 / 1000);
+}
+
+/****************************************************************************
+ * AudioPCMCache
+ ****************************************************************************/
+
+AudioPCMCache::AudioPCMCache(AudioPluginCache *pluginCache, QObject *parent)
+    : QThread(parent)
+    , m_pluginCache(pluginCache)
+    , m_running(true)
+    , m_budget(0)
+    , m_usage(0)
+    , m_generation(0)
+    , m_useCounter(0)
+{
+    Q_ASSERT(m_pluginCache != NULL);
+}
+
+AudioPCMCache::~AudioPCMCache()
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        m_running = false;
+        m_condition.wakeOne();
+    }
+
+    wait();
+}
+
+void AudioPCMCache::setBudget(qint64 bytes)
+{
+    QMutexLocker locker(&m_mutex);
+    m_budget = qMax(qint64(0), bytes);
+
+    if (m_budget == 0)
+        m_queue.clear();
+
+    makeRoom(0);
+}
+
+qint64 AudioPCMCache::budget() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_budget;
+}
+
+qint64 AudioPCMCache::usage() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_usage;
+}
+
+void AudioPCMCache::request(const QString &fileName)
+{
+    QMutexLocker locker(&m_mutex);
+
+    if (m_budget == 0 || fileName.isEmpty() ||
+        m_entries.contains(fileName) || m_queue.contains(fileName))
+        return;
+
+    m_queue.append(fileName);
+
+    if (isRunning() == false)
+        start(QThread::LowPriority);
+    else
+        m_condition.wakeOne();
+}
+
+bool AudioPCMCache::contains(const QString &fileName) const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_entries.contains(fileName);
+}
+
+AudioDecoder *AudioPCMCache::createDecoder(const QString &fileName)
+{
+    QMutexLocker locker(&m_mutex);
+
+    QHash<QString, CacheEntry>::iterator it = m_entries.find(fileName);
+    if (it == m_entries.end())
+        return NULL;
+
+    it.value().m_lastUsed = ++m_useCounter;
+
+    return new AudioDecoderPCMCache(it.value().m_data, it.value().m_parameters);
+}
+
+void AudioPCMCache::clear()
+{
+    QMutexLocker locker(&m_mutex);
+    m_queue.clear();
+    m_entries.clear();
+    m_usage = 0;
+    m_generation++;
+}
+
+bool AudioPCMCache::makeRoom(qint64 size)
+{
+    if (size > m_budget)
+        return false;
+
+    while (m_usage + size > m_budget && m_entries.isEmpty() == false)
+    {
+        QHash<QString, CacheEntry>::iterator oldest = m_entries.begin();
+        for (QHash<QString, CacheEntry>::iterator it = m_entries.begin(); it != m_entries.end(); ++it)
+        {
+            if (it.value().m_lastUsed < oldest.value().m_lastUsed)
+                oldest = it;
+        }
+
+        qDebug() << "[AudioPCMCache] evicting" << oldest.key();
+
+        // decoders still playing it keep their own reference to the data
+        m_usage -= oldest.value().m_data.size();
+        m_entries.erase(oldest);
+    }
+
+    return true;
+}
+
+/****************************************************************************
+ * Worker thread
+ ****************************************************************************/
+
+void AudioPCMCache::run()
+{
+    QMutexLocker locker(&m_mutex);
+
+    while (m_running)
+    {
+        if (m_queue.isEmpty())
+        {
+            m_condition.wait(&m_mutex);
+            continue;
+        }
+
+        QString fileName = m_queue.takeFirst();
+        quint32 generation = m_generation;
+
+        locker.unlock();
+        QByteArray data;
+        AudioParameters parameters;
+        bool decoded = decode(fileName, data, parameters);
+        locker.relock();
+
+        // the cache might have been cleared in the meantime
+        if (decoded == false || m_running == false || generation != m_generation)
+            continue;
+
+        if (makeRoom(data.size()) == false)
+            continue;
+
+        CacheEntry entry;
+        entry.m_data = data;
+        entry.m_parameters = parameters;
+        entry.m_lastUsed = ++m_useCounter;
+        m_entries.insert(fileName, entry);
+        m_usage += data.size();
+
+        qDebug() << "[AudioPCMCache] cached" << fileName << "-" << data.size() << "bytes, usage:" << m_usage;
+
+        locker.unlock();
+        emit fileCached(fileName);
+        locker.relock();
+    }
+}
+
+bool AudioPCMCache::decode(const QString &fileName, QByteArray &data, AudioParameters &parameters)
+{
+    AudioDecoder *decoder = m_pluginCache->getDecoderForFile(fileName);
+    if (decoder == NULL)
+        return false;
+
+    parameters = decoder->audioParameters();
+    qint64 frameSize = parameters.channels() * parameters.sampleSize();
+    qint64 estimatedSize = decoder->totalTime() * parameters.sampleRate() / 1000 * frameSize;
+
+    {
+        QMutexLocker locker(&m_mutex);
+        // don't even try with files that can't fit
+        if (frameSize <= 0 || estimatedSize > m_budget ||
+            estimatedSize > INT_MAX - 2 * DECODE_CHUNK_SIZE)
+        {
+            qDebug() << "[AudioPCMCache]" << fileName << "doesn't fit in the cache";
+            delete decoder;
+            return false;
+        }
+    }
+
+    data.reserve(int(estimatedSize + DECODE_CHUNK_SIZE));
+    decoder->seek(0);
+
+    qint64 size = 0;
+    bool result = true;
+
+    forever
+    {
+        data.resize(int(size + DECODE_CHUNK_SIZE));
+        qint64 read = decoder->read(data.data() + size, DECODE_CHUNK_SIZE);
+        if (read <= 0)
+            break;
+
+        size += read;
+
+        QMutexLocker locker(&m_mutex);
+        if (m_running == false || size > m_budget ||
+            size > INT_MAX - 2 * DECODE_CHUNK_SIZE)
+        {
+            result = false;
+            break;
+        }
+    }
+
+    delete decoder;
+
+    // keep whole frames only, so seeks stay aligned
+    data.resize(int(size - size % frameSize));
+    data.squeeze();
+
+    return result && data.isEmpty() == false;
+}
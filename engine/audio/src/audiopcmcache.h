@@ -0,0 +1,177 @@
+/*
+  Q Light Controller Plus
+  audiopcmcache.h
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef AUDIOPCMCACHE_H
+#define AUDIOPCMCACHE_H
+
+#include <QWaitCondition>
+#include <QStringList>
+#include <QByteArray>
+#include <QThread>
+#include <QMutex>
+#include <QHash>
+
+#include "audiodecoder.h"
+
+class AudioPluginCache;
+
+/** @addtogroup engine_audio Audio
+ * @{
+ */
+
+/** Memory budget of the decoded audio in megabytes. 0 disables the cache */
+#define SETTINGS_AUDIO_PCM_CACHE_SIZE "audio/pcmcachesize"
+
+/** Budget in megabytes used when the setting is absent: the cache is disabled */
+#define AUDIO_PCM_CACHE_DEFAULT_SIZE 0
+
+/**
+ * AudioDecoderPCMCache plays the decoded PCM data held by AudioPCMCache.
+ * Seeking and reading are just a position change and a copy.
+ * The data is implicitly shared, so it stays valid even if the cache
+ * evicts it while the decoder is in use.
+ */
+class AudioDecoderPCMCache : public AudioDecoder
+{
+    Q_OBJECT
+
+public:
+    AudioDecoderPCMCache(const QByteArray &data, const AudioParameters &parameters);
+    ~AudioDecoderPCMCache();
+
+    /** @reimp */
+    AudioDecoder *createCopy();
+
+    /** @reimp */
+    int priority() const;
+
+    /** @reimp */
+    QStringList supportedFormats();
+
+    /** @reimp */
+    bool initialize(const QString &path);
+
+    /** @reimp */
+    qint64 totalTime();
+
+    /** @reimp */
+    void seek(qint64 time);
+
+    /** @reimp */
+    qint64 read(char *data, qint64 maxSize);
+
+    /** @reimp */
+    int bitrate();
+
+private:
+    QByteArray m_data;
+    qint64 m_frameSize;
+    qint64 m_position;
+};
+
+/**
+ * AudioPCMCache decodes in a background thread the audio files of the
+ * loaded workspace and keeps their PCM data in memory, so that Audio
+ * functions can start and seek without decoding.
+ *
+ * The decoded data is bounded by a memory budget. When a new file
+ * doesn't fit, the least recently used files are evicted, and files
+ * bigger than the whole budget are not cached at all.
+ */
+class AudioPCMCache : public QThread
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(AudioPCMCache)
+
+public:
+    AudioPCMCache(AudioPluginCache *pluginCache, QObject *parent = NULL);
+    ~AudioPCMCache();
+
+    /** Set the memory budget in bytes. 0 disables the cache */
+    void setBudget(qint64 bytes);
+
+    /** Get the memory budget in bytes */
+    qint64 budget() const;
+
+    /** Get the size in bytes of the decoded data in the cache */
+    qint64 usage() const;
+
+    /** Queue $fileName to be decoded in the background */
+    void request(const QString &fileName);
+
+    /** Return true if $fileName has been decoded */
+    bool contains(const QString &fileName) const;
+
+    /**
+     * Create a decoder playing the cached data of $fileName, or
+     * return NULL if $fileName has not been decoded. The caller
+     * owns the returned decoder.
+     */
+    AudioDecoder *createDecoder(const QString &fileName);
+
+    /** Forget the queued requests and release all the decoded data */
+    void clear();
+
+signals:
+    /** Emitted from the worker thread when $fileName has been decoded */
+    void fileCached(const QString &fileName);
+
+protected:
+    /** @reimp */
+    void run();
+
+private:
+    /** Decode $fileName into $data, if it fits in the budget */
+    bool decode(const QString &fileName, QByteArray &data, AudioParameters &parameters);
+
+    /** Evict the least recently used entries until $size bytes fit in the budget.
+     *  Must be called with m_mutex locked */
+    bool makeRoom(qint64 size);
+
+private:
+    AudioPluginCache *m_pluginCache;
+
+    /** Mutex guarding all the members below */
+    mutable QMutex m_mutex;
+    QWaitCondition m_condition;
+    bool m_running;
+
+    qint64 m_budget;
+    qint64 m_usage;
+
+    /** Incremented by clear(), to discard the files decoded before */
+    quint32 m_generation;
+
+    /** The files waiting to be decoded */
+    QStringList m_queue;
+
+    typedef struct
+    {
+        QByteArray m_data;              //! The decoded PCM data
+        AudioParameters m_parameters;   //! The format of m_data
+        quint64 m_lastUsed;             //! Value of m_useCounter at the last use
+    } CacheEntry;
+
+    QHash<QString, CacheEntry> m_entries;
+    quint64 m_useCounter;
+};
+
+/** @} */
+
+#endif
@@ -18,9 +18,11 @@
 */
 
 #include <QPluginLoader>
+#include <QSettings>
 #include <QDebug>
 
 #include "audioplugincache.h"
+#include "audiopcmcache.h"
 #include "audiodecoder.h"
 #include "qlcfile.h"
 
@@ -50,10 +52,21 @@ AudioPluginCache::AudioPluginCache(QObject *parent)
 #else
     m_audioDevicesList = AudioRendererQt::getDevicesInfo();
 #endif
+
+    m_pcmCache = new AudioPCMCache(this, this);
+
+    QSettings settings;
+    QVariant var = settings.value(SETTINGS_AUDIO_PCM_CACHE_SIZE);
+    if (var.isValid() == true)
+        m_pcmCache->setBudget(var.toLongLong() * 1024 * 1024);
+    else
+        m_pcmCache->setBudget(qint64(AUDIO_PCM_CACHE_DEFAULT_SIZE) * 1024 * 1024);
 }
 
 AudioPluginCache::~AudioPluginCache()
 {
+    // stop the decoding thread before the plugins list goes away
+    delete m_pcmCache;
 }
 
 void AudioPluginCache::load(const QDir &dir)
@@ -137,3 +150,8 @@ QList<AudioDeviceInfo> AudioPluginCache::audioDevicesList() const
 {
     return m_audioDevicesList;
 }
+
+AudioPCMCache *AudioPluginCache::pcmCache() const
+{
+    return m_pcmCache;
+}
@@ -31,6 +31,7 @@
  */
 
 class AudioDecoder;
+class AudioPCMCache;
 
 class AudioPluginCache : public QObject
 {
@@ -54,10 +55,14 @@ public:
     /** Get the list of cached audio devices detected on creation */
     QList<AudioDeviceInfo> audioDevicesList() const;
 
+    /** Get the cache of the decoded audio files */
+    AudioPCMCache *pcmCache() const;
+
 private:
     /** a map of the vailable plugins ordered by priority */
     QMap<int, QString> m_pluginsMap;
     QList<AudioDeviceInfo> m_audioDevicesList;
+    AudioPCMCache *m_pcmCache;
 };
 
 /** @} */
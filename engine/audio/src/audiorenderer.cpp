@@ -26,6 +26,10 @@
 AudioRenderer::AudioRenderer (QObject* parent)
     : QThread (parent)
     , m_fadeStep(0.0)
+    , m_startPosition(0)
+    , m_bytesWritten(0)
+    , m_writtenPosition(-1)
+    , m_playedPosition(-1)
     , m_userStop(true)
     , m_pause(false)
     , m_intensity(1.0)
@@ -75,6 +79,46 @@ void AudioRenderer::setFadeOut(uint fadeTime)
     qDebug() << Q_FUNC_INFO << "stepsCount:" << stepsCount << ", fadeStep:" << m_fadeStep;
 }
 
+/*********************************************************************
+ * Playback position
+ *********************************************************************/
+
+void AudioRenderer::setStartPosition(qint64 msec)
+{
+    QMutexLocker locker(&m_positionMutex);
+    m_startPosition = msec;
+}
+
+qint64 AudioRenderer::playbackPosition() const
+{
+    QMutexLocker locker(&m_positionMutex);
+
+    if (m_playedPosition < 0)
+        return -1;
+
+    // the device keeps playing between writes, but it can't play
+    // what has not been written yet
+    qint64 elapsed = qMin(m_positionTimer.nsecsElapsed() / 1000,
+                          qint64(AUDIO_POSITION_MAX_EXTRAPOLATION) * 1000);
+
+    return qMin(m_playedPosition + elapsed, m_writtenPosition) / 1000;
+}
+
+void AudioRenderer::updatePosition()
+{
+    AudioParameters ap = m_adec->audioParameters();
+    qint64 frameSize = ap.channels() * ap.sampleSize();
+    if (frameSize <= 0 || ap.sampleRate() == 0)
+        return;
+
+    qint64 delay = latency();
+
+    QMutexLocker locker(&m_positionMutex);
+    m_writtenPosition = m_startPosition * 1000 + (m_bytesWritten / frameSize) * 1000000 / ap.sampleRate();
+    m_playedPosition = qMax(m_startPosition * 1000, m_writtenPosition - delay * 1000);
+    m_positionTimer.start();
+}
+
 void AudioRenderer::stop()
 {
     m_userStop = true;
@@ -87,6 +131,14 @@ void AudioRenderer::run()
 {
     m_userStop = false;
     audioDataRead = 0;
+
+    {
+        QMutexLocker locker(&m_positionMutex);
+        m_bytesWritten = 0;
+        m_writtenPosition = -1;
+        m_playedPosition = -1;
+    }
+
     int sampleSize = m_adec->audioParameters().sampleSize();
     if (sampleSize > 2)
         sampleSize = 2;
@@ -173,6 +225,10 @@ void AudioRenderer::run()
                 usleep(15000);
           }
           //qDebug() << "[Cycle] read: " << audioDataRead << ", written: " << audioDataWritten;
+
+          if (audioDataWritten > 0)
+              m_bytesWritten += audioDataWritten;
+          updatePosition();
         }
         else
             usleep(15000);
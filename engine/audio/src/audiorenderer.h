@@ -20,6 +20,7 @@
 #ifndef AUDIORENDERER_H
 #define AUDIORENDERER_H
 
+#include <QElapsedTimer>
 #include <QThread>
 #include <QMutex>
 
@@ -34,6 +35,10 @@
 
 #define SETTINGS_AUDIO_OUTPUT_DEVICE "audio/output"
 
+/** Maximum time in milliseconds the playback position is extrapolated
+ *  after the last write to the device */
+#define AUDIO_POSITION_MAX_EXTRAPOLATION 100
+
 typedef struct
 {
     QString deviceName;
@@ -107,6 +112,45 @@ public:
 private:
     qreal m_fadeStep;
 
+    /*********************************************************************
+     * Playback position
+     *********************************************************************/
+public:
+    /**
+     * Set the position in milliseconds of the first sample that
+     * will be rendered, when the decoder has been seeked. Call it
+     * before start().
+     */
+    void setStartPosition(qint64 msec);
+
+    /**
+     * Get the position in milliseconds of the sample being heard right
+     * now, or -1 if nothing has been written to the device yet.
+     * The position is the duration of the frames written to the device
+     * minus its latency, extrapolated between writes, and it keeps
+     * growing when the stream loops. This method is thread safe.
+     */
+    qint64 playbackPosition() const;
+
+private:
+    /** Publish the position after a write to the device */
+    void updatePosition();
+
+private:
+    /** Mutex guarding the position members below */
+    mutable QMutex m_positionMutex;
+
+    qint64 m_startPosition;
+    qint64 m_bytesWritten;
+
+    /** Position in microseconds of the last sample written and of the
+     *  sample heard at the last update, or -1 */
+    qint64 m_writtenPosition;
+    qint64 m_playedPosition;
+
+    /** Time elapsed since the last update */
+    QElapsedTimer m_positionTimer;
+
     /*********************************************************************
      * Thread functions
      *********************************************************************/
@@ -52,6 +52,7 @@ AudioRendererAlsa::AudioRendererAlsa(QString device, QObject * parent)
     m_prebuf_size = 0;
     m_prebuf_fill = 0;
     m_can_pause = false;
+    m_rate = 0;
 }
 
 AudioRendererAlsa::~AudioRendererAlsa()
@@ -197,6 +198,7 @@ bool AudioRendererAlsa::initialize(quint32 freq, int chan, AudioFormat format)
     //setup needed values
     m_bits_per_frame = snd_pcm_format_physical_width(alsa_format) * chan;
     m_chunk_size = period_size;
+    m_rate = exact_rate;
     m_can_pause = snd_pcm_hw_params_can_pause(hwparams);
 
     qDebug("OutputALSA: can pause: %d", m_can_pause);
@@ -211,8 +213,17 @@ bool AudioRendererAlsa::initialize(quint32 freq, int chan, AudioFormat format)
 
 qint64 AudioRendererAlsa::latency()
 {
-    //return m_prebuf_fill * 1000 / sampleRate() / channels() / sampleSize();
-    return 0;
+    if (pcm_handle == NULL || m_inited == false || m_rate == 0)
+        return 0;
+
+    // the frames queued in the device, plus the ones still in the prebuffer
+    snd_pcm_sframes_t delay = 0;
+    if (snd_pcm_delay(pcm_handle, &delay) < 0 || delay < 0)
+        delay = 0;
+
+    delay += snd_pcm_bytes_to_frames(pcm_handle, m_prebuf_fill);
+
+    return qint64(delay) * 1000 / m_rate;
 }
 
 QList<AudioDeviceInfo> AudioRendererAlsa::getDevicesInfo()
@@ -89,6 +89,7 @@ private:
     qint64 m_prebuf_size;
     qint64 m_prebuf_fill;
     bool m_can_pause;
+    uint m_rate;
 };
 
 /** @} */
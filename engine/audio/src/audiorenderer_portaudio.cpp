@@ -147,7 +147,19 @@ bool AudioRendererPortAudio::initialize(quint32 freq, int chan, AudioFormat form
 
 qint64 AudioRendererPortAudio::latency()
 {
-    return 0;
+    QMutexLocker locker(&m_paMutex);
+
+    if (m_paStream == NULL || m_channels == 0 || m_frameSize == 0)
+        return 0;
+
+    const PaStreamInfo *info = Pa_GetStreamInfo(m_paStream);
+    if (info == NULL || info->sampleRate <= 0)
+        return 0;
+
+    // the frames waiting for the callback, plus the latency of the stream
+    qint64 frames = m_buffer.size() / (m_frameSize * m_channels);
+
+    return qint64((frames / info->sampleRate + info->outputLatency) * 1000);
 }
 
 QList<AudioDeviceInfo> AudioRendererPortAudio::getDevicesInfo()
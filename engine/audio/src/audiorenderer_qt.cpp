@@ -109,7 +109,13 @@ bool AudioRendererQt::initialize(quint32 freq, int chan, AudioFormat format)
 
 qint64 AudioRendererQt::latency()
 {
-    return 0;
+    if (m_audioOutput == NULL)
+        return 0;
+
+    // the bytes written to the output buffer and not played yet
+    qint64 pending = m_audioOutput->bufferSize() - m_audioOutput->bytesFree();
+
+    return qMax(qint64(0), m_format.durationForBytes(qint32(pending)) / 1000);
 }
 
 QList<AudioDeviceInfo> AudioRendererQt::getDevicesInfo()
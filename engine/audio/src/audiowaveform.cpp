@@ -0,0 +1,442 @@
+/*
+  Q Light Controller Plus
+  audiowaveform.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QCryptographicHash>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QtEndian>
+#include <QDebug>
+#include <QFile>
+#include <QDir>
+#include <qmath.h>
+#include <string.h>
+
+#if QT_VERSION >= 0x050000
+#include <QStandardPaths>
+#endif
+
+#include "audioplugincache.h"
+#include "audiowaveform.h"
+#include "audiodecoder.h"
+
+/** Bytes of the beginning and of the end of a file hashed to name its cache */
+#define HASHED_CHUNK_SIZE   65536
+
+/** Bytes decoded at once */
+#define DECODE_BUFFER_SIZE  65536
+
+AudioWaveform::AudioWaveform(AudioPluginCache *cache, const QString &fileName, QObject *parent)
+    : QThread(parent)
+    , m_cache(cache)
+    , m_fileName(fileName)
+    , m_ready(0)
+    , m_cancelled(0)
+    , m_channels(0)
+    , m_sampleRate(0)
+    , m_framesCount(0)
+{
+    Q_ASSERT(m_cache != NULL);
+}
+
+AudioWaveform::~AudioWaveform()
+{
+    m_cancelled.storeRelease(1);
+    wait();
+}
+
+bool AudioWaveform::isReady() const
+{
+    return m_ready.loadAcquire() != 0;
+}
+
+int AudioWaveform::channels() const
+{
+    return isReady() ? m_channels : 0;
+}
+
+quint32 AudioWaveform::sampleRate() const
+{
+    return isReady() ? m_sampleRate : 0;
+}
+
+qint64 AudioWaveform::duration() const
+{
+    if (isReady() == false || m_sampleRate == 0)
+        return 0;
+
+    return qint64(m_framesCount * 1000 / m_sampleRate);
+}
+
+bool AudioWaveform::peaks(int channel, qint64 startTime, qint64 endTime, int count,
+                          QVector<WaveformPeak> &result) const
+{
+    result.resize(qMax(count, 0));
+
+    if (isReady() == false || m_levels.isEmpty() || count <= 0 || endTime <= startTime ||
+        channel >= m_channels)
+        return false;
+
+    // pick the coarsest level with at least one entry per peak
+    double blocksPerPeak = double(endTime - startTime) * m_sampleRate / 1000.0 /
+                           AUDIOWAVEFORM_BLOCK_SIZE / count;
+    int level = 0;
+    while (level < m_levels.count() - 1 && blocksPerPeak >= double(2 << level))
+        level++;
+
+    const quint8 *entries = reinterpret_cast<const quint8 *>(m_levels.at(level).constData());
+    qint64 entriesCount = m_levels.at(level).size() / (m_channels * 3);
+    double entryDuration = double(AUDIOWAVEFORM_BLOCK_SIZE << level) * 1000.0 / m_sampleRate;
+    double entriesPerPeak = double(endTime - startTime) / entryDuration / count;
+    double position = double(startTime) / entryDuration;
+    int firstChannel = channel < 0 ? 0 : channel;
+    int lastChannel = channel < 0 ? m_channels - 1 : channel;
+
+    for (int i = 0; i < count; i++)
+    {
+        qint64 first = qint64(qFloor(position + i * entriesPerPeak));
+        qint64 last = qMax(first + 1, qint64(qFloor(position + (i + 1) * entriesPerPeak)));
+        WaveformPeak &peak = result[i];
+
+        first = qMax(first, qint64(0));
+        last = qMin(last, entriesCount);
+
+        if (first >= last)
+        {
+            peak.m_min = peak.m_max = 0;
+            peak.m_rms = 0;
+            continue;
+        }
+
+        int min = 127, max = -128;
+        double squares = 0;
+
+        for (qint64 e = first; e < last; e++)
+        {
+            for (int c = firstChannel; c <= lastChannel; c++)
+            {
+                const quint8 *entry = entries + (e * m_channels + c) * 3;
+                min = qMin(min, int(qint8(entry[0])));
+                max = qMax(max, int(qint8(entry[1])));
+                squares += double(entry[2]) * entry[2];
+            }
+        }
+
+        peak.m_min = qint8(min);
+        peak.m_max = qint8(max);
+        peak.m_rms = quint8(qMin(255, qRound(sqrt(squares / ((last - first) * (lastChannel - firstChannel + 1))))));
+    }
+
+    return true;
+}
+
+QString AudioWaveform::cacheFileName(const QString &fileName)
+{
+    QFile file(fileName);
+    if (file.open(QIODevice::ReadOnly) == false)
+        return QString();
+
+    // hashing the whole file would take as long as decoding it, so hash
+    // its size, its modification time and its edges, where the audio
+    // formats keep their headers. The time catches the edits that
+    // change neither the size nor the edges
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    qint64 size = file.size();
+    qint64 mtime = QFileInfo(file).lastModified().toMSecsSinceEpoch();
+    uchar keyData[16];
+    qToLittleEndian<quint64>(quint64(size), keyData);
+    qToLittleEndian<quint64>(quint64(mtime), keyData + 8);
+    hash.addData(reinterpret_cast<const char *>(keyData), 16);
+    hash.addData(file.read(HASHED_CHUNK_SIZE));
+    if (size > HASHED_CHUNK_SIZE)
+    {
+        file.seek(qMax(qint64(HASHED_CHUNK_SIZE), size - HASHED_CHUNK_SIZE));
+        hash.addData(file.read(HASHED_CHUNK_SIZE));
+    }
+
+#if QT_VERSION >= 0x050000
+    QString dir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+#else
+    QString dir = QDir::tempPath() + QDir::separator() + "qlcplus";
+#endif
+
+    return dir + QDir::separator() + "waveforms" + QDir::separator() +
+           QString(hash.result().toHex()) + ".peaks";
+}
+
+/****************************************************************************
+ * Worker thread
+ ****************************************************************************/
+
+void AudioWaveform::run()
+{
+    QString path = cacheFileName(m_fileName);
+
+    if (path.isEmpty())
+    {
+        qWarning() << "[AudioWaveform] unable to read" << m_fileName;
+        return;
+    }
+
+    if (load(path) == false)
+    {
+        if (decode() == false)
+            return;
+
+        buildLevels();
+
+        if (save(path) == false)
+            qWarning() << "[AudioWaveform] unable to cache the waveform to" << path;
+    }
+
+    m_ready.storeRelease(1);
+
+    emit ready();
+}
+
+bool AudioWaveform::load(const QString &path)
+{
+    QFile file(path);
+    if (file.open(QIODevice::ReadOnly) == false)
+        return false;
+
+    uchar header[AUDIOWAVEFORM_HEADER_SIZE];
+    if (file.read(reinterpret_cast<char *>(header), AUDIOWAVEFORM_HEADER_SIZE) != AUDIOWAVEFORM_HEADER_SIZE ||
+        memcmp(header, AUDIOWAVEFORM_MAGIC, 8) != 0 ||
+        qFromLittleEndian<quint32>(header + 8) != AUDIOWAVEFORM_VERSION)
+        return false;
+
+    int channels = int(qFromLittleEndian<quint32>(header + 12));
+    quint32 sampleRate = qFromLittleEndian<quint32>(header + 16);
+    int levelsCount = int(qFromLittleEndian<quint32>(header + 20));
+    quint64 framesCount = qFromLittleEndian<quint64>(header + 24);
+
+    if (channels <= 0 || sampleRate == 0 || levelsCount <= 0 || levelsCount > 64)
+        return false;
+
+    m_levels.clear();
+
+    quint64 entriesCount = (framesCount + AUDIOWAVEFORM_BLOCK_SIZE - 1) / AUDIOWAVEFORM_BLOCK_SIZE;
+    for (int i = 0; i < levelsCount; i++)
+    {
+        qint64 size = qint64(entriesCount) * channels * 3;
+        QByteArray data = file.read(size);
+        if (data.size() != size)
+        {
+            m_levels.clear();
+            return false;
+        }
+        m_levels.append(data);
+        entriesCount = (entriesCount + 1) / 2;
+    }
+
+    m_channels = channels;
+    m_sampleRate = sampleRate;
+    m_framesCount = framesCount;
+
+    qDebug() << "[AudioWaveform] loaded" << m_fileName << "from" << path;
+
+    return true;
+}
+
+bool AudioWaveform::save(const QString &path) const
+{
+    QFileInfo info(path);
+    if (QDir().mkpath(info.absolutePath()) == false)
+        return false;
+
+    // write to a temporary file, so a half written cache is never loaded
+    QString tmpPath = path + ".tmp";
+    QFile file(tmpPath);
+    if (file.open(QIODevice::WriteOnly | QIODevice::Truncate) == false)
+        return false;
+
+    uchar header[AUDIOWAVEFORM_HEADER_SIZE];
+    memcpy(header, AUDIOWAVEFORM_MAGIC, 8);
+    qToLittleEndian<quint32>(AUDIOWAVEFORM_VERSION, header + 8);
+    qToLittleEndian<quint32>(quint32(m_channels), header + 12);
+    qToLittleEndian<quint32>(m_sampleRate, header + 16);
+    qToLittleEndian<quint32>(quint32(m_levels.count()), header + 20);
+    qToLittleEndian<quint64>(m_framesCount, header + 24);
+    qToLittleEndian<quint64>(0, header + 32);
+
+    bool result = file.write(reinterpret_cast<const char *>(header), AUDIOWAVEFORM_HEADER_SIZE) == AUDIOWAVEFORM_HEADER_SIZE;
+    foreach (QByteArray level, m_levels)
+        result = result && file.write(level) == level.size();
+
+    file.close();
+
+    if (result)
+    {
+        QFile::remove(path);
+        result = QFile::rename(tmpPath, path);
+    }
+
+    if (result == false)
+        QFile::remove(tmpPath);
+
+    return result;
+}
+
+bool AudioWaveform::decode()
+{
+    AudioDecoder *decoder = m_cache->getDecoderForFile(m_fileName);
+    if (decoder == NULL)
+    {
+        qWarning() << "[AudioWaveform] no decoder for" << m_fileName;
+        return false;
+    }
+
+    AudioParameters ap = decoder->audioParameters();
+    int channels = ap.channels();
+    int sampleSize = ap.sampleSize();
+    AudioFormat format = ap.format();
+
+    if (channels <= 0 || sampleSize <= 0 || format == PCM_UNKNOWN)
+    {
+        delete decoder;
+        return false;
+    }
+
+    // estimate the size of the finest level, to avoid reallocations
+    qint64 estimatedFrames = decoder->totalTime() * ap.sampleRate() / 1000;
+    QByteArray entries;
+    entries.reserve(int((estimatedFrames / AUDIOWAVEFORM_BLOCK_SIZE + 1) * channels * 3));
+
+    QVector<qint32> min(channels), max(channels);
+    QVector<qint64> squares(channels);
+    int frameSize = channels * sampleSize;
+    int blockFrames = 0;
+    quint64 framesCount = 0;
+
+    // some decoders return partial frames, so keep the remainder
+    QByteArray buffer(DECODE_BUFFER_SIZE + frameSize, 0);
+    int pending = 0;
+
+    decoder->seek(0);
+
+    while (m_cancelled.loadAcquire() == 0)
+    {
+        qint64 read = decoder->read(buffer.data() + pending, DECODE_BUFFER_SIZE);
+        if (read <= 0)
+            break;
+
+        int available = pending + int(read);
+        int framesRead = available / frameSize;
+        const uchar *data = reinterpret_cast<const uchar *>(buffer.constData());
+
+        for (int f = 0; f < framesRead; f++)
+        {
+            if (blockFrames == 0)
+            {
+                min.fill(32767);
+                max.fill(-32768);
+                squares.fill(0);
+            }
+
+            for (int c = 0; c < channels; c++, data += sampleSize)
+            {
+                // peaks are 8 bit anyway, so 16 bit samples are enough
+                qint32 value;
+                switch (format)
+                {
+                    case PCM_S8: value = qint32(qint8(data[0])) << 8; break;
+                    case PCM_S16LE: value = qFromLittleEndian<qint16>(data); break;
+                    case PCM_S24LE: value = qint16(qFromLittleEndian<quint16>(data + 1)); break;
+                    default: value = qint16(qFromLittleEndian<quint16>(data + 2)); break;
+                }
+
+                min[c] = qMin(min[c], value);
+                max[c] = qMax(max[c], value);
+                squares[c] += qint64(value) * value;
+            }
+
+            if (++blockFrames == AUDIOWAVEFORM_BLOCK_SIZE)
+            {
+                for (int c = 0; c < channels; c++)
+                {
+                    entries.append(char(min[c] >> 8));
+                    entries.append(char(max[c] >> 8));
+                    entries.append(char(qMin(255, int(sqrt(double(squares[c]) / blockFrames)) >> 7)));
+                }
+                blockFrames = 0;
+            }
+        }
+
+        framesCount += framesRead;
+        pending = available - framesRead * frameSize;
+        if (pending)
+            memmove(buffer.data(), buffer.constData() + framesRead * frameSize, pending);
+    }
+
+    // the last block may be incomplete
+    if (blockFrames > 0)
+    {
+        for (int c = 0; c < channels; c++)
+        {
+            entries.append(char(min[c] >> 8));
+            entries.append(char(max[c] >> 8));
+            entries.append(char(qMin(255, int(sqrt(double(squares[c]) / blockFrames)) >> 7)));
+        }
+    }
+
+    delete decoder;
+
+    if (m_cancelled.loadAcquire() != 0 || framesCount == 0)
+        return false;
+
+    m_channels = channels;
+    m_sampleRate = ap.sampleRate();
+    m_framesCount = framesCount;
+    m_levels.clear();
+    m_levels.append(entries);
+
+    qDebug() << "[AudioWaveform] decoded" << framesCount << "frames of" << m_fileName;
+
+    return true;
+}
+
+void AudioWaveform::buildLevels()
+{
+    while (m_levels.last().size() > m_channels * 3)
+    {
+        const QByteArray &lower = m_levels.last();
+        int lowerCount = lower.size() / (m_channels * 3);
+        QByteArray upper((lowerCount + 1) / 2 * m_channels * 3, 0);
+        const quint8 *src = reinterpret_cast<const quint8 *>(lower.constData());
+        quint8 *dst = reinterpret_cast<quint8 *>(upper.data());
+
+        for (int i = 0; i < lowerCount; i += 2)
+        {
+            // an odd entry at the end has no sibling
+            int siblings = (i + 1 < lowerCount) ? 2 : 1;
+
+            for (int c = 0; c < m_channels; c++, dst += 3)
+            {
+                const quint8 *a = src + (i * m_channels + c) * 3;
+                const quint8 *b = a + (siblings - 1) * m_channels * 3;
+
+                dst[0] = quint8(qMin(qint8(a[0]), qint8(b[0])));
+                dst[1] = quint8(qMax(qint8(a[1]), qint8(b[1])));
+                dst[2] = quint8(qRound(sqrt((double(a[2]) * a[2] + double(b[2]) * b[2]) / 2)));
+            }
+        }
+
+        m_levels.append(upper);
+    }
+}
@@ -0,0 +1,141 @@
+/*
+  Q Light Controller Plus
+  audiowaveform.h
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef AUDIOWAVEFORM_H
+#define AUDIOWAVEFORM_H
+
+#include <QAtomicInt>
+#include <QByteArray>
+#include <QVector>
+#include <QThread>
+
+class AudioPluginCache;
+class AudioDecoder;
+
+/** @addtogroup engine_audio Audio
+ * @{
+ */
+
+#define AUDIOWAVEFORM_MAGIC "QLCWAVEF"
+#define AUDIOWAVEFORM_VERSION 1
+#define AUDIOWAVEFORM_HEADER_SIZE 40
+
+/** Number of audio frames summarized by an entry of the finest level */
+#define AUDIOWAVEFORM_BLOCK_SIZE 256
+
+typedef struct
+{
+    qint8 m_min;    //! Lowest sample value, from -128 to 127
+    qint8 m_max;    //! Highest sample value, from -128 to 127
+    quint8 m_rms;   //! RMS value, from 0 to 255
+} WaveformPeak;
+
+/**
+ * AudioWaveform holds the peaks of an audio file at multiple resolutions,
+ * so that a timeline can draw it at any zoom level without decoding it.
+ *
+ * The finest level summarizes AUDIOWAVEFORM_BLOCK_SIZE frames per entry
+ * and each level above halves the resolution of the one below. An entry
+ * holds the WaveformPeak of each channel.
+ *
+ * The pyramid is computed once in a background thread and stored in a
+ * cache directory, named after a hash of the file contents, so that the
+ * next time it is just loaded. All the values are little endian.
+ *
+ * Cache file header (AUDIOWAVEFORM_HEADER_SIZE bytes):
+ *   char[8]  magic (AUDIOWAVEFORM_MAGIC)
+ *   quint32  version
+ *   quint32  number of channels
+ *   quint32  sample rate
+ *   quint32  number of levels
+ *   quint64  number of audio frames
+ *   quint64  reserved
+ *
+ * Then the entries of each level, from the finest one.
+ */
+class AudioWaveform : public QThread
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(AudioWaveform)
+
+public:
+    /** Create the waveform of $fileName, decoded with the plugins of $cache.
+     *  Call start() to load or compute it */
+    AudioWaveform(AudioPluginCache *cache, const QString &fileName, QObject *parent = NULL);
+    ~AudioWaveform();
+
+    /** Return true when the peaks are available */
+    bool isReady() const;
+
+    int channels() const;
+    quint32 sampleRate() const;
+
+    /** Get the duration of the audio file in milliseconds */
+    qint64 duration() const;
+
+    /**
+     * Summarize the time range from $startTime to $endTime (in milliseconds)
+     * into $count peaks of $channel, or of all the channels if $channel is -1.
+     * Return false if the waveform is not ready.
+     */
+    bool peaks(int channel, qint64 startTime, qint64 endTime, int count,
+               QVector<WaveformPeak> &result) const;
+
+    /** Get the path of the cache file of the waveform of $fileName */
+    static QString cacheFileName(const QString &fileName);
+
+signals:
+    /** Emitted from the worker thread when the peaks are available */
+    void ready();
+
+protected:
+    /** @reimp */
+    void run();
+
+private:
+    /** Load the pyramid from $path. Return false if missing or invalid */
+    bool load(const QString &path);
+
+    /** Save the pyramid to $path */
+    bool save(const QString &path) const;
+
+    /** Decode the audio file and compute the finest level */
+    bool decode();
+
+    /** Compute the coarser levels from the finest one */
+    void buildLevels();
+
+private:
+    AudioPluginCache *m_cache;
+    QString m_fileName;
+
+    QAtomicInt m_ready;
+    QAtomicInt m_cancelled;
+
+    int m_channels;
+    quint32 m_sampleRate;
+    quint64 m_framesCount;
+
+    /** The entries of each level, from the finest one */
+    QVector<QByteArray> m_levels;
+};
+
+/** @} */
+
+#endif
@@ -0,0 +1,348 @@
+/*
+  Q Light Controller Plus
+  beattracker.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <qmath.h>
+
+#include "beattracker.h"
+
+/** The tempo preferred when several lags correlate equally well */
+#define PREFERRED_BPM       120.0
+
+/** Weight of a new estimation in the smoothed beat period and phase */
+#define PERIOD_SMOOTHING    0.1
+#define PHASE_SMOOTHING     0.25
+
+/** A tempo estimation further than this from the tracked one is a tempo change,
+ *  which is followed when it lasts more than TEMPO_CHANGE_TIME milliseconds */
+#define TEMPO_CHANGE        0.08
+#define TEMPO_CHANGE_TIME   2000
+
+/** Weight decay of the older beats when estimating the phase */
+#define PHASE_DECAY         0.9
+
+BeatTracker::BeatTracker()
+    : m_framePeriod(0)
+    , m_onsetsHead(0)
+    , m_onsetsCount(0)
+    , m_locked(false)
+    , m_missedFrames(0)
+    , m_tempoChangeFrames(0)
+    , m_beatPeriod(0)
+    , m_beatTime(0)
+    , m_bpm(0)
+{
+}
+
+BeatTracker::~BeatTracker()
+{
+}
+
+void BeatTracker::reset(qint64 framePeriod)
+{
+    Q_ASSERT(framePeriod > 0);
+
+    m_framePeriod = framePeriod;
+    m_previousSpectrum.clear();
+    m_onsets.fill(0, qMax(1, int((qint64(BEATTRACKER_HISTORY) * 1000) / framePeriod)));
+    m_onsetsHead = 0;
+    m_onsetsCount = 0;
+    m_locked = false;
+    m_missedFrames = 0;
+    m_tempoChangeFrames = 0;
+    m_beatPeriod = 0;
+    m_beatTime = 0;
+    m_bpm = 0;
+
+    // allocate the analysis buffers for the slowest beat once,
+    // since the frames are processed on the capture thread
+    int maxLag = qCeil(60000000.0 / framePeriod / BEATTRACKER_MIN_BPM);
+    m_autoCorrelation.reserve(2 * maxLag + 2);
+    m_phaseScores.reserve(2 * maxLag + 4);
+}
+
+bool BeatTracker::processSpectrum(const double *magnitude, int binsCount, qint64 time)
+{
+    bool firstFrame = false;
+    if (m_previousSpectrum.size() != binsCount)
+    {
+        m_previousSpectrum.fill(0, binsCount);
+        firstFrame = true;
+    }
+
+    // spectral flux of the log-magnitude, so that quiet
+    // and loud onsets weigh about the same
+    double *previous = m_previousSpectrum.data();
+    double flux = 0;
+
+    for (int i = 0; i < binsCount; i++)
+    {
+        double value = qLn(1.0 + magnitude[i]);
+        if (value > previous[i])
+            flux += value - previous[i];
+        previous[i] = value;
+    }
+
+    return processOnset(firstFrame ? 0 : flux, time);
+}
+
+bool BeatTracker::processOnset(double onset, qint64 time)
+{
+    if (m_framePeriod <= 0)
+        return false;
+
+    m_onsets[m_onsetsHead] = onset;
+    m_onsetsHead = (m_onsetsHead + 1) % m_onsets.size();
+    if (m_onsetsCount < m_onsets.size())
+        m_onsetsCount++;
+
+    double period = estimatePeriod();
+    if (period <= 0)
+    {
+        // keep predicting on the last tempo through short breaks
+        m_missedFrames++;
+        if (m_locked && qint64(m_missedFrames) * m_framePeriod > qint64(BEATTRACKER_HISTORY) * 500)
+        {
+            m_locked = false;
+            m_bpm = 0;
+        }
+        return m_locked;
+    }
+
+    m_missedFrames = 0;
+
+    double periodTime = period * m_framePeriod;
+
+    if (m_locked && qAbs(periodTime - m_beatPeriod) >= m_beatPeriod * TEMPO_CHANGE)
+    {
+        // follow a different tempo only when it persists, otherwise
+        // keep the tracked one and just correct the phase
+        m_tempoChangeFrames++;
+        if (qint64(m_tempoChangeFrames) * m_framePeriod < qint64(TEMPO_CHANGE_TIME) * 1000)
+        {
+            period = m_beatPeriod / m_framePeriod;
+            periodTime = m_beatPeriod;
+        }
+        else
+        {
+            m_locked = false;
+        }
+    }
+    else
+    {
+        m_tempoChangeFrames = 0;
+    }
+
+    double lastBeat = double(time) - estimatePhase(period) * m_framePeriod;
+
+    if (m_locked)
+    {
+        m_beatPeriod += (periodTime - m_beatPeriod) * PERIOD_SMOOTHING;
+
+        // move the reference beat next to the estimated one,
+        // then correct a part of the phase error
+        double predicted = m_beatTime + qRound((lastBeat - m_beatTime) / m_beatPeriod) * m_beatPeriod;
+        m_beatTime = predicted + (lastBeat - predicted) * PHASE_SMOOTHING;
+    }
+    else
+    {
+        m_beatPeriod = periodTime;
+        m_beatTime = lastBeat;
+        m_tempoChangeFrames = 0;
+        m_bpm = 0;
+        m_locked = true;
+    }
+
+    // avoid flickering between two adjacent BPM numbers
+    double bpm = 60000000.0 / m_beatPeriod;
+    if (m_bpm == 0 || qAbs(bpm - m_bpm) > 0.75)
+        m_bpm = qRound(bpm);
+
+    return true;
+}
+
+bool BeatTracker::isLocked() const
+{
+    return m_locked;
+}
+
+int BeatTracker::bpm() const
+{
+    return m_locked ? m_bpm : 0;
+}
+
+double BeatTracker::beatPeriod() const
+{
+    return m_locked ? m_beatPeriod : 0;
+}
+
+qint64 BeatTracker::nextBeatTime(qint64 time) const
+{
+    if (m_locked == false)
+        return -1;
+
+    double beats = qFloor((double(time) - m_beatTime) / m_beatPeriod) + 1;
+    return qint64(m_beatTime + beats * m_beatPeriod);
+}
+
+double BeatTracker::onsetAt(double ago) const
+{
+    double position = m_envelope.size() - 1 - ago;
+    if (position < 0 || position > m_envelope.size() - 1)
+        return 0;
+
+    int index = int(position);
+    double fraction = position - index;
+    if (index + 1 >= m_envelope.size())
+        return m_envelope.at(index);
+
+    return m_envelope.at(index) * (1.0 - fraction) + m_envelope.at(index + 1) * fraction;
+}
+
+double BeatTracker::estimatePeriod()
+{
+    double framesPerMinute = 60000000.0 / m_framePeriod;
+    int minLag = qMax(1, int(framesPerMinute / BEATTRACKER_MAX_BPM));
+    int maxLag = qCeil(framesPerMinute / BEATTRACKER_MIN_BPM);
+
+    // wait for a couple of the slowest beats
+    if (m_onsetsCount < 2 * (maxLag + 2))
+        return 0;
+
+    // unwrap the history, without its mean
+    int count = m_onsetsCount;
+    int first = (m_onsetsHead - count + m_onsets.size()) % m_onsets.size();
+    double mean = 0;
+
+    m_envelope.resize(count);
+    for (int i = 0; i < count; i++)
+    {
+        m_envelope[i] = m_onsets.at((first + i) % m_onsets.size());
+        mean += m_envelope.at(i);
+    }
+    mean /= count;
+    for (int i = 0; i < count; i++)
+        m_envelope[i] -= mean;
+
+    const double *envelope = m_envelope.constData();
+
+    // also correlate on twice the slowest beat, to refine the period below
+    int lagsCount = qMin(2 * maxLag + 2, count / 2);
+
+    m_autoCorrelation.resize(lagsCount);
+    for (int lag = 0; lag < lagsCount; lag++)
+    {
+        double sum = 0;
+        for (int n = lag; n < count; n++)
+            sum += envelope[n] * envelope[n - lag];
+        m_autoCorrelation[lag] = sum / (count - lag);
+    }
+
+    const double *ac = m_autoCorrelation.constData();
+    if (ac[0] <= 0)
+        return 0;
+
+    int bestLag = -1;
+    double bestScore = 0;
+
+    for (int lag = minLag; lag <= maxLag; lag++)
+    {
+        double bpm = framesPerMinute / lag;
+        if (bpm < BEATTRACKER_MIN_BPM || bpm > BEATTRACKER_MAX_BPM)
+            continue;
+
+        if (ac[lag] <= 0 || ac[lag] < ac[lag - 1] || ac[lag] < ac[lag + 1])
+            continue;
+
+        // a period between two lags splits its peak between them
+        double peak = ac[lag] + qMax(0.0, qMax(ac[lag - 1], ac[lag + 1]));
+
+        // log-gaussian weight, one octave wide, around the preferred tempo
+        double octaves = qLn(bpm / PREFERRED_BPM) / qLn(2.0);
+        double score = peak * qExp(-0.5 * octaves * octaves);
+        if (score > bestScore)
+        {
+            bestScore = score;
+            bestLag = lag;
+        }
+    }
+
+    if (bestLag < 0 || ac[bestLag] / ac[0] < BEATTRACKER_MIN_CONFIDENCE)
+        return 0;
+
+    double period = interpolatePeak(bestLag);
+
+    // the beat period is rarely a whole number of frames: the peak
+    // at twice the period halves the error of the interpolation
+    int doubleLag = qRound(2 * period);
+    if (doubleLag + 1 < lagsCount)
+    {
+        if (ac[doubleLag - 1] > ac[doubleLag])
+            doubleLag--;
+        else if (ac[doubleLag + 1] > ac[doubleLag])
+            doubleLag++;
+
+        if (doubleLag + 1 < lagsCount && ac[doubleLag] > 0)
+            period = interpolatePeak(doubleLag) / 2;
+    }
+
+    return period;
+}
+
+double BeatTracker::interpolatePeak(int lag) const
+{
+    // parabolic interpolation around the peak
+    const double *ac = m_autoCorrelation.constData();
+    double denominator = ac[lag - 1] - 2 * ac[lag] + ac[lag + 1];
+    double delta = denominator != 0 ? 0.5 * (ac[lag - 1] - ac[lag + 1]) / denominator : 0;
+
+    return lag + qBound(-0.5, delta, 0.5);
+}
+
+double BeatTracker::estimatePhase(double period)
+{
+    int steps = qCeil(period);
+    QVector<double> &scores = m_phaseScores;
+    scores.resize(steps + 2);
+
+    // score of each phase on a comb of beats, with the older beats weighing less
+    for (int phase = -1; phase <= steps; phase++)
+    {
+        double score = 0;
+        double weight = 1.0;
+        for (double ago = phase; ago < m_envelope.size() - 1; ago += period)
+        {
+            score += onsetAt(ago) * weight;
+            weight *= PHASE_DECAY;
+        }
+        scores[phase + 1] = score;
+    }
+
+    int best = 0;
+    for (int phase = 1; phase < steps; phase++)
+    {
+        if (scores.at(phase + 1) > scores.at(best + 1))
+            best = phase;
+    }
+
+    double a = scores.at(best), b = scores.at(best + 1), c = scores.at(best + 2);
+    double denominator = a - 2 * b + c;
+    double delta = denominator != 0 ? 0.5 * (a - c) / denominator : 0;
+
+    return best + qBound(-0.5, delta, 0.5);
+}
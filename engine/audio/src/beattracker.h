@@ -0,0 +1,142 @@
+/*
+  Q Light Controller Plus
+  beattracker.h
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef BEATTRACKER_H
+#define BEATTRACKER_H
+
+#include <QVector>
+
+/** @addtogroup engine_audio Audio
+ * @{
+ */
+
+#define BEATTRACKER_MIN_BPM         60
+#define BEATTRACKER_MAX_BPM         200
+
+/** Duration of the onset history used to estimate the tempo, in milliseconds */
+#define BEATTRACKER_HISTORY         6000
+
+/** Minimum autocorrelation, relative to the signal energy, to lock on a tempo */
+#define BEATTRACKER_MIN_CONFIDENCE  0.1
+
+/**
+ * BeatTracker estimates the tempo and the beat phase of a live audio
+ * signal from a sequence of magnitude spectra, like the ones computed
+ * by AudioCapture.
+ *
+ * The onset strength of each frame is the spectral flux: the sum of the
+ * increases of the log-magnitude of each bin. The tempo is the lag that
+ * maximizes the autocorrelation of the onset strength history, weighted
+ * towards 120 BPM to avoid octave errors. The phase is the offset that
+ * maximizes the onset strength on a comb of beats at that tempo.
+ *
+ * All the times are in microseconds, on any monotonic clock, and refer
+ * to the moment the audio of a frame has been heard (the caller has to
+ * compensate the capture latency). Beats can then be predicted in the
+ * future to trigger them exactly on time.
+ */
+class BeatTracker
+{
+public:
+    BeatTracker();
+    ~BeatTracker();
+
+    /** Forget the history and expect a frame every $framePeriod microseconds */
+    void reset(qint64 framePeriod);
+
+    /**
+     * Process the $binsCount magnitudes of the spectrum of a frame
+     * heard at $time. Return true if the tracker is locked on a tempo.
+     */
+    bool processSpectrum(const double *magnitude, int binsCount, qint64 time);
+
+    /**
+     * Process the onset strength of a frame heard at $time.
+     * Return true if the tracker is locked on a tempo.
+     */
+    bool processOnset(double onset, qint64 time);
+
+    /** Return true if the tracker is confident about the tempo and the phase */
+    bool isLocked() const;
+
+    /** Get the tracked tempo in beats per minute, or 0 if not locked */
+    int bpm() const;
+
+    /** Get the duration of a beat in microseconds, or 0 if not locked */
+    double beatPeriod() const;
+
+    /** Get the time of the first beat after $time, or -1 if not locked */
+    qint64 nextBeatTime(qint64 time) const;
+
+private:
+    /** Get the onset strength $ago frames before the last one,
+     *  interpolating between frames. Return 0 outside of the history */
+    double onsetAt(double ago) const;
+
+    /** Estimate the beat period in frames, or return 0 if not confident */
+    double estimatePeriod();
+
+    /** Get the fractional lag of the autocorrelation peak at $lag */
+    double interpolatePeak(int lag) const;
+
+    /** Estimate how many frames ago the last beat happened */
+    double estimatePhase(double period);
+
+private:
+    /** Duration of a frame in microseconds */
+    qint64 m_framePeriod;
+
+    /** The log-magnitude spectrum of the previous frame */
+    QVector<double> m_previousSpectrum;
+
+    /** Ring buffer of the onset strength history */
+    QVector<double> m_onsets;
+    int m_onsetsHead;
+    int m_onsetsCount;
+
+    /** The onset strength history in chronological order, without its mean */
+    QVector<double> m_envelope;
+
+    /** Autocorrelation buffer, reused at every frame */
+    QVector<double> m_autoCorrelation;
+
+    /** Phase scores buffer, reused at every frame */
+    QVector<double> m_phaseScores;
+
+    bool m_locked;
+
+    /** Number of consecutive frames without a confident tempo estimation */
+    int m_missedFrames;
+
+    /** Number of consecutive frames estimating a different tempo */
+    int m_tempoChangeFrames;
+
+    /** The smoothed duration of a beat in microseconds */
+    double m_beatPeriod;
+
+    /** The time of a reference beat, the other beats are m_beatPeriod apart */
+    double m_beatTime;
+
+    /** The tracked BPM, changed only when the tempo moves enough */
+    int m_bpm;
+};
+
+/** @} */
+
+#endif
@@ -21,7 +21,10 @@ HEADERS += audio.h \
            audiorenderer.h \
            audioparameters.h \
            audiocapture.h \
-           audioplugincache.h
+           audioplugincache.h \
+           audiopcmcache.h \
+           audiowaveform.h \
+           beattracker.h
 
 lessThan(QT_MAJOR_VERSION, 5) {
   unix:!macx:HEADERS += audiorenderer_alsa.h audiocapture_alsa.h
@@ -36,7 +39,10 @@ SOURCES += audio.cpp \
            audiorenderer.cpp \
            audioparameters.cpp \
            audiocapture.cpp \
-           audioplugincache.cpp
+           audioplugincache.cpp \
+           audiopcmcache.cpp \
+           audiowaveform.cpp \
+           beattracker.cpp
 
 lessThan(QT_MAJOR_VERSION, 5) {
   unix:!macx:SOURCES += audiorenderer_alsa.cpp audiocapture_alsa.cpp
@@ -0,0 +1,22 @@
+include(../../variables.pri)
+
+TEMPLATE = app
+LANGUAGE = C++
+TARGET   = qlcplus-enginebench
+
+QT      += core
+qmlui {
+  QT += qml
+} else {
+  QT += script
+}
+CONFIG  -= app_bundle
+
+DEPENDPATH   += ../src
+INCLUDEPATH  += ../../plugins/interfaces
+INCLUDEPATH  += ../src
+QMAKE_LIBDIR += ../src
+LIBS         += -lqlcplusengine
+
+HEADERS += enginebench.h
+SOURCES += enginebench.cpp main.cpp
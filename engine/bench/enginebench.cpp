@@ -0,0 +1,338 @@
+/*
+  Q Light Controller Plus
+  enginebench.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QXmlStreamReader>
+#include <QElapsedTimer>
+#include <QAtomicInteger>
+#include <QFileInfo>
+#include <QIODevice>
+#include <QDebug>
+#include <stdlib.h>
+#include <string.h>
+#include <new>
+
+#include "enginebench.h"
+#include "universesnapshot.h"
+#include "inputoutputmap.h"
+#include "bakedstream.h"
+#include "tickprofiler.h"
+#include "mastertimer.h"
+#include "universe.h"
+#include "qlcfile.h"
+#include "doc.h"
+
+#define KXMLQLCWorkspace "Workspace"
+
+/* FNV-1a 64 bit parameters */
+#define CHECKSUM_OFFSET Q_UINT64_C(14695981039346656037)
+#define CHECKSUM_PRIME Q_UINT64_C(1099511628211)
+
+/****************************************************************************
+ * Allocations counting
+ ****************************************************************************/
+
+static QAtomicInteger<quint64> s_allocationsCount(0);
+
+quint64 allocationsCount()
+{
+    return s_allocationsCount.loadAcquire();
+}
+
+void *operator new(size_t size)
+{
+    s_allocationsCount.fetchAndAddRelaxed(1);
+
+    void *ptr = malloc(size ? size : 1);
+    if (ptr == NULL)
+        throw std::bad_alloc();
+
+    return ptr;
+}
+
+void *operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void *ptr) Q_DECL_NOEXCEPT
+{
+    free(ptr);
+}
+
+void operator delete[](void *ptr) Q_DECL_NOEXCEPT
+{
+    free(ptr);
+}
+
+/****************************************************************************
+ * Initialization
+ ****************************************************************************/
+
+EngineBench::EngineBench(Doc *doc)
+    : m_doc(doc)
+    , m_framesDevice(NULL)
+    , m_clock(0)
+    , m_nextBeat(0)
+    , m_ticksCount(0)
+    , m_elapsed(0)
+    , m_allocationsCount(0)
+    , m_checksum(CHECKSUM_OFFSET)
+{
+    Q_ASSERT(m_doc != NULL);
+
+    MasterTimer *timer = m_doc->masterTimer();
+
+    // beats are requested by tick() on the virtual clock
+    timer->setBeatSourceType(MasterTimer::External);
+    timer->setVirtualClockTime(m_clock);
+    timer->setProfilingEnabled(true);
+}
+
+EngineBench::~EngineBench()
+{
+    m_doc->masterTimer()->setProfilingEnabled(false);
+}
+
+bool EngineBench::loadWorkspace(const QString &fileName)
+{
+    QXmlStreamReader *doc = QLCFile::getXMLReader(fileName);
+    if (doc == NULL || doc->device() == NULL || doc->hasError())
+    {
+        qWarning() << Q_FUNC_INFO << "Unable to read from" << fileName;
+        return false;
+    }
+
+    while (!doc->atEnd())
+    {
+        if (doc->readNext() == QXmlStreamReader::DTD)
+            break;
+    }
+
+    m_doc->setWorkspacePath(QFileInfo(fileName).absolutePath());
+
+    bool loaded = false;
+
+    if (doc->hasError() == false && doc->dtdName() == KXMLQLCWorkspace &&
+        doc->readNextStartElement() && doc->name() == KXMLQLCWorkspace)
+    {
+        while (doc->readNextStartElement())
+        {
+            if (doc->name() == KXMLQLCEngine)
+                loaded = m_doc->loadXML(*doc);
+            else
+                doc->skipCurrentElement();
+        }
+    }
+
+    QLCFile::releaseXMLReader(doc);
+
+    if (loaded == false)
+        qWarning() << Q_FUNC_INFO << fileName << "is not a valid workspace file";
+
+    return loaded;
+}
+
+bool EngineBench::startFunctions(const QList<quint32> &ids)
+{
+    QList<Function *> functions;
+
+    if (ids.isEmpty())
+    {
+        functions = m_doc->functionsByType(Function::ShowType);
+    }
+    else
+    {
+        foreach (quint32 id, ids)
+        {
+            Function *function = m_doc->function(id);
+            if (function == NULL)
+            {
+                qWarning() << "[EngineBench] function" << id << "not found";
+                return false;
+            }
+            functions.append(function);
+        }
+    }
+
+    if (functions.isEmpty())
+    {
+        qWarning() << "[EngineBench] no functions to start";
+        return false;
+    }
+
+    foreach (Function *function, functions)
+    {
+        qDebug() << "[EngineBench] starting" << function->name();
+        function->start(m_doc->masterTimer(), FunctionParent::master());
+    }
+
+    return true;
+}
+
+void EngineBench::setFramesDevice(QIODevice *device)
+{
+    m_framesDevice = device;
+}
+
+/****************************************************************************
+ * Run
+ ****************************************************************************/
+
+void EngineBench::tick()
+{
+    MasterTimer *timer = m_doc->masterTimer();
+
+    if (m_clock >= m_nextBeat)
+    {
+        timer->requestBeat();
+        m_nextBeat += timer->beatTimeDuration();
+    }
+
+    timer->timerTick();
+    m_clock += MasterTimer::tick();
+    timer->setVirtualClockTime(m_clock);
+}
+
+quint64 EngineBench::frameChecksum()
+{
+    UniverseSnapshot snapshot = m_doc->inputOutputMap()->snapshot();
+    quint64 frame = CHECKSUM_OFFSET;
+
+    for (int u = 0; u < snapshot.universesCount(); u++)
+    {
+        const uchar *values = snapshot.postGMValues(u);
+        for (int i = 0; i < UNIVERSE_SIZE; i++)
+        {
+            frame = (frame ^ values[i]) * CHECKSUM_PRIME;
+            m_checksum = (m_checksum ^ values[i]) * CHECKSUM_PRIME;
+        }
+    }
+
+    return frame;
+}
+
+void EngineBench::run(int count)
+{
+    m_doc->masterTimer()->profiler()->reset();
+
+    QElapsedTimer elapsed;
+    qint64 tickTime = 0;
+    quint64 allocations = 0;
+
+    for (int i = 0; i < count; i++)
+    {
+        quint64 start = allocationsCount();
+        elapsed.start();
+
+        tick();
+
+        tickTime += elapsed.nsecsElapsed();
+        allocations += allocationsCount() - start;
+
+        // checksums are not part of the measured time
+        quint64 frame = frameChecksum();
+        if (m_framesDevice != NULL)
+            m_framesDevice->write(QString("%1 %2\n").arg(m_ticksCount + i)
+                                  .arg(frame, 16, 16, QChar('0')).toLatin1());
+    }
+
+    m_ticksCount += count;
+    m_elapsed = tickTime;
+    m_allocationsCount = allocations;
+}
+
+bool EngineBench::bake(const QString &fileName, int maxTicks)
+{
+    MasterTimer *timer = m_doc->masterTimer();
+    int universesCount = int(m_doc->inputOutputMap()->universesCount());
+
+    BakedStreamWriter writer;
+    if (writer.open(fileName, universesCount, MasterTimer::tick()) == false)
+        return false;
+
+    m_doc->masterTimer()->profiler()->reset();
+
+    QByteArray frame(universesCount * UNIVERSE_SIZE, 0);
+    QElapsedTimer elapsed;
+    qint64 tickTime = 0;
+    int count = 0;
+
+    do
+    {
+        elapsed.start();
+        tick();
+        tickTime += elapsed.nsecsElapsed();
+        count++;
+
+        // frames are baked before the Grand Master, which is applied on playback
+        UniverseSnapshot snapshot = m_doc->inputOutputMap()->snapshot();
+        for (int u = 0; u < qMin(universesCount, snapshot.universesCount()); u++)
+        {
+            const uchar *values = snapshot.preGMValues(u);
+            if (values != NULL)
+                memcpy(frame.data() + u * UNIVERSE_SIZE, values, UNIVERSE_SIZE);
+        }
+
+        if (writer.writeFrame(reinterpret_cast<const uchar *>(frame.constData())) == false)
+        {
+            qWarning() << "[EngineBench] unable to write" << fileName;
+            return false;
+        }
+    } while (timer->runningFunctions() > 0 && (maxTicks <= 0 || count < maxTicks));
+
+    m_ticksCount += count;
+    m_elapsed = tickTime;
+
+    qDebug() << "[EngineBench] baked" << writer.framesCount() << "frames to" << fileName;
+
+    return writer.close();
+}
+
+/****************************************************************************
+ * Results
+ ****************************************************************************/
+
+void EngineBench::report(QTextStream &out)
+{
+    TickProfiler *profiler = m_doc->masterTimer()->profiler();
+    quint64 count = profiler->ticksCount();
+
+    out << "Ticks: " << count << " (" << (m_clock / 1000) << " s of virtual time)\n";
+    if (m_elapsed > 0)
+        out << "Ticks/second: " << qRound64(double(count) * 1000000000 / m_elapsed) << "\n";
+    if (count > 0)
+        out << "Allocations/tick: " << double(m_allocationsCount) / count << "\n";
+
+    out << "Phases (us, last " << TICKPROFILER_SAMPLES << " ticks):\n";
+    for (int i = 0; i < TickProfiler::PhasesCount; i++)
+    {
+        TickProfiler::Phase phase = TickProfiler::Phase(i);
+        TickStatistics stats = profiler->phaseStatistics(phase);
+        out << "  " << TickProfiler::phaseToString(phase).leftJustified(16)
+            << " p50 " << stats.m_p50 << "  p99 " << stats.m_p99 << "  max " << stats.m_max << "\n";
+    }
+
+    out << "Checksum: " << QString("%1").arg(m_checksum, 16, 16, QChar('0')) << "\n";
+    out.flush();
+}
+
+quint64 EngineBench::checksum() const
+{
+    return m_checksum;
+}
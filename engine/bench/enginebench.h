@@ -0,0 +1,106 @@
+/*
+  Q Light Controller Plus
+  enginebench.h
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef ENGINEBENCH_H
+#define ENGINEBENCH_H
+
+#include <QTextStream>
+#include <QString>
+#include <QList>
+
+class QIODevice;
+class Doc;
+
+/** @addtogroup engine Engine
+ * @{
+ */
+
+/** Get the number of heap allocations done so far by the whole process */
+quint64 allocationsCount();
+
+/**
+ * EngineBench runs the MasterTimer of a Doc as fast as possible, on a
+ * virtual clock: each tick advances the time by MasterTimer::tick()
+ * milliseconds, regardless of the real time it took. Beats and the
+ * MasterTimer clock follow the same virtual clock, so two runs of the
+ * same workspace produce the same DMX frames, whose checksum can be
+ * used to verify that an engine change is bit-exact.
+ */
+class EngineBench
+{
+public:
+    EngineBench(Doc *doc);
+    ~EngineBench();
+
+    /** Load the engine part of a workspace file */
+    bool loadWorkspace(const QString &fileName);
+
+    /**
+     * Start the functions with the given IDs. If $ids is empty,
+     * all the Shows of the workspace are started.
+     */
+    bool startFunctions(const QList<quint32> &ids);
+
+    /** Write the checksum of each frame to $device, one per line */
+    void setFramesDevice(QIODevice *device);
+
+    /** Run $count ticks, collecting the statistics */
+    void run(int count);
+
+    /**
+     * Run until all the started functions have stopped (or for $maxTicks
+     * ticks, if greater than zero) and write each frame to the baked
+     * stream $fileName, to be played back by a BakedShow function
+     */
+    bool bake(const QString &fileName, int maxTicks);
+
+    /** Print the statistics of the last run */
+    void report(QTextStream &out);
+
+    /** Get the checksum of all the frames generated so far */
+    quint64 checksum() const;
+
+private:
+    /** Execute one tick on the virtual clock */
+    void tick();
+
+    /** Add the current values of all universes to the checksum */
+    quint64 frameChecksum();
+
+private:
+    Doc *m_doc;
+    QIODevice *m_framesDevice;
+
+    /** The virtual clock, in milliseconds */
+    quint64 m_clock;
+    /** Virtual time of the next beat, in milliseconds */
+    quint64 m_nextBeat;
+
+    /** Statistics of the last run */
+    int m_ticksCount;
+    qint64 m_elapsed;
+    quint64 m_allocationsCount;
+
+    /** Running checksum of all the frames */
+    quint64 m_checksum;
+};
+
+/** @} */
+
+#endif
@@ -0,0 +1,157 @@
+/*
+  Q Light Controller Plus
+  main.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QTextStream>
+#include <QDebug>
+#include <QFile>
+
+#include "qlcfixturedefcache.h"
+#include "qlcmodifierscache.h"
+#include "rgbscriptscache.h"
+#include "enginebench.h"
+#include "mastertimer.h"
+#include "qlcconfig.h"
+#include "doc.h"
+
+static void messageHandler(QtMsgType type, const QMessageLogContext &context, const QString &msg)
+{
+    Q_UNUSED(context)
+
+    // keep the output clean, unless something goes wrong
+    if (type == QtDebugMsg || type == QtInfoMsg)
+        return;
+
+    QTextStream(stderr) << msg << endl;
+}
+
+int main(int argc, char **argv)
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setOrganizationName("qlcplus");
+    QCoreApplication::setOrganizationDomain("sf.net");
+    QCoreApplication::setApplicationName("qlcplus-enginebench");
+    QCoreApplication::setApplicationVersion(QString(APPVERSION));
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Q Light Controller Plus engine benchmark.\n"
+                                     "Runs the functions of a workspace as fast as possible "
+                                     "and reports the engine throughput.");
+    parser.addHelpOption();
+    parser.addVersionOption();
+    parser.addPositionalArgument("workspace", "The workspace file to load.");
+
+    QCommandLineOption functionsOption(QStringList() << "f" << "functions",
+                                       "Comma separated IDs of the functions to start. "
+                                       "All the Shows are started if omitted.",
+                                       "ids");
+    parser.addOption(functionsOption);
+
+    QCommandLineOption ticksOption(QStringList() << "t" << "ticks",
+                                   "Number of ticks to run (default 10000).",
+                                   "count", "10000");
+    parser.addOption(ticksOption);
+
+    QCommandLineOption parallelOption(QStringList() << "p" << "parallel",
+                                      "Write the functions in parallel.");
+    parser.addOption(parallelOption);
+
+    QCommandLineOption framesOption(QStringList() << "c" << "checksums",
+                                    "Write the checksum of each frame to a file.",
+                                    "filename");
+    parser.addOption(framesOption);
+
+    QCommandLineOption bakeOption(QStringList() << "b" << "bake",
+                                  "Run the functions until they stop and bake their frames "
+                                  "to a file that a Baked Show can play back. The number of "
+                                  "ticks becomes a limit, if given.",
+                                  "filename");
+    parser.addOption(bakeOption);
+
+    QCommandLineOption debugOption(QStringList() << "d" << "debug",
+                                   "Enable debug messages.");
+    parser.addOption(debugOption);
+
+    parser.process(app);
+
+    if (parser.isSet(debugOption) == false)
+        qInstallMessageHandler(messageHandler);
+
+    if (parser.positionalArguments().count() != 1)
+        parser.showHelp(1);
+
+    QList<quint32> ids;
+    foreach (QString id, parser.value(functionsOption).split(",", QString::SkipEmptyParts))
+        ids.append(id.toUInt());
+
+    int ticks = parser.value(ticksOption).toInt();
+    if (ticks <= 0)
+        parser.showHelp(1);
+
+    Doc doc(&app);
+    doc.fixtureDefCache()->load(QLCFixtureDefCache::userDefinitionDirectory());
+    doc.fixtureDefCache()->loadMap(QLCFixtureDefCache::systemDefinitionDirectory());
+    doc.modifiersCache()->load(QLCModifiersCache::systemTemplateDirectory(), true);
+    doc.modifiersCache()->load(QLCModifiersCache::userTemplateDirectory());
+    doc.rgbScriptsCache()->load(RGBScriptsCache::systemScriptsDirectory());
+    doc.rgbScriptsCache()->load(RGBScriptsCache::userScriptsDirectory());
+
+    EngineBench bench(&doc);
+    doc.masterTimer()->setParallelWrite(parser.isSet(parallelOption));
+
+    if (bench.loadWorkspace(parser.positionalArguments().first()) == false)
+        return 1;
+
+    if (bench.startFunctions(ids) == false)
+        return 1;
+
+    if (parser.isSet(bakeOption))
+    {
+        bool baked = bench.bake(parser.value(bakeOption), parser.isSet(ticksOption) ? ticks : 0);
+        doc.masterTimer()->stopAllFunctions();
+
+        if (baked == false)
+            return 1;
+
+        QTextStream out(stdout);
+        bench.report(out);
+        return 0;
+    }
+
+    QFile framesFile(parser.value(framesOption));
+    if (parser.isSet(framesOption))
+    {
+        if (framesFile.open(QIODevice::WriteOnly | QIODevice::Text) == false)
+        {
+            qWarning() << "Unable to write" << framesFile.fileName();
+            return 1;
+        }
+        bench.setFramesDevice(&framesFile);
+    }
+
+    bench.run(ticks);
+
+    QTextStream out(stdout);
+    bench.report(out);
+
+    doc.masterTimer()->stopAllFunctions();
+
+    return 0;
+}
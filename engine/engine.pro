@@ -4,4 +4,5 @@ SUBDIRS += audio
 SUBDIRS += src
 !android:!ios {
   SUBDIRS += test
+  greaterThan(QT_MAJOR_VERSION, 4): SUBDIRS += bench
 }
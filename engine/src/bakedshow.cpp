@@ -0,0 +1,518 @@
+/*
+  Q Light Controller Plus
+  bakedshow.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QXmlStreamReader>
+#include <QXmlStreamWriter>
+#include <QFileInfo>
+#include <QBuffer>
+#include <QFile>
+#include <QSet>
+#include <QDebug>
+#include <string.h>
+
+#include "qlcfixturedefcache.h"
+#include "universesnapshot.h"
+#include "inputoutputmap.h"
+#include "rgbscriptscache.h"
+#include "qlcfixturedef.h"
+#include "mastertimer.h"
+#include "bakedshow.h"
+#include "universe.h"
+#include "fixture.h"
+#include "doc.h"
+
+#define KXMLQLCBakedShowSource "Source"
+
+/*****************************************************************************
+ * Initialization
+ *****************************************************************************/
+
+BakedShow::BakedShow(Doc* doc)
+    : Function(doc, Function::BakedShowType)
+    , m_doc(doc)
+    , m_sourceFileName("")
+    , m_startPosition(0)
+    , m_clockOrigin(0)
+    , m_pauseClockTime(0)
+    , m_paused(false)
+    , m_seekRequested(false)
+    , m_seekTime(0)
+{
+    setName(tr("New Baked Show"));
+    setRunOrder(BakedShow::SingleShot);
+}
+
+BakedShow::~BakedShow()
+{
+}
+
+QIcon BakedShow::getIcon() const
+{
+    return QIcon(":/bakedshow.png");
+}
+
+/*****************************************************************************
+ * Copying
+ *****************************************************************************/
+
+Function* BakedShow::createCopy(Doc* doc, bool addToDoc)
+{
+    Q_ASSERT(doc != NULL);
+
+    Function* copy = new BakedShow(doc);
+    if (copy->copyFrom(this) == false)
+    {
+        delete copy;
+        copy = NULL;
+    }
+    if (addToDoc == true && doc->addFunction(copy) == false)
+    {
+        delete copy;
+        copy = NULL;
+    }
+
+    return copy;
+}
+
+bool BakedShow::copyFrom(const Function* function)
+{
+    const BakedShow* show = qobject_cast<const BakedShow*> (function);
+    if (show == NULL)
+        return false;
+
+    setSourceFileName(show->m_sourceFileName);
+
+    return Function::copyFrom(function);
+}
+
+/*********************************************************************
+ * Properties
+ *********************************************************************/
+
+quint32 BakedShow::totalDuration()
+{
+    QMutexLocker locker(&m_streamMutex);
+    return m_stream.duration();
+}
+
+int BakedShow::universesCount()
+{
+    QMutexLocker locker(&m_streamMutex);
+    return m_stream.isOpen() ? m_stream.universesCount() : 0;
+}
+
+QString BakedShow::sourceFileName() const
+{
+    return m_sourceFileName;
+}
+
+bool BakedShow::setSourceFileName(QString filename)
+{
+    QMutexLocker locker(&m_streamMutex);
+
+    m_sourceFileName = filename;
+    m_usedChannels.clear();
+
+    if (m_stream.open(m_sourceFileName) == false)
+    {
+        setName(tr("File not found"));
+        emit changed(id());
+        return false;
+    }
+
+    setName(QFileInfo(m_sourceFileName).fileName());
+
+    // playback writes only the channels that the show has used
+    m_usedChannels.resize(m_stream.universesCount());
+    for (int u = 0; u < m_stream.universesCount(); u++)
+    {
+        for (int i = 0; i < UNIVERSE_SIZE; i++)
+        {
+            if (m_stream.isChannelUsed(u, i))
+                m_usedChannels[u].append(i);
+        }
+    }
+
+    locker.unlock();
+
+    emit sourceFileNameChanged();
+    emit totalDurationChanged();
+    emit changed(id());
+
+    return true;
+}
+
+/*********************************************************************
+ * Save & Load
+ *********************************************************************/
+
+bool BakedShow::saveXML(QXmlStreamWriter *doc)
+{
+    Q_ASSERT(doc != NULL);
+
+    /* Function tag */
+    doc->writeStartElement(KXMLQLCFunction);
+
+    /* Common attributes */
+    saveXMLCommon(doc);
+
+    /* Speed */
+    saveXMLSpeed(doc);
+
+    /* Playback mode */
+    saveXMLRunOrder(doc);
+
+    doc->writeTextElement(KXMLQLCBakedShowSource, m_doc->normalizeComponentPath(m_sourceFileName));
+
+    /* End the <Function> tag */
+    doc->writeEndElement();
+
+    return true;
+}
+
+bool BakedShow::loadXML(QXmlStreamReader &root)
+{
+    if (root.name() != KXMLQLCFunction)
+    {
+        qWarning() << Q_FUNC_INFO << "Function node not found";
+        return false;
+    }
+
+    if (root.attributes().value(KXMLQLCFunctionType).toString() != typeToString(Function::BakedShowType))
+    {
+        qWarning() << Q_FUNC_INFO << root.attributes().value(KXMLQLCFunctionType).toString()
+                   << "is not a Baked Show";
+        return false;
+    }
+
+    QString fname = name();
+
+    while (root.readNextStartElement())
+    {
+        if (root.name() == KXMLQLCBakedShowSource)
+        {
+            setSourceFileName(m_doc->denormalizeComponentPath(root.readElementText()));
+        }
+        else if (root.name() == KXMLQLCFunctionSpeed)
+        {
+            loadXMLSpeed(root);
+        }
+        else if (root.name() == KXMLQLCFunctionRunOrder)
+        {
+            loadXMLRunOrder(root);
+        }
+        else
+        {
+            qWarning() << Q_FUNC_INFO << "Unknown Baked Show tag:" << root.name();
+            root.skipCurrentElement();
+        }
+    }
+
+    setName(fname);
+
+    return true;
+}
+
+/*********************************************************************
+ * Baking
+ *********************************************************************/
+
+bool BakedShow::bake(Doc *doc, quint32 functionID, const QString &fileName,
+                     quint32 maxDuration)
+{
+    BakedShowBaker baker(doc, functionID, fileName, maxDuration);
+    return baker.bake();
+}
+
+BakedShowBaker::BakedShowBaker(Doc *doc, quint32 functionID, const QString &fileName,
+                               quint32 maxDuration, QObject *parent)
+    : QThread(parent)
+    , m_functionID(functionID)
+    , m_fileName(fileName)
+    , m_maxDuration(maxDuration)
+    , m_universesCount(0)
+    , m_bpmNumber(0)
+    , m_cancelled(0)
+    , m_progress(0)
+    , m_baked(false)
+{
+    Q_ASSERT(doc != NULL);
+
+    Function *source = doc->function(functionID);
+    if (source == NULL || source->type() == Function::AudioType ||
+        source->type() == Function::VideoType)
+        return;
+
+    /* Copy the workspace, so the live engine keeps running */
+    QBuffer buffer(&m_workspace);
+    buffer.open(QIODevice::WriteOnly);
+    QXmlStreamWriter xmlWriter(&buffer);
+    doc->saveXML(&xmlWriter);
+    xmlWriter.setDevice(NULL);
+    buffer.close();
+
+    m_workspacePath = doc->getWorkspacePath();
+    m_universesCount = int(doc->inputOutputMap()->universesCount());
+    m_bpmNumber = doc->masterTimer()->bpmNumber();
+
+    // the definitions in use are already loaded, no need to scan the disk
+    QSet<QLCFixtureDef *> defs;
+    foreach (Fixture *fxi, doc->fixtures())
+    {
+        QLCFixtureDef *def = fxi->fixtureDef();
+        if (def == NULL || defs.contains(def) ||
+            doc->fixtureDefCache()->fixtureDef(def->manufacturer(), def->model()) != def)
+            continue;
+
+        defs.insert(def);
+        m_fixtureDefs.append(new QLCFixtureDef(def));
+    }
+}
+
+BakedShowBaker::~BakedShowBaker()
+{
+    cancel();
+    wait();
+
+    qDeleteAll(m_fixtureDefs);
+}
+
+QString BakedShowBaker::fileName() const
+{
+    return m_fileName;
+}
+
+bool BakedShowBaker::bake()
+{
+    m_baked = false;
+    m_progress.store(0);
+
+    if (m_workspace.isEmpty())
+        return false;
+
+    Doc bakeDoc(NULL, m_universesCount);
+    bakeDoc.setWorkspacePath(m_workspacePath);
+    bakeDoc.rgbScriptsCache()->load(RGBScriptsCache::systemScriptsDirectory());
+    bakeDoc.rgbScriptsCache()->load(RGBScriptsCache::userScriptsDirectory());
+
+    foreach (QLCFixtureDef *def, m_fixtureDefs)
+        bakeDoc.fixtureDefCache()->addFixtureDef(new QLCFixtureDef(def));
+
+    QBuffer buffer(&m_workspace);
+    buffer.open(QIODevice::ReadOnly);
+    QXmlStreamReader xmlReader(&buffer);
+    if (xmlReader.readNextStartElement() == false || bakeDoc.loadXML(xmlReader) == false)
+    {
+        qWarning() << "[BakedShow] unable to copy the workspace";
+        return false;
+    }
+
+    foreach (Function *function, bakeDoc.functions())
+    {
+        if (function->type() == Function::AudioType || function->type() == Function::VideoType)
+            bakeDoc.deleteFunction(function->id());
+    }
+
+    Function *function = bakeDoc.function(m_functionID);
+    if (function == NULL)
+        return false;
+
+    /* Run the copy on a virtual clock, as fast as possible */
+    MasterTimer *timer = bakeDoc.masterTimer();
+    int universesCount = int(bakeDoc.inputOutputMap()->universesCount());
+    quint64 clock = 0;
+    quint64 nextBeat = 0;
+
+    timer->setBeatSourceType(MasterTimer::External);
+    if (m_bpmNumber > 0)
+        timer->requestBpmNumber(m_bpmNumber);
+    timer->setVirtualClockTime(clock);
+
+    BakedStreamWriter writer;
+    if (writer.open(m_fileName, universesCount, MasterTimer::tick()) == false)
+        return false;
+
+    function->start(timer, FunctionParent::master());
+
+    QByteArray frame(universesCount * UNIVERSE_SIZE, 0);
+    bool written = true;
+
+    do
+    {
+        if (timer->bpmNumber() > 0 && clock >= nextBeat)
+        {
+            timer->requestBeat();
+            nextBeat += timer->beatTimeDuration();
+        }
+
+        timer->timerTick();
+        clock += MasterTimer::tick();
+        timer->setVirtualClockTime(clock);
+
+        // frames are baked before the Grand Master, which is applied on playback
+        UniverseSnapshot snapshot = bakeDoc.inputOutputMap()->snapshot();
+        for (int u = 0; u < qMin(universesCount, snapshot.universesCount()); u++)
+        {
+            const uchar *values = snapshot.preGMValues(u);
+            if (values != NULL)
+                memcpy(frame.data() + u * UNIVERSE_SIZE, values, UNIVERSE_SIZE);
+        }
+
+        written = writer.writeFrame(reinterpret_cast<const uchar *>(frame.constData()));
+
+        int percent = m_maxDuration > 0 ? int(qMin(clock * 100 / m_maxDuration, quint64(99))) : 0;
+        if (percent != m_progress.load())
+        {
+            m_progress.store(percent);
+            emit progressChanged(percent);
+        }
+    } while (written && m_cancelled.load() == 0 &&
+             timer->runningFunctions() > 0 && clock < m_maxDuration);
+
+    timer->stopAllFunctions();
+
+    if (m_cancelled.load() != 0)
+    {
+        writer.close();
+        QFile::remove(m_fileName);
+        return false;
+    }
+
+    if (written == false || writer.close() == false)
+    {
+        qWarning() << "[BakedShow] unable to write" << m_fileName;
+        return false;
+    }
+
+    qDebug() << "[BakedShow] baked" << writer.framesCount() << "frames to" << m_fileName;
+
+    m_baked = true;
+    m_progress.store(100);
+    emit progressChanged(100);
+
+    return true;
+}
+
+bool BakedShowBaker::isBaked() const
+{
+    return m_baked;
+}
+
+int BakedShowBaker::progress() const
+{
+    return m_progress.load();
+}
+
+void BakedShowBaker::cancel()
+{
+    m_cancelled.store(1);
+}
+
+void BakedShowBaker::run()
+{
+    bake();
+}
+
+/*********************************************************************
+ * Running
+ *********************************************************************/
+
+void BakedShow::seek(quint32 time)
+{
+    QMutexLocker locker(&m_streamMutex);
+    m_seekTime = time;
+    m_seekRequested = true;
+}
+
+void BakedShow::preRun(MasterTimer* timer)
+{
+    {
+        QMutexLocker locker(&m_streamMutex);
+        // a Show might start this function with a time offset
+        m_startPosition = elapsed();
+        m_clockOrigin = timer->clockTime();
+        m_paused = false;
+        m_seekRequested = false;
+    }
+
+    Function::preRun(timer);
+}
+
+void BakedShow::write(MasterTimer* timer, QList<Universe *> universes)
+{
+    QMutexLocker locker(&m_streamMutex);
+
+    quint64 now = timer->clockTime();
+
+    // the time spent in pause must not move the playback position
+    if (isPaused())
+    {
+        if (m_paused == false)
+        {
+            m_pauseClockTime = now;
+            m_paused = true;
+        }
+        return;
+    }
+    else if (m_paused)
+    {
+        m_clockOrigin += now - m_pauseClockTime;
+        m_paused = false;
+    }
+
+    if (m_seekRequested)
+    {
+        m_startPosition = m_seekTime;
+        m_clockOrigin = now;
+        m_seekRequested = false;
+    }
+
+    // the position is absolute, so late ticks don't make the playback drift
+    quint64 position = quint64(m_startPosition) + (now - m_clockOrigin);
+
+    if (m_stream.isOpen() == false || position / m_stream.tick() >= m_stream.framesCount() ||
+        m_stream.seek(quint32(position / m_stream.tick())) == false)
+    {
+        locker.unlock();
+        stop(FunctionParent::master());
+        return;
+    }
+
+    qreal intensity = getAttributeValue(Intensity);
+    int count = qMin(m_usedChannels.count(), universes.count());
+
+    for (int u = 0; u < count; u++)
+    {
+        Universe *universe = universes.at(u);
+        const uchar *values = m_stream.values(u);
+
+        foreach (int channel, m_usedChannels.at(u))
+        {
+            uchar value = values[channel];
+
+            // the intensity only scales the intensity channels, like a Scene does
+            if (intensity != 1.0 && (universe->channelCapabilities(channel) & Universe::Intensity))
+                value = uchar(qRound(qreal(value) * intensity));
+
+            universe->writeBlended(channel, value, blendMode());
+        }
+    }
+
+    incrementElapsed();
+}
@@ -0,0 +1,230 @@
+/*
+  Q Light Controller Plus
+  bakedshow.h
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef BAKEDSHOW_H
+#define BAKEDSHOW_H
+
+#include <QVector>
+#include <QThread>
+#include <QMutex>
+
+#include "bakedstream.h"
+#include "function.h"
+
+class QXmlStreamReader;
+class QLCFixtureDef;
+
+/** @addtogroup engine_functions Functions
+ * @{
+ */
+
+/**
+ * A BakedShow plays back the DMX frames of a Show pre-rendered into a
+ * baked stream file (see BakedStreamWriter), so the cost of playback
+ * doesn't depend on the complexity of the original Show.
+ */
+class BakedShow : public Function
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(BakedShow)
+
+    /*********************************************************************
+     * Initialization
+     *********************************************************************/
+public:
+    BakedShow(Doc* doc);
+    virtual ~BakedShow();
+
+    /** @reimp */
+    QIcon getIcon() const;
+
+private:
+    Doc *m_doc;
+
+    /*********************************************************************
+     * Copying
+     *********************************************************************/
+public:
+    /** @reimp */
+    Function* createCopy(Doc* doc, bool addToDoc = true);
+
+    /** Copy the contents for this function from another function */
+    bool copyFrom(const Function* function);
+
+    /*********************************************************************
+     * Properties
+     *********************************************************************/
+public:
+    /** @reimp */
+    quint32 totalDuration();
+
+    /** Get the number of universes stored in the baked stream */
+    int universesCount();
+
+    /** Get/Set the baked stream file played by this function */
+    QString sourceFileName() const;
+    bool setSourceFileName(QString filename);
+
+signals:
+    void sourceFileNameChanged();
+
+private:
+    /** The baked stream file path */
+    QString m_sourceFileName;
+
+    /** The mapped baked stream */
+    BakedStreamReader m_stream;
+
+    /** The channels of each universe that are used by the stream */
+    QVector< QVector<int> > m_usedChannels;
+
+    /** Mutex guarding the stream and the playback position */
+    QMutex m_streamMutex;
+
+    /*********************************************************************
+     * Save & Load
+     *********************************************************************/
+public:
+    /** Save function's contents to an XML document */
+    bool saveXML(QXmlStreamWriter *doc);
+
+    /** Load function's contents from an XML document */
+    bool loadXML(QXmlStreamReader &root);
+
+    /*********************************************************************
+     * Baking
+     *********************************************************************/
+public:
+    /**
+     * Render the function $functionID of $doc into the baked stream
+     * $fileName, faster than real time. The function runs offline on a
+     * copy of the workspace, so the engine of $doc is not affected.
+     * Audio and Video functions are left out, since they don't produce
+     * DMX. Rendering stops when the function stops or after $maxDuration
+     * milliseconds.
+     *
+     * This blocks the calling thread until the rendering is done: use
+     * a BakedShowBaker to render on a worker thread instead.
+     *
+     * @return false if the function cannot be baked or the file cannot
+     *         be written
+     */
+    static bool bake(Doc *doc, quint32 functionID, const QString &fileName,
+                     quint32 maxDuration);
+
+    /*********************************************************************
+     * Running
+     *********************************************************************/
+public:
+    /** Move the playback to $time (in milliseconds) at the next write */
+    void seek(quint32 time);
+
+    /** @reimpl */
+    void preRun(MasterTimer* timer);
+
+    /** @reimpl */
+    void write(MasterTimer* timer, QList<Universe*> universes);
+
+private:
+    /** Playback position at m_clockOrigin, in milliseconds */
+    quint32 m_startPosition;
+
+    /** MasterTimer clock time when the playback was at m_startPosition */
+    quint64 m_clockOrigin;
+
+    /** MasterTimer clock time when the function has been paused */
+    quint64 m_pauseClockTime;
+
+    /** Flag set when write() has seen the function paused */
+    bool m_paused;
+
+    /** Flag set when a seek has been requested and not applied yet */
+    bool m_seekRequested;
+
+    /** The requested seek position */
+    quint32 m_seekTime;
+};
+
+/**
+ * BakedShowBaker renders a function into a baked stream file (see
+ * BakedShow::bake()) on a worker thread, reporting the progress.
+ *
+ * The workspace is copied when the baker is created, so it must be created
+ * on the thread owning the Doc. Changes made to the workspace afterwards
+ * don't affect the rendering.
+ */
+class BakedShowBaker : public QThread
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(BakedShowBaker)
+
+public:
+    BakedShowBaker(Doc *doc, quint32 functionID, const QString &fileName,
+                   quint32 maxDuration, QObject *parent = NULL);
+    ~BakedShowBaker();
+
+    /** Get the baked stream file written by this baker */
+    QString fileName() const;
+
+    /** Render the function on the calling thread. start() renders it
+     *  on the worker thread instead */
+    bool bake();
+
+    /** Get the result of the last rendering */
+    bool isBaked() const;
+
+    /** Get the rendering progress, in percent */
+    int progress() const;
+
+public slots:
+    /** Stop the rendering as soon as possible. The partial file is removed */
+    void cancel();
+
+signals:
+    /** Emitted from the rendering thread when the progress changes */
+    void progressChanged(int percent);
+
+protected:
+    /** @reimp */
+    void run();
+
+private:
+    quint32 m_functionID;
+    QString m_fileName;
+    quint32 m_maxDuration;
+
+    /** The copy of the workspace, empty if the function cannot be baked */
+    QByteArray m_workspace;
+    QString m_workspacePath;
+    int m_universesCount;
+
+    /** Copies of the fixture definitions in use, owned by the baker */
+    QList<QLCFixtureDef *> m_fixtureDefs;
+
+    /** The BPM of the workspace, 0 if not set */
+    int m_bpmNumber;
+
+    QAtomicInt m_cancelled;
+    QAtomicInt m_progress;
+    bool m_baked;
+};
+
+/** @} */
+
+#endif
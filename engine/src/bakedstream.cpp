@@ -0,0 +1,413 @@
+/*
+  Q Light Controller Plus
+  bakedstream.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QtEndian>
+#include <QDebug>
+#include <string.h>
+
+#include "bakedstream.h"
+#include "universe.h"
+
+/** Changes closer than the size of a run header are merged in a single run */
+#define RUN_HEADER_SIZE 6
+#define MASK_SIZE (UNIVERSE_SIZE / 8)
+
+static void appendUInt16(QByteArray &data, quint16 value)
+{
+    uchar buffer[2];
+    qToLittleEndian<quint16>(value, buffer);
+    data.append(reinterpret_cast<const char *>(buffer), 2);
+}
+
+static void appendUInt32(QByteArray &data, quint32 value)
+{
+    uchar buffer[4];
+    qToLittleEndian<quint32>(value, buffer);
+    data.append(reinterpret_cast<const char *>(buffer), 4);
+}
+
+static void appendUInt64(QByteArray &data, quint64 value)
+{
+    uchar buffer[8];
+    qToLittleEndian<quint64>(value, buffer);
+    data.append(reinterpret_cast<const char *>(buffer), 8);
+}
+
+static void appendRun(QByteArray &data, int universe, int start, int length, const uchar *values)
+{
+    appendUInt16(data, quint16(universe));
+    appendUInt16(data, quint16(start));
+    appendUInt16(data, quint16(length));
+    data.append(reinterpret_cast<const char *>(values), length);
+}
+
+static QByteArray streamHeader(quint32 tick, int universesCount, quint32 framesCount,
+                               quint32 keyFrameInterval, quint64 indexOffset)
+{
+    QByteArray header(BAKEDSTREAM_MAGIC);
+    appendUInt32(header, BAKEDSTREAM_VERSION);
+    appendUInt32(header, tick);
+    appendUInt32(header, quint32(universesCount));
+    appendUInt32(header, framesCount);
+    appendUInt32(header, keyFrameInterval);
+    appendUInt32(header, 0);
+    appendUInt64(header, indexOffset);
+
+    Q_ASSERT(header.size() == BAKEDSTREAM_HEADER_SIZE);
+    return header;
+}
+
+/****************************************************************************
+ * BakedStreamWriter
+ ****************************************************************************/
+
+BakedStreamWriter::BakedStreamWriter()
+    : m_universesCount(0)
+    , m_tick(0)
+    , m_keyFrameInterval(BAKEDSTREAM_KEYFRAME_INTERVAL)
+{
+}
+
+BakedStreamWriter::~BakedStreamWriter()
+{
+    if (m_file.isOpen())
+        close();
+}
+
+bool BakedStreamWriter::open(const QString &fileName, int universesCount, quint32 tick,
+                             quint32 keyFrameInterval)
+{
+    if (m_file.isOpen() || universesCount <= 0 || tick == 0 || keyFrameInterval == 0)
+        return false;
+
+    m_file.setFileName(fileName);
+    if (m_file.open(QIODevice::WriteOnly | QIODevice::Truncate) == false)
+    {
+        qWarning() << "[BakedStreamWriter] unable to create" << fileName << ":" << m_file.errorString();
+        return false;
+    }
+
+    m_universesCount = universesCount;
+    m_tick = tick;
+    m_keyFrameInterval = keyFrameInterval;
+    m_lastValues.fill(0, universesCount * UNIVERSE_SIZE);
+    m_usedMask.fill(0, universesCount * MASK_SIZE);
+    m_index.clear();
+
+    // the frames count and the index offset are written by close()
+    QByteArray header = streamHeader(tick, universesCount, 0, keyFrameInterval, 0);
+    return m_file.write(header) == header.size();
+}
+
+bool BakedStreamWriter::writeFrame(const uchar *values)
+{
+    if (m_file.isOpen() == false || values == NULL)
+        return false;
+
+    bool keyFrame = (quint32(m_index.count()) % m_keyFrameInterval) == 0;
+    uchar *last = reinterpret_cast<uchar *>(m_lastValues.data());
+    char *mask = m_usedMask.data();
+    quint16 runsCount = 0;
+
+    // the runs count is patched when the frame is complete
+    m_frame.resize(0);
+    appendUInt16(m_frame, 0);
+
+    for (int u = 0; u < m_universesCount; u++)
+    {
+        const uchar *current = values + u * UNIVERSE_SIZE;
+        const uchar *previous = last + u * UNIVERSE_SIZE;
+
+        for (int i = 0; i < UNIVERSE_SIZE; i++)
+        {
+            if (current[i] != 0)
+                mask[u * MASK_SIZE + i / 8] |= char(1 << (i % 8));
+        }
+
+        runsCount += appendRuns(m_frame, u, current, keyFrame ? NULL : previous);
+    }
+
+    qToLittleEndian<quint16>(runsCount, reinterpret_cast<uchar *>(m_frame.data()));
+
+    m_index.append(quint64(m_file.pos()));
+    memcpy(last, values, m_lastValues.size());
+
+    return m_file.write(m_frame) == m_frame.size();
+}
+
+bool BakedStreamWriter::close()
+{
+    if (m_file.isOpen() == false)
+        return false;
+
+    quint64 indexOffset = quint64(m_file.pos());
+    QByteArray data;
+
+    foreach (quint64 offset, m_index)
+        appendUInt64(data, offset);
+    data.append(m_usedMask);
+
+    bool result = m_file.write(data) == data.size();
+
+    QByteArray header = streamHeader(m_tick, m_universesCount, quint32(m_index.count()),
+                                     m_keyFrameInterval, indexOffset);
+    result = result && m_file.seek(0) && m_file.write(header) == header.size();
+
+    m_file.close();
+
+    return result;
+}
+
+quint32 BakedStreamWriter::framesCount() const
+{
+    return quint32(m_index.count());
+}
+
+int BakedStreamWriter::appendRuns(QByteArray &data, int universe, const uchar *values, const uchar *previous)
+{
+    if (previous == NULL)
+    {
+        appendRun(data, universe, 0, UNIVERSE_SIZE, values);
+        return 1;
+    }
+
+    int runsCount = 0;
+    int channel = 0;
+
+    while (channel < UNIVERSE_SIZE)
+    {
+        if (values[channel] == previous[channel])
+        {
+            channel++;
+            continue;
+        }
+
+        // extend the run until the next change is too far
+        int start = channel;
+        int end = channel + 1;
+        for (int i = end; i < UNIVERSE_SIZE && i - end < RUN_HEADER_SIZE; i++)
+        {
+            if (values[i] != previous[i])
+                end = i + 1;
+        }
+
+        appendRun(data, universe, start, end - start, values + start);
+        runsCount++;
+        channel = end;
+    }
+
+    return runsCount;
+}
+
+/****************************************************************************
+ * BakedStreamReader
+ ****************************************************************************/
+
+BakedStreamReader::BakedStreamReader()
+    : m_data(NULL)
+    , m_size(0)
+    , m_tick(0)
+    , m_universesCount(0)
+    , m_framesCount(0)
+    , m_keyFrameInterval(0)
+    , m_index(NULL)
+    , m_usedMask(NULL)
+    , m_currentFrame(-1)
+{
+}
+
+BakedStreamReader::~BakedStreamReader()
+{
+    close();
+}
+
+bool BakedStreamReader::open(const QString &fileName)
+{
+    close();
+
+    m_file.setFileName(fileName);
+    if (m_file.open(QIODevice::ReadOnly) == false)
+    {
+        qWarning() << "[BakedStreamReader] unable to open" << fileName << ":" << m_file.errorString();
+        return false;
+    }
+
+    m_size = m_file.size();
+    if (m_size >= BAKEDSTREAM_HEADER_SIZE)
+        m_data = m_file.map(0, m_size);
+
+    if (m_data == NULL || memcmp(m_data, BAKEDSTREAM_MAGIC, 8) != 0 ||
+        qFromLittleEndian<quint32>(m_data + 8) != BAKEDSTREAM_VERSION)
+    {
+        qWarning() << "[BakedStreamReader]" << fileName << "is not a valid baked stream";
+        close();
+        return false;
+    }
+
+    m_tick = qFromLittleEndian<quint32>(m_data + 12);
+    m_universesCount = int(qFromLittleEndian<quint32>(m_data + 16));
+    m_framesCount = qFromLittleEndian<quint32>(m_data + 20);
+    m_keyFrameInterval = qFromLittleEndian<quint32>(m_data + 24);
+    quint64 indexOffset = qFromLittleEndian<quint64>(m_data + 32);
+
+    quint64 indexSize = quint64(m_framesCount) * 8 + quint64(m_universesCount) * MASK_SIZE;
+
+    if (m_tick == 0 || m_universesCount <= 0 || m_keyFrameInterval == 0 ||
+        indexOffset < BAKEDSTREAM_HEADER_SIZE || indexOffset > quint64(m_size) ||
+        indexSize > quint64(m_size) - indexOffset)
+    {
+        qWarning() << "[BakedStreamReader]" << fileName << "is truncated or corrupted";
+        close();
+        return false;
+    }
+
+    m_index = m_data + indexOffset;
+    m_usedMask = m_index + quint64(m_framesCount) * 8;
+    m_values.fill(0, m_universesCount * UNIVERSE_SIZE);
+    m_currentFrame = -1;
+
+    return true;
+}
+
+void BakedStreamReader::close()
+{
+    if (m_data != NULL)
+        m_file.unmap(const_cast<uchar *>(m_data));
+    if (m_file.isOpen())
+        m_file.close();
+
+    m_data = NULL;
+    m_size = 0;
+    m_index = NULL;
+    m_usedMask = NULL;
+    m_framesCount = 0;
+    m_universesCount = 0;
+    m_values.clear();
+    m_currentFrame = -1;
+}
+
+bool BakedStreamReader::isOpen() const
+{
+    return m_data != NULL;
+}
+
+quint32 BakedStreamReader::tick() const
+{
+    return m_tick;
+}
+
+int BakedStreamReader::universesCount() const
+{
+    return m_universesCount;
+}
+
+quint32 BakedStreamReader::framesCount() const
+{
+    return m_framesCount;
+}
+
+quint32 BakedStreamReader::duration() const
+{
+    return m_framesCount * m_tick;
+}
+
+bool BakedStreamReader::seek(quint32 frame)
+{
+    if (isOpen() == false || frame >= m_framesCount)
+        return false;
+
+    if (qint64(frame) == m_currentFrame)
+        return true;
+
+    // moving forward within the same key frame interval only needs the deltas
+    quint32 from = (frame / m_keyFrameInterval) * m_keyFrameInterval;
+    if (m_currentFrame >= 0 && qint64(frame) > m_currentFrame && qint64(from) <= m_currentFrame)
+        from = quint32(m_currentFrame + 1);
+
+    for (quint32 i = from; i <= frame; i++)
+    {
+        if (decodeFrame(i) == false)
+        {
+            qWarning() << "[BakedStreamReader] frame" << i << "is corrupted";
+            m_currentFrame = -1;
+            return false;
+        }
+    }
+
+    m_currentFrame = frame;
+    return true;
+}
+
+qint64 BakedStreamReader::currentFrame() const
+{
+    return m_currentFrame;
+}
+
+const uchar *BakedStreamReader::values(int universe) const
+{
+    if (universe < 0 || universe >= m_universesCount)
+        return NULL;
+
+    return reinterpret_cast<const uchar *>(m_values.constData()) + universe * UNIVERSE_SIZE;
+}
+
+bool BakedStreamReader::isChannelUsed(int universe, int channel) const
+{
+    if (universe < 0 || universe >= m_universesCount || channel < 0 || channel >= UNIVERSE_SIZE)
+        return false;
+
+    return m_usedMask[universe * MASK_SIZE + channel / 8] & (1 << (channel % 8));
+}
+
+bool BakedStreamReader::decodeFrame(quint32 frame)
+{
+    quint64 offset = qFromLittleEndian<quint64>(m_index + quint64(frame) * 8);
+    // frames are stored between the header and the index. The offsets are
+    // checked numerically, before pointing into the mapped file
+    quint64 end = quint64(m_index - m_data);
+
+    if (offset < BAKEDSTREAM_HEADER_SIZE || offset > end || end - offset < 2)
+        return false;
+
+    int runsCount = qFromLittleEndian<quint16>(m_data + offset);
+    offset += 2;
+
+    uchar *values = reinterpret_cast<uchar *>(m_values.data());
+
+    for (int i = 0; i < runsCount; i++)
+    {
+        if (end - offset < RUN_HEADER_SIZE)
+            return false;
+
+        const uchar *ptr = m_data + offset;
+        int universe = qFromLittleEndian<quint16>(ptr);
+        int start = qFromLittleEndian<quint16>(ptr + 2);
+        int length = qFromLittleEndian<quint16>(ptr + 4);
+        offset += RUN_HEADER_SIZE;
+
+        if (universe >= m_universesCount || start + length > UNIVERSE_SIZE ||
+            end - offset < quint64(length))
+            return false;
+
+        memcpy(values + universe * UNIVERSE_SIZE + start, m_data + offset, length);
+        offset += length;
+    }
+
+    return true;
+}
@@ -0,0 +1,183 @@
+/*
+  Q Light Controller Plus
+  bakedstream.h
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef BAKEDSTREAM_H
+#define BAKEDSTREAM_H
+
+#include <QByteArray>
+#include <QVector>
+#include <QString>
+#include <QFile>
+
+/** @addtogroup engine Engine
+ * @{
+ */
+
+#define BAKEDSTREAM_MAGIC "QLCBAKED"
+#define BAKEDSTREAM_VERSION 1
+#define BAKEDSTREAM_HEADER_SIZE 40
+
+#define KExtBakedStream ".qxb" // 'Q'LC+ 'X' 'B'aked stream
+
+/** A full frame is stored every BAKEDSTREAM_KEYFRAME_INTERVAL frames */
+#define BAKEDSTREAM_KEYFRAME_INTERVAL 250
+
+/**
+ * A baked stream is a file holding the pre-rendered DMX frames of a Show,
+ * one per MasterTimer tick. All the values are little endian.
+ *
+ * Header (BAKEDSTREAM_HEADER_SIZE bytes):
+ *   char[8]  magic (BAKEDSTREAM_MAGIC)
+ *   quint32  version
+ *   quint32  duration of a frame in milliseconds
+ *   quint32  number of universes
+ *   quint32  number of frames
+ *   quint32  key frame interval
+ *   quint32  reserved
+ *   quint64  offset of the frames index
+ *
+ * Each frame is a quint16 runs count, followed by the runs. A run is
+ * quint16 universe, quint16 first channel, quint16 length and the run
+ * values. A key frame holds all the channels of all the universes,
+ * the other frames only the channels changed since the previous frame.
+ *
+ * The frames index (one quint64 file offset per frame) is followed by
+ * a bit mask per universe (UNIVERSE_SIZE / 8 bytes) of the channels
+ * that are not zero in at least one frame.
+ */
+
+class BakedStreamWriter
+{
+public:
+    BakedStreamWriter();
+    ~BakedStreamWriter();
+
+    /**
+     * Create $fileName to store frames of $universesCount universes,
+     * each lasting $tick milliseconds
+     */
+    bool open(const QString &fileName, int universesCount, quint32 tick,
+              quint32 keyFrameInterval = BAKEDSTREAM_KEYFRAME_INTERVAL);
+
+    /**
+     * Append a frame. $values holds the UNIVERSE_SIZE values
+     * of each universe, one after the other.
+     */
+    bool writeFrame(const uchar *values);
+
+    /** Write the index and close the file */
+    bool close();
+
+    /** Get the number of frames written so far */
+    quint32 framesCount() const;
+
+    /**
+     * Append to $data the runs of the values of $universe that differ from
+     * $previous, or all of them if $previous is NULL.
+     * Return the number of runs appended.
+     */
+    static int appendRuns(QByteArray &data, int universe, const uchar *values, const uchar *previous);
+
+private:
+    QFile m_file;
+    int m_universesCount;
+    quint32 m_tick;
+    quint32 m_keyFrameInterval;
+
+    /** The values of the last frame written */
+    QByteArray m_lastValues;
+
+    /** The channels that have been not zero at least once */
+    QByteArray m_usedMask;
+
+    /** File offset of each frame */
+    QVector<quint64> m_index;
+
+    /** Buffer holding the encoded frame, reused across frames */
+    QByteArray m_frame;
+};
+
+class BakedStreamReader
+{
+public:
+    BakedStreamReader();
+    ~BakedStreamReader();
+
+    /** Map $fileName into memory and check its header and index */
+    bool open(const QString &fileName);
+
+    /** Release the file mapping */
+    void close();
+
+    /** Return true if a stream is open */
+    bool isOpen() const;
+
+    /** Get the duration of a frame in milliseconds */
+    quint32 tick() const;
+
+    /** Get the number of universes of each frame */
+    int universesCount() const;
+
+    /** Get the number of frames in the stream */
+    quint32 framesCount() const;
+
+    /** Get the total duration of the stream in milliseconds */
+    quint32 duration() const;
+
+    /**
+     * Decode $frame. Consecutive frames only apply their changes,
+     * other positions restart from the previous key frame.
+     */
+    bool seek(quint32 frame);
+
+    /** Get the index of the decoded frame, or -1 if none */
+    qint64 currentFrame() const;
+
+    /** Get the UNIVERSE_SIZE values of $universe in the decoded frame */
+    const uchar *values(int universe) const;
+
+    /** Return true if $channel of $universe is not zero in at least one frame */
+    bool isChannelUsed(int universe, int channel) const;
+
+private:
+    /** Apply the runs of $frame to m_values */
+    bool decodeFrame(quint32 frame);
+
+private:
+    QFile m_file;
+    const uchar *m_data;
+    qint64 m_size;
+
+    quint32 m_tick;
+    int m_universesCount;
+    quint32 m_framesCount;
+    quint32 m_keyFrameInterval;
+
+    /** Pointers to the frames index and the used channels masks */
+    const uchar *m_index;
+    const uchar *m_usedMask;
+
+    /** The values of the decoded frame */
+    QByteArray m_values;
+    qint64 m_currentFrame;
+};
+
+/** @} */
+
+#endif
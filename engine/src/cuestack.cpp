@@ -525,12 +525,8 @@ void CueStack::postRun(MasterTimer* timer)
     Q_ASSERT(m_fader != NULL);
 
     // Bounce all intensity channels to MasterTimer's fader for zeroing
-    QHashIterator <FadeChannel,FadeChannel> it(m_fader->channels());
-    while (it.hasNext() == true)
+    foreach (FadeChannel fc, m_fader->channels())
     {
-        it.next();
-        FadeChannel fc = it.value();
-
         if (fc.group(doc()) == QLCChannel::Intensity)
         {
             fc.setStart(fc.current(intensity()));
@@ -635,12 +631,11 @@ void CueStack::switchCue(int from, int to, const QList<Universe *> ua)
 void CueStack::insertStartValue(FadeChannel& fc, const QList<Universe *> ua)
 {
     qDebug() << Q_FUNC_INFO;
-    const QHash <FadeChannel,FadeChannel>& channels(m_fader->channels());
-    if (channels.contains(fc) == true)
+    if (m_fader->contains(fc) == true)
     {
         // GenericFader contains the channel so grab its current
         // value as the new starting value to get a smoother fade
-        FadeChannel existing = channels[fc];
+        FadeChannel existing = m_fader->channel(fc);
         fc.setStart(existing.current());
         fc.setCurrent(fc.start());
     }
@@ -0,0 +1,522 @@
+/*
+  Q Light Controller Plus
+  dmxrecorder.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QDateTime>
+#include <QtEndian>
+#include <QDebug>
+#include <string.h>
+
+#include "inputoutputmap.h"
+#include "bakedstream.h"
+#include "dmxrecorder.h"
+#include "universe.h"
+
+#define RECORD_HEADER_SIZE 11
+#define RUN_HEADER_SIZE 6
+
+DMXRecorder::DMXRecorder(InputOutputMap *ioMap, QObject *parent)
+    : QThread(parent)
+    , m_ioMap(ioMap)
+    , m_recordInput(false)
+    , m_running(false)
+    , m_queueHead(0)
+    , m_queueCount(0)
+    , m_framesCount(0)
+    , m_droppedFramesCount(0)
+    , m_droppedInputsCount(0)
+    , m_lastOutputKeyFrame(-1)
+    , m_lastInputKeyFrame(-1)
+{
+    Q_ASSERT(m_ioMap != NULL);
+
+    m_queue.resize(DMXRECORDER_QUEUE_SIZE);
+}
+
+DMXRecorder::~DMXRecorder()
+{
+    stopRecording();
+}
+
+bool DMXRecorder::startRecording(const QString &fileName, bool recordInput)
+{
+    if (isRunning())
+        return false;
+
+    m_file.setFileName(fileName);
+    if (m_file.open(QIODevice::WriteOnly | QIODevice::Truncate) == false)
+    {
+        qWarning() << "[DMXRecorder] unable to create" << fileName << ":" << m_file.errorString();
+        return false;
+    }
+
+    uchar header[DMXRECORDER_HEADER_SIZE];
+    memcpy(header, DMXRECORDER_MAGIC, 8);
+    qToLittleEndian<quint32>(DMXRECORDER_VERSION, header + 8);
+    qToLittleEndian<quint32>(0, header + 12);
+    qToLittleEndian<qint64>(QDateTime::currentMSecsSinceEpoch(), header + 16);
+
+    if (m_file.write(reinterpret_cast<const char *>(header), DMXRECORDER_HEADER_SIZE) != DMXRECORDER_HEADER_SIZE)
+    {
+        qWarning() << "[DMXRecorder] unable to write" << fileName << ":" << m_file.errorString();
+        m_file.close();
+        return false;
+    }
+
+    m_recordInput = recordInput;
+    m_queueHead = 0;
+    m_queueCount = 0;
+    m_inputQueue.clear();
+    m_framesCount = 0;
+    m_droppedFramesCount = 0;
+    m_droppedInputsCount = 0;
+    m_lastOutput.clear();
+    m_lastInput.clear();
+    m_inputFrame.clear();
+    m_inputChanged.clear();
+    m_lastOutputKeyFrame = -1;
+    m_lastInputKeyFrame = -1;
+    m_running = true;
+    m_clock.start();
+
+    // frames are queued directly from the MasterTimer thread
+    connect(m_ioMap, SIGNAL(universesSnapshotPublished()),
+            this, SLOT(slotSnapshotPublished()), Qt::DirectConnection);
+    if (m_recordInput)
+        connect(m_ioMap, SIGNAL(inputValueChanged(quint32,quint32,uchar,const QString&)),
+                this, SLOT(slotInputValueChanged(quint32,quint32,uchar,const QString&)),
+                Qt::DirectConnection);
+
+    start();
+
+    // snapshots are published only on changes, so record the current values first
+    slotSnapshotPublished();
+
+    qDebug() << "[DMXRecorder] recording to" << fileName;
+
+    return true;
+}
+
+void DMXRecorder::stopRecording()
+{
+    if (isRunning() == false)
+        return;
+
+    disconnect(m_ioMap, SIGNAL(universesSnapshotPublished()),
+               this, SLOT(slotSnapshotPublished()));
+    disconnect(m_ioMap, SIGNAL(inputValueChanged(quint32,quint32,uchar,const QString&)),
+               this, SLOT(slotInputValueChanged(quint32,quint32,uchar,const QString&)));
+
+    {
+        QMutexLocker locker(&m_mutex);
+        m_running = false;
+        m_condition.wakeOne();
+    }
+
+    // the thread writes the pending frames before quitting
+    wait();
+
+    m_file.close();
+
+    qDebug() << "[DMXRecorder] recorded" << m_framesCount << "frames, dropped" << m_droppedFramesCount
+             << "frames and" << m_droppedInputsCount << "input changes";
+}
+
+bool DMXRecorder::isRecording() const
+{
+    return isRunning();
+}
+
+quint64 DMXRecorder::framesCount() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_framesCount;
+}
+
+quint64 DMXRecorder::droppedFramesCount() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_droppedFramesCount;
+}
+
+quint64 DMXRecorder::droppedInputsCount() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_droppedInputsCount;
+}
+
+/****************************************************************************
+ * Producers
+ ****************************************************************************/
+
+void DMXRecorder::slotSnapshotPublished()
+{
+    UniverseSnapshot snapshot = m_ioMap->snapshot();
+    qint64 timestamp = m_clock.nsecsElapsed() / 1000;
+
+    QMutexLocker locker(&m_mutex);
+    if (m_running == false)
+        return;
+
+    // never block the MasterTimer: if the disk can't keep up, drop the frame
+    if (m_queueCount == DMXRECORDER_QUEUE_SIZE)
+    {
+        m_droppedFramesCount++;
+        return;
+    }
+
+    QueuedFrame &frame = m_queue[(m_queueHead + m_queueCount) % DMXRECORDER_QUEUE_SIZE];
+    frame.m_timestamp = timestamp;
+    frame.m_snapshot = snapshot;
+    m_queueCount++;
+
+    m_condition.wakeOne();
+}
+
+void DMXRecorder::slotInputValueChanged(quint32 universe, quint32 channel, uchar value, const QString &key)
+{
+    Q_UNUSED(key)
+
+    if (channel >= UNIVERSE_SIZE)
+        return;
+
+    QMutexLocker locker(&m_mutex);
+    if (m_running == false)
+        return;
+
+    // never block the input plugin either
+    if (m_inputQueue.count() == DMXRECORDER_INPUT_QUEUE_SIZE)
+    {
+        m_droppedInputsCount++;
+        return;
+    }
+
+    InputChange change;
+    change.m_timestamp = m_clock.nsecsElapsed() / 1000;
+    change.m_universe = universe;
+    change.m_channel = channel;
+    change.m_value = value;
+    m_inputQueue.append(change);
+
+    m_condition.wakeOne();
+}
+
+/****************************************************************************
+ * Recorder thread
+ ****************************************************************************/
+
+void DMXRecorder::run()
+{
+    QMutexLocker locker(&m_mutex);
+
+    while (m_running || m_queueCount > 0 || m_inputQueue.isEmpty() == false)
+    {
+        if (m_queueCount > 0)
+        {
+            QueuedFrame &frame = m_queue[m_queueHead];
+            UniverseSnapshot snapshot = frame.m_snapshot;
+            qint64 timestamp = frame.m_timestamp;
+
+            // release the frame, so the engine can recycle it
+            frame.m_snapshot = UniverseSnapshot();
+            m_queueHead = (m_queueHead + 1) % DMXRECORDER_QUEUE_SIZE;
+            m_queueCount--;
+            m_framesCount++;
+
+            locker.unlock();
+            recordOutput(snapshot, timestamp);
+            locker.relock();
+        }
+        else if (m_inputQueue.isEmpty() == false)
+        {
+            m_inputBatch.swap(m_inputQueue);
+
+            locker.unlock();
+            recordInputChanges(m_inputBatch);
+            m_inputBatch.resize(0);
+            locker.relock();
+        }
+        else
+        {
+            m_condition.wait(&m_mutex);
+        }
+    }
+
+    locker.unlock();
+
+    m_file.flush();
+}
+
+bool DMXRecorder::writeRecord(quint8 type, qint64 timestamp, int runsCount)
+{
+    uchar header[RECORD_HEADER_SIZE];
+    header[0] = type;
+    qToLittleEndian<qint64>(timestamp, header + 1);
+    qToLittleEndian<quint16>(quint16(runsCount), header + 9);
+
+    bool result = m_file.write(reinterpret_cast<const char *>(header), RECORD_HEADER_SIZE) == RECORD_HEADER_SIZE &&
+                  m_file.write(m_runs) == m_runs.size();
+
+    // make sure that a recording interrupted by a crash can be decoded
+    if (type & KeyFrameFlag)
+        m_file.flush();
+
+    if (result == false)
+        qWarning() << "[DMXRecorder] write error:" << m_file.errorString();
+
+    return result;
+}
+
+void DMXRecorder::recordOutput(const UniverseSnapshot &snapshot, qint64 timestamp)
+{
+    int universesCount = snapshot.universesCount();
+
+    if (m_lastOutput.size() < universesCount * UNIVERSE_SIZE)
+        m_lastOutput.append(QByteArray(universesCount * UNIVERSE_SIZE - m_lastOutput.size(), 0));
+
+    bool keyFrame = m_lastOutputKeyFrame < 0 ||
+                    timestamp - m_lastOutputKeyFrame >= qint64(DMXRECORDER_KEYFRAME_INTERVAL) * 1000;
+    uchar *last = reinterpret_cast<uchar *>(m_lastOutput.data());
+    int runsCount = 0;
+
+    m_runs.resize(0);
+
+    for (int u = 0; u < universesCount; u++)
+    {
+        const uchar *values = snapshot.postGMValues(u);
+        if (values == NULL)
+            continue;
+
+        uchar *previous = last + u * UNIVERSE_SIZE;
+        runsCount += BakedStreamWriter::appendRuns(m_runs, u, values, keyFrame ? NULL : previous);
+        memcpy(previous, values, UNIVERSE_SIZE);
+    }
+
+    if (keyFrame)
+        m_lastOutputKeyFrame = timestamp;
+    else if (runsCount == 0)
+        return;
+
+    writeRecord(OutputRecord | (keyFrame ? KeyFrameFlag : 0), timestamp, runsCount);
+}
+
+void DMXRecorder::recordInput(qint64 timestamp)
+{
+    int universesCount = m_inputFrame.size() / UNIVERSE_SIZE;
+
+    bool keyFrame = m_lastInputKeyFrame < 0 ||
+                    timestamp - m_lastInputKeyFrame >= qint64(DMXRECORDER_KEYFRAME_INTERVAL) * 1000;
+    const uchar *current = reinterpret_cast<const uchar *>(m_inputFrame.constData());
+    uchar *last = reinterpret_cast<uchar *>(m_lastInput.data());
+    int runsCount = 0;
+
+    m_runs.resize(0);
+
+    // only the universes that changed are compared, unless a key frame is due
+    for (int u = 0; u < universesCount; u++)
+    {
+        if (keyFrame == false && m_inputChanged.at(u) == false)
+            continue;
+
+        runsCount += BakedStreamWriter::appendRuns(m_runs, u, current + u * UNIVERSE_SIZE,
+                                                   keyFrame ? NULL : last + u * UNIVERSE_SIZE);
+        memcpy(last + u * UNIVERSE_SIZE, current + u * UNIVERSE_SIZE, UNIVERSE_SIZE);
+        m_inputChanged[u] = false;
+    }
+
+    if (keyFrame)
+        m_lastInputKeyFrame = timestamp;
+    else if (runsCount == 0)
+        return;
+
+    writeRecord(InputRecord | (keyFrame ? KeyFrameFlag : 0), timestamp, runsCount);
+}
+
+void DMXRecorder::recordInputChanges(const QVector<InputChange> &changes)
+{
+    if (changes.isEmpty())
+        return;
+
+    qint64 timestamp = changes.first().m_timestamp;
+
+    foreach (const InputChange &change, changes)
+    {
+        int index = int(change.m_universe * UNIVERSE_SIZE + change.m_channel);
+        if (m_inputFrame.size() <= index)
+        {
+            int size = int(change.m_universe + 1) * UNIVERSE_SIZE;
+            m_inputFrame.append(QByteArray(size - m_inputFrame.size(), 0));
+            m_lastInput.append(QByteArray(size - m_lastInput.size(), 0));
+            m_inputChanged.resize(int(change.m_universe + 1));
+        }
+
+        // a channel changing again closes the record, so its previous value is kept
+        if (m_inputFrame.at(index) != m_lastInput.at(index))
+            recordInput(timestamp);
+
+        m_inputFrame[index] = char(change.m_value);
+        m_inputChanged[int(change.m_universe)] = true;
+        timestamp = change.m_timestamp;
+    }
+
+    recordInput(timestamp);
+}
+
+/****************************************************************************
+ * DMXRecordingReader
+ ****************************************************************************/
+
+DMXRecordingReader::DMXRecordingReader()
+    : m_startTime(0)
+    , m_recordType(DMXRecorder::OutputRecord)
+    , m_timestamp(0)
+{
+}
+
+DMXRecordingReader::~DMXRecordingReader()
+{
+    close();
+}
+
+bool DMXRecordingReader::open(const QString &fileName)
+{
+    close();
+
+    m_file.setFileName(fileName);
+    if (m_file.open(QIODevice::ReadOnly) == false)
+    {
+        qWarning() << "[DMXRecordingReader] unable to open" << fileName << ":" << m_file.errorString();
+        return false;
+    }
+
+    QByteArray header = m_file.read(DMXRECORDER_HEADER_SIZE);
+    const uchar *ptr = reinterpret_cast<const uchar *>(header.constData());
+
+    if (header.size() != DMXRECORDER_HEADER_SIZE || header.left(8) != DMXRECORDER_MAGIC ||
+        qFromLittleEndian<quint32>(ptr + 8) != DMXRECORDER_VERSION)
+    {
+        qWarning() << "[DMXRecordingReader]" << fileName << "is not a valid recording";
+        m_file.close();
+        return false;
+    }
+
+    m_startTime = qFromLittleEndian<qint64>(ptr + 16);
+
+    return true;
+}
+
+void DMXRecordingReader::close()
+{
+    m_file.close();
+    m_startTime = 0;
+    m_recordType = DMXRecorder::OutputRecord;
+    m_timestamp = 0;
+    m_outputValues.clear();
+    m_inputValues.clear();
+}
+
+bool DMXRecordingReader::isOpen() const
+{
+    return m_file.isOpen();
+}
+
+qint64 DMXRecordingReader::startTime() const
+{
+    return m_startTime;
+}
+
+bool DMXRecordingReader::readRecord()
+{
+    if (m_file.isOpen() == false)
+        return false;
+
+    uchar header[RECORD_HEADER_SIZE];
+    if (m_file.read(reinterpret_cast<char *>(header), RECORD_HEADER_SIZE) != RECORD_HEADER_SIZE)
+        return false;
+
+    quint8 type = header[0] & ~DMXRecorder::KeyFrameFlag;
+    if (type != DMXRecorder::OutputRecord && type != DMXRecorder::InputRecord)
+    {
+        qWarning() << "[DMXRecordingReader] unknown record type" << header[0];
+        return false;
+    }
+
+    QByteArray &values = (type == DMXRecorder::InputRecord) ? m_inputValues : m_outputValues;
+    int runsCount = qFromLittleEndian<quint16>(header + 9);
+
+    for (int i = 0; i < runsCount; i++)
+    {
+        uchar run[RUN_HEADER_SIZE];
+        if (m_file.read(reinterpret_cast<char *>(run), RUN_HEADER_SIZE) != RUN_HEADER_SIZE)
+            return false;
+
+        int universe = qFromLittleEndian<quint16>(run);
+        int start = qFromLittleEndian<quint16>(run + 2);
+        int length = qFromLittleEndian<quint16>(run + 4);
+
+        if (start + length > UNIVERSE_SIZE)
+        {
+            qWarning() << "[DMXRecordingReader] corrupted run at" << m_file.pos();
+            return false;
+        }
+
+        if (values.size() < (universe + 1) * UNIVERSE_SIZE)
+            values.append(QByteArray((universe + 1) * UNIVERSE_SIZE - values.size(), 0));
+
+        if (m_file.read(values.data() + universe * UNIVERSE_SIZE + start, length) != length)
+            return false;
+    }
+
+    m_recordType = header[0];
+    m_timestamp = qFromLittleEndian<qint64>(header + 1);
+
+    return true;
+}
+
+DMXRecorder::RecordType DMXRecordingReader::recordType() const
+{
+    return DMXRecorder::RecordType(m_recordType & ~DMXRecorder::KeyFrameFlag);
+}
+
+bool DMXRecordingReader::isKeyFrame() const
+{
+    return (m_recordType & DMXRecorder::KeyFrameFlag) != 0;
+}
+
+qint64 DMXRecordingReader::timestamp() const
+{
+    return m_timestamp;
+}
+
+int DMXRecordingReader::universesCount(DMXRecorder::RecordType type) const
+{
+    if (type == DMXRecorder::InputRecord)
+        return m_inputValues.size() / UNIVERSE_SIZE;
+
+    return m_outputValues.size() / UNIVERSE_SIZE;
+}
+
+const uchar *DMXRecordingReader::values(DMXRecorder::RecordType type, int universe) const
+{
+    if (universe < 0 || universe >= universesCount(type))
+        return NULL;
+
+    const QByteArray &values = (type == DMXRecorder::InputRecord) ? m_inputValues : m_outputValues;
+
+    return reinterpret_cast<const uchar *>(values.constData()) + universe * UNIVERSE_SIZE;
+}
@@ -0,0 +1,262 @@
+/*
+  Q Light Controller Plus
+  dmxrecorder.h
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef DMXRECORDER_H
+#define DMXRECORDER_H
+
+#include <QWaitCondition>
+#include <QElapsedTimer>
+#include <QByteArray>
+#include <QVector>
+#include <QThread>
+#include <QMutex>
+#include <QFile>
+
+#include "universesnapshot.h"
+
+class InputOutputMap;
+
+/** @addtogroup engine Engine
+ * @{
+ */
+
+#define KExtDMXRecording ".qxr" // 'Q'LC+ 'X' 'R'ecording
+
+#define DMXRECORDER_MAGIC "QLCDMXRC"
+#define DMXRECORDER_VERSION 1
+#define DMXRECORDER_HEADER_SIZE 24
+
+/** Number of frames that can wait to be written. When full, new frames are dropped */
+#define DMXRECORDER_QUEUE_SIZE 64
+
+/** Number of input changes that can wait to be written. When full, new changes are dropped */
+#define DMXRECORDER_INPUT_QUEUE_SIZE 4096
+
+/** A full frame is recorded every DMXRECORDER_KEYFRAME_INTERVAL milliseconds */
+#define DMXRECORDER_KEYFRAME_INTERVAL 10000
+
+/**
+ * DMXRecorder records the output of all the universes, and optionally
+ * the values received by the input patches, to a file that grows as
+ * the recording goes on. All the values are little endian.
+ *
+ * Header (DMXRECORDER_HEADER_SIZE bytes):
+ *   char[8]  magic (DMXRECORDER_MAGIC)
+ *   quint32  version
+ *   quint32  reserved
+ *   qint64   wall clock time of the recording start, in ms since the epoch
+ *
+ * Then a record for each change:
+ *   quint8   record type (RecordType)
+ *   qint64   monotonic time since the recording start, in microseconds
+ *   quint16  runs count
+ *   runs     as in the baked streams (see BakedStreamWriter)
+ *
+ * Key frames hold all the universes and are written periodically,
+ * so a recording can be decoded from any key frame on.
+ *
+ * The output frames are taken from the snapshot published by
+ * InputOutputMap at each tick and queued to the recorder thread,
+ * which encodes and writes them. The input changes are queued with
+ * their own timestamp and the changes drained together are written
+ * as a single record, which is closed earlier only when a channel
+ * changes again, so fast input movements are not lost. Timestamps
+ * are monotonic within each record type.
+ *
+ * Recordings are decoded by DMXRecordingReader.
+ */
+class DMXRecorder : public QThread
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(DMXRecorder)
+
+public:
+    enum RecordType
+    {
+        OutputRecord = 0,
+        InputRecord = 1,
+        KeyFrameFlag = 0x80
+    };
+
+    DMXRecorder(InputOutputMap *ioMap, QObject *parent = NULL);
+    ~DMXRecorder();
+
+    /**
+     * Start recording to $fileName. If $recordInput is true, the values
+     * received by the input patches are recorded too.
+     */
+    bool startRecording(const QString &fileName, bool recordInput = false);
+
+    /** Write the pending frames and close the recording */
+    void stopRecording();
+
+    /** Return true if a recording is in progress */
+    bool isRecording() const;
+
+    /** Get the number of output frames recorded so far */
+    quint64 framesCount() const;
+
+    /** Get the number of output frames dropped because the queue was full */
+    quint64 droppedFramesCount() const;
+
+    /** Get the number of input changes dropped because the queue was full */
+    quint64 droppedInputsCount() const;
+
+private slots:
+    /** Queue the latest snapshot. Called in the MasterTimer thread */
+    void slotSnapshotPublished();
+
+    /** Store an input value. Called in the input plugin thread */
+    void slotInputValueChanged(quint32 universe, quint32 channel, uchar value, const QString& key);
+
+protected:
+    /** @reimp */
+    void run();
+
+private:
+    typedef struct
+    {
+        qint64 m_timestamp; //! Microseconds since the recording start
+        quint32 m_universe;
+        quint32 m_channel;
+        uchar m_value;
+    } InputChange;
+
+    /** Write a record of $type with the runs encoded in m_runs */
+    bool writeRecord(quint8 type, qint64 timestamp, int runsCount);
+
+    /** Write the changes of $snapshot since the previous output record */
+    void recordOutput(const UniverseSnapshot &snapshot, qint64 timestamp);
+
+    /** Write the changes of m_inputFrame since the previous input record */
+    void recordInput(qint64 timestamp);
+
+    /** Apply the queued input changes to m_inputFrame and record them */
+    void recordInputChanges(const QVector<InputChange> &changes);
+
+private:
+    InputOutputMap *m_ioMap;
+    QFile m_file;
+    bool m_recordInput;
+
+    /** Time of the recording start */
+    QElapsedTimer m_clock;
+
+    /** Mutex guarding the queues and m_running */
+    mutable QMutex m_mutex;
+    QWaitCondition m_condition;
+    bool m_running;
+
+    typedef struct
+    {
+        qint64 m_timestamp;          //! Microseconds since the recording start
+        UniverseSnapshot m_snapshot; //! The published universes
+    } QueuedFrame;
+
+    /** Ring buffer of the frames to be written */
+    QVector<QueuedFrame> m_queue;
+    int m_queueHead;
+    int m_queueCount;
+
+    /** The input changes to be written, in the order they were received */
+    QVector<InputChange> m_inputQueue;
+
+    quint64 m_framesCount;
+    quint64 m_droppedFramesCount;
+    quint64 m_droppedInputsCount;
+
+    /**
+     * Recorder thread data: the last values written, the time of
+     * the last key frames, the buffer of the encoded runs, the
+     * current input values, the input universes changed since the
+     * last input record and the input changes being written
+     */
+    QByteArray m_lastOutput;
+    QByteArray m_lastInput;
+    qint64 m_lastOutputKeyFrame;
+    qint64 m_lastInputKeyFrame;
+    QByteArray m_runs;
+    QByteArray m_inputFrame;
+    QVector<bool> m_inputChanged;
+    QVector<InputChange> m_inputBatch;
+};
+
+/**
+ * DMXRecordingReader decodes a recording written by DMXRecorder,
+ * one record at a time. The values of each record type are kept
+ * separately and updated by each record, so after readRecord()
+ * values() returns the complete universes at timestamp().
+ */
+class DMXRecordingReader
+{
+public:
+    DMXRecordingReader();
+    ~DMXRecordingReader();
+
+    /** Open $fileName and check its header */
+    bool open(const QString &fileName);
+
+    /** Close the recording */
+    void close();
+
+    /** Return true if a recording is open */
+    bool isOpen() const;
+
+    /** Get the wall clock time of the recording start, in ms since the epoch */
+    qint64 startTime() const;
+
+    /**
+     * Decode the next record. Returns false at the end of the recording
+     * or if the record is corrupted.
+     */
+    bool readRecord();
+
+    /** Get the type of the last record, without KeyFrameFlag */
+    DMXRecorder::RecordType recordType() const;
+
+    /** Return true if the last record was a key frame */
+    bool isKeyFrame() const;
+
+    /** Get the timestamp of the last record, in microseconds since the start */
+    qint64 timestamp() const;
+
+    /** Get the number of universes decoded so far for $type */
+    int universesCount(DMXRecorder::RecordType type) const;
+
+    /**
+     * Get the UNIVERSE_SIZE values of $universe for $type, or NULL
+     * if $universe is beyond the universes decoded so far
+     */
+    const uchar *values(DMXRecorder::RecordType type, int universe) const;
+
+private:
+    QFile m_file;
+    qint64 m_startTime;
+
+    quint8 m_recordType;
+    qint64 m_timestamp;
+
+    /** The decoded output and input values */
+    QByteArray m_outputValues;
+    QByteArray m_inputValues;
+};
+
+/** @} */
+
+#endif
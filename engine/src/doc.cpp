@@ -33,6 +33,7 @@
 
 #include "monitorproperties.h"
 #include "audioplugincache.h"
+#include "audiopcmcache.h"
 #include "rgbscriptscache.h"
 #include "channelsgroup.h"
 #include "scriptwrapper.h"
@@ -134,6 +135,9 @@ void Doc::clearContents()
         delete func;
     }
 
+    // release the audio decoded for the functions deleted above
+    m_audioPluginCache->pcmCache()->clear();
+
     // Delete all channels groups
     QListIterator <quint32> grpchans(m_channelsGroups.keys());
     while (grpchans.hasNext() == true)
@@ -283,6 +287,7 @@ void Doc::destroyAudioCapture()
     {
         qDebug() << "Destroying audio capture";
         m_inputCapture.clear();
+        emit audioCaptureDestroyed();
     }
 }
 
@@ -933,6 +938,14 @@ bool Doc::addFunction(Function* func, quint32 id)
         connect(this, SIGNAL(fixtureRemoved(quint32)),
                 func, SLOT(slotFixtureRemoved(quint32)));
 
+        // Make the function listen to fixture changes
+        connect(this, SIGNAL(fixtureChanged(quint32)),
+                func, SLOT(slotFixtureChanged(quint32)));
+
+        // Make the function listen to fixture group changes
+        connect(this, SIGNAL(fixtureGroupChanged(quint32)),
+                func, SLOT(slotFixtureGroupChanged(quint32)));
+
         // Place the function in the map and assign it the new ID
         m_functions[id] = func;
         func->setID(id);
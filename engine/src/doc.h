@@ -151,6 +151,11 @@ public:
     /** Destroy a previously created audio capture instance */
     void destroyAudioCapture();
 
+signals:
+    /** Emitted when the audio capture has been destroyed. A new one
+     *  is created by the next call to audioInputCapture() */
+    void audioCaptureDestroyed();
+
 private:
     QLCFixtureDefCache *m_fixtureDefCache;
     QLCModifiersCache *m_modifiersCache;
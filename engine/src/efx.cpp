@@ -58,6 +58,7 @@ EFX::EFX(Doc* doc) : Function(doc, Function::EFXType)
     m_propagationMode = Parallel;
 
     m_algorithm = EFX::Circle;
+    m_pathTableChanged = true;
 
     setName(tr("New EFX"));
 
@@ -142,6 +143,7 @@ bool EFX::copyFrom(const Function* function)
     m_yPhase = efx->m_yPhase;
 
     m_algorithm = efx->m_algorithm;
+    m_pathTableChanged = true;
 
     return Function::copyFrom(function);
 }
@@ -171,6 +173,7 @@ void EFX::setAlgorithm(EFX::Algorithm algo)
         m_algorithm = algo;
     else
         m_algorithm = EFX::Circle;
+    m_pathTableChanged = true;
 
     emit changed(this->id());
 }
@@ -283,6 +286,49 @@ void EFX::calculatePoint(Function::Direction direction, int startOffset, float i
     calculatePoint(iterator, x, y);
 }
 
+void EFX::calculateTablePoint(Function::Direction direction, int startOffset, float iterator, float* x, float* y) const
+{
+    // Not running yet
+    if (m_pathX.isEmpty())
+    {
+        calculatePoint(direction, startOffset, iterator, x, y);
+        return;
+    }
+
+    iterator = calculateDirection(direction, iterator);
+    iterator += convertOffset(startOffset + getAttributeValue(StartOffset));
+
+    if (iterator >= M_PI * 2.0)
+        iterator -= M_PI * 2.0;
+
+    float pos = iterator * float(EFX_PATH_TABLE_SIZE / (M_PI * 2.0));
+    int index = CLAMP(int(pos), 0, EFX_PATH_TABLE_SIZE - 1);
+    float fraction = pos - index;
+
+    const float *pathX = m_pathX.constData() + index;
+    const float *pathY = m_pathY.constData() + index;
+
+    *x = pathX[0] + (pathX[1] - pathX[0]) * fraction;
+    *y = pathY[0] + (pathY[1] - pathY[0]) * fraction;
+
+    rotateAndScale(x, y);
+}
+
+void EFX::updatePathTable()
+{
+    if (m_pathTableChanged == false)
+        return;
+
+    m_pathTableChanged = false;
+
+    m_pathX.resize(EFX_PATH_TABLE_SIZE + 1);
+    m_pathY.resize(EFX_PATH_TABLE_SIZE + 1);
+
+    // The last point closes the cycle, to interpolate the last sample
+    for (int i = 0; i <= EFX_PATH_TABLE_SIZE; i++)
+        calculatePathPoint(i * (M_PI * 2.0) / EFX_PATH_TABLE_SIZE, &m_pathX[i], &m_pathY[i]);
+}
+
 void EFX::rotateAndScale(float* x, float* y) const
 {
     float xx = *x;
@@ -316,8 +362,14 @@ float EFX::calculateDirection(Function::Direction direction, float iterator) con
     }
 }
 
-// this function should map from 0..M_PI * 2 -> -1..1
 void EFX::calculatePoint(float iterator, float* x, float* y) const
+{
+    calculatePathPoint(iterator, x, y);
+    rotateAndScale(x, y);
+}
+
+// this function should map from 0..M_PI * 2 -> -1..1
+void EFX::calculatePathPoint(float iterator, float* x, float* y) const
 {
     switch (algorithm())
     {
@@ -409,8 +461,6 @@ void EFX::calculatePoint(float iterator, float* x, float* y) const
         }
         break;
     }
-
-    rotateAndScale(x, y);
 }
 
 /*****************************************************************************
@@ -534,6 +584,7 @@ int EFX::yOffset() const
 void EFX::setXFrequency(int freq)
 {
     m_xFrequency = static_cast<float> (CLAMP(freq, 0, 32));
+    m_pathTableChanged = true;
     emit changed(this->id());
 }
 
@@ -545,6 +596,7 @@ int EFX::xFrequency() const
 void EFX::setYFrequency(int freq)
 {
     m_yFrequency = static_cast<float> (CLAMP(freq, 0, 32));
+    m_pathTableChanged = true;
     emit changed(this->id());
 }
 
@@ -568,6 +620,7 @@ bool EFX::isFrequencyEnabled()
 void EFX::setXPhase(int phase)
 {
     m_xPhase = static_cast<float> (CLAMP(phase, 0, 359)) * M_PI / 180.0;
+    m_pathTableChanged = true;
     emit changed(this->id());
 }
 
@@ -579,6 +632,7 @@ int EFX::xPhase() const
 void EFX::setYPhase(int phase)
 {
     m_yPhase = static_cast<float> (CLAMP(phase, 0, 359)) * M_PI / 180.0;
+    m_pathTableChanged = true;
     emit changed(this->id());
 }
 
@@ -739,6 +793,17 @@ void EFX::slotFixtureRemoved(quint32 fxi_id)
     }
 }
 
+void EFX::slotFixtureChanged(quint32 fxi_id)
+{
+    /* Running heads resolve their channels again, since the fixture
+       address, universe or mode may have changed */
+    foreach (EFXFixture *ef, m_fixtures)
+    {
+        if (ef->head().fxi == fxi_id)
+            ef->setChannelsChanged();
+    }
+}
+
 /*****************************************************************************
  * Fixture propagation mode
  *****************************************************************************/
@@ -1042,6 +1107,10 @@ void EFX::preRun(MasterTimer* timer)
     m_fader = new GenericFader(doc());
     m_fader->adjustIntensity(getAttributeValue(Intensity));
     m_fader->setBlendMode(blendMode());
+    // the fixtures hold the indices of their fader channels
+    m_fader->setKeepZeroChannels(true);
+
+    updatePathTable();
 
     Function::preRun(timer);
 }
@@ -1055,6 +1124,9 @@ void EFX::write(MasterTimer* timer, QList<Universe*> universes)
     if (isPaused())
         return;
 
+    // Parameters may have been changed while running
+    updatePathTable();
+
     QListIterator <EFXFixture*> it(m_fixtures);
     while (it.hasNext() == true)
     {
@@ -1073,6 +1145,11 @@ void EFX::write(MasterTimer* timer, QList<Universe*> universes)
     m_fader->write(universes);
 }
 
+bool EFX::canWriteConcurrently() const
+{
+    return true;
+}
+
 void EFX::postRun(MasterTimer* timer, QList<Universe *> universes)
 {
     /* Reset all fixtures */
@@ -67,6 +67,9 @@ class Fixture;
 #define KXMLQLCEFXLeafAlgorithmName "Leaf"
 #define KXMLQLCEFXLissajousAlgorithmName "Lissajous"
 
+/** Number of samples of the path table, over a whole cycle */
+#define EFX_PATH_TABLE_SIZE 4096
+
 /**
  * An EFX (effects) function that is used to create
  * more complex automation especially for moving lights
@@ -181,6 +184,13 @@ public:
      */
     void calculatePoint(Function::Direction direction, int startOffset, float iterator, float* x, float* y) const;
 
+    /**
+     * Same as calculatePoint(), but the path is interpolated from the
+     * table built by updatePathTable() instead of being calculated.
+     * Used while running, where updatePathTable() is called on each tick.
+     */
+    void calculateTablePoint(Function::Direction direction, int startOffset, float iterator, float* x, float* y) const;
+
 private:
 
     void preview(QPolygonF &polygon, Function::Direction direction, int startOffset) const;
@@ -209,6 +219,12 @@ private:
      */
     void calculatePoint(float iterator, float* x, float* y) const;
 
+    /**
+     * Calculate a single point of the current algorithm path, in the
+     * -1..1 range, before rotation and scaling.
+     */
+    void calculatePathPoint(float iterator, float* x, float* y) const;
+
     /**
      * Recalculate iterator depending on direction
      *
@@ -217,10 +233,23 @@ private:
      */
     float calculateDirection(Function::Direction direction, float iterator) const;
 
+    /**
+     * Sample the path of the current algorithm into m_pathX and m_pathY,
+     * if any of its parameters changed since the last time.
+     */
+    void updatePathTable();
+
 private:
     /** Current algorithm used by the EFX */
     Algorithm m_algorithm;
 
+    /** The path sampled over a cycle, EFX_PATH_TABLE_SIZE + 1 points */
+    QVector<float> m_pathX;
+    QVector<float> m_pathY;
+
+    /** Flag raised when the path table must be sampled again */
+    bool m_pathTableChanged;
+
     /*********************************************************************
      * Width
      *********************************************************************/
@@ -505,6 +534,9 @@ public slots:
     /** Slot that captures Doc::fixtureRemoved signals */
     void slotFixtureRemoved(quint32 fxi_id);
 
+    /** Slot that captures Doc::fixtureChanged signals */
+    void slotFixtureChanged(quint32 fxi_id);
+
 private:
     QList <EFXFixture *> m_fixtures;
     GenericFader *m_fader;
@@ -564,6 +596,9 @@ public:
     /** @reimp */
     void write(MasterTimer* timer, QList<Universe *> universes);
 
+    /** @reimp */
+    bool canWriteConcurrently() const;
+
     /** @reimp */
     void postRun(MasterTimer* timer, QList<Universe*> universes);
 
@@ -53,9 +53,20 @@ EFXFixture::EFXFixture(const EFX* parent)
     , m_started(false)
     , m_elapsed(0)
     , m_currentAngle(0)
+    , m_universe(Universe::invalid())
+    , m_panMsbChannel(QLCChannel::invalid())
+    , m_panLsbChannel(QLCChannel::invalid())
+    , m_tiltMsbChannel(QLCChannel::invalid())
+    , m_tiltLsbChannel(QLCChannel::invalid())
+    , m_intensityChannel(QLCChannel::invalid())
+    , m_intensityIndex(-1)
+    , m_channelsChanged(0)
 {
     Q_ASSERT(parent != NULL);
 
+    for (int i = 0; i < 3; i++)
+        m_rgbIndices[i] = -1;
+
     if(m_rgbGradient.isNull ())
         m_rgbGradient = Gradient::getRGBGradient (256, 256);
 }
@@ -75,6 +86,10 @@ void EFXFixture::copyFrom(const EFXFixture* ef)
     m_started = ef->m_started;
     m_elapsed = ef->m_elapsed;
     m_currentAngle = ef->m_currentAngle;
+
+    // The channels are resolved for this fixture's head on the next step
+    if (m_started)
+        setChannelsChanged();
 }
 
 EFXFixture::~EFXFixture()
@@ -378,8 +393,9 @@ void EFXFixture::nextStep(MasterTimer* timer, QList<Universe *> universes)
     m_elapsed += MasterTimer::tick();
 
     // Bail out without doing anything if this fixture is ready (after single-shot)
-    // or it has no pan&tilt channels (not valid).
-    if (m_ready == true || isValid() == false)
+    // or it has no pan&tilt channels (not valid). Once started, the channels
+    // have been resolved already.
+    if (m_ready == true || (m_started == false && isValid() == false))
         return;
 
     // Bail out without doing anything if this fixture is waiting for its turn.
@@ -389,6 +405,8 @@ void EFXFixture::nextStep(MasterTimer* timer, QList<Universe *> universes)
     // Fade in
     if (m_started == false)
         start(timer, universes);
+    else if (m_channelsChanged.testAndSetOrdered(1, 0))
+        resolveChannels();
 
     // Nothing to do
     if (m_parent->duration() == 0)
@@ -407,7 +425,7 @@ void EFXFixture::nextStep(MasterTimer* timer, QList<Universe *> universes)
         m_elapsed < (m_parent->duration() + timeOffset()))
         || m_elapsed < m_parent->duration())
     {
-        m_parent->calculatePoint(m_runTimeDirection, m_startOffset, m_currentAngle, &valX, &valY);
+        m_parent->calculateTablePoint(m_runTimeDirection, m_startOffset, m_currentAngle, &valX, &valY);
 
         /* Write this fixture's data to universes. */
         switch(m_mode)
@@ -449,49 +467,44 @@ void EFXFixture::nextStep(MasterTimer* timer, QList<Universe *> universes)
 
 void EFXFixture::setPointPanTilt(QList<Universe *> universes, float pan, float tilt)
 {
-    Fixture* fxi = doc()->fixture(head().fxi);
-    Q_ASSERT(fxi != NULL);
+    Universe *universe = universes[m_universe];
+    bool relative = m_parent->isRelative();
 
     /* Write coarse point data to universes */
-    quint32 panMsbChannel = fxi->channelNumber(QLCChannel::Pan, QLCChannel::MSB, head().head);
-    quint32 panLsbChannel = fxi->channelNumber(QLCChannel::Pan, QLCChannel::LSB, head().head);
-    quint32 tiltMsbChannel = fxi->channelNumber(QLCChannel::Tilt, QLCChannel::MSB, head().head);
-    quint32 tiltLsbChannel = fxi->channelNumber(QLCChannel::Tilt, QLCChannel::LSB, head().head);
-
-    if (panMsbChannel != QLCChannel::invalid())
+    if (m_panMsbChannel != QLCChannel::invalid())
     {
-        if (m_parent->isRelative())
-            universes[fxi->universe()]->writeRelative(fxi->address() + panMsbChannel, static_cast<char>(pan));
+        if (relative)
+            universe->writeRelative(m_panMsbChannel, static_cast<char>(pan));
         else
-            universes[fxi->universe()]->write(fxi->address() + panMsbChannel, static_cast<char>(pan));
+            universe->write(m_panMsbChannel, static_cast<char>(pan));
     }
-    if (tiltMsbChannel != QLCChannel::invalid())
+    if (m_tiltMsbChannel != QLCChannel::invalid())
     {
-        if (m_parent->isRelative())
-            universes[fxi->universe()]->writeRelative(fxi->address() + tiltMsbChannel, static_cast<char> (tilt));
+        if (relative)
+            universe->writeRelative(m_tiltMsbChannel, static_cast<char> (tilt));
         else
-            universes[fxi->universe()]->write(fxi->address() + tiltMsbChannel, static_cast<char> (tilt));
+            universe->write(m_tiltMsbChannel, static_cast<char> (tilt));
     }
 
     /* Write fine point data to universes if applicable */
-    if (panLsbChannel != QLCChannel::invalid())
+    if (m_panLsbChannel != QLCChannel::invalid())
     {
         /* Leave only the fraction */
         char value = static_cast<char> ((pan - floor(pan)) * double(UCHAR_MAX));
-        if (m_parent->isRelative())
-            universes[fxi->universe()]->writeRelative(fxi->address() + panLsbChannel, value);
+        if (relative)
+            universe->writeRelative(m_panLsbChannel, value);
         else
-            universes[fxi->universe()]->write(fxi->address() + panLsbChannel, value);
+            universe->write(m_panLsbChannel, value);
     }
 
-    if (tiltLsbChannel != QLCChannel::invalid())
+    if (m_tiltLsbChannel != QLCChannel::invalid())
     {
         /* Leave only the fraction */
         char value = static_cast<char> ((tilt - floor(tilt)) * double(UCHAR_MAX));
-        if (m_parent->isRelative())
-            universes[fxi->universe()]->writeRelative(fxi->address() + tiltLsbChannel, value);
+        if (relative)
+            universe->writeRelative(m_tiltLsbChannel, value);
         else
-            universes[fxi->universe()]->write(fxi->address() + tiltLsbChannel, value);
+            universe->write(m_tiltLsbChannel, value);
     }
 }
 
@@ -499,39 +512,22 @@ void EFXFixture::setPointDimmer(QList<Universe *> universes, float dimmer)
 {
     Q_UNUSED(universes);
 
-    Fixture* fxi = doc()->fixture(head().fxi);
-    Q_ASSERT(fxi != NULL);
-
-    quint32 intChannel = fxi->channelNumber(QLCChannel::Intensity, QLCChannel::MSB, head().head);
-
     /* Don't write dimmer data directly to universes but use FadeChannel to avoid steps at EFX loop restart */
-    if (intChannel != QLCChannel::invalid())
-    {
-        setFadeChannel(intChannel, dimmer);
-    }
-    else if (fxi->masterIntensityChannel() != QLCChannel::invalid())
-    {
-        setFadeChannel(fxi->masterIntensityChannel(), dimmer);
-    }
+    setFadeChannel(m_intensityIndex, dimmer);
 }
 
 void EFXFixture::setPointRGB(QList<Universe *> universes, float x, float y)
 {
     Q_UNUSED(universes);
 
-    Fixture* fxi = doc()->fixture(head().fxi);
-    Q_ASSERT(fxi != NULL);
-
-    QVector<quint32> rgbChannels = fxi->rgbChannels(head().head);
-
     /* Don't write dimmer data directly to universes but use FadeChannel to avoid steps at EFX loop restart */
-    if (rgbChannels.size() >= 3)
+    if (m_rgbIndices[0] >= 0)
     {
         QColor pixel = m_rgbGradient.pixel(x, y);
 
-        setFadeChannel(rgbChannels[0], pixel.red());
-        setFadeChannel(rgbChannels[1], pixel.green());
-        setFadeChannel(rgbChannels[2], pixel.blue());
+        setFadeChannel(m_rgbIndices[0], pixel.red());
+        setFadeChannel(m_rgbIndices[1], pixel.green());
+        setFadeChannel(m_rgbIndices[2], pixel.blue());
     }
 }
 
@@ -540,9 +536,64 @@ void EFXFixture::start(MasterTimer* timer, QList<Universe *> universes)
     Q_UNUSED(universes);
     Q_UNUSED(timer);
 
+    m_channelsChanged.fetchAndStoreOrdered(0);
+    resolveChannels();
+
     m_started = true;
 }
 
+void EFXFixture::resolveChannels()
+{
+    Fixture* fxi = doc()->fixture(head().fxi);
+    if (fxi == NULL)
+        return;
+
+    m_universe = fxi->universe();
+
+    m_panMsbChannel = fxi->channelNumber(QLCChannel::Pan, QLCChannel::MSB, head().head);
+    m_panLsbChannel = fxi->channelNumber(QLCChannel::Pan, QLCChannel::LSB, head().head);
+    m_tiltMsbChannel = fxi->channelNumber(QLCChannel::Tilt, QLCChannel::MSB, head().head);
+    m_tiltLsbChannel = fxi->channelNumber(QLCChannel::Tilt, QLCChannel::LSB, head().head);
+
+    quint32 *channels[] = { &m_panMsbChannel, &m_panLsbChannel, &m_tiltMsbChannel, &m_tiltLsbChannel };
+    for (int i = 0; i < 4; i++)
+    {
+        if (*channels[i] != QLCChannel::invalid())
+            *channels[i] += fxi->address();
+    }
+
+    m_intensityChannel = fxi->channelNumber(QLCChannel::Intensity, QLCChannel::MSB, head().head);
+    if (m_intensityChannel == QLCChannel::invalid())
+        m_intensityChannel = fxi->masterIntensityChannel();
+
+    m_rgbChannels = fxi->rgbChannels(head().head);
+
+    // Add the faded channels to the parent's fader now,
+    // so that the steps only have to set their targets
+    GenericFader *fader = m_parent->m_fader;
+    m_intensityIndex = -1;
+    for (int i = 0; i < 3; i++)
+        m_rgbIndices[i] = -1;
+
+    if (fader == NULL)
+        return;
+
+    if (m_mode == Dimmer && m_intensityChannel != QLCChannel::invalid())
+    {
+        m_intensityIndex = fader->channelIndex(FadeChannel(doc(), head().fxi, m_intensityChannel));
+    }
+    else if (m_mode == RGB && m_rgbChannels.size() >= 3)
+    {
+        for (int i = 0; i < 3; i++)
+            m_rgbIndices[i] = fader->channelIndex(FadeChannel(doc(), head().fxi, m_rgbChannels[i]));
+    }
+}
+
+void EFXFixture::setChannelsChanged()
+{
+    m_channelsChanged.fetchAndStoreOrdered(1);
+}
+
 void EFXFixture::stop(MasterTimer* timer, QList<Universe *> universes)
 {
     Q_UNUSED(timer)
@@ -554,10 +605,9 @@ void EFXFixture::stop(MasterTimer* timer, QList<Universe *> universes)
 /*****************************************************************************
  * Helper Function
  *****************************************************************************/
-void EFXFixture::setFadeChannel(quint32 nChannel, uchar val)
+void EFXFixture::setFadeChannel(int index, uchar val)
 {
-    FadeChannel fc(doc(), head().fxi, nChannel);
-
-    fc.setTarget(val);
-    m_parent->m_fader->forceAdd(fc);
+    // no fade time: the values jump, as the path is computed on every step
+    if (index >= 0)
+        m_parent->m_fader->setTarget(index, val, 0);
 }
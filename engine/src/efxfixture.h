@@ -21,6 +21,8 @@
 #ifndef EFXFIXTURE_H
 #define EFXFIXTURE_H
 
+#include <QAtomicInt>
+#include <QVector>
 #include <QImage>
 #include "function.h"
 #include "grouphead.h"
@@ -195,13 +197,42 @@ private:
     /* Run the start scene if necessary */
     void start(MasterTimer* timer, QList<Universe *> universes);
 
+    /** Resolve the universe and the channels of the head */
+    void resolveChannels();
+
+    /** Resolve the channels again at the next step, because the
+        fixture address, mode or universe has changed. Thread safe. */
+    void setChannelsChanged();
+
     /* Run the stop scene if necessary */
     void stop(MasterTimer* timer, QList<Universe *> universes);
 
+private:
+    /** The channels of the head, resolved by start() so that nothing
+        needs to be looked up on each step. Pan/tilt channels are absolute
+        addresses within m_universe, the others are relative to the fixture. */
+    quint32 m_universe;
+    quint32 m_panMsbChannel;
+    quint32 m_panLsbChannel;
+    quint32 m_tiltMsbChannel;
+    quint32 m_tiltLsbChannel;
+    quint32 m_intensityChannel;
+    QVector<quint32> m_rgbChannels;
+
+    /** The indices in the parent's fader of the intensity and RGB
+        channels, resolved along with the channels when they are used
+        by the mode, -1 otherwise */
+    int m_intensityIndex;
+    int m_rgbIndices[3];
+
+    /** Set by setChannelsChanged() while the fixture is running */
+    QAtomicInt m_channelsChanged;
+
 private:
     static QImage m_rgbGradient;
 
-    void setFadeChannel(quint32 nChannel, uchar val);
+    /** Set the target of the parent's fader channel at $index */
+    void setFadeChannel(int index, uchar val);
 };
 
 /** @} */
@@ -30,6 +30,7 @@
 
 #include "scriptwrapper.h"
 #include "mastertimer.h"
+#include "bakedshow.h"
 #include "collection.h"
 #include "rgbmatrix.h"
 #include "function.h"
@@ -58,6 +59,7 @@ const QString KAudioString      (      "Audio" );
 #if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
 const QString KVideoString      (      "Video" );
 #endif
+const QString KBakedShowString  (  "BakedShow" );
 const QString KUndefinedString  (  "Undefined" );
 
 const QString KLoopString       (       "Loop" );
@@ -257,6 +259,7 @@ QString Function::typeToString(Type type)
 #if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
         case VideoType:      return KVideoString;
 #endif
+        case BakedShowType:  return KBakedShowString;
         case Undefined:
         default:
             return KUndefinedString;
@@ -287,6 +290,8 @@ Function::Type Function::stringToType(const QString& string)
     else if (string == KVideoString)
         return VideoType;
 #endif
+    else if (string == KBakedShowString)
+        return BakedShowType;
     else
         return Undefined;
 }
@@ -846,6 +851,16 @@ void Function::slotFixtureRemoved(quint32 fid)
     Q_UNUSED(fid);
 }
 
+void Function::slotFixtureChanged(quint32 fid)
+{
+    Q_UNUSED(fid);
+}
+
+void Function::slotFixtureGroupChanged(quint32 id)
+{
+    Q_UNUSED(id);
+}
+
 /*****************************************************************************
  * Load & Save
  *****************************************************************************/
@@ -917,6 +932,8 @@ bool Function::loader(QXmlStreamReader &root, Doc* doc)
     else if (type == Function::VideoType)
         function = new class Video(doc);
 #endif
+    else if (type == Function::BakedShowType)
+        function = new class BakedShow(doc);
     else
         return false;
 
@@ -1007,6 +1024,11 @@ void Function::write(MasterTimer *timer, QList<Universe *> universes)
     Q_UNUSED(universes);
 }
 
+bool Function::canWriteConcurrently() const
+{
+    return false;
+}
+
 void Function::postRun(MasterTimer* timer, QList<Universe *> universes)
 {
     Q_UNUSED(timer);
@@ -119,6 +119,7 @@ public:
 #if QT_VERSION >= 0x050000
         , VideoType    = 1 << 9
 #endif
+        , BakedShowType = 1 << 10
     };
 #if QT_VERSION >= 0x050500
     Q_ENUM(Type)
@@ -571,6 +572,12 @@ public slots:
     /** Slot that captures Doc::fixtureRemoved signals */
     virtual void slotFixtureRemoved(quint32 fxi_id);
 
+    /** Slot that captures Doc::fixtureChanged signals */
+    virtual void slotFixtureChanged(quint32 fxi_id);
+
+    /** Slot that captures Doc::fixtureGroupChanged signals */
+    virtual void slotFixtureGroupChanged(quint32 id);
+
     /*********************************************************************
      * Load & Save
      *********************************************************************/
@@ -678,6 +685,15 @@ public:
      */
     virtual void write(MasterTimer* timer, QList<Universe*> universes);
 
+    /**
+     * Return true if write() can be called on a worker thread, at the same
+     * time as other functions' write(). This is true only for functions
+     * that don't read values back from $universes, don't start/stop other
+     * functions and don't touch MasterTimer's generic fader during write().
+     * The default implementation returns false.
+     */
+    virtual bool canWriteConcurrently() const;
+
     /**
      * Called by MasterTimer when the function is stopped. No more write()
      * calls will arrive to the function after this call. The function may
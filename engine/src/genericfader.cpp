@@ -17,6 +17,7 @@
   limitations under the License.
 */
 
+#include <climits>
 #include <cmath>
 #include <QDebug>
 
@@ -25,8 +26,10 @@
 #include "doc.h"
 
 GenericFader::GenericFader(Doc* doc)
-    : m_intensity(1)
+    : m_indexDirty(false)
+    , m_intensity(1)
     , m_blendMode(Universe::NormalBlend)
+    , m_keepZeroChannels(false)
     , m_doc(doc)
 {
     Q_ASSERT(doc != NULL);
@@ -38,87 +41,209 @@ GenericFader::~GenericFader()
 
 void GenericFader::add(const FadeChannel& ch)
 {
-    QHash<FadeChannel,FadeChannel>::iterator channelIterator = m_channels.find(ch);
-    if (channelIterator != m_channels.end())
+    int index = indexOf(ch);
+    if (index >= 0)
     {
         // perform a HTP check
-        if (channelIterator.value().current() <= ch.current())
-            channelIterator.value() = ch;
+        if (m_currents.at(index) <= ch.current())
+            set(index, ch);
     }
     else
     {
-        m_channels.insert(ch, ch);
+        append(ch);
     }
 }
 
 void GenericFader::forceAdd(const FadeChannel &ch)
 {
-    m_channels.insert(ch, ch);
+    int index = indexOf(ch);
+    if (index >= 0)
+        set(index, ch);
+    else
+        append(ch);
 }
 
 void GenericFader::remove(const FadeChannel& ch)
 {
-    m_channels.remove(ch);
+    int index = indexOf(ch);
+    if (index < 0)
+        return;
+
+    int count = m_targets.count();
+    for (int i = index + 1; i < count; i++)
+        move(i, i - 1);
+    resize(count - 1);
+
+    m_indexDirty = true;
 }
 
 void GenericFader::removeAll()
 {
-    m_channels.clear();
+    resize(0);
+    m_index.clear();
+    m_indexDirty = false;
 }
 
-const QHash <FadeChannel,FadeChannel>& GenericFader::channels() const
+int GenericFader::count() const
 {
-    return m_channels;
+    return m_targets.count();
 }
 
-void GenericFader::write(QList<Universe*> ua, bool paused)
+bool GenericFader::contains(const FadeChannel &fc) const
+{
+    return indexOf(fc) >= 0;
+}
+
+FadeChannel GenericFader::channel(const FadeChannel &fc) const
+{
+    int index = indexOf(fc);
+    if (index < 0)
+        return FadeChannel();
+
+    return channelAt(index);
+}
+
+QList<FadeChannel> GenericFader::channels() const
+{
+    QList<FadeChannel> list;
+    for (int i = 0; i < m_targets.count(); i++)
+        list.append(channelAt(i));
+    return list;
+}
+
+int GenericFader::channelIndex(const FadeChannel &ch)
 {
-    QMutableHashIterator <FadeChannel,FadeChannel> it(m_channels);
-    while (it.hasNext() == true)
+    int index = indexOf(ch);
+    if (index < 0)
     {
-        FadeChannel& fc(it.next().value());
-        QLCChannel::Group grp = fc.group(m_doc);
-        quint32 addr = fc.addressInUniverse();
-        quint32 universe = fc.universe();
-        bool canFade = fc.canFade(m_doc);
-        uchar value;
+        append(ch);
+        return m_targets.count() - 1;
+    }
 
-        // Calculate the next step
-        if (paused)
-            value = fc.current();
-        else
-            value = fc.nextStep(MasterTimer::tick());
+    resolve(index, ch);
+    return index;
+}
 
-        // Apply intensity to HTP channels
-        if (grp == QLCChannel::Intensity && canFade == true)
-            value = fc.current(intensity());
+void GenericFader::setTarget(int index, uchar target, uint fadeTime)
+{
+    if (m_targets.at(index) != target)
+    {
+        m_targets[index] = target;
+        m_starts[index] = m_currents.at(index);
+        m_elapsed[index] = 0;
+    }
 
-        if (universe != Universe::invalid())
-        {
-            //qDebug() << "[GenericFader] >>> uni:" << universe << ", address:" << addr << ", value:" << value;
-            ua[universe]->writeBlended(addr, value, m_blendMode);
-        }
+    m_fadeTimes[index] = fadeTime;
+    m_flags[index] &= ~Ready;
+}
+
+void GenericFader::setKeepZeroChannels(bool keep)
+{
+    m_keepZeroChannels = keep;
+}
 
-        if (grp == QLCChannel::Intensity && m_blendMode == Universe::NormalBlend)
+void GenericFader::setFadeTime(uint ms)
+{
+    for (int i = 0; i < m_fadeTimes.count(); i++)
+        m_fadeTimes[i] = (m_flags.at(i) & CanFade) ? ms : 0;
+}
+
+void GenericFader::setStartValues(const GenericFader *fader, const QList<Universe *> &universes)
+{
+    int universesCount = universes.count();
+
+    for (int i = 0; i < m_identities.count(); i++)
+    {
+        const ChannelIdentity &id = m_identities.at(i);
+        int index = fader != NULL ? fader->indexOf(id.m_fixture, id.m_channel) : -1;
+        uchar value = 0;
+
+        if (index >= 0)
+            value = fader->m_currents.at(index);
+        else if ((m_flags.at(i) & Intensity) == 0 && m_universes.at(i) < quint32(universesCount))
+            value = universes.at(m_universes.at(i))->preGMValue(m_addresses.at(i));
+
+        m_starts[i] = value;
+        m_currents[i] = value;
+        m_elapsed[i] = 0;
+    }
+}
+
+void GenericFader::write(QList<Universe*> ua, bool paused)
+{
+    int count = m_targets.count();
+    if (count == 0)
+        return;
+
+    const quint32 *universes = m_universes.constData();
+    const quint32 *addresses = m_addresses.constData();
+    const uchar *starts = m_starts.constData();
+    const uchar *targets = m_targets.constData();
+    uchar *currents = m_currents.data();
+    uint *elapsed = m_elapsed.data();
+    const uint *fadeTimes = m_fadeTimes.constData();
+    const uchar *flags = m_flags.constData();
+
+    quint32 universesCount = ua.count();
+    uint tick = MasterTimer::tick();
+    int kept = 0;
+
+    for (int i = 0; i < count; i++)
+    {
+        // Calculate the next step
+        if (paused == false)
         {
-            // Remove all HTP channels that reach their target _zero_ value.
-            // They have no effect either way so removing them saves CPU a bit.
-            if (fc.current() == 0 && fc.target() == 0)
+            if (elapsed[i] < UINT_MAX)
+                elapsed[i] += tick;
+
+            if (elapsed[i] >= fadeTimes[i] || (flags[i] & Ready))
             {
-                it.remove();
-                continue;
+                // Use the target value if all time has been consumed
+                // or if the channel has been marked ready.
+                currents[i] = targets[i];
+            }
+            else if (elapsed[i] == 0)
+            {
+                currents[i] = starts[i];
+            }
+            else
+            {
+                int value = int(targets[i]) - int(starts[i]);
+                value = int(value * (qreal(elapsed[i]) / qreal(fadeTimes[i])));
+                currents[i] = uchar(value + starts[i]);
             }
         }
-/*
-        else
+
+        uchar value = currents[i];
+
+        // Apply intensity to HTP channels
+        if ((flags[i] & (Intensity | CanFade)) == (Intensity | CanFade))
+            value = uchar(floor((qreal(value) * m_intensity) + 0.5));
+
+        if (universes[i] < universesCount)
         {
-            // Remove all LTP channels after their time is up
-            if (fc.elapsed() >= fc.fadeTime())
-                it.remove();
+            //qDebug() << "[GenericFader] >>> uni:" << universes[i] << ", address:" << addresses[i] << ", value:" << value;
+            ua[universes[i]]->writeBlended(addresses[i], value, m_blendMode);
         }
-*/
-        if (fc.isFlashing())
-            it.remove();
+
+        // Remove all HTP channels that reach their target _zero_ value.
+        // They have no effect either way so removing them saves CPU a bit.
+        bool zero = (flags[i] & Intensity) && m_blendMode == Universe::NormalBlend &&
+                    currents[i] == 0 && targets[i] == 0 && m_keepZeroChannels == false;
+
+        if (zero || (flags[i] & Flashing))
+            continue;
+
+        // Compact the arrays in place, preserving the channels order
+        if (kept != i)
+            move(i, kept);
+        kept++;
+    }
+
+    if (kept != count)
+    {
+        resize(kept);
+        m_indexDirty = true;
     }
 }
 
@@ -136,3 +261,142 @@ void GenericFader::setBlendMode(Universe::BlendMode mode)
 {
     m_blendMode = mode;
 }
+
+/****************************************************************************
+ * Channel storage
+ ****************************************************************************/
+
+quint64 GenericFader::channelKey(quint32 fixture, quint32 channel)
+{
+    return (quint64(fixture) << 32) | quint64(channel);
+}
+
+int GenericFader::indexOf(const FadeChannel &fc) const
+{
+    return indexOf(fc.fixture(), fc.channel());
+}
+
+int GenericFader::indexOf(quint32 fixture, quint32 channel) const
+{
+    if (m_indexDirty)
+    {
+        m_index.clear();
+        for (int i = 0; i < m_identities.count(); i++)
+        {
+            const ChannelIdentity &id = m_identities.at(i);
+            m_index.insert(channelKey(id.m_fixture, id.m_channel), i);
+        }
+        m_indexDirty = false;
+    }
+
+    return m_index.value(channelKey(fixture, channel), -1);
+}
+
+void GenericFader::append(const FadeChannel &ch)
+{
+    int index = m_targets.count();
+    int count = index + 1;
+
+    m_identities.resize(count);
+    m_universes.resize(count);
+    m_addresses.resize(count);
+    m_starts.resize(count);
+    m_targets.resize(count);
+    m_currents.resize(count);
+    m_elapsed.resize(count);
+    m_fadeTimes.resize(count);
+    m_flags.resize(count);
+
+    set(index, ch);
+
+    if (m_indexDirty == false)
+        m_index.insert(channelKey(ch.fixture(), ch.channel()), index);
+}
+
+void GenericFader::set(int index, const FadeChannel &ch)
+{
+    m_flags[index] = 0;
+    resolve(index, ch);
+
+    m_starts[index] = ch.start();
+    m_targets[index] = ch.target();
+    m_currents[index] = ch.current();
+    m_elapsed[index] = ch.elapsed();
+    m_fadeTimes[index] = ch.fadeTime();
+
+    if (ch.isReady())
+        m_flags[index] |= Ready;
+    if (ch.isFlashing())
+        m_flags[index] |= Flashing;
+}
+
+void GenericFader::resolve(int index, const FadeChannel &ch)
+{
+    // Resolve the channel group and fade capability once,
+    // so that write() doesn't have to look up the Doc
+    ChannelIdentity &id = m_identities[index];
+    id.m_fixture = ch.m_fixture;
+    id.m_channel = ch.m_channel;
+    id.m_fixtureUniverse = ch.m_universe;
+    id.m_fixtureAddress = ch.m_address;
+    id.m_group = ch.group(m_doc);
+
+    // an invalid universe is skipped by write(), being out of range
+    m_universes[index] = ch.universe();
+    m_addresses[index] = ch.addressInUniverse();
+
+    uchar flags = m_flags.at(index) & (Ready | Flashing);
+    if (id.m_group == QLCChannel::Intensity)
+        flags |= Intensity;
+    if (ch.canFade(m_doc))
+        flags |= CanFade;
+    m_flags[index] = flags;
+}
+
+FadeChannel GenericFader::channelAt(int index) const
+{
+    const ChannelIdentity &id = m_identities.at(index);
+
+    FadeChannel fc;
+    fc.m_fixture = id.m_fixture;
+    fc.m_channel = id.m_channel;
+    fc.m_universe = id.m_fixtureUniverse;
+    fc.m_address = id.m_fixtureAddress;
+    fc.m_group = id.m_group;
+
+    fc.setStart(m_starts.at(index));
+    fc.setTarget(m_targets.at(index));
+    fc.setCurrent(m_currents.at(index));
+    fc.setElapsed(m_elapsed.at(index));
+    fc.setFadeTime(m_fadeTimes.at(index));
+    fc.setReady(m_flags.at(index) & Ready);
+    fc.setFlashing(m_flags.at(index) & Flashing);
+
+    return fc;
+}
+
+void GenericFader::move(int from, int to)
+{
+    m_identities[to] = m_identities.at(from);
+    m_universes[to] = m_universes.at(from);
+    m_addresses[to] = m_addresses.at(from);
+    m_starts[to] = m_starts.at(from);
+    m_targets[to] = m_targets.at(from);
+    m_currents[to] = m_currents.at(from);
+    m_elapsed[to] = m_elapsed.at(from);
+    m_fadeTimes[to] = m_fadeTimes.at(from);
+    m_flags[to] = m_flags.at(from);
+}
+
+void GenericFader::resize(int count)
+{
+    m_identities.resize(count);
+    m_universes.resize(count);
+    m_addresses.resize(count);
+    m_starts.resize(count);
+    m_targets.resize(count);
+    m_currents.resize(count);
+    m_elapsed.resize(count);
+    m_fadeTimes.resize(count);
+    m_flags.resize(count);
+}
@@ -20,9 +20,11 @@
 #ifndef GENERICFADER
 #define GENERICFADER
 
+#include <QVector>
 #include <QList>
 #include <QHash>
 
+#include "qlcchannel.h"
 #include "universe.h"
 
 class FadeChannel;
@@ -32,6 +34,16 @@ class Doc;
  * @{
  */
 
+/**
+ * GenericFader fades a set of channels from their start values to their
+ * target values, writing the result to the universes on every tick.
+ *
+ * Channels are stored as a structure of arrays: the values needed on every
+ * tick (universe, address, start, target, current, elapsed, fade time and
+ * flags) are kept in contiguous vectors, while the channel group and the fade
+ * capability are resolved once, when a channel is added. This way write()
+ * is a tight loop that never looks up the Doc.
+ */
 class GenericFader
 {
 public:
@@ -63,8 +75,69 @@ public:
      */
     void removeAll();
 
-    /** Get all channels in a non-modifiable hashmap */
-    const QHash <FadeChannel,FadeChannel>& channels() const;
+    /** Get the number of channels in the fader */
+    int count() const;
+
+    /** Check if the fader contains a channel whose fixture & channel match with $fc's */
+    bool contains(const FadeChannel& fc) const;
+
+    /**
+     * Get a copy of the channel whose fixture & channel match with $fc's.
+     * If the fader doesn't contain such a channel, an empty FadeChannel
+     * is returned.
+     */
+    FadeChannel channel(const FadeChannel& fc) const;
+
+    /** Get a copy of all the channels, in the order they are written */
+    QList<FadeChannel> channels() const;
+
+    /**
+     * Get the index of the channel matching $ch, adding $ch if the fader
+     * doesn't contain it. An existing channel keeps its values, but takes
+     * the universe and address of $ch, as its fixture might have moved.
+     * The index stays valid until a channel is removed, so it can be used
+     * with setTarget() along with setKeepZeroChannels(true).
+     *
+     * @param ch The channel to look up
+     * @return The index of the channel
+     */
+    int channelIndex(const FadeChannel& ch);
+
+    /**
+     * Set the target value of the channel at $index. When the target
+     * changes, the channel fades to it from its current value.
+     *
+     * @param index An index returned by channelIndex()
+     * @param target The new target value
+     * @param fadeTime The fade time in milliseconds
+     */
+    void setTarget(int index, uchar target, uint fadeTime);
+
+    /**
+     * Keep the HTP channels that reach a zero target, instead of removing
+     * them from the fader, so that their indices stay valid.
+     */
+    void setKeepZeroChannels(bool keep);
+
+    /**
+     * Set the fade time of all the channels that can fade.
+     * The others jump to their target value.
+     *
+     * @param ms The fade time in milliseconds
+     */
+    void setFadeTime(uint ms);
+
+    /**
+     * Set the start and current values of all the channels, to fade from
+     * what is being output. A channel contained in $fader starts from its
+     * current value there, otherwise an LTP channel starts from its value
+     * in $universes and an HTP channel from zero.
+     * The caller must lock $fader, if it is shared with another thread.
+     *
+     * @param fader The fader whose channels take precedence, or NULL
+     * @param universes The universe array holding the current values
+     */
+    void setStartValues(const GenericFader *fader, const QList<Universe *> &universes);
 
     /**
      * Run the channels forward by one step and write their current values to
@@ -96,10 +169,73 @@ public:
      */
     void setBlendMode(Universe::BlendMode mode);
 
+    /*********************************************************************
+     * Channel storage
+     *********************************************************************/
 private:
-    QHash <FadeChannel,FadeChannel> m_channels;
+    enum ChannelFlag
+    {
+        Intensity = 1 << 0, //! The channel belongs to the intensity group
+        CanFade   = 1 << 1, //! The channel can be faded
+        Ready     = 1 << 2, //! The channel jumps to its target value
+        Flashing  = 1 << 3  //! The channel is removed once written
+    };
+
+    /** The identity of a channel, needed only to look it up or to copy it out */
+    typedef struct
+    {
+        quint32 m_fixture;          //! The ID of the Fixture owning the channel
+        quint32 m_channel;          //! The channel number within the Fixture
+        quint32 m_fixtureUniverse;  //! The universe of the Fixture
+        quint32 m_fixtureAddress;   //! The absolute address of the Fixture
+        QLCChannel::Group m_group;  //! The channel group resolved on add
+    } ChannelIdentity;
+
+    /** Build the lookup key of a channel from its fixture & channel */
+    static quint64 channelKey(quint32 fixture, quint32 channel);
+
+    /** Get the index of the channel matching $fc, or -1 if not found */
+    int indexOf(const FadeChannel& fc) const;
+
+    /** Get the index of the given fixture channel, or -1 if not found */
+    int indexOf(quint32 fixture, quint32 channel) const;
+
+    /** Append a new channel to the arrays */
+    void append(const FadeChannel& ch);
+
+    /** Overwrite the channel at $index with $ch */
+    void set(int index, const FadeChannel& ch);
+
+    /** Resolve where and how the channel at $index is written, out of $ch */
+    void resolve(int index, const FadeChannel& ch);
+
+    /** Build a FadeChannel out of the channel at $index */
+    FadeChannel channelAt(int index) const;
+
+    /** Move the channel at $from to $to, within the arrays */
+    void move(int from, int to);
+
+    /** Shrink all the arrays to $count elements */
+    void resize(int count);
+
+private:
+    QVector<ChannelIdentity> m_identities;
+    QVector<quint32> m_universes;
+    QVector<quint32> m_addresses;
+    QVector<uchar> m_starts;
+    QVector<uchar> m_targets;
+    QVector<uchar> m_currents;
+    QVector<uint> m_elapsed;
+    QVector<uint> m_fadeTimes;
+    QVector<uchar> m_flags;
+
+    /** Map of channel keys to array indices, rebuilt lazily after removals */
+    mutable QHash<quint64, int> m_index;
+    mutable bool m_indexDirty;
+
     qreal m_intensity;
     Universe::BlendMode m_blendMode;
+    bool m_keepZeroChannels;
     Doc* m_doc;
 };
 
@@ -34,6 +34,7 @@
 #include "qlcinputchannel.h"
 #include "qlcinputsource.h"
 #include "qlcioplugin.h"
+#include "audiocapture.h"
 #include "outputpatch.h"
 #include "inputpatch.h"
 #include "qlcconfig.h"
@@ -48,6 +49,8 @@ InputOutputMap::InputOutputMap(Doc *doc, quint32 universes)
   , m_blackout(false)
   , m_blackoutRequest(BlackoutRequestNone)
   , m_universeChanged(false)
+  , m_beatGeneratorType(Disabled)
+  , m_currentBPM(0)
   , m_beatTime(new QElapsedTimer())
 {
     m_grandMaster = new GrandMaster(this);
@@ -57,10 +60,14 @@ InputOutputMap::InputOutputMap(Doc *doc, quint32 universes)
     connect(doc->ioPluginCache(), SIGNAL(pluginConfigurationChanged(QLCIOPlugin*)),
             this, SLOT(slotPluginConfigurationChanged(QLCIOPlugin*)));
     connect(doc->masterTimer(), SIGNAL(beat()), this, SLOT(slotMasterTimerBeat()));
+    connect(doc, SIGNAL(audioCaptureDestroyed()), this, SLOT(slotAudioCaptureDestroyed()));
 }
 
 InputOutputMap::~InputOutputMap()
 {
+    if (m_beatCapture)
+        m_beatCapture->unregisterBeatTracker();
+
     removeAllUniverses();
     delete m_grandMaster;
     delete m_beatTime;
@@ -95,11 +102,11 @@ bool InputOutputMap::setBlackout(bool blackout)
 
     QMutexLocker locker(&m_universeMutex);
     m_blackout = blackout;
+    m_snapshots.beginFrame(m_universeArray.count());
 
     for (quint32 i = 0; i < universesCount(); i++)
     {
         Universe *universe = m_universeArray.at(i);
-        QByteArray data;
 
         for (int j = 0; j < universe->outputPatchesCount(); j++)
         {
@@ -109,21 +116,19 @@ bool InputOutputMap::setBlackout(bool blackout)
         }
 
         if (blackout == true)
-        {
             universe->dumpBlackout();
-            data = universe->blackoutData();
-        }
-        else
-        {
-            data = universe->postGMValues()->mid(0, universe->usedChannels());
-        }
 
-        // notify the universe listeners that some channels have changed
-        locker.unlock();
-        emit universesWritten(i, data);
-        locker.relock();
+        snapshotUniverse(i, true);
     }
 
+    if (blackout == true)
+        flushOutputs();
+
+    // notify the universe listeners that all the channels have changed
+    m_snapshots.publish();
+    locker.unlock();
+    emit universesSnapshotPublished();
+
     emit blackoutChanged(m_blackout);
 
     return true;
@@ -266,6 +271,34 @@ bool InputOutputMap::getUniverseMonitor(int index)
     return m_universeArray.at(index)->monitor();
 }
 
+void InputOutputMap::setUniverseSendOnChange(int index, bool enable)
+{
+    if (index < 0 || index >= m_universeArray.count())
+        return;
+    m_universeArray.at(index)->setSendOnChange(enable);
+}
+
+bool InputOutputMap::getUniverseSendOnChange(int index)
+{
+    if (index < 0 || index >= m_universeArray.count())
+        return false;
+    return m_universeArray.at(index)->sendOnChange();
+}
+
+void InputOutputMap::setUniverseKeepAliveInterval(int index, uint ms)
+{
+    if (index < 0 || index >= m_universeArray.count())
+        return;
+    m_universeArray.at(index)->setKeepAliveInterval(ms);
+}
+
+uint InputOutputMap::getUniverseKeepAliveInterval(int index)
+{
+    if (index < 0 || index >= m_universeArray.count())
+        return 0;
+    return m_universeArray.at(index)->keepAliveInterval();
+}
+
 bool InputOutputMap::isUniversePatched(int index)
 {
     if (index < 0 || index >= m_universeArray.count())
@@ -307,23 +340,60 @@ void InputOutputMap::dumpUniverses()
     QMutexLocker locker(&m_universeMutex);
     if (m_blackout == false)
     {
+        bool anyChanged = false;
+
+        m_dumpBuffers.resize(m_universeArray.count());
+        m_snapshots.beginFrame(m_universeArray.count());
+
         for (int i = 0; i < m_universeArray.count(); i++)
         {
             Universe *universe = m_universeArray.at(i);
-            const QByteArray postGM = universe->postGMValues()->mid(0, universe->usedChannels());
+            QByteArray &postGM = m_dumpBuffers[i];
+            bool changed = universe->hasChanged();
 
-            // notify the universe listeners that some channels have changed
-            if (universe->hasChanged())
-            {
-                locker.unlock();
-                emit universesWritten(i, postGM);
-                locker.relock();
-            }
+            // reuse the buffer of the previous dump, unless a plugin still holds it
+            postGM.resize(universe->usedChannels());
+            memcpy(postGM.data(), universe->postGMValues()->constData(), postGM.size());
 
             // this is where QLC+ sends data to the output plugins
-            universe->dumpOutput(postGM);
+            universe->dumpOutput(postGM, changed);
+
+            snapshotUniverse(i, changed);
+            if (changed)
+                anyChanged = true;
+        }
+
+        flushOutputs();
+        m_snapshots.publish();
+
+        // notify the universe listeners that some channels have changed
+        if (anyChanged)
+        {
+            locker.unlock();
+            emit universesSnapshotPublished();
+        }
+    }
+}
+
+void InputOutputMap::flushOutputs()
+{
+    m_flushPlugins.resize(0);
+
+    foreach (Universe *universe, m_universeArray)
+    {
+        for (int i = 0; i < universe->outputPatchesCount(); i++)
+        {
+            OutputPatch *op = universe->outputPatch(i);
+            if (op == NULL || op->plugin() == NULL)
+                continue;
+
+            if (m_flushPlugins.contains(op->plugin()) == false)
+                m_flushPlugins.append(op->plugin());
         }
     }
+
+    foreach (QLCIOPlugin *plugin, m_flushPlugins)
+        plugin->flushOutputs();
 }
 
 void InputOutputMap::resetUniverses()
@@ -340,6 +410,22 @@ void InputOutputMap::resetUniverses()
     setGrandMasterChannelMode(GrandMaster::Intensity);
 }
 
+UniverseSnapshot InputOutputMap::snapshot() const
+{
+    return m_snapshots.latest();
+}
+
+void InputOutputMap::snapshotUniverse(int index, bool changed)
+{
+    Universe *universe = m_universeArray.at(index);
+    const QByteArray preGM = universe->preGMValues();
+    const QByteArray *postGM = m_blackout ? &universe->blackoutData() : universe->postGMValues();
+
+    m_snapshots.setUniverse(index, reinterpret_cast<const uchar *>(postGM->constData()),
+                            reinterpret_cast<const uchar *>(preGM.constData()),
+                            universe->usedChannels(), changed);
+}
+
 /*********************************************************************
  * Grand Master
  *********************************************************************/
@@ -951,6 +1037,8 @@ void InputOutputMap::setBeatGeneratorType(InputOutputMap::BeatGeneratorType type
     m_beatGeneratorType = type;
     qDebug() << "[InputOutputMap] setting beat type:" << m_beatGeneratorType;
 
+    releaseBeatCapture();
+
     switch (m_beatGeneratorType)
     {
         case Internal:
@@ -968,6 +1056,8 @@ void InputOutputMap::setBeatGeneratorType(InputOutputMap::BeatGeneratorType type
             // reset the current BPM number and detect it from the audio input
             setBpmNumber(0);
             m_beatTime->restart();
+
+            slotAcquireBeatCapture();
         break;
         case Disabled:
         default:
@@ -1008,7 +1098,8 @@ int InputOutputMap::bpmNumber() const
 
 void InputOutputMap::slotMasterTimerBeat()
 {
-    if (m_beatGeneratorType != Internal)
+    // MasterTimer generates the beats predicted by the audio beat tracker too
+    if (m_beatGeneratorType != Internal && m_beatGeneratorType != Audio)
         return;
 
     emit beat();
@@ -1045,12 +1136,50 @@ void InputOutputMap::slotMIDIBeat(quint32 universe, quint32 channel, uchar value
     }
 }
 
-void InputOutputMap::slotAudioSpectrum(double *spectrumBands, int size, double maxMagnitude, quint32 power)
+void InputOutputMap::slotAudioBeat(int bpm, int nextBeatDelay)
 {
-    Q_UNUSED(spectrumBands)
-    Q_UNUSED(size)
-    Q_UNUSED(maxMagnitude)
-    Q_UNUSED(power)
+    if (m_beatGeneratorType != Audio)
+        return;
+
+    setBpmNumber(bpm);
+
+    // the tracker predicts the beats, so MasterTimer can fire
+    // them on time instead of one analysis frame late
+    MasterTimer *timer = doc()->masterTimer();
+    timer->requestBeatAt(timer->clockTime() + qMax(0, nextBeatDelay));
+}
+
+void InputOutputMap::slotAudioCaptureDestroyed()
+{
+    if (m_beatCapture.isNull() && m_beatGeneratorType != Audio)
+        return;
+
+    releaseBeatCapture();
+
+    // don't create the new capture right away: Doc might be going away
+    QMetaObject::invokeMethod(this, "slotAcquireBeatCapture", Qt::QueuedConnection);
+}
+
+void InputOutputMap::slotAcquireBeatCapture()
+{
+    if (m_beatGeneratorType != Audio || m_beatCapture)
+        return;
+
+    // the beats are scheduled directly from the capture thread
+    m_beatCapture = doc()->audioInputCapture().data();
+    connect(m_beatCapture, SIGNAL(beatTracked(int,int)),
+            this, SLOT(slotAudioBeat(int,int)), Qt::DirectConnection);
+    m_beatCapture->registerBeatTracker();
+}
+
+void InputOutputMap::releaseBeatCapture()
+{
+    if (m_beatCapture.isNull())
+        return;
+
+    disconnect(m_beatCapture, SIGNAL(beatTracked(int,int)), this, SLOT(slotAudioBeat(int,int)));
+    m_beatCapture->unregisterBeatTracker();
+    m_beatCapture = NULL;
 }
 
 /*********************************************************************
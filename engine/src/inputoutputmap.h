@@ -21,10 +21,12 @@
 #define INPUTOUTPUTMAP_H
 
 #include <QSharedPointer>
+#include <QPointer>
 #include <QObject>
 #include <QMutex>
 #include <QDir>
 
+#include "universesnapshot.h"
 #include "qlcinputprofile.h"
 #include "grandmaster.h"
 
@@ -33,6 +35,7 @@ class QXmlStreamWriter;
 class QLCInputSource;
 class QElapsedTimer;
 class QLCIOPlugin;
+class AudioCapture;
 class OutputPatch;
 class InputPatch;
 class Universe;
@@ -222,6 +225,34 @@ public:
      */
     bool getUniverseMonitor(int index);
 
+    /**
+     * Enable/disable the send-on-change mode for the universe with the given index
+     * @param index The universe index
+     * @param enable true = send only changed data, false = send every frame
+     */
+    void setUniverseSendOnChange(int index, bool enable);
+
+    /**
+     * Retrieve the send-on-change mode of the universe at the given index
+     * @param index The universe index
+     * @return true = send only changed data, false = send every frame
+     */
+    bool getUniverseSendOnChange(int index);
+
+    /**
+     * Set the send-on-change keep alive interval of the universe with the given index
+     * @param index The universe index
+     * @param ms The maximum time in milliseconds between two writes
+     */
+    void setUniverseKeepAliveInterval(int index, uint ms);
+
+    /**
+     * Retrieve the send-on-change keep alive interval of the universe at the given index
+     * @param index The universe index
+     * @return The keep alive interval in milliseconds
+     */
+    uint getUniverseKeepAliveInterval(int index);
+
     /**
      * Return if a universe is patched with any input, output or
      * feedback line
@@ -265,15 +296,52 @@ public:
      */
     void resetUniverses();
 
+    /**
+     * Get the values of all universes as they were at the end of the
+     * last dump, without locking. The returned snapshot is immutable.
+     */
+    UniverseSnapshot snapshot() const;
+
+private:
+    /**
+     * Copy the universe at $index into the snapshot being filled.
+     * m_universeMutex must be held.
+     *
+     * @param index The universe index
+     * @param changed true if the universe values changed since the last snapshot
+     */
+    void snapshotUniverse(int index, bool changed);
+
+    /**
+     * Tell the output plugins of all universes that the frame has been
+     * written, so they can transmit what they queued in writeUniverse.
+     * m_universeMutex must be held.
+     */
+    void flushOutputs();
+
 signals:
     void universeAdded(quint32 id);
     void universeRemoved(quint32 id);
-    void universesWritten(int index, const QByteArray& universesCount);
+
+    /**
+     * Emitted when a snapshot with changed universes has been published.
+     * Use snapshot() and UniverseSnapshot::changeSerial() to know which.
+     */
+    void universesSnapshotPublished();
 
 private:
     /** The values of all universes */
     QList<Universe *> m_universeArray;
 
+    /** The published universe snapshots */
+    UniverseSnapshotBuffer m_snapshots;
+
+    /** Buffers holding the values sent to the output plugins, reused on each dump */
+    QVector<QByteArray> m_dumpBuffers;
+
+    /** The plugins notified by flushOutputs, reused on each dump */
+    QVector<QLCIOPlugin *> m_flushPlugins;
+
     /** When true, universes are dumped. Otherwise not. */
     bool m_universeChanged;
 
@@ -591,7 +659,15 @@ public:
 protected slots:
     void slotMasterTimerBeat();
     void slotMIDIBeat(quint32 universe, quint32 channel, uchar value);
-    void slotAudioSpectrum(double *spectrumBands, int size, double maxMagnitude, quint32 power);
+    void slotAudioBeat(int bpm, int nextBeatDelay);
+
+    /** Release the beat capture destroyed by Doc and track the beats
+     *  of the new one, created when the event loop runs again */
+    void slotAudioCaptureDestroyed();
+    void slotAcquireBeatCapture();
+
+private:
+    void releaseBeatCapture();
 
 signals:
     void beatGeneratorTypeChanged();
@@ -602,6 +678,8 @@ private:
     BeatGeneratorType m_beatGeneratorType;
     int m_currentBPM;
     QElapsedTimer *m_beatTime;
+    /** The audio capture tracking the beats when the generator is Audio */
+    QPointer<AudioCapture> m_beatCapture;
 
     /*********************************************************************
      * Defaults
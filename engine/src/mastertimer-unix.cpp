@@ -80,6 +80,16 @@ int MasterTimerPrivate::compareTime(struct timespec *time1, struct timespec *tim
         return 0;
 }
 
+#if defined(Q_OS_OSX) || defined(Q_OS_IOS)
+qint64 MasterTimerPrivate::timeDifference(mach_timespec_t *from, mach_timespec_t *to)
+#else
+qint64 MasterTimerPrivate::timeDifference(struct timespec *from, struct timespec *to)
+#endif
+{
+    return (qint64(to->tv_sec) - qint64(from->tv_sec)) * 1000000000LL
+           + (qint64(to->tv_nsec) - qint64(from->tv_nsec));
+}
+
 void MasterTimerPrivate::run()
 {
     /* Don't start another thread */
@@ -151,7 +161,7 @@ void MasterTimerPrivate::run()
         {
             qDebug() << Q_FUNC_INFO << "MasterTimer is running late!";
             /* No need to sleep. Immediately process the next tick */
-            mt->timerTick();
+            mt->timerTick(timeDifference(finish, current));
             /* Now the finish time needs to be recalibrated */
 #if defined(Q_OS_OSX) || defined(Q_OS_IOS)
             clock_get_time(cclock, finish);
@@ -203,8 +213,21 @@ void MasterTimerPrivate::run()
             qDebug() << "Full CPU wait:" << sleepTime->tv_nsec;
         }
 #endif
+        /* Tell the profiler how late the tick is, compared to its schedule */
+        qint64 delay = 0;
+        if (mt->profilingEnabled())
+        {
+#if defined(Q_OS_OSX) || defined(Q_OS_IOS)
+            ret = clock_get_time(cclock, current);
+#else
+            ret = clock_gettime(CLOCK_MONOTONIC, current);
+#endif
+            if (ret != -1)
+                delay = timeDifference(finish, current);
+        }
+
         /* Execute the next timer event */
-        mt->timerTick();
+        mt->timerTick(delay);
     }
 
     free(finish);
@@ -46,8 +46,10 @@ private:
     void run();
 #if defined(Q_OS_OSX) || defined(Q_OS_IOS)
     int compareTime(mach_timespec_t *time1, mach_timespec_t *time2);
+    qint64 timeDifference(mach_timespec_t *from, mach_timespec_t *to);
 #else
     int compareTime(struct timespec *time1, struct timespec *time2);
+    qint64 timeDifference(struct timespec *from, struct timespec *to);
 #endif
 
 private:
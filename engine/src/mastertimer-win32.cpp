@@ -53,6 +53,7 @@ MasterTimerPrivate::MasterTimerPrivate(MasterTimer* masterTimer)
     , m_systemTimerResolution(0)
     , m_phTimer(NULL)
     , m_run(false)
+    , m_nextTick(0)
 {
     Q_ASSERT(masterTimer != NULL);
 }
@@ -100,6 +101,8 @@ void MasterTimerPrivate::start()
         return;
     }
 
+    m_clock.start();
+    m_nextTick = 0;
     m_run = true;
 }
 
@@ -124,5 +127,14 @@ bool MasterTimerPrivate::isRunning() const
 
 void MasterTimerPrivate::timerTick()
 {
-    m_masterTimer->timerTick();
+    qint64 tickTime = qint64(m_masterTimer->tick()) * 1000000;
+    qint64 now = m_clock.nsecsElapsed();
+    qint64 delay = now - m_nextTick;
+
+    /* Resynchronize the schedule when a whole tick has been missed */
+    if (delay > tickTime)
+        m_nextTick = now;
+    m_nextTick += tickTime;
+
+    m_masterTimer->timerTick(delay);
 }
@@ -21,6 +21,7 @@
 #ifndef MASTERTIMER_PRIVATE_H
 #define MASTERTIMER_PRIVATE_H
 
+#include <QElapsedTimer>
 #include <Windows.h>
 
 class MasterTimer;
@@ -46,6 +47,11 @@ private:
     UINT m_systemTimerResolution;
     HANDLE m_phTimer;
     bool m_run;
+
+    /** Clock and time (in ns) of the next expected callback, used to
+     *  tell MasterTimer how late each tick fires */
+    QElapsedTimer m_clock;
+    qint64 m_nextTick;
 };
 
 /** @} */
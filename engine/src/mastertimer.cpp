@@ -30,8 +30,10 @@
 #   include "mastertimer-unix.h"
 #endif
 
+#include "parallelfunctionwriter.h"
 #include "inputoutputmap.h"
 #include "genericfader.h"
+#include "tickprofiler.h"
 #include "fadechannel.h"
 #include "mastertimer.h"
 #include "dmxsource.h"
@@ -41,6 +43,7 @@
 #include "doc.h"
 
 #define MASTERTIMER_FREQUENCY "mastertimer/frequency"
+#define MASTERTIMER_PARALLEL "mastertimer/parallel"
 #define LATE_TO_BEAT_THRESHOLD 25
 
 /** The timer tick frequency in Hertz */
@@ -60,15 +63,25 @@ quint64 ticksCount = 0;
 MasterTimer::MasterTimer(Doc* doc)
     : QObject(doc)
     , d_ptr(new MasterTimerPrivate(this))
+    , m_profilingEnabled(false)
+    , m_profiler(new TickProfiler())
+    , m_clock(new QElapsedTimer())
+    , m_virtualClock(false)
+    , m_virtualClockTime(0)
     , m_stopAllFunctions(false)
+    , m_parallelWrite(false)
+    , m_parallelWriter(NULL)
     , m_dmxSourceListMutex(QMutex::Recursive)
     , m_fader(new GenericFader(doc))
     , m_beatSourceType(None)
     , m_currentBPM(120)
+    , m_requestedBPM(0)
     , m_beatTimeDuration(500)
     , m_beatRequested(false)
     , m_beatTimer(new QElapsedTimer())
     , m_lastBeatOffset(0)
+    , m_scheduledBeatTime(-1)
+    , m_firedBeatTime(-1)
 {
     Q_ASSERT(doc != NULL);
     Q_ASSERT(d_ptr != NULL);
@@ -79,6 +92,12 @@ MasterTimer::MasterTimer(Doc* doc)
         s_frequency = var.toUInt();
 
     s_tick = uint(double(1000) / double(s_frequency));
+
+    var = settings.value(MASTERTIMER_PARALLEL);
+    if (var.isValid() == true)
+        m_parallelWrite = var.toBool();
+
+    m_clock->start();
 }
 
 MasterTimer::~MasterTimer()
@@ -90,6 +109,9 @@ MasterTimer::~MasterTimer()
     d_ptr = NULL;
 
     delete m_beatTimer;
+    delete m_clock;
+    delete m_parallelWriter;
+    delete m_profiler;
 }
 
 void MasterTimer::start()
@@ -105,7 +127,7 @@ void MasterTimer::stop()
     d_ptr->stop();
 }
 
-void MasterTimer::timerTick()
+void MasterTimer::timerTick(qint64 delay)
 {
     Doc* doc = qobject_cast<Doc*> (parent());
     Q_ASSERT(doc != NULL);
@@ -114,6 +136,12 @@ void MasterTimer::timerTick()
     qDebug() << "[MasterTimer] *********** tick:" << ticksCount++ << "**********";
 #endif
 
+    TickProfiler *profiler = m_profilingEnabled ? m_profiler : NULL;
+    if (profiler != NULL)
+        profiler->beginTick(qint64(s_tick) * 1000000, profiler->timestamp() - delay);
+
+    timerTickBpmNumber();
+
     switch (m_beatSourceType)
     {
         case Internal:
@@ -137,6 +165,21 @@ void MasterTimer::timerTick()
         }
         break;
         case External:
+        {
+            QMutexLocker locker(&m_scheduledBeatMutex);
+            // fire the scheduled beat on the tick closest to it,
+            // so that it is never more than half a tick late or early
+            if (m_scheduledBeatTime >= 0 && clockTime() + s_tick / 2 >= quint64(m_scheduledBeatTime))
+            {
+                m_firedBeatTime = m_scheduledBeatTime;
+                m_scheduledBeatTime = -1;
+                locker.unlock();
+
+                m_beatRequested = true;
+                m_beatTimer->restart();
+                emit beat();
+            }
+        }
         break;
 
         case None:
@@ -145,6 +188,9 @@ void MasterTimer::timerTick()
         break;
     }
 
+    if (profiler != NULL)
+        profiler->endPhase(TickProfiler::BeatPhase);
+
     QList<Universe *> universes = doc->inputOutputMap()->claimUniverses();
     for (int i = 0 ; i < universes.count(); i++)
     {
@@ -153,14 +199,77 @@ void MasterTimer::timerTick()
         universes[i]->zeroRelativeValues();
     }
 
+    if (profiler != NULL)
+        profiler->endPhase(TickProfiler::InputPhase);
+
     timerTickFunctions(universes);
+
+    if (profiler != NULL)
+        profiler->endPhase(TickProfiler::FunctionsPhase);
+
     timerTickDMXSources(universes);
+
+    if (profiler != NULL)
+        profiler->endPhase(TickProfiler::DMXSourcesPhase);
+
     timerTickFader(universes);
 
+    if (profiler != NULL)
+        profiler->endPhase(TickProfiler::FaderPhase);
+
     doc->inputOutputMap()->releaseUniverses();
     doc->inputOutputMap()->dumpUniverses();
 
     m_beatRequested = false;
+
+    if (profiler != NULL)
+    {
+        profiler->endPhase(TickProfiler::DumpPhase);
+        profiler->endTick();
+    }
+}
+
+/*****************************************************************************
+ * Profiling
+ *****************************************************************************/
+
+void MasterTimer::setProfilingEnabled(bool enable)
+{
+    if (enable == m_profilingEnabled)
+        return;
+
+    if (enable)
+        m_profiler->reset();
+
+    m_profilingEnabled = enable;
+}
+
+bool MasterTimer::profilingEnabled() const
+{
+    return m_profilingEnabled;
+}
+
+TickProfiler *MasterTimer::profiler() const
+{
+    return m_profiler;
+}
+
+/*****************************************************************************
+ * Clock
+ *****************************************************************************/
+
+quint64 MasterTimer::clockTime() const
+{
+    if (m_virtualClock)
+        return m_virtualClockTime;
+
+    return quint64(m_clock->elapsed());
+}
+
+void MasterTimer::setVirtualClockTime(quint64 time)
+{
+    m_virtualClockTime = time;
+    m_virtualClock = true;
 }
 
 uint MasterTimer::frequency()
@@ -194,6 +303,13 @@ void MasterTimer::stopAllFunctions()
     /* Wait until all functions have been stopped */
     while (runningFunctions() > 0)
     {
+        // without the timer thread, nobody else would stop them
+        if (d_ptr->isRunning() == false)
+        {
+            timerTick();
+            continue;
+        }
+
 #if defined(WIN32) || defined(Q_OS_WIN)
         Sleep(10);
 #else
@@ -262,6 +378,67 @@ int MasterTimer::runningFunctions() const
     return m_functionList.size();
 }
 
+void MasterTimer::setParallelWrite(bool enable)
+{
+    m_parallelWrite = enable;
+}
+
+bool MasterTimer::parallelWrite() const
+{
+    return m_parallelWrite;
+}
+
+QList<Function *> MasterTimer::writeFunctionsConcurrently(QList<Universe *> universes)
+{
+    QList<Function *> concurrentList;
+
+    if (m_parallelWrite == false || m_stopAllFunctions == true)
+        return concurrentList;
+
+    // Functions started by another function are excluded, since their
+    // parent might stop them before their turn in the serial path
+    foreach (Function *function, m_functionList)
+    {
+        if (function != NULL && function->stopped() == false &&
+            function->canWriteConcurrently() == true &&
+            function->startedAsChild() == false)
+                concurrentList.append(function);
+    }
+
+    // Not worth the threads synchronization for a single function
+    if (concurrentList.count() < 2)
+    {
+        concurrentList.clear();
+        return concurrentList;
+    }
+
+    if (m_parallelWriter == NULL)
+        m_parallelWriter = new ParallelFunctionWriter();
+
+    m_parallelWriter->write(this, concurrentList, universes.count());
+
+    if (m_profilingEnabled)
+    {
+        for (int i = 0; i < concurrentList.count(); i++)
+            m_profiler->addFunctionDuration(concurrentList.at(i)->id(), m_parallelWriter->duration(i));
+    }
+
+    return concurrentList;
+}
+
+void MasterTimer::writeFunction(Function *function, QList<Universe *> universes)
+{
+    if (m_profilingEnabled == false)
+    {
+        function->write(this, universes);
+        return;
+    }
+
+    qint64 start = m_profiler->timestamp();
+    function->write(this, universes);
+    m_profiler->addFunctionCost(function->id(), start);
+}
+
 void MasterTimer::timerTickFunctions(QList<Universe *> universes)
 {
     // List of m_functionList indices that should be removed at the end of this
@@ -272,6 +449,10 @@ void MasterTimer::timerTickFunctions(QList<Universe *> universes)
     bool stoppedAFunction = true;
     bool firstIteration = true;
 
+    // Functions already written by worker threads, in m_functionList order
+    QList<Function *> concurrentList = writeFunctionsConcurrently(universes);
+    int concurrentIndex = 0;
+
     while (stoppedAFunction)
     {
         stoppedAFunction = false;
@@ -281,13 +462,24 @@ void MasterTimer::timerTickFunctions(QList<Universe *> universes)
         {
             Function* function = m_functionList.at(i);
 
+            if (firstIteration && concurrentIndex < concurrentList.count() &&
+                concurrentList.at(concurrentIndex) == function)
+            {
+                // Apply the values written in advance, in running order.
+                // If the function has been stopped meanwhile, this is handled
+                // at the next round, as if the stop arrived right after write()
+                Universe::applyDeferredWrites(universes, m_parallelWriter->writes(concurrentIndex));
+                concurrentIndex++;
+                continue;
+            }
+
             if (function != NULL)
             {
                 /* Run the function unless it's supposed to be stopped */
                 if (function->stopped() == false && m_stopAllFunctions == false)
                 {
                     if (firstIteration)
-                        function->write(this, universes);
+                        writeFunction(function, universes);
                 }
                 else
                 {
@@ -339,7 +531,7 @@ void MasterTimer::timerTickFunctions(QList<Universe *> universes)
                     functionListHasChanged = true;
                 }
                 f->preRun(this);
-                f->write(this, universes);
+                writeFunction(f, universes);
                 emit functionStarted(f->id());
             }
 
@@ -385,6 +577,7 @@ void MasterTimer::unregisterDMXSource(DMXSource* source)
 
     QMutexLocker lock(&m_dmxSourceListMutex);
     m_dmxSourceList.removeAll(source);
+    m_profiler->removeDMXSource(source);
 }
 
 void MasterTimer::requestNewPriority(DMXSource *source)
@@ -412,6 +605,12 @@ void MasterTimer::requestNewPriority(DMXSource *source)
 
 }
 
+QList<DMXSource *> MasterTimer::registeredDMXSources() const
+{
+    QMutexLocker lock(const_cast<QMutex*>(&m_dmxSourceListMutex));
+    return m_dmxSourceList;
+}
+
 void MasterTimer::timerTickDMXSources(QList<Universe *> universes)
 {
     /* Lock before accessing the DMX sources list. */
@@ -426,7 +625,16 @@ void MasterTimer::timerTickDMXSources(QList<Universe *> universes)
 #endif
 
         /* Get DMX data from the source */
-        source->writeDMX(this, universes);
+        if (m_profilingEnabled)
+        {
+            qint64 start = m_profiler->timestamp();
+            source->writeDMX(this, universes);
+            m_profiler->addDMXSourceCost(source, start);
+        }
+        else
+        {
+            source->writeDMX(this, universes);
+        }
     }
 }
 
@@ -453,16 +661,21 @@ void MasterTimer::faderForceAdd(const FadeChannel& ch)
     fader()->forceAdd(ch);
 }
 
-QHash<FadeChannel,FadeChannel> MasterTimer::faderChannels() const
+QList<FadeChannel> MasterTimer::faderChannels() const
 {
     QMutexLocker faderLocker(const_cast<QMutex*>(&m_faderMutex));
 
     return fader()->channels();
 }
 
-QHash<FadeChannel,FadeChannel> const& MasterTimer::faderChannelsRef() const
+bool MasterTimer::faderContains(const FadeChannel& ch) const
 {
-    return fader()->channels();
+    return fader()->contains(ch);
+}
+
+FadeChannel MasterTimer::faderChannel(const FadeChannel& ch) const
+{
+    return fader()->channel(ch);
 }
 
 QMutex* MasterTimer::faderMutex() const
@@ -475,7 +688,7 @@ void MasterTimer::timerTickFader(QList<Universe *> universes)
     QMutexLocker faderLocker(&m_faderMutex);
 
 #ifdef DEBUG_MASTERTIMER
-        qDebug() << "[MasterTimer] ticking fader (channels:" << fader()->channels().count() << ")";
+        qDebug() << "[MasterTimer] ticking fader (channels:" << fader()->count() << ")";
 #endif
 
         fader()->write(universes);
@@ -495,6 +708,12 @@ void MasterTimer::setBeatSourceType(MasterTimer::BeatsSourceType type)
     m_beatTimeDuration = 60000 / m_currentBPM;
     m_beatTimer->restart();
 
+    {
+        QMutexLocker locker(&m_scheduledBeatMutex);
+        m_scheduledBeatTime = -1;
+        m_firedBeatTime = -1;
+    }
+
     m_beatSourceType = type;
 }
 
@@ -505,11 +724,25 @@ MasterTimer::BeatsSourceType MasterTimer::beatSourceType() const
 
 void MasterTimer::requestBpmNumber(int bpm)
 {
-    if (bpm == m_currentBPM)
+    if (bpm <= 0)
+        return;
+
+    // the beat timer is owned by the timer thread, which
+    // applies the new BPM number at its next tick
+    m_requestedBPM.fetchAndStoreOrdered(bpm);
+}
+
+void MasterTimer::timerTickBpmNumber()
+{
+    int bpm = m_requestedBPM.fetchAndStoreOrdered(0);
+    if (bpm == 0 || bpm == m_currentBPM)
         return;
 
     m_currentBPM = bpm;
-    m_beatTimeDuration = 60000 / m_currentBPM;
+    {
+        QMutexLocker locker(&m_scheduledBeatMutex);
+        m_beatTimeDuration = 60000 / m_currentBPM;
+    }
     m_beatTimer->restart();
 
     emit bpmNumberChanged(bpm);
@@ -517,12 +750,14 @@ void MasterTimer::requestBpmNumber(int bpm)
 
 int MasterTimer::bpmNumber() const
 {
-    return m_currentBPM;
+    int bpm = m_requestedBPM.loadAcquire();
+    return bpm != 0 ? bpm : m_currentBPM;
 }
 
 int MasterTimer::beatTimeDuration() const
 {
-    return m_beatTimeDuration;
+    int bpm = m_requestedBPM.loadAcquire();
+    return bpm != 0 ? 60000 / bpm : m_beatTimeDuration;
 }
 
 int MasterTimer::timeToNextBeat() const
@@ -559,3 +794,14 @@ void MasterTimer::requestBeat()
     // the next timerTick call
     m_beatRequested = true;
 }
+
+void MasterTimer::requestBeatAt(quint64 time)
+{
+    QMutexLocker locker(&m_scheduledBeatMutex);
+
+    // the beat may have fired before its time: don't fire it twice
+    if (m_firedBeatTime >= 0 && qAbs(qint64(time) - m_firedBeatTime) < m_beatTimeDuration / 2)
+        return;
+
+    m_scheduledBeatTime = qint64(time);
+}
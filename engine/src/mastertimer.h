@@ -21,11 +21,14 @@
 #ifndef MASTERTIMER_H
 #define MASTERTIMER_H
 
+#include <QAtomicInt>
 #include <QHash>
 #include <QObject>
 #include <QMutex>
 #include <QList>
 
+class ParallelFunctionWriter;
+class TickProfiler;
 class MasterTimerPrivate;
 class QElapsedTimer;
 class GenericFader;
@@ -45,6 +48,7 @@ class MasterTimer : public QObject
     Q_DISABLE_COPY(MasterTimer)
 
     friend class MasterTimerPrivate;
+    friend class EngineBench;
 
     /*************************************************************************
      * Initialization
@@ -74,8 +78,10 @@ public:
     static uint tick();
 
 private:
-    /** Execute one timer tick (called by MasterTimerPrivate) */
-    void timerTick();
+    /** Execute one timer tick (called by MasterTimerPrivate), $delay
+     *  nanoseconds after it was scheduled. The delay is used by the
+     *  tick profiler only */
+    void timerTick(qint64 delay = 0);
 
 private:
     /** The timer tick frequency in Hertz */
@@ -87,6 +93,58 @@ private:
     /** The private reference to a MasterTimer platform dependent implementation */
     MasterTimerPrivate* d_ptr;
 
+    /*************************************************************************
+     * Profiling
+     *************************************************************************/
+public:
+    /**
+     * Enable or disable the measurement of each tick phase and of each
+     * Function and DMXSource write cost. Enabling profiling resets
+     * the statistics collected so far.
+     */
+    void setProfilingEnabled(bool enable);
+
+    /** Return true if tick profiling is enabled */
+    bool profilingEnabled() const;
+
+    /** Get the profiler holding the collected tick statistics */
+    TickProfiler *profiler() const;
+
+private:
+    /** Flag to enable tick profiling */
+    bool m_profilingEnabled;
+
+    /** The tick profiler. Never NULL */
+    TickProfiler *m_profiler;
+
+    /*************************************************************************
+     * Clock
+     *************************************************************************/
+public:
+    /**
+     * Get the current time of the engine clock, in milliseconds. The clock
+     * is monotonic and starts when the MasterTimer is created. Functions
+     * that need an absolute position in time (like Shows) should derive
+     * it from this clock instead of accumulating ticks, so that they don't
+     * drift when ticks are late.
+     */
+    quint64 clockTime() const;
+
+private:
+    /**
+     * Make clockTime() return $time instead of the real time.
+     * Used by EngineBench to run the engine on a virtual clock.
+     */
+    void setVirtualClockTime(quint64 time);
+
+private:
+    /** The monotonic timer behind clockTime() */
+    QElapsedTimer *m_clock;
+    /** Flag set when the clock is driven by setVirtualClockTime() */
+    bool m_virtualClock;
+    /** The current virtual clock time in milliseconds */
+    quint64 m_virtualClockTime;
+
     /*********************************************************************
      * Functions
      *********************************************************************/
@@ -95,7 +153,9 @@ public:
     /** This should be called by the function itself */
     virtual void startFunction(Function* function);
 
-    /** Stop all functions. Doesn't affect registered DMX sources. */
+    /** Stop all functions. Doesn't affect registered DMX sources.
+     *  If the timer thread is not running (e.g. a timer driven by
+     *  timerTick() calls), the functions are stopped on the calling thread */
     void stopAllFunctions();
 
     /** Fade all functions for a given time and then stop them all */
@@ -104,6 +164,17 @@ public:
     /** Get the number of currently running functions */
     int runningFunctions() const;
 
+    /**
+     * Enable or disable the parallel write mode. When enabled, the running
+     * functions that support it (see Function::canWriteConcurrently) are
+     * written on a pool of worker threads, and their values are applied
+     * to the universes in the same order as the serial path.
+     */
+    void setParallelWrite(bool enable);
+
+    /** Return true if the parallel write mode is enabled */
+    bool parallelWrite() const;
+
 signals:
     /** Tells that the list of running functions has changed */
     void functionListChanged();
@@ -115,6 +186,15 @@ private:
     /** Execute one timer tick for each registered Function */
     void timerTickFunctions(QList<Universe *> universes);
 
+    /** Call $function's write(), measuring its cost if profiling is enabled */
+    void writeFunction(Function *function, QList<Universe *> universes);
+
+    /**
+     * Write in advance the running functions that can be written
+     * concurrently, and return them in running order
+     */
+    QList<Function *> writeFunctionsConcurrently(QList<Universe *> universes);
+
 private:
     /** List of currently running functions */
     QList <Function*> m_functionList;
@@ -126,6 +206,12 @@ private:
     /** Flag for stopping all functions */
     bool m_stopAllFunctions;
 
+    /** Flag to write functions on a pool of worker threads */
+    bool m_parallelWrite;
+
+    /** The worker pool used when m_parallelWrite is enabled */
+    ParallelFunctionWriter *m_parallelWriter;
+
     /*************************************************************************
      * DMX Sources
      *************************************************************************/
@@ -154,6 +240,9 @@ public:
      */
     virtual void requestNewPriority(DMXSource* source);
 
+    /** Get a copy of the list of currently registered DMX sources */
+    QList<DMXSource*> registeredDMXSources() const;
+
 private:
     /** Execute one timer tick for each registered DMXSource */
     void timerTickDMXSources(QList<Universe *> universes);
@@ -182,8 +271,14 @@ private:
 public:
     void faderAdd(const FadeChannel& ch);
     void faderForceAdd(const FadeChannel& ch);
-    QHash<FadeChannel,FadeChannel> faderChannels() const;
-    QHash<FadeChannel,FadeChannel> const& faderChannelsRef() const;
+    QList<FadeChannel> faderChannels() const;
+
+    /** Check if the fader contains $ch. The caller must lock faderMutex() */
+    bool faderContains(const FadeChannel& ch) const;
+
+    /** Get a copy of the fader channel matching $ch. The caller must lock faderMutex() */
+    FadeChannel faderChannel(const FadeChannel& ch) const;
+
     QMutex* faderMutex() const;
 
 private:
@@ -213,13 +308,15 @@ public:
     BeatsSourceType beatSourceType() const;
 
     /** Requests a $bpm number to be generated by MasterTimer if m_beatSourceType is "Internal",
-     *  otherwise informs MasterTimer about how many $bpm have been detected by an external generator */
+     *  otherwise informs MasterTimer about how many $bpm have been detected by an external generator.
+     *  This can be called from any thread: the new BPM number is applied at the next tick */
     void requestBpmNumber(int bpm);
 
-    /** Get the current number of BPM under MasterTimer control */
+    /** Get the current number of BPM under MasterTimer control, or the requested one
+     *  if not applied yet */
     int bpmNumber() const;
 
-    /** Get the duration of a beat in milliseconds */
+    /** Get the duration of a beat in milliseconds, according to bpmNumber() */
     int beatTimeDuration() const;
 
     /** Get the time in milliseconds to the next beat */
@@ -247,15 +344,29 @@ public:
      *  This is quite safe cause even 300bpm should happen every 200ms. */
     void requestBeat();
 
+    /** Request MasterTimer to generate a beat at clockTime() $time. This is used
+     *  by beat trackers that predict the beats, so that they can compensate their
+     *  own latency. The beat is generated by the tick closest to $time, and
+     *  replaces any beat previously scheduled. Since a beat can fire up to half
+     *  a tick early, requests within half a beat of the last scheduled beat fired
+     *  are the same beat predicted again, and are ignored. */
+    void requestBeatAt(quint64 time);
+
 signals:
     void bpmNumberChanged(int bpm);
     void beat();
 
+private:
+    /** Apply the BPM number requested with requestBpmNumber(), if any */
+    void timerTickBpmNumber();
+
 private:
     /** The current type of beat source */
     BeatsSourceType m_beatSourceType;
     /** The current number of beats per minute emitted by a generator */
     int m_currentBPM;
+    /** The BPM number requested with requestBpmNumber() for the next tick, or 0 if none */
+    QAtomicInt m_requestedBPM;
     /** The duration of a beat in milliseconds according to m_currentBPM */
     int m_beatTimeDuration;
     /** Flag to request a beat generation at the next MasterTimer tick */
@@ -264,6 +375,13 @@ private:
     QElapsedTimer *m_beatTimer;
     /** Time offset in milliseconds when the last beat occured */
     int m_lastBeatOffset;
+    /** Mutex guarding the scheduled beat times, set by external beat trackers,
+     *  and the beat duration they are compared with */
+    QMutex m_scheduledBeatMutex;
+    /** The clockTime() of the beat requested with requestBeatAt(), or -1 if none */
+    qint64 m_scheduledBeatTime;
+    /** The requested clockTime() of the last scheduled beat fired, or -1 if none */
+    qint64 m_firedBeatTime;
 };
 
 /** @} */
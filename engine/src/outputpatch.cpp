@@ -40,6 +40,7 @@ OutputPatch::OutputPatch(QObject* parent)
     , m_universe(UINT_MAX)
     , m_paused(false)
     , m_blackout(false)
+    , m_forceWrite(true)
 {
 }
 
@@ -50,6 +51,7 @@ OutputPatch::OutputPatch(quint32 universe, QObject* parent)
     , m_universe(universe)
     , m_paused(false)
     , m_blackout(false)
+    , m_forceWrite(true)
 {
 }
 
@@ -70,6 +72,7 @@ bool OutputPatch::set(QLCIOPlugin* plugin, quint32 output)
 
     m_plugin = plugin;
     m_pluginLine = output;
+    m_forceWrite = true;
 
     if (m_plugin != NULL)
     {
@@ -97,6 +100,7 @@ bool OutputPatch::reconnect()
         bool ret = m_plugin->openOutput(m_pluginLine, m_universe);
         if (ret == true)
         {
+            m_forceWrite = true;
             foreach(QString par, m_parametersCache.keys())
                 m_plugin->setParameter(m_universe, m_pluginLine, QLCIOPlugin::Output, par, m_parametersCache[par]);
         }
@@ -170,6 +174,7 @@ void OutputPatch::setPaused(bool paused)
         return;
 
     m_paused = paused;
+    m_forceWrite = true;
 
     if (m_pauseBuffer.length())
         m_pauseBuffer.clear();
@@ -188,24 +193,31 @@ void OutputPatch::setBlackout(bool blackout)
         return;
 
     m_blackout = blackout;
+    m_forceWrite = true;
     emit blackoutChanged(m_blackout);
 }
 
-void OutputPatch::dump(quint32 universe, const QByteArray& data)
+void OutputPatch::dump(quint32 universe, const QByteArray& data, bool dataChanged)
 {
     /* Don't do anything if there is no plugin and/or output line. */
     if (m_plugin != NULL && m_pluginLine != QLCIOPlugin::invalidLine())
     {
+        if (m_forceWrite)
+        {
+            dataChanged = true;
+            m_forceWrite = false;
+        }
+
         if (m_paused)
         {
             if (m_pauseBuffer.isNull())
                 m_pauseBuffer.append(data);
 
-            m_plugin->writeUniverse(universe, m_pluginLine, m_pauseBuffer);
+            m_plugin->writeUniverse(universe, m_pluginLine, m_pauseBuffer, dataChanged);
         }
         else
         {
-            m_plugin->writeUniverse(universe, m_pluginLine, data);
+            m_plugin->writeUniverse(universe, m_pluginLine, data, dataChanged);
         }
     }
 }
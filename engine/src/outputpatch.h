@@ -117,8 +117,9 @@ public:
     void setBlackout(bool blackout);
 
     /** Write the contents of a 512 channel value buffer to the plugin.
-      * Called periodically by OutputMap. No need to call manually. */
-    void dump(quint32 universe, const QByteArray &data);
+      * Called periodically by OutputMap. No need to call manually.
+      * $dataChanged tells the plugin if $data differs from the last dump */
+    void dump(quint32 universe, const QByteArray &data, bool dataChanged);
 
 signals:
     void pausedChanged(bool paused);
@@ -129,6 +130,8 @@ private:
     QByteArray m_pauseBuffer;
     bool m_paused;
     bool m_blackout;
+    /** Flag raised when the next dump must be written even if unchanged */
+    bool m_forceWrite;
 };
 
 /** @} */
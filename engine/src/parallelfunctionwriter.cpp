@@ -0,0 +1,161 @@
+/*
+  Q Light Controller Plus
+  parallelfunctionwriter.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QElapsedTimer>
+#include <QRunnable>
+#include <QThread>
+
+#include "parallelfunctionwriter.h"
+#include "mastertimer.h"
+#include "function.h"
+
+/****************************************************************************
+ * Worker
+ ****************************************************************************/
+
+class ParallelFunctionWriter::Worker : public QRunnable
+{
+public:
+    Worker(ParallelFunctionWriter *parent)
+        : m_parent(parent)
+    {
+        setAutoDelete(false);
+    }
+
+    ~Worker()
+    {
+        qDeleteAll(m_universes);
+    }
+
+    /** Make sure there is one shadow universe per real universe */
+    void setUniversesCount(int count)
+    {
+        while (m_universes.count() < count)
+            m_universes.append(new Universe(m_universes.count()));
+        while (m_universes.count() > count)
+            delete m_universes.takeLast();
+    }
+
+    void run()
+    {
+        int count = m_parent->m_functions.count();
+        qint64 *durations = m_parent->m_durations.data();
+        QElapsedTimer elapsed;
+        int index;
+
+        while ((index = m_parent->m_nextIndex.fetchAndAddOrdered(1)) < count)
+        {
+            QVector<DeferredWrite> *writes = m_parent->m_writes.at(index);
+
+            foreach (Universe *universe, m_universes)
+                universe->setDeferredWrites(writes);
+
+            elapsed.start();
+            m_parent->m_functions.at(index)->write(m_parent->m_timer, m_universes);
+            durations[index] = elapsed.nsecsElapsed();
+        }
+
+        foreach (Universe *universe, m_universes)
+            universe->setDeferredWrites(NULL);
+    }
+
+private:
+    ParallelFunctionWriter *m_parent;
+
+    /** Universes recording writes instead of applying them */
+    QList<Universe *> m_universes;
+};
+
+/****************************************************************************
+ * ParallelFunctionWriter
+ ****************************************************************************/
+
+ParallelFunctionWriter::ParallelFunctionWriter()
+    : m_timer(NULL)
+    , m_nextIndex(0)
+{
+    int threads = qMax(1, QThread::idealThreadCount());
+
+    for (int i = 0; i < threads; i++)
+        m_workers.append(new Worker(this));
+
+    // the calling thread runs the first worker itself
+    m_pool.setMaxThreadCount(qMax(1, threads - 1));
+    // keep the threads alive between ticks
+    m_pool.setExpiryTimeout(-1);
+}
+
+ParallelFunctionWriter::~ParallelFunctionWriter()
+{
+    m_pool.waitForDone();
+    qDeleteAll(m_workers);
+    qDeleteAll(m_writes);
+}
+
+int ParallelFunctionWriter::threadCount() const
+{
+    return m_workers.count();
+}
+
+void ParallelFunctionWriter::write(MasterTimer *timer, const QList<Function *> &functions,
+                                   int universesCount)
+{
+    if (functions.isEmpty())
+        return;
+
+    m_timer = timer;
+    m_functions = functions;
+
+    while (m_writes.count() < functions.count())
+        m_writes.append(new QVector<DeferredWrite>());
+
+    // resize instead of clear, to keep the allocated memory across ticks
+    for (int i = 0; i < functions.count(); i++)
+        m_writes.at(i)->resize(0);
+
+    // make sure the workers write to a detached buffer
+    m_durations.resize(functions.count());
+    m_durations.detach();
+
+    m_nextIndex.fetchAndStoreOrdered(0);
+
+    int workersCount = qMin(m_workers.count(), functions.count());
+
+    for (int i = 0; i < workersCount; i++)
+        m_workers.at(i)->setUniversesCount(universesCount);
+
+    for (int i = 1; i < workersCount; i++)
+        m_pool.start(m_workers.at(i));
+
+    m_workers.at(0)->run();
+
+    m_pool.waitForDone();
+
+    m_functions.clear();
+}
+
+const QVector<DeferredWrite> &ParallelFunctionWriter::writes(int index) const
+{
+    return *m_writes.at(index);
+}
+
+qint64 ParallelFunctionWriter::duration(int index) const
+{
+    return m_durations.at(index);
+}
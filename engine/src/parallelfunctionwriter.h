@@ -0,0 +1,96 @@
+/*
+  Q Light Controller Plus
+  parallelfunctionwriter.h
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef PARALLELFUNCTIONWRITER_H
+#define PARALLELFUNCTIONWRITER_H
+
+#include <QThreadPool>
+#include <QAtomicInt>
+#include <QVector>
+#include <QList>
+
+#include "universe.h"
+
+class MasterTimer;
+class Function;
+
+/** @addtogroup engine Engine
+ * @{
+ */
+
+/**
+ * ParallelFunctionWriter runs Function::write() of several functions on
+ * a pool of worker threads. Each worker owns a set of "shadow" universes
+ * that don't apply values but record them as DeferredWrite entries, one list
+ * per function. MasterTimer then replays the lists on the real universes in
+ * the functions running order, so the result is identical to the serial path.
+ */
+class ParallelFunctionWriter
+{
+public:
+    ParallelFunctionWriter();
+    ~ParallelFunctionWriter();
+
+    /** Get the number of threads (including the calling one) used to write */
+    int threadCount() const;
+
+    /**
+     * Call write() on each Function of $functions, concurrently.
+     * This method returns when all the functions have been written.
+     *
+     * @param timer The MasterTimer instance passed to Function::write()
+     * @param functions The functions to write
+     * @param universesCount The number of universes in the current tick
+     */
+    void write(MasterTimer *timer, const QList<Function *>& functions, int universesCount);
+
+    /** Get the writes recorded for the function at $index in the last write() call */
+    const QVector<DeferredWrite>& writes(int index) const;
+
+    /** Get the time in nanoseconds spent writing the function at $index */
+    qint64 duration(int index) const;
+
+private:
+    class Worker;
+
+    /** The pool of threads running the workers, except the first one */
+    QThreadPool m_pool;
+
+    /** The workers. The first one always runs on the calling thread */
+    QList<Worker *> m_workers;
+
+    /** One list of recorded writes per function */
+    QList<QVector<DeferredWrite> *> m_writes;
+
+    /** The write duration of each function, in nanoseconds */
+    QVector<qint64> m_durations;
+
+    /** The functions currently being written */
+    QList<Function *> m_functions;
+
+    /** The MasterTimer currently writing */
+    MasterTimer *m_timer;
+
+    /** Index of the next function to be picked up by a worker */
+    QAtomicInt m_nextIndex;
+};
+
+/** @} */
+
+#endif
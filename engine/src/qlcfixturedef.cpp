@@ -46,7 +46,12 @@ QLCFixtureDef::QLCFixtureDef(const QLCFixtureDef* fixtureDef)
     , m_type(Dimmer)
 {
     if (fixtureDef != NULL)
+    {
         *this = *fixtureDef;
+        // a copy of a loaded definition doesn't need its file anymore
+        m_isLoaded = fixtureDef->m_isLoaded;
+        m_relativePath = fixtureDef->m_relativePath;
+    }
 }
 
 QLCFixtureDef::~QLCFixtureDef()
@@ -39,11 +39,69 @@
 
 RGBAlgorithm::RGBAlgorithm(Doc * doc)
     : m_doc(doc)
+    , m_mapsCacheSize(0)
     , m_startColor(QColor())
     , m_endColor(QColor())
 {
 }
 
+RGBAlgorithm::~RGBAlgorithm()
+{
+    clearMapsCache();
+}
+
+/****************************************************************************
+ * Maps cache
+ ****************************************************************************/
+
+QAtomicInt RGBAlgorithm::s_mapsCacheTotalSize(0);
+
+RGBMap RGBAlgorithm::cachedRgbMap(const QSize& size, uint rgb, int step)
+{
+    if (isCacheable() == false)
+        return rgbMap(size, rgb, step);
+
+    QPair<quint64, quint64> key((quint64(size.width()) << 32) | quint32(size.height()),
+                                (quint64(rgb) << 32) | quint32(step));
+
+    QHash<QPair<quint64, quint64>, RGBMap>::const_iterator it = m_mapsCache.constFind(key);
+    if (it != m_mapsCache.constEnd())
+        return it.value();
+
+    RGBMap map = rgbMap(size, rgb, step);
+
+    // reserve the map size in the shared budget, or give it back
+    int mapSize = size.width() * size.height() * sizeof(uint);
+    if (s_mapsCacheTotalSize.fetchAndAddOrdered(mapSize) + mapSize <= RGBMAP_CACHE_BUDGET)
+    {
+        m_mapsCache.insert(key, map);
+        m_mapsCacheSize += mapSize;
+    }
+    else
+    {
+        s_mapsCacheTotalSize.fetchAndAddOrdered(-mapSize);
+    }
+
+    return map;
+}
+
+bool RGBAlgorithm::isMapsCacheFull() const
+{
+    return s_mapsCacheTotalSize.loadAcquire() >= RGBMAP_CACHE_BUDGET;
+}
+
+void RGBAlgorithm::clearMapsCache()
+{
+    m_mapsCache.clear();
+    s_mapsCacheTotalSize.fetchAndAddOrdered(-m_mapsCacheSize);
+    m_mapsCacheSize = 0;
+}
+
+int RGBAlgorithm::mapsCacheTotalSize()
+{
+    return s_mapsCacheTotalSize.loadAcquire();
+}
+
 void RGBAlgorithm::setColors(QColor start, QColor end)
 {
     m_startColor = start;
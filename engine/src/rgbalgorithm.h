@@ -21,9 +21,12 @@
 #ifndef RGBALGORITHM_H
 #define RGBALGORITHM_H
 
+#include <QAtomicInt>
 #include <QString>
 #include <QVector>
 #include <QColor>
+#include <QHash>
+#include <QPair>
 #include <QSize>
 
 class QXmlStreamReader;
@@ -40,11 +43,14 @@ typedef QVector<QVector<uint> > RGBMap;
 #define KXMLQLCRGBAlgorithm "Algorithm"
 #define KXMLQLCRGBAlgorithmType "Type"
 
+/** Maximum size in bytes of the maps cached by all the algorithms together */
+#define RGBMAP_CACHE_BUDGET (32 * 1024 * 1024)
+
 class RGBAlgorithm
 {
 public:
     RGBAlgorithm(Doc* doc);
-    virtual ~RGBAlgorithm() { /* NOP */ }
+    virtual ~RGBAlgorithm();
 
     enum Type
     {
@@ -97,6 +103,39 @@ public:
      */
     virtual int acceptColors() const = 0;
 
+    /************************************************************************
+     * Maps cache
+     ************************************************************************/
+public:
+    /** Return true if rgbMap() depends only on its arguments and on the
+     *  algorithm settings, so that its results can be cached. Cacheable
+     *  algorithms must call clearMapsCache() when their settings change. */
+    virtual bool isCacheable() const { return false; }
+
+    /** Get the RGBMap for the given step. Maps of cacheable algorithms are
+     *  computed only once, and kept while all the algorithms together
+     *  cache less than RGBMAP_CACHE_BUDGET bytes. */
+    RGBMap cachedRgbMap(const QSize& size, uint rgb, int step);
+
+    /** Return true if no more maps can be added to the caches */
+    bool isMapsCacheFull() const;
+
+    /** Drop all the cached maps, giving their size back to the budget */
+    void clearMapsCache();
+
+    /** Get the size in bytes of the maps cached by all the algorithms */
+    static int mapsCacheTotalSize();
+
+private:
+    /** The cached maps, by (width << 32 | height, rgb << 32 | step) */
+    QHash<QPair<quint64, quint64>, RGBMap> m_mapsCache;
+    /** The size in bytes of m_mapsCache, accounted in s_mapsCacheTotalSize */
+    int m_mapsCacheSize;
+
+    /** The size in bytes of the maps cached by all the algorithms,
+     *  which can be filled by several threads */
+    static QAtomicInt s_mapsCacheTotalSize;
+
     /************************************************************************
      * RGB Colors
      ************************************************************************/
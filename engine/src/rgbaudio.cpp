@@ -62,26 +62,9 @@ void RGBAudio::setAudioCapture(AudioCapture* cap)
     qDebug() << Q_FUNC_INFO << "Audio capture set";
 
     m_audioInput = cap;
-    connect(m_audioInput, SIGNAL(dataProcessed(double*,int,double,quint32)),
-            this, SLOT(slotAudioBarsChanged(double*,int,double,quint32)));
     m_bandsNumber = -1;
 }
 
-void RGBAudio::slotAudioBarsChanged(double *spectrumBands, int size,
-                                    double maxMagnitude, quint32 power)
-{
-    if (size != m_bandsNumber)
-        return;
-
-    QMutexLocker locker(&m_mutex);
-
-    m_spectrumValues.clear();
-    for (int i = 0; i < m_bandsNumber; i++)
-        m_spectrumValues.append(spectrumBands[i]);
-    m_maxMagnitude = maxMagnitude;
-    m_volumePower = power;
-}
-
 void RGBAudio::calculateColors(int barsHeight)
 {
     if (barsHeight > 0)
@@ -150,6 +133,15 @@ RGBMap RGBAudio::rgbMap(const QSize& size, uint rgb, int step)
     if (m_barColors.count() == 0)
         calculateColors(size.height());
 
+    // read the latest spectrum directly, without waiting for a queued signal
+    double bands[FREQ_SUBBANDS_MAX_NUMBER];
+    if (m_audioInput->latestSpectrum(m_bandsNumber, bands, m_maxMagnitude, m_volumePower))
+    {
+        m_spectrumValues.resize(m_bandsNumber);
+        for (int i = 0; i < m_bandsNumber; i++)
+            m_spectrumValues[i] = bands[i];
+    }
+
     double volHeight = (m_volumePower * size.height()) / 0x7FFF;
     for (int x = 0; x < m_spectrumValues.count(); x++)
     {
@@ -179,13 +171,8 @@ void RGBAudio::postRun()
     QMutexLocker locker(&m_mutex);
 
     QSharedPointer<AudioCapture> capture = doc()->audioInputCapture();
-    if (capture.data() == m_audioInput)
-    {
-        disconnect(m_audioInput, SIGNAL(dataProcessed(double*,int,double,quint32)),
-                   this, SLOT(slotAudioBarsChanged(double*,int,double,quint32)));
-        if (m_bandsNumber > 0)
-            m_audioInput->unregisterBandsNumber(m_bandsNumber);
-    }
+    if (capture.data() == m_audioInput && m_bandsNumber > 0)
+        m_audioInput->unregisterBandsNumber(m_bandsNumber);
     m_audioInput = NULL;
     m_bandsNumber = -1;
 }
@@ -48,9 +48,6 @@ public:
 private:
     void setAudioCapture(AudioCapture* cap);
 
-protected slots:
-    void slotAudioBarsChanged(double *spectrumBands, int size, double maxMagnitude, quint32 power);
-
 private:
     void calculateColors(int barsHeight = 0);
 
@@ -73,6 +73,7 @@ void RGBImage::setFilename(const QString& filename)
 {
     m_filename = filename;
     reloadImage();
+    clearMapsCache();
 }
 
 QString RGBImage::filename() const
@@ -101,6 +102,7 @@ void RGBImage::setImageData(int width, int height, const QByteArray &pixelData)
         }
     }
     m_image = newImg;
+    clearMapsCache();
 }
 
 bool RGBImage::animatedSource() const
@@ -147,6 +149,7 @@ void RGBImage::setAnimationStyle(RGBImage::AnimationStyle ani)
         m_animationStyle = ani;
     else
         m_animationStyle = Static;
+    clearMapsCache();
 }
 
 RGBImage::AnimationStyle RGBImage::animationStyle() const
@@ -195,6 +198,7 @@ QStringList RGBImage::animationStyles()
 void RGBImage::setXOffset(int offset)
 {
     m_xOffset = offset;
+    clearMapsCache();
 }
 
 int RGBImage::xOffset() const
@@ -205,6 +209,7 @@ int RGBImage::xOffset() const
 void RGBImage::setYOffset(int offset)
 {
     m_yOffset = offset;
+    clearMapsCache();
 }
 
 int RGBImage::yOffset() const
@@ -312,6 +317,12 @@ int RGBImage::acceptColors() const
     return 0;
 }
 
+bool RGBImage::isCacheable() const
+{
+    // animated GIFs advance by one frame on each rgbMap() call
+    return m_animatedSource == false;
+}
+
 bool RGBImage::loadXML(QXmlStreamReader &root)
 {
     if (root.name() != KXMLQLCRGBAlgorithm)
@@ -22,6 +22,10 @@
 #include <QXmlStreamWriter>
 #include <QCoreApplication>
 #include <QElapsedTimer>
+#include <QWaitCondition>
+#include <QThreadPool>
+#include <QThread>
+#include <QRunnable>
 #include <QDebug>
 #include <cmath>
 #include <QDir>
@@ -45,6 +49,94 @@
 #define KXMLQLCRGBMatrixPropertyName "Name"
 #define KXMLQLCRGBMatrixPropertyValue "Value"
 
+class RGBMatrix::PrerenderState
+{
+public:
+    PrerenderState(RGBMatrix *matrix)
+        : m_matrix(matrix)
+        , m_running(false)
+        , m_cancelled(0)
+    {
+    }
+
+    /** Cancel the pre-rendering, without waiting for it */
+    void cancel()
+    {
+        m_cancelled.fetchAndStoreOrdered(1);
+
+        // A Prerenderer still queued will find no matrix and return at once
+        QMutexLocker locker(&m_mutex);
+        m_matrix = NULL;
+    }
+
+    /** Wait for the pre-rendering to finish, and the ones it replaced */
+    void wait()
+    {
+        QSharedPointer<PrerenderState> previous;
+        {
+            QMutexLocker locker(&m_mutex);
+            while (m_running)
+                m_finished.wait(&m_mutex);
+            previous = m_previous;
+        }
+
+        if (previous.isNull() == false)
+            previous->wait();
+    }
+
+    QMutex m_mutex;
+    QWaitCondition m_finished;
+    /** Reset to NULL when the matrix stops the pre-rendering */
+    RGBMatrix *m_matrix;
+    bool m_running;
+    QAtomicInt m_cancelled;
+    /** The cancelled pre-rendering this one replaces, which might still be
+     *  running. It is waited for by the Prerenderer, not by the matrix */
+    QSharedPointer<PrerenderState> m_previous;
+};
+
+class RGBMatrix::Prerenderer : public QRunnable
+{
+public:
+    Prerenderer(QSharedPointer<PrerenderState> state)
+        : m_state(state)
+    {
+        setAutoDelete(true);
+    }
+
+    void run()
+    {
+        QSharedPointer<PrerenderState> previous;
+        {
+            QMutexLocker locker(&m_state->m_mutex);
+            previous = m_state->m_previous;
+        }
+
+        // Never render a matrix twice at the same time
+        if (previous.isNull() == false)
+            previous->wait();
+
+        RGBMatrix *matrix;
+        {
+            QMutexLocker locker(&m_state->m_mutex);
+            m_state->m_previous.clear();
+            if (m_state->m_matrix == NULL)
+                return;
+            matrix = m_state->m_matrix;
+            m_state->m_running = true;
+        }
+
+        matrix->prerenderSteps(m_state->m_cancelled);
+
+        QMutexLocker locker(&m_state->m_mutex);
+        m_state->m_running = false;
+        m_state->m_finished.wakeAll();
+    }
+
+private:
+    QSharedPointer<PrerenderState> m_state;
+};
+
 /****************************************************************************
  * Initialization
  ****************************************************************************/
@@ -59,6 +151,7 @@ RGBMatrix::RGBMatrix(Doc* doc)
     , m_startColor(Qt::red)
     , m_endColor(QColor())
     , m_stepHandler(new RGBMatrixStep())
+    , m_pixelMapChanged(true)
     , m_fader(NULL)
     , m_roundTime(new QElapsedTimer())
     , m_stepsCount(0)
@@ -73,6 +166,7 @@ RGBMatrix::RGBMatrix(Doc* doc)
 
 RGBMatrix::~RGBMatrix()
 {
+    stopPrerender();
     delete m_algorithm;
     delete m_roundTime;
     delete m_stepHandler;
@@ -115,7 +209,10 @@ quint32 RGBMatrix::totalDuration()
 
 void RGBMatrix::setDimmerControl(bool dimmerControl)
 {
+    QMutexLocker algoLocker(&m_algorithmMutex);
     m_dimmerControl = dimmerControl;
+    // the dimmers are in the pixel map only with dimmer control
+    m_pixelMapChanged = true;
 }
 
 bool RGBMatrix::dimmerControl() const
@@ -179,6 +276,7 @@ void RGBMatrix::setFixtureGroup(quint32 id)
     {
         QMutexLocker algoLocker(&m_algorithmMutex);
         m_group = doc()->fixtureGroup(m_fixtureGroupID);
+        m_pixelMapChanged = true;
     }
     m_stepsCount = stepsCount();
 }
@@ -191,12 +289,37 @@ QList<quint32> RGBMatrix::components()
     return QList<quint32>();
 }
 
+void RGBMatrix::slotFixtureRemoved(quint32 fxi_id)
+{
+    Q_UNUSED(fxi_id)
+
+    QMutexLocker algoLocker(&m_algorithmMutex);
+    m_pixelMapChanged = true;
+}
+
+void RGBMatrix::slotFixtureChanged(quint32 fxi_id)
+{
+    // Fixture heads may have moved: rebuild the pixel map at the next step
+    QMutexLocker algoLocker(&m_algorithmMutex);
+    if (m_group != NULL && m_group->fixtureList().contains(fxi_id))
+        m_pixelMapChanged = true;
+}
+
+void RGBMatrix::slotFixtureGroupChanged(quint32 id)
+{
+    QMutexLocker algoLocker(&m_algorithmMutex);
+    if (id == m_fixtureGroupID)
+        m_pixelMapChanged = true;
+}
+
 /****************************************************************************
  * Algorithm
  ****************************************************************************/
 
 void RGBMatrix::setAlgorithm(RGBAlgorithm* algo)
 {
+    cancelPrerender();
+
     {
         QMutexLocker algorithmLocker(&m_algorithmMutex);
         delete m_algorithm;
@@ -261,7 +384,7 @@ RGBMap RGBMatrix::previewMap(int step, RGBMatrixStep *handler)
         m_group = doc()->fixtureGroup(fixtureGroup());
 
     if (m_group != NULL)
-        map = m_algorithm->rgbMap(m_group->size(), handler->stepColor().rgb(), step);
+        map = m_algorithm->cachedRgbMap(m_group->size(), handler->stepColor().rgb(), step);
 
     return map;
 }
@@ -496,6 +619,7 @@ void RGBMatrix::preRun(MasterTimer* timer)
         QMutexLocker algorithmLocker(&m_algorithmMutex);
 
         m_group = doc()->fixtureGroup(m_fixtureGroupID);
+        m_pixelMapChanged = true;
         if (m_group == NULL)
         {
             // No fixture group to control
@@ -509,6 +633,8 @@ void RGBMatrix::preRun(MasterTimer* timer)
             m_fader = new GenericFader(doc());
             m_fader->adjustIntensity(getAttributeValue(Intensity));
             m_fader->setBlendMode(blendMode());
+            // m_pixelMap holds the indices of the fader channels
+            m_fader->setKeepZeroChannels(true);
 
             // Copy direction from parent class direction
             m_stepHandler->initializeDirection(direction(), m_startColor, m_endColor, m_stepsCount);
@@ -528,6 +654,8 @@ void RGBMatrix::preRun(MasterTimer* timer)
 
     m_roundTime->restart();
 
+    startPrerender();
+
     Function::preRun(timer);
 }
 
@@ -561,7 +689,7 @@ void RGBMatrix::write(MasterTimer* timer, QList<Universe *> universes)
                     m_stepBeatDuration = beatsToTime(duration(), timer->beatTimeDuration());
 
                 //qDebug() << "RGBMatrix step" << m_stepHandler->currentStepIndex() << ", color:" << QString::number(m_stepHandler->stepColor().rgb(), 16);
-                RGBMap map = m_algorithm->rgbMap(m_group->size(), m_stepHandler->stepColor().rgb(), m_stepHandler->currentStepIndex());
+                RGBMap map = m_algorithm->cachedRgbMap(m_group->size(), m_stepHandler->stepColor().rgb(), m_stepHandler->currentStepIndex());
                 updateMapChannels(map, m_group);
             }
         }
@@ -611,15 +739,25 @@ void RGBMatrix::write(MasterTimer* timer, QList<Universe *> universes)
     }
 }
 
+bool RGBMatrix::canWriteConcurrently() const
+{
+    QMutexLocker algorithmLocker(const_cast<QMutex*>(&m_algorithmMutex));
+
+    // RGBAudio shares the Doc audio capture, so keep it on the timer thread
+    if (m_algorithm != NULL && m_algorithm->type() == RGBAlgorithm::Audio)
+        return false;
+
+    return true;
+}
+
 void RGBMatrix::postRun(MasterTimer* timer, QList<Universe *> universes)
 {
+    cancelPrerender();
+
     if (m_fader != NULL)
     {
-        QHashIterator <FadeChannel,FadeChannel> it(m_fader->channels());
-        while (it.hasNext() == true)
+        foreach (FadeChannel fc, m_fader->channels())
         {
-            it.next();
-            FadeChannel fc = it.value();
             // fade out only intensity channels
             if (fc.group(doc()) != QLCChannel::Intensity)
                 continue;
@@ -679,15 +817,22 @@ void RGBMatrix::roundCheck()
         roundElapsed(duration());
 }
 
-void RGBMatrix::updateMapChannels(const RGBMap& map, const FixtureGroup* grp)
+void RGBMatrix::updatePixelMap(const FixtureGroup* grp)
 {
-    uint fadeTime = (overrideFadeInSpeed() == defaultSpeed()) ? fadeInSpeed() : overrideFadeInSpeed();
+    Q_ASSERT(m_fader != NULL);
 
-    // Create/modify fade channels for ALL pixels in the color map.
-    for (int y = 0; y < map.size(); y++)
+    m_pixelMapSize = grp->size();
+    m_pixelMap.resize(m_pixelMapSize.width() * m_pixelMapSize.height());
+
+    for (int y = 0; y < m_pixelMapSize.height(); y++)
     {
-        for (int x = 0; x < map[y].size(); x++)
+        for (int x = 0; x < m_pixelMapSize.width(); x++)
         {
+            PixelChannels &pixel = m_pixelMap[y * m_pixelMapSize.width() + x];
+            pixel.m_colorsCount = 0;
+            pixel.m_cmy = false;
+            pixel.m_dimmersCount = 0;
+
             QLCPoint pt(x, y);
             GroupHead grpHead(grp->head(pt));
             Fixture* fxi = doc()->fixture(grpHead.fxi);
@@ -725,119 +870,203 @@ void RGBMatrix::updateMapChannels(const RGBMap& map, const FixtureGroup* grp)
             if (headDim != QLCChannel::invalid())
                 dim << headDim;
 
-            uint col = map[y][x];
-
-            if (rgb.size() == 3)
+            if (rgb.size() == 3 || cmy.size() == 3)
             {
-                // RGB color mixing
-                {
-                    FadeChannel fc(doc(), grpHead.fxi, rgb.at(0));
-                    fc.setTarget(qRed(col));
-                    insertStartValues(fc, fadeTime);
-                    m_fader->add(fc);
-                }
+                pixel.m_cmy = rgb.size() != 3;
+                const QVector <quint32> &colors = pixel.m_cmy ? cmy : rgb;
+                for (int i = 0; i < 3; i++)
+                    pixel.m_colors[i] = m_fader->channelIndex(FadeChannel(doc(), grpHead.fxi, colors.at(i)));
+                pixel.m_colorsCount = 3;
+            }
+            else if (!dim.empty())
+            {
+                pixel.m_colors[0] = m_fader->channelIndex(FadeChannel(doc(), grpHead.fxi, dim.last()));
+                pixel.m_colorsCount = 1;
+                dim.pop_back();
+            }
 
-                {
-                    FadeChannel fc(doc(), grpHead.fxi, rgb.at(1));
-                    fc.setTarget(qGreen(col));
-                    insertStartValues(fc, fadeTime);
-                    m_fader->add(fc);
-                }
+            // the fader writes all its channels, so add the dimmers only when used
+            if (m_dimmerControl == false)
+                continue;
 
-                {
-                    FadeChannel fc(doc(), grpHead.fxi, rgb.at(2));
-                    fc.setTarget(qBlue(col));
-                    insertStartValues(fc, fadeTime);
-                    m_fader->add(fc);
-                }
-            }
-            else if (cmy.size() == 3)
+            foreach(quint32 ch, dim)
+                pixel.m_dimmers[pixel.m_dimmersCount++] = m_fader->channelIndex(FadeChannel(doc(), grpHead.fxi, ch));
+        }
+    }
+
+    m_pixelMapChanged = false;
+}
+
+void RGBMatrix::updateMapChannels(const RGBMap& map, const FixtureGroup* grp)
+{
+    // Fade in speed is used for all non-zero targets
+    uint fadeTime = (overrideFadeInSpeed() == defaultSpeed()) ? fadeInSpeed() : overrideFadeInSpeed();
+    uint fadeOutTime = fadeOutSpeed();
+
+    if (m_pixelMapChanged || m_pixelMapSize != grp->size())
+        updatePixelMap(grp);
+
+    int width = m_pixelMapSize.width();
+    int height = qMin(map.size(), m_pixelMapSize.height());
+
+    // Set the fade channels of ALL pixels in the color map.
+    for (int y = 0; y < height; y++)
+    {
+        const QVector<uint> &row = map.at(y);
+        const PixelChannels *pixel = m_pixelMap.constData() + y * width;
+        int rowWidth = qMin(row.size(), width);
+
+        for (int x = 0; x < rowWidth; x++, pixel++)
+        {
+            uint col = row.at(x);
+
+            if (pixel->m_colorsCount == 3)
             {
-                // CMY color mixing
-                QColor cmyCol(col);
+                uchar values[3];
 
+                if (pixel->m_cmy)
                 {
-                    FadeChannel fc(doc(), grpHead.fxi, cmy.at(0));
-                    fc.setTarget(cmyCol.cyan());
-                    insertStartValues(fc, fadeTime);
-                    m_fader->add(fc);
+                    // CMY color mixing
+                    QColor cmyCol(col);
+                    values[0] = cmyCol.cyan();
+                    values[1] = cmyCol.magenta();
+                    values[2] = cmyCol.yellow();
                 }
-
+                else
                 {
-                    FadeChannel fc(doc(), grpHead.fxi, cmy.at(1));
-                    fc.setTarget(cmyCol.magenta());
-                    insertStartValues(fc, fadeTime);
-                    m_fader->add(fc);
+                    // RGB color mixing
+                    values[0] = qRed(col);
+                    values[1] = qGreen(col);
+                    values[2] = qBlue(col);
                 }
 
-                {
-                    FadeChannel fc(doc(), grpHead.fxi, cmy.at(2));
-                    fc.setTarget(cmyCol.yellow());
-                    insertStartValues(fc, fadeTime);
-                    m_fader->add(fc);
-                }
+                for (int i = 0; i < 3; i++)
+                    m_fader->setTarget(pixel->m_colors[i], values[i], values[i] == 0 ? fadeOutTime : fadeTime);
             }
-            else if (!dim.empty())
+            else if (pixel->m_colorsCount == 1)
             {
                 // Set dimmer to value of the color (e.g. for PARs)
-                FadeChannel fc(doc(), grpHead.fxi, dim.last());
                 // the weights are taken from
                 // https://en.wikipedia.org/wiki/YUV#SDTV_with_BT.601
-                fc.setTarget(0.299 * qRed(col) + 0.587 * qGreen(col) + 0.114 * qBlue(col));
-                insertStartValues(fc, fadeTime);
-                m_fader->add(fc);
-                dim.pop_back();
+                uchar value = uchar(0.299 * qRed(col) + 0.587 * qGreen(col) + 0.114 * qBlue(col));
+                m_fader->setTarget(pixel->m_colors[0], value, value == 0 ? fadeOutTime : fadeTime);
             }
 
             if (m_dimmerControl)
             {
                 // Set the rest of the dimmer channels to full on
-                foreach(quint32 ch, dim)
-                {
-                    FadeChannel fc(doc(), grpHead.fxi, ch);
-                    fc.setTarget(col == 0 ? 0 : 255);
-                    insertStartValues(fc, fadeTime);
-                    m_fader->add(fc);
-                }
+                for (int i = 0; i < pixel->m_dimmersCount; i++)
+                    m_fader->setTarget(pixel->m_dimmers[i], col == 0 ? 0 : 255, col == 0 ? fadeOutTime : fadeTime);
             }
         }
     }
 }
 
-void RGBMatrix::insertStartValues(FadeChannel& fc, uint fadeTime) const
+/*********************************************************************
+ * Steps pre-rendering
+ *********************************************************************/
+
+void RGBMatrix::startPrerender()
 {
-    Q_ASSERT(m_fader != NULL);
+    QMutexLocker algorithmLocker(&m_algorithmMutex);
+    if (m_algorithm == NULL || m_algorithm->isCacheable() == false)
+        return;
+
+    cancelPrerender();
+
+    // the previous pre-rendering might still be finishing its step:
+    // the new one waits for it in the pool, not here
+    QSharedPointer<PrerenderState> state(new PrerenderState(this));
+    state->m_previous = m_prerenderState;
+    m_prerenderState = state;
+    prerenderPool()->start(new Prerenderer(state));
+}
 
-    // To create a nice and smooth fade, get the starting value from
-    // m_fader's existing FadeChannel (if any). Otherwise just assume
-    // we're starting from zero.
-    QHash <FadeChannel,FadeChannel>::const_iterator oldChannelIterator = m_fader->channels().find(fc);
-    if (oldChannelIterator != m_fader->channels().end())
+void RGBMatrix::cancelPrerender()
+{
+    QMutexLocker algorithmLocker(&m_algorithmMutex);
+    if (m_prerenderState.isNull() == false)
+        m_prerenderState->cancel();
+}
+
+void RGBMatrix::stopPrerender()
+{
+    QSharedPointer<PrerenderState> state;
+    {
+        QMutexLocker algorithmLocker(&m_algorithmMutex);
+        if (m_prerenderState.isNull())
+            return;
+
+        m_prerenderState->cancel();
+        state = m_prerenderState;
+        m_prerenderState.clear();
+    }
+
+    // the Prerenderer needs the algorithm mutex to notice the cancellation
+    state->wait();
+}
+
+void RGBMatrix::prerenderSteps(const QAtomicInt &cancelled)
+{
+    RGBMatrixStep handler;
+    QSize size;
+    int stepsCount = 0;
+
+    for (int i = 0; ; i++)
     {
-        FadeChannel old = oldChannelIterator.value();
-        fc.setCurrent(old.current());
-        if (fc.target() == old.target())
+        // Lock only one step at a time, to let write() run in between
+        QMutexLocker algorithmLocker(&m_algorithmMutex);
+
+        // checked with the lock held, so that a cancelled pre-rendering
+        // never sees the algorithm changed by who cancelled it
+        if (cancelled.loadAcquire() != 0)
+            return;
+
+        if (m_algorithm == NULL || m_algorithm->isCacheable() == false ||
+            m_algorithm->isMapsCacheFull() || m_group == NULL)
+            return;
+
+        if (i == 0)
         {
-            fc.setStart(old.start());
-            fc.setElapsed(old.elapsed());
+            size = m_group->size();
+            stepsCount = m_algorithm->rgbMapStepCount(size);
+            handler.initializeDirection(direction(), m_startColor, m_endColor, stepsCount);
         }
         else
-            fc.setStart(old.current());
-    }
-    else
-    {
-        fc.setCurrent(0);
-        fc.setStart(0);
+        {
+            // The group has been resized in the meantime
+            if (m_group->size() != size)
+                return;
+
+            // Follow the playback, so that the first steps are ready first
+            // and the step colors match the ones write() will ask for
+            if (handler.checkNextStep(runOrder(), m_startColor, m_endColor, stepsCount) == false)
+                break;
+        }
+
+        // Any run order visits all the steps within stepsCount moves
+        if (i >= stepsCount)
+            break;
+
+        m_algorithm->cachedRgbMap(size, handler.stepColor().rgb(), handler.currentStepIndex());
     }
+}
 
-    // The channel is not ready yet
-    fc.setReady(false);
+QThreadPool *RGBMatrix::prerenderPool()
+{
+    class PrerenderPool : public QThreadPool
+    {
+    public:
+        PrerenderPool()
+        {
+            // Leave the other cores to MasterTimer and the UI
+            setMaxThreadCount(qMax(1, QThread::idealThreadCount() / 2));
+        }
+    };
 
-    // Fade in speed is used for all non-zero targets
-    if (fc.target() == 0)
-        fc.setFadeTime(fadeOutSpeed());
-    else
-        fc.setFadeTime(fadeTime);
+    // Created on first use, it waits for the running jobs when destroyed
+    static PrerenderPool pool;
+    return &pool;
 }
 
 /*********************************************************************
@@ -21,6 +21,8 @@
 #ifndef RGBMATRIX_H
 #define RGBMATRIX_H
 
+#include <QSharedPointer>
+#include <QAtomicInt>
 #include <QVector>
 #include <QColor>
 #include <QList>
@@ -35,12 +37,13 @@
 #else
   #include "rgbscript.h"
 #endif
+#include "fadechannel.h"
 #include "function.h"
 
 class QElapsedTimer;
+class QThreadPool;
 class FixtureGroup;
 class GenericFader;
-class FadeChannel;
 class QDir;
 
 /** @addtogroup engine_functions Functions
@@ -144,6 +147,16 @@ public:
     /** @reimp */
     QList<quint32> components();
 
+public slots:
+    /** @reimp */
+    void slotFixtureRemoved(quint32 fxi_id);
+
+    /** @reimp */
+    void slotFixtureChanged(quint32 fxi_id);
+
+    /** @reimp */
+    void slotFixtureGroupChanged(quint32 id);
+
 private:
     quint32 m_fixtureGroupID;
     FixtureGroup *m_group;
@@ -225,6 +238,9 @@ public:
     /** @reimp */
     void write(MasterTimer* timer, QList<Universe*> universes);
 
+    /** @reimp */
+    bool canWriteConcurrently() const;
+
     /** @reimp */
     void postRun(MasterTimer* timer, QList<Universe*> universes);
 
@@ -232,11 +248,32 @@ private:
     /** Check what should be done when elapsed() >= duration() */
     void roundCheck();
 
-    /** Update new FadeChannels to m_fader when $map has changed since last time */
+    /** Set the targets of the m_fader channels out of $map */
     void updateMapChannels(const RGBMap& map, const FixtureGroup* grp);
 
-    /** Grab starting values for a fade channel from $fader if available */
-    void insertStartValues(FadeChannel& fc, uint fadeTime) const;
+    /** Resolve the channels of each pixel of $grp into m_fader
+     *  and store their indices into m_pixelMap */
+    void updatePixelMap(const FixtureGroup* grp);
+
+private:
+    /** The channels controlled by a single pixel of the matrix */
+    typedef struct
+    {
+        int m_colorsCount;          //! 3 for RGB/CMY heads, 1 for grayscale dimmer, 0 if none
+        bool m_cmy;                 //! true if the color channels are CMY
+        int m_dimmersCount;         //! Dimmers to set to full with dimmer control enabled
+        int m_colors[3];            //! The m_fader indices of the color channels, or the grayscale dimmer
+        int m_dimmers[2];           //! The m_fader indices of the master and/or head dimmer channels
+    } PixelChannels;
+
+    /** The channels of each pixel, row by row, built by updatePixelMap() */
+    QVector<PixelChannels> m_pixelMap;
+
+    /** The size of the fixture group m_pixelMap was built for */
+    QSize m_pixelMapSize;
+
+    /** Flag raised when m_pixelMap must be built again */
+    bool m_pixelMapChanged;
 
 private:
     /** Reference of a GenericFader in charge of actually sending DMX data
@@ -252,6 +289,40 @@ private:
     /** The duration of a step based on the current BPM (Beats tempo only) */
     uint m_stepBeatDuration;
 
+    /*********************************************************************
+     * Steps pre-rendering
+     *********************************************************************/
+private:
+    /** Start rendering the maps of all the steps in the background, when
+     *  the algorithm is cacheable, so that the steps are ready in the
+     *  algorithm cache when write() needs them */
+    void startPrerender();
+
+    /** Cancel the background rendering without waiting for it, so that
+     *  it can be called from the MasterTimer thread */
+    void cancelPrerender();
+
+    /** Cancel the background rendering and wait for it to finish, since
+     *  it uses the matrix. Must not be called with m_algorithmMutex locked. */
+    void stopPrerender();
+
+    /** Render the maps of all the steps, in the order they will be played,
+     *  until $cancelled is set. Runs in the shared pre-rendering pool. */
+    void prerenderSteps(const QAtomicInt &cancelled);
+
+    /** The thread pool shared by all the matrices to pre-render their
+     *  steps, with half of the available cores */
+    static QThreadPool *prerenderPool();
+
+private:
+    class Prerenderer;
+    class PrerenderState;
+
+    /** The last pre-rendering started, shared with its Prerenderer, which
+     *  does nothing if the matrix has cancelled it in the meantime.
+     *  Guarded by m_algorithmMutex */
+    QSharedPointer<PrerenderState> m_prerenderState;
+
     /*********************************************************************
      * Attributes
      *********************************************************************/
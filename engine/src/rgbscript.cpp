@@ -50,6 +50,7 @@ QMutex* RGBScript::s_engineMutex = NULL;
 RGBScript::RGBScript(Doc * doc)
     : RGBAlgorithm(doc)
     , m_apiVersion(0)
+    , m_cacheable(false)
 {
 }
 
@@ -58,6 +59,7 @@ RGBScript::RGBScript(const RGBScript& s)
     , m_fileName(s.m_fileName)
     , m_contents(s.m_contents)
     , m_apiVersion(0)
+    , m_cacheable(false)
 {
     evaluate();
 }
@@ -133,6 +135,8 @@ bool RGBScript::evaluate()
     m_rgbMap = QScriptValue();
     m_rgbMapStepCount = QScriptValue();
     m_apiVersion = 0;
+    m_cacheable = false;
+    clearMapsCache();
 
     m_script = s_engine->evaluate(m_contents, m_fileName);
     if (s_engine->hasUncaughtException() == true)
@@ -160,6 +164,7 @@ bool RGBScript::evaluate()
         }
 
         m_apiVersion = m_script.property("apiVersion").toInteger();
+        m_cacheable = m_script.property("cacheable").toBool();
         if (m_apiVersion > 0)
         {
             if (m_apiVersion == 2)
@@ -279,6 +284,11 @@ int RGBScript::acceptColors() const
     return 2;
 }
 
+bool RGBScript::isCacheable() const
+{
+    return m_cacheable;
+}
+
 bool RGBScript::loadXML(QXmlStreamReader &root)
 {
     Q_UNUSED(root)
@@ -346,6 +356,10 @@ bool RGBScript::setProperty(QString propertyName, QString value)
                 qWarning() << name() << "doesn't have a write function for" << propertyName;
                 return false;
             }
+            // cached maps are valid only for the current values
+            if (property(propertyName) != value)
+                clearMapsCache();
+
             QScriptValueList args;
             args << value;
             writeMethod.call(QScriptValue(), args);
@@ -99,6 +99,9 @@ public:
     /** @reimp */
     int acceptColors() const;
 
+    /** @reimp */
+    bool isCacheable() const;
+
     /** @reimp */
     bool loadXML(QXmlStreamReader &root);
 
@@ -107,6 +110,7 @@ public:
 
 private:
     int m_apiVersion;               //! The API version that the script uses
+    bool m_cacheable;               //! rgbMap() is declared as a pure function
     QScriptValue m_script;          //! The script itself
     QScriptValue m_rgbMap;          //! rgbMap() function
     QScriptValue m_rgbMapStepCount; //! rgbMapStepCount() function
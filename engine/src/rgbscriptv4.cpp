@@ -20,6 +20,7 @@
 #include <QXmlStreamReader>
 #include <QXmlStreamWriter>
 #include <QJSEngine>
+#include <QThread>
 #include <QMutex>
 #include <QDebug>
 #include <QFile>
@@ -30,8 +31,8 @@
 #include "qlcconfig.h"
 #include "qlcfile.h"
 
-QJSEngine* RGBScript::s_engine = NULL;
-QMutex* RGBScript::s_engineMutex = NULL;
+QList<RGBScript::PooledEngine *> RGBScript::s_enginePool;
+QMutex RGBScript::s_enginePoolMutex;
 
 /****************************************************************************
  * Initialization
@@ -39,21 +40,55 @@ QMutex* RGBScript::s_engineMutex = NULL;
 
 RGBScript::RGBScript(Doc * doc)
     : RGBAlgorithm(doc)
+    , m_engine(NULL)
     , m_apiVersion(0)
+    , m_cacheable(false)
 {
+    initEngine();
 }
 
 RGBScript::RGBScript(const RGBScript& s)
     : RGBAlgorithm(s.doc())
+    , m_engine(NULL)
     , m_fileName(s.m_fileName)
     , m_contents(s.m_contents)
     , m_apiVersion(0)
+    , m_cacheable(false)
 {
+    initEngine();
     evaluate();
 }
 
 RGBScript::~RGBScript()
 {
+    releaseEngine();
+}
+
+RGBScript& RGBScript::operator=(const RGBScript& s)
+{
+    if (this == &s)
+        return *this;
+
+    RGBAlgorithm::operator=(s);
+
+    {
+        // drop the values belonging to the current engine
+        QMutexLocker engineLocker(m_engine->m_mutex);
+        m_script = QJSValue();
+        m_rgbMap = QJSValue();
+        m_rgbMapStepCount = QJSValue();
+    }
+
+    releaseEngine();
+    m_engine = NULL;
+    initEngine();
+
+    m_fileName = s.m_fileName;
+    m_contents = s.m_contents;
+    m_properties.clear();
+    evaluate();
+
+    return *this;
 }
 
 bool RGBScript::operator==(const RGBScript& s) const
@@ -76,10 +111,7 @@ RGBAlgorithm* RGBScript::clone() const
 
 bool RGBScript::load(const QDir& dir, const QString& fileName)
 {
-    // Create the script engine when it's first needed
-    initEngine();
-
-    QMutexLocker engineLocker(s_engineMutex);
+    QMutexLocker engineLocker(m_engine->m_mutex);
 
     m_contents.clear();
     m_script = QJSValue();
@@ -109,13 +141,15 @@ QString RGBScript::fileName() const
 
 bool RGBScript::evaluate()
 {
-    QMutexLocker engineLocker(s_engineMutex);
+    QMutexLocker engineLocker(m_engine->m_mutex);
 
     m_rgbMap = QJSValue();
     m_rgbMapStepCount = QJSValue();
     m_apiVersion = 0;
+    m_cacheable = false;
+    clearMapsCache();
 
-    m_script = s_engine->evaluate(m_contents, m_fileName);
+    m_script = m_engine->m_jsEngine->evaluate(m_contents, m_fileName);
     if (m_script.isError())
     {
         QString msg("%1: Uncaught exception at line %2. Error: %3");
@@ -141,6 +175,7 @@ bool RGBScript::evaluate()
     }
 
     m_apiVersion = m_script.property("apiVersion").toInt();
+    m_cacheable = m_script.property("cacheable").toBool();
     if (m_apiVersion > 0)
     {
         if (m_apiVersion == 2)
@@ -156,13 +191,37 @@ bool RGBScript::evaluate()
 
 void RGBScript::initEngine()
 {
-    if (s_engineMutex == NULL)
+    QMutexLocker poolLocker(&s_enginePoolMutex);
+
+    Q_ASSERT(m_engine == NULL);
+
+    foreach (PooledEngine *engine, s_enginePool)
+    {
+        if (m_engine == NULL || engine->m_scriptsCount < m_engine->m_scriptsCount)
+            m_engine = engine;
+    }
+
+    // Engines are created when they're first needed
+    if ((m_engine == NULL || m_engine->m_scriptsCount > 0) &&
+        s_enginePool.count() < qMax(1, QThread::idealThreadCount()))
     {
-        s_engineMutex = new QMutex(QMutex::Recursive);
-        s_engine = new QJSEngine();
+        m_engine = new PooledEngine;
+        m_engine->m_jsEngine = new QJSEngine();
+        m_engine->m_mutex = new QMutex(QMutex::Recursive);
+        m_engine->m_scriptsCount = 0;
+        s_enginePool.append(m_engine);
     }
-    Q_ASSERT(s_engineMutex != NULL);
-    Q_ASSERT(s_engine != NULL);
+
+    Q_ASSERT(m_engine != NULL);
+    m_engine->m_scriptsCount++;
+}
+
+void RGBScript::releaseEngine()
+{
+    QMutexLocker poolLocker(&s_enginePoolMutex);
+
+    // The engine is kept in the pool for the next scripts
+    m_engine->m_scriptsCount--;
 }
 
 /****************************************************************************
@@ -171,7 +230,7 @@ void RGBScript::initEngine()
 
 int RGBScript::rgbMapStepCount(const QSize& size)
 {
-    QMutexLocker engineLocker(s_engineMutex);
+    QMutexLocker engineLocker(m_engine->m_mutex);
 
     if (m_rgbMapStepCount.isCallable() == false)
         return -1;
@@ -187,7 +246,7 @@ RGBMap RGBScript::rgbMap(const QSize& size, uint rgb, int step)
 {
     RGBMap map;
 
-    QMutexLocker engineLocker(s_engineMutex);
+    QMutexLocker engineLocker(m_engine->m_mutex);
 
     if (m_rgbMap.isUndefined() == true)
         return map;
@@ -201,19 +260,40 @@ RGBMap RGBScript::rgbMap(const QSize& size, uint rgb, int step)
         map = RGBMap(ylen);
         for (int y = 0; y < ylen && y < size.height(); y++)
         {
-            QJSValue xarray = yarray.property(QString::number(y));
+            QJSValue xarray = yarray.property(quint32(y));
             int xlen = xarray.property("length").toInt();
             map[y].resize(xlen);
             for (int x = 0; x < xlen && x < size.width(); x++)
-            {
-                QJSValue yx = xarray.property(QString::number(x));
-                map[y][x] = yx.toInt();
-            }
+                map[y][x] = xarray.property(quint32(x)).toUInt();
+        }
+    }
+    else if (yarray.property("constructor").property("name").toString() == "Uint32Array" &&
+             yarray.property("BYTES_PER_ELEMENT").toInt() == int(sizeof(uint)))
+    {
+        // A Uint32Array of width * height values, row by row: the whole
+        // buffer is copied at once instead of walking each element
+        QByteArray buffer = yarray.property("buffer").toVariant().toByteArray();
+        int offset = yarray.property("byteOffset").toInt();
+        int width = size.width();
+        int height = qMin(size.height(), yarray.property("length").toInt() / qMax(1, width));
+
+        if (offset < 0 || buffer.size() < offset + height * width * int(sizeof(uint)))
+        {
+            qWarning() << "Returned typed array is shorter than expected!";
+            return map;
+        }
+
+        const uint *values = reinterpret_cast<const uint *>(buffer.constData() + offset);
+        map = RGBMap(height);
+        for (int y = 0; y < height; y++)
+        {
+            map[y].resize(width);
+            memcpy(map[y].data(), values + y * width, width * sizeof(uint));
         }
     }
     else
     {
-        qWarning() << "Returned value is not an array within an array!";
+        qWarning() << "Returned value is not an array within an array, nor a Uint32Array!";
     }
 
     return map;
@@ -221,7 +301,7 @@ RGBMap RGBScript::rgbMap(const QSize& size, uint rgb, int step)
 
 QString RGBScript::name() const
 {
-    QMutexLocker engineLocker(s_engineMutex);
+    QMutexLocker engineLocker(m_engine->m_mutex);
 
     QJSValue name = m_script.property("name");
     QString ret = name.isUndefined() ? QString() : name.toString();
@@ -230,7 +310,7 @@ QString RGBScript::name() const
 
 QString RGBScript::author() const
 {
-    QMutexLocker engineLocker(s_engineMutex);
+    QMutexLocker engineLocker(m_engine->m_mutex);
 
     QJSValue author = m_script.property("author");
     QString ret = author.isUndefined() ? QString() : author.toString();
@@ -249,7 +329,7 @@ RGBAlgorithm::Type RGBScript::type() const
 
 int RGBScript::acceptColors() const
 {
-    QMutexLocker engineLocker(s_engineMutex);
+    QMutexLocker engineLocker(m_engine->m_mutex);
 
     QJSValue accColors = m_script.property("acceptColors");
     if (!accColors.isUndefined())
@@ -259,6 +339,11 @@ int RGBScript::acceptColors() const
     return 2;
 }
 
+bool RGBScript::isCacheable() const
+{
+    return m_cacheable;
+}
+
 bool RGBScript::loadXML(QXmlStreamReader &root)
 {
     Q_UNUSED(root)
@@ -295,7 +380,7 @@ QList<RGBScriptProperty> RGBScript::properties()
 
 QHash<QString, QString> RGBScript::propertiesAsStrings()
 {
-    QMutexLocker engineLocker(s_engineMutex);
+    QMutexLocker engineLocker(m_engine->m_mutex);
 
     QHash<QString, QString> properties;
     foreach(RGBScriptProperty cap, m_properties)
@@ -314,7 +399,7 @@ QHash<QString, QString> RGBScript::propertiesAsStrings()
 
 bool RGBScript::setProperty(QString propertyName, QString value)
 {
-    QMutexLocker engineLocker(s_engineMutex);
+    QMutexLocker engineLocker(m_engine->m_mutex);
 
     foreach(RGBScriptProperty cap, m_properties)
     {
@@ -326,6 +411,10 @@ bool RGBScript::setProperty(QString propertyName, QString value)
                 qWarning() << name() << "doesn't have a write function for" << propertyName;
                 return false;
             }
+            // cached maps are valid only for the current values
+            if (property(propertyName) != value)
+                clearMapsCache();
+
             QJSValueList args;
             args << value;
             writeMethod.call(args);
@@ -337,7 +426,7 @@ bool RGBScript::setProperty(QString propertyName, QString value)
 
 QString RGBScript::property(QString propertyName)
 {
-    QMutexLocker engineLocker(s_engineMutex);
+    QMutexLocker engineLocker(m_engine->m_mutex);
 
     foreach(RGBScriptProperty cap, m_properties)
     {
@@ -362,7 +451,7 @@ QString RGBScript::property(QString propertyName)
 
 bool RGBScript::loadProperties()
 {
-    QMutexLocker engineLocker(s_engineMutex);
+    QMutexLocker engineLocker(m_engine->m_mutex);
 
     QJSValue svCaps = m_script.property("properties");
     if (svCaps.isArray() == false)
@@ -22,6 +22,7 @@
 
 #include <QHash>
 #include <QJSValue>
+#include <QList>
 
 #include "rgbalgorithm.h"
 #include "rgbscriptproperty.h"
@@ -46,6 +47,10 @@ public:
     RGBScript(const RGBScript& s);
     ~RGBScript();
 
+    /** Assignment operator. The script is moved to the least used engine
+     *  of the pool and evaluated again, like in the copy constructor. */
+    RGBScript& operator=(const RGBScript& s);
+
     /** Comparison operator. Uses simply fileName() == s.fileName(). */
     bool operator==(const RGBScript& s) const;
 
@@ -66,12 +71,27 @@ public:
     bool evaluate();
 
 private:
-    /** Init engine, engine mutex, and scripts map */
-    static void initEngine();
+    /** An engine of the pool, shared by the scripts assigned to it */
+    typedef struct
+    {
+        QJSEngine *m_jsEngine;      //! The engine that runs the scripts
+        QMutex *m_mutex;            //! Protection
+        int m_scriptsCount;         //! Number of scripts assigned to the engine
+    } PooledEngine;
+
+    /** Assign the least used engine of the pool to this script */
+    void initEngine();
+
+    /** Give the engine of this script back to the pool */
+    void releaseEngine();
 
 private:
-    static QJSEngine* s_engine;      //! The engine that runs all scripts
-    static QMutex* s_engineMutex;   //! Protection
+    /** Up to QThread::idealThreadCount() engines, so that scripts
+     *  assigned to different engines can run concurrently */
+    static QList<PooledEngine *> s_enginePool;
+    static QMutex s_enginePoolMutex;
+
+    PooledEngine *m_engine;         //! The engine that runs this script
     QString m_fileName;             //! The file name that contains this script
     QString m_contents;             //! The file's contents
 
@@ -100,6 +120,9 @@ public:
     /** @reimp */
     int acceptColors() const;
 
+    /** @reimp */
+    bool isCacheable() const;
+
     /** @reimp */
     bool loadXML(QXmlStreamReader &root);
 
@@ -108,6 +131,7 @@ public:
 
 private:
     int m_apiVersion;           //! The API version that the script uses
+    bool m_cacheable;           //! rgbMap() is declared as a pure function
     QJSValue m_script;          //! The script itself
     QJSValue m_rgbMap;          //! rgbMap() function
     QJSValue m_rgbMapStepCount; //! rgbMapStepCount() function
@@ -69,6 +69,7 @@ RGBAlgorithm* RGBText::clone() const
 void RGBText::setText(const QString& str)
 {
     m_text = str;
+    clearMapsCache();
 }
 
 QString RGBText::text() const
@@ -79,6 +80,7 @@ QString RGBText::text() const
 void RGBText::setFont(const QFont& font)
 {
     m_font = font;
+    clearMapsCache();
 }
 
 QFont RGBText::font() const
@@ -96,6 +98,7 @@ void RGBText::setAnimationStyle(RGBText::AnimationStyle ani)
         m_animationStyle = ani;
     else
         m_animationStyle = StaticLetters;
+    clearMapsCache();
 }
 
 RGBText::AnimationStyle RGBText::animationStyle() const
@@ -139,6 +142,7 @@ QStringList RGBText::animationStyles()
 void RGBText::setXOffset(int offset)
 {
     m_xOffset = offset;
+    clearMapsCache();
 }
 
 int RGBText::xOffset() const
@@ -149,6 +153,7 @@ int RGBText::xOffset() const
 void RGBText::setYOffset(int offset)
 {
     m_yOffset = offset;
+    clearMapsCache();
 }
 
 int RGBText::yOffset() const
@@ -298,6 +303,11 @@ int RGBText::acceptColors() const
     return 2; // start and end colors accepted
 }
 
+bool RGBText::isCacheable() const
+{
+    return true;
+}
+
 bool RGBText::loadXML(QXmlStreamReader &root)
 {
     if (root.name() != KXMLQLCRGBAlgorithm)
@@ -116,6 +116,9 @@ public:
     /** @reimp */
     int acceptColors() const;
 
+    /** @reimp */
+    bool isCacheable() const;
+
     /** @reimp */
     bool loadXML(QXmlStreamReader &root);
 
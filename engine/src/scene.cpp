@@ -43,6 +43,8 @@
 Scene::Scene(Doc* doc) : Function(doc, Function::SceneType)
     , m_legacyFadeBus(Bus::invalid())
     , m_fader(NULL)
+    , m_compiledFader(doc)
+    , m_valuesChanged(true)
 {
     setName(tr("New Scene"));
 }
@@ -90,8 +92,12 @@ bool Scene::copyFrom(const Function* function)
     if (scene == NULL)
         return false;
 
-    m_values.clear();
-    m_values = scene->m_values;
+    {
+        QMutexLocker locker(&m_valueListMutex);
+        m_values.clear();
+        m_values = scene->m_values;
+        m_valuesChanged = true;
+    }
     m_fixtures.clear();
     m_fixtures = scene->m_fixtures;
     m_channelGroups.clear();
@@ -132,6 +138,9 @@ void Scene::setValue(const SceneValue& scv, bool blind, bool checkHTP)
             valChanged = true;
         }
 
+        if (valChanged)
+            m_valuesChanged = true;
+
         // if the scene is running, we must
         // update/add the changed channel
         if (blind == false && m_fader != NULL)
@@ -165,7 +174,8 @@ void Scene::unsetValue(quint32 fxi, quint32 ch)
 
     {
         QMutexLocker locker(&m_valueListMutex);
-        m_values.remove(SceneValue(fxi, ch, 0));
+        if (m_values.remove(SceneValue(fxi, ch, 0)) > 0)
+            m_valuesChanged = true;
     }
 
     emit changed(this->id());
@@ -267,7 +277,11 @@ QColor Scene::colorValue(quint32 fxi)
 
 void Scene::clear()
 {
-    m_values.clear();
+    {
+        QMutexLocker locker(&m_valueListMutex);
+        m_values.clear();
+        m_valuesChanged = true;
+    }
     m_fixtures.clear();
 }
 
@@ -330,6 +344,12 @@ void Scene::slotFixtureRemoved(quint32 fxi_id)
         }
     }
 
+    if (hasChanged)
+    {
+        QMutexLocker locker(&m_valueListMutex);
+        m_valuesChanged = true;
+    }
+
     if (removeFixture(fxi_id))
         hasChanged = true;
 
@@ -337,6 +357,16 @@ void Scene::slotFixtureRemoved(quint32 fxi_id)
         emit changed(this->id());
 }
 
+void Scene::slotFixtureChanged(quint32 fxi_id)
+{
+    // address, mode or channels may have changed
+    if (m_fixtures.contains(fxi_id))
+    {
+        QMutexLocker locker(&m_valueListMutex);
+        m_valuesChanged = true;
+    }
+}
+
 void Scene::addFixture(quint32 fixtureId)
 {
     if (m_fixtures.contains(fixtureId) == false)
@@ -541,6 +571,11 @@ void Scene::postLoad()
         if (fxi == NULL || fxi->channel(value.channel) == NULL)
             it.remove();
     }
+
+    // Compile the values now, so that the first start is as fast as the next ones
+    QMutexLocker locker(&m_valueListMutex);
+    m_valuesChanged = true;
+    compileValues();
 }
 
 /****************************************************************************
@@ -617,55 +652,39 @@ void Scene::write(MasterTimer* timer, QList<Universe*> ua)
     {
         QMutexLocker locker(&m_valueListMutex);
 
-        m_fader = new GenericFader(doc());
+        compileValues();
+
+        // the channels are resolved already, only the start values change
+        m_fader = new GenericFader(m_compiledFader);
         m_fader->adjustIntensity(getAttributeValue(Intensity));
         m_fader->setBlendMode(blendMode());
 
-        QMapIterator <SceneValue, uchar> it(m_values);
-        while (it.hasNext() == true)
-        {
-            SceneValue value(it.next().key());
-            bool canFade = true;
-
-            FadeChannel fc(doc(), value.fxi, value.channel);
-            Fixture *fixture = doc()->fixture(value.fxi);
-            if (fixture != NULL)
-                canFade = fixture->channelCanFade(value.channel);
+        uint fadeTime = overrideFadeInSpeed() == defaultSpeed() ? fadeInSpeed() : overrideFadeInSpeed();
 
-            fc.setTarget(value.value);
+        if (tempoType() == Beats)
+        {
+            int fadeInTime = beatsToTime(fadeTime, timer->beatTimeDuration());
+            int beatOffset = timer->nextBeatTimeOffset();
 
-            if (canFade == false)
-            {
-                fc.setFadeTime(0);
-            }
+            if (fadeInTime - beatOffset > 0)
+                fadeTime = fadeInTime - beatOffset;
             else
-            {
-                uint fadein = overrideFadeInSpeed() == defaultSpeed() ? fadeInSpeed() : overrideFadeInSpeed();
+                fadeTime = fadeInTime;
+        }
 
-                if (tempoType() == Beats)
-                {
-                    int fadeInTime = beatsToTime(fadein, timer->beatTimeDuration());
-                    int beatOffset = timer->nextBeatTimeOffset();
+        m_fader->setFadeTime(fadeTime);
 
-                    if (fadeInTime - beatOffset > 0)
-                        fc.setFadeTime(fadeInTime - beatOffset);
-                    else
-                        fc.setFadeTime(fadeInTime);
-                }
-                else
-                    fc.setFadeTime(fadein);
-            }
-            insertStartValue(fc, timer, ua);
-            m_fader->add(fc);
-        }
+        // fade from the values MasterTimer's fader is still fading out
+        QMutexLocker faderLocker(timer->faderMutex());
+        m_fader->setStartValues(timer->fader(), ua);
     }
 
-    //qDebug() << "[Scene] writing channels:" << m_fader->channels().count();
+    //qDebug() << "[Scene] writing channels:" << m_fader->count();
     // Run the internal GenericFader
     m_fader->write(ua, isPaused());
 
     // Fader has nothing to do. Stop.
-    if (m_fader->channels().size() == 0)
+    if (m_fader->count() == 0)
         stop(FunctionParent::master());
 
     if (isPaused() == false)
@@ -680,11 +699,8 @@ void Scene::postRun(MasterTimer* timer, QList<Universe *> ua)
 {
     if (m_fader != NULL)
     {
-        QHashIterator <FadeChannel,FadeChannel> it(m_fader->channels());
-        while (it.hasNext() == true)
+        foreach (FadeChannel fc, m_fader->channels())
         {
-            it.next();
-            FadeChannel fc = it.value();
             // fade out only intensity channels
             if (fc.group(doc()) != QLCChannel::Intensity)
                 continue;
@@ -724,30 +740,25 @@ void Scene::postRun(MasterTimer* timer, QList<Universe *> ua)
     Function::postRun(timer, ua);
 }
 
-void Scene::insertStartValue(FadeChannel& fc, const MasterTimer* timer,
-                             const QList<Universe*> ua)
+void Scene::compileValues()
 {
-    QMutexLocker channelsLocker(timer->faderMutex());
-    QHash <FadeChannel,FadeChannel> const& channels(timer->faderChannelsRef());
-    QHash <FadeChannel,FadeChannel>::const_iterator existing_it = channels.find(fc);
-    if (existing_it != channels.constEnd())
-    {
-        // MasterTimer's GenericFader contains the channel so grab its current
-        // value as the new starting value to get a smoother fade
-        fc.setStart(existing_it.value().current());
-        fc.setCurrent(fc.start());
-    }
-    else
+    if (m_valuesChanged == false)
+        return;
+
+    // the group and the fade capability are resolved here, once
+    m_compiledFader.removeAll();
+
+    QMapIterator <SceneValue, uchar> it(m_values);
+    while (it.hasNext() == true)
     {
-        // MasterTimer didn't have the channel. Grab the starting value from UniverseArray.
-        quint32 address = fc.address();
-        quint32 uni = fc.universe();
-        if (fc.group(doc()) != QLCChannel::Intensity)
-            fc.setStart(ua[uni]->preGMValue(address));
-        else
-            fc.setStart(0); // HTP channels must start at zero
-        fc.setCurrent(fc.start());
+        SceneValue value(it.next().key());
+
+        FadeChannel fc(doc(), value.fxi, value.channel);
+        fc.setTarget(value.value);
+        m_compiledFader.forceAdd(fc);
     }
+
+    m_valuesChanged = false;
 }
 
 /****************************************************************************
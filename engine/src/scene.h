@@ -21,6 +21,7 @@
 #ifndef SCENE_H
 #define SCENE_H
 
+#include <QVector>
 #include <QMutex>
 #include <QList>
 
@@ -190,6 +191,9 @@ protected:
 public slots:
     void slotFixtureRemoved(quint32 fxi_id);
 
+    /** Recompile the scene values when one of its fixtures changes */
+    void slotFixtureChanged(quint32 fxi_id);
+
 public:
     void addFixture(quint32 fixtureId);
     bool removeFixture(quint32 fixtureId);
@@ -241,12 +245,20 @@ public:
     void postRun(MasterTimer* timer, QList<Universe*> ua);
 
 private:
-    /** Insert starting values to $fc, either from $timer->fader() or $ua */
-    void insertStartValue(FadeChannel& fc, const MasterTimer* timer, const QList<Universe *> ua);
+    /** Resolve m_values into m_compiledFader if they have changed.
+     *  m_valueListMutex must be locked by the caller. */
+    void compileValues();
 
 private:
     GenericFader* m_fader;
 
+    /** The scene values resolved into fade channels, in the same order
+     *  of m_values. It is copied into m_fader when the scene starts */
+    GenericFader m_compiledFader;
+
+    /** Flag raised when m_compiledFader must be built again */
+    bool m_valuesChanged;
+
     /*********************************************************************
      * Attributes
      *********************************************************************/
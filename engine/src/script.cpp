@@ -677,8 +677,8 @@ QString Script::handleSetFixture(const QList<QStringList>& tokens, QList<Univers
                 // the bowels of GenericFader so get the starting value from there.
                 // Otherwise get it from universes (HTP channels are always 0 then).
                 quint32 uni = fc.universe();
-                if (gf->channels().contains(fc) == true)
-                    fc.setStart(gf->channels()[fc].current());
+                if (gf->contains(fc) == true)
+                    fc.setStart(gf->channel(fc).current());
                 else
                     fc.setStart(universes[uni]->preGMValue(address));
                 fc.setCurrent(fc.start());
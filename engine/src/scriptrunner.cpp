@@ -286,8 +286,8 @@ bool ScriptRunner::setFixture(quint32 fxID, quint32 channel, uchar value, uint t
     // the bowels of GenericFader so get the starting value from there.
     // Otherwise get it from universes (HTP channels are always 0 then).
     //quint32 uni = fc.universe();
-    if (gf->channels().contains(fc) == true)
-        fc.setStart(gf->channels()[fc].current());
+    if (gf->contains(fc) == true)
+        fc.setStart(gf->channel(fc).current());
     //else
     //    fc.setStart(universes[uni]->preGMValue(address)); // TODO ?
     fc.setCurrent(fc.start());
@@ -412,6 +412,12 @@ void Show::setPause(bool enable)
     Function::setPause(enable);
 }
 
+void Show::seek(quint32 time)
+{
+    if (m_runner != NULL)
+        m_runner->seek(time);
+}
+
 void Show::write(MasterTimer* timer, QList<Universe *> universes)
 {
     Q_UNUSED(universes);
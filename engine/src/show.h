@@ -153,6 +153,9 @@ public:
     /** @reimp */
     void setPause(bool enable);
 
+    /** Move the playback of a running Show to $time (in milliseconds) */
+    void seek(quint32 time);
+
     /** @reimp */
     void write(MasterTimer* timer, QList<Universe*> universes);
 
@@ -21,6 +21,7 @@
 #include <QDebug>
 
 #include "showrunner.h"
+#include "mastertimer.h"
 #include "chaserstep.h"
 #include "function.h"
 #include "chaser.h"
@@ -28,12 +29,21 @@
 #include "scene.h"
 #include "audio.h"
 #include "show.h"
+#include "doc.h"
 #if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
 #include "video.h"
 #endif
 
 #define TIMER_INTERVAL 50
 
+/** Fraction of the difference from the audio position corrected at each write */
+#define AUDIOSYNC_GAIN          0.05
+
+/** Beyond this difference in milliseconds the clock jumps to the audio position,
+ *  if the difference persists for AUDIOSYNC_JUMP_COUNT writes */
+#define AUDIOSYNC_MAX_DRIFT     500
+#define AUDIOSYNC_JUMP_COUNT    10
+
 static bool compareShowFunctions(const ShowFunction *sf1, const ShowFunction *sf2)
 {
     if (sf1->startTime() < sf2->startTime())
@@ -41,12 +51,39 @@ static bool compareShowFunctions(const ShowFunction *sf1, const ShowFunction *sf
     return false;
 }
 
+static bool compareStartTime(quint32 time, const ShowFunction *sf)
+{
+    return time < sf->startTime();
+}
+
+static bool compareStopTime(const QPair<Function *, quint32> &f1, const QPair<Function *, quint32> &f2)
+{
+    return f1.second < f2.second;
+}
+
+static quint32 stopTime(const ShowFunction *sf)
+{
+    return sf->startTime() + sf->duration();
+}
+
 ShowRunner::ShowRunner(const Doc* doc, quint32 showID, quint32 startTime)
     : QObject(NULL)
     , m_doc(doc)
     , m_elapsedTime(startTime)
     , m_totalRunTime(0)
     , m_currentFunctionIndex(0)
+    , m_startPosition(startTime)
+    , m_clockOrigin(0)
+    , m_pauseClockTime(0)
+    , m_paused(false)
+    , m_seekRequested(true)
+    , m_seekTime(startTime)
+    , m_seekToAudio(false)
+    , m_clockCorrection(0)
+    , m_audioSyncEnabled(true)
+    , m_syncAudio(NULL)
+    , m_syncFunction(NULL)
+    , m_syncDriftCount(0)
 {
     Q_ASSERT(m_doc != NULL);
     Q_ASSERT(showID != Show::invalidId());
@@ -65,19 +102,20 @@ ShowRunner::ShowRunner(const Doc* doc, quint32 showID, quint32 startTime)
         if (track->isMute())
             continue;
 
-        // get all the functions of the track and append them to the runner queue
+        // get all the functions of the track and append them to the runner queue.
+        // Functions ending before startTime are kept too, since the show can be
+        // moved back with seek()
         foreach(ShowFunction *sfunc, track->showFunctions())
         {
-            if (sfunc->startTime() + sfunc->duration() <= startTime)
-                continue;
             Function *f = m_doc->function(sfunc->functionID());
             if (f == NULL)
                 continue;
 
             m_functions.append(sfunc);
+            m_functionTracks[sfunc] = track->id();
 
-            if (sfunc->startTime() + sfunc->duration() > m_totalRunTime)
-                m_totalRunTime = sfunc->startTime() + sfunc->duration();
+            if (stopTime(sfunc) > m_totalRunTime)
+                m_totalRunTime = stopTime(sfunc);
         }
 
         // Initialize the intensity map
@@ -86,6 +124,9 @@ ShowRunner::ShowRunner(const Doc* doc, quint32 showID, quint32 startTime)
 
     qSort(m_functions.begin(), m_functions.end(), compareShowFunctions);
 
+    m_maxStopTimes.resize(m_functions.count());
+    buildIndex(0, m_functions.count());
+
 #if 1
     qDebug() << "Ordered list of ShowFunctions:";
     foreach (ShowFunction *sfunc, m_functions)
@@ -107,6 +148,22 @@ void ShowRunner::start()
 
 void ShowRunner::setPause(bool enable)
 {
+    {
+        QMutexLocker locker(&m_clockMutex);
+        if (enable != m_paused)
+        {
+            quint64 now = m_doc->masterTimer()->clockTime();
+
+            // the time spent in pause must not move the show position
+            if (enable)
+                m_pauseClockTime = now;
+            else
+                m_clockOrigin += now - m_pauseClockTime;
+
+            m_paused = enable;
+        }
+    }
+
     for (int i = 0; i < m_runningQueue.count(); i++)
     {
         Function *f = m_runningQueue.at(i).first;
@@ -125,76 +182,224 @@ void ShowRunner::stop()
     }
 
     m_runningQueue.clear();
+    m_syncAudio = NULL;
+    m_syncFunction = NULL;
     qDebug() << "ShowRunner stopped";
 }
 
+void ShowRunner::seek(quint32 time)
+{
+    QMutexLocker locker(&m_clockMutex);
+    m_seekTime = time;
+    m_seekRequested = true;
+    m_seekToAudio = false;
+}
+
 FunctionParent ShowRunner::functionParent() const
 {
     return FunctionParent(FunctionParent::Function, m_show->id());
 }
 
-void ShowRunner::write()
+quint32 ShowRunner::buildIndex(int lo, int hi)
 {
-    //qDebug() << Q_FUNC_INFO << "elapsed:" << m_elapsedTime << ", total:" << m_totalRunTime;
+    if (lo >= hi)
+        return 0;
 
-    // Phase 1. Check all the Functions that need to be started
-    // m_functions is ordered by startup time, so when we found an entry
-    // with start time greater than m_elapsed, this phase is over
-    bool startupDone = false;
+    int mid = (lo + hi) / 2;
+    quint32 maxStop = qMax(stopTime(m_functions.at(mid)),
+                           qMax(buildIndex(lo, mid), buildIndex(mid + 1, hi)));
+    m_maxStopTimes[mid] = maxStop;
+
+    return maxStop;
+}
+
+void ShowRunner::activeFunctions(int lo, int hi, quint32 time, QList<ShowFunction *> &list) const
+{
+    if (lo >= hi)
+        return;
+
+    int mid = (lo + hi) / 2;
+
+    // nothing in this subtree is still running at $time
+    if (m_maxStopTimes.at(mid) <= time)
+        return;
+
+    activeFunctions(lo, mid, time, list);
+
+    // the right subtree starts even later than this node
+    ShowFunction *sf = m_functions.at(mid);
+    if (sf->startTime() > time)
+        return;
+
+    if (stopTime(sf) > time)
+        list.append(sf);
 
-    while(startupDone == false)
+    activeFunctions(mid + 1, hi, time, list);
+}
+
+void ShowRunner::startFunction(ShowFunction *sf, quint32 timeOffset)
+{
+    Function *f = m_doc->function(sf->functionID());
+    if (f == NULL)
+        return;
+
+    int intOverrideId = f->requestAttributeOverride(Function::Intensity,
+                                                    m_intensityMap[m_functionTracks.value(sf)]);
+    sf->setIntensityOverrideId(intOverrideId);
+
+    f->start(m_doc->masterTimer(), functionParent(), timeOffset);
+
+    // the first audio started becomes the reference of the clock
+    if (m_syncAudio == NULL && f->type() == Function::AudioType)
     {
-        if (m_currentFunctionIndex == m_functions.count())
-            break;
+        m_syncAudio = qobject_cast<Audio *>(f);
+        m_syncFunction = sf;
+        m_syncDriftCount = 0;
+    }
 
-        ShowFunction *sf = m_functions.at(m_currentFunctionIndex);
-        quint32 funcStartTime = sf->startTime();
-        quint32 functionTimeOffset = 0;
-        Function *f = m_doc->function(sf->functionID());
+    // keep the running queue ordered by stop time
+    QPair<Function *, quint32> entry(f, stopTime(sf));
+    m_runningQueue.insert(qUpperBound(m_runningQueue.begin(), m_runningQueue.end(),
+                                      entry, compareStopTime), entry);
+}
 
-        // this should happen only when a Show is not started from 0
-        if (m_elapsedTime > funcStartTime)
-        {
-            functionTimeOffset = m_elapsedTime - funcStartTime;
-            funcStartTime = m_elapsedTime;
-        }
-        if (m_elapsedTime >= funcStartTime)
+void ShowRunner::applySeek(quint32 time, Function *keepRunning)
+{
+    // functions starting after $time are left to write()
+    m_currentFunctionIndex = qUpperBound(m_functions.begin(), m_functions.end(),
+                                         time, compareStartTime) - m_functions.begin();
+
+    // the index is an implicit tree over all the functions, so it must
+    // be searched as a whole. The start times prune the later ones
+    QList<ShowFunction *> active;
+    activeFunctions(0, m_functions.count(), time, active);
+
+    // the functions still active at $time keep running, except the media
+    // ones, which can be moved to the new position only by a restart
+    QList < QPair<Function *, quint32> > keptQueue;
+    for (int i = 0; i < m_runningQueue.count(); i++)
+    {
+        Function *f = m_runningQueue.at(i).first;
+        quint32 fStopTime = m_runningQueue.at(i).second;
+        ShowFunction *keptSf = NULL;
+
+        if (f == keepRunning ||
+            (f->type() != Function::AudioType && f->type() != Function::VideoType))
         {
-            foreach (Track *track, m_show->tracks())
+            foreach (ShowFunction *sf, active)
             {
-                if (track->showFunctions().contains(sf))
+                if (sf->functionID() == f->id() && stopTime(sf) == fStopTime)
                 {
-                    int intOverrideId = f->requestAttributeOverride(Function::Intensity, m_intensityMap[track->id()]);
-                    //f->adjustAttribute(m_intensityMap[track->id()], Function::Intensity);
-                    sf->setIntensityOverrideId(intOverrideId);
+                    keptSf = sf;
                     break;
                 }
             }
+        }
 
-            f->start(m_doc->masterTimer(), functionParent(), functionTimeOffset);
-            m_runningQueue.append(QPair<Function *, quint32>(f, sf->startTime() + sf->duration()));
-            m_currentFunctionIndex++;
+        if (keptSf != NULL)
+        {
+            active.removeOne(keptSf);
+            keptQueue.append(m_runningQueue.at(i));
         }
         else
-            startupDone = true;
+        {
+            f->stop(functionParent());
+            if (f == m_syncAudio)
+            {
+                m_syncAudio = NULL;
+                m_syncFunction = NULL;
+            }
+        }
+    }
+
+    // a subset of an ordered queue is still ordered by stop time
+    m_runningQueue = keptQueue;
+
+    foreach (ShowFunction *sf, active)
+        startFunction(sf, time - sf->startTime());
+}
+
+/************************************************************************
+ * Clock
+ ************************************************************************/
+
+quint32 ShowRunner::clockPosition() const
+{
+    QMutexLocker locker(&m_clockMutex);
+    quint64 now = m_paused ? m_pauseClockTime : m_doc->masterTimer()->clockTime();
+
+    qint64 position = qint64(m_startPosition) + qint64(now - m_clockOrigin) + qRound64(m_clockCorrection);
+
+    return quint32(qMax(qint64(0), position));
+}
+
+void ShowRunner::write()
+{
+    //qDebug() << Q_FUNC_INFO << "elapsed:" << m_elapsedTime << ", total:" << m_totalRunTime;
+
+    bool seekRequested;
+    bool seekToAudio;
+    quint32 seekTime;
+
+    // the audio might request a seek to its position
+    if (m_audioSyncEnabled && m_syncAudio != NULL)
+        syncToAudio(clockPosition());
+
+    {
+        QMutexLocker locker(&m_clockMutex);
+        seekRequested = m_seekRequested;
+        seekToAudio = m_seekToAudio;
+        seekTime = m_seekTime;
+
+        if (m_seekRequested)
+        {
+            // restart the clock from the requested position
+            m_startPosition = m_seekTime;
+            m_clockOrigin = m_paused ? m_pauseClockTime : m_doc->masterTimer()->clockTime();
+            m_clockCorrection = 0;
+            m_seekRequested = false;
+            m_seekToAudio = false;
+        }
+    }
+
+    // when following the audio, the audio itself is already there
+    if (seekRequested)
+        applySeek(seekTime, seekToAudio ? m_syncAudio : NULL);
+
+    // the show position is absolute, so late ticks don't make the show drift
+    m_elapsedTime = clockPosition();
+
+    // Phase 1. Check all the Functions that need to be started
+    // m_functions is ordered by startup time, so when we found an entry
+    // with start time greater than m_elapsed, this phase is over
+    while (m_currentFunctionIndex < m_functions.count())
+    {
+        ShowFunction *sf = m_functions.at(m_currentFunctionIndex);
+        if (sf->startTime() > m_elapsedTime)
+            break;
+
+        m_currentFunctionIndex++;
+
+        // the clock might have jumped over the whole function
+        if (stopTime(sf) <= m_elapsedTime)
+            continue;
+
+        startFunction(sf, m_elapsedTime - sf->startTime());
     }
 
     // Phase 2. Check if we need to stop some running Functions
-    // It is done in reverse order for two reasons:
-    // 1- m_runningQueue is not ordered by stop time
-    // 2- to avoid messing up with indices when an entry is removed
-    for(int i = m_runningQueue.count() - 1; i >= 0; i--)
+    // m_runningQueue is ordered by stop time, so when we found an entry
+    // with stop time greater than m_elapsed, this phase is over
+    while (m_runningQueue.isEmpty() == false &&
+           m_elapsedTime >= m_runningQueue.first().second)
     {
-        Function *func = m_runningQueue.at(i).first;
-        quint32 stopTime = m_runningQueue.at(i).second;
+        Function *func = m_runningQueue.takeFirst().first;
+        func->stop(functionParent());
 
-        // if we passed the function stop time
-        if (m_elapsedTime >= stopTime)
+        if (func == m_syncAudio)
         {
-            // stop the function
-            func->stop(functionParent());
-            // remove it from the running queue
-            m_runningQueue.removeAt(i);
+            m_syncAudio = NULL;
+            m_syncFunction = NULL;
         }
     }
 
@@ -207,10 +412,61 @@ void ShowRunner::write()
         return;
     }
 
-    m_elapsedTime += MasterTimer::tick();
     emit timeChanged(m_elapsedTime);
 }
 
+/************************************************************************
+ * Audio synchronization
+ ************************************************************************/
+
+void ShowRunner::setAudioSyncEnabled(bool enable)
+{
+    m_audioSyncEnabled = enable;
+}
+
+bool ShowRunner::audioSyncEnabled() const
+{
+    return m_audioSyncEnabled;
+}
+
+void ShowRunner::syncToAudio(quint32 position)
+{
+    qint64 audioPosition = m_syncAudio->playbackPosition();
+
+    // the audio device has not played anything yet
+    if (audioPosition < 0)
+        return;
+
+    double drift = double(m_syncFunction->startTime() + audioPosition) - double(position);
+
+    QMutexLocker locker(&m_clockMutex);
+
+    if (m_paused || m_seekRequested)
+        return;
+
+    if (qAbs(drift) > AUDIOSYNC_MAX_DRIFT)
+    {
+        // a stalled device or a renderer still playing the position
+        // before a seek: jump only if the difference persists
+        if (++m_syncDriftCount >= AUDIOSYNC_JUMP_COUNT)
+        {
+            qDebug() << "[ShowRunner] jumping" << drift << "ms to follow the audio";
+            m_seekTime = quint32(qMax(qint64(0), qint64(m_syncFunction->startTime()) + audioPosition));
+            m_seekRequested = true;
+            m_seekToAudio = true;
+            m_syncDriftCount = 0;
+        }
+        return;
+    }
+
+    m_syncDriftCount = 0;
+
+    // slew the clock smoothly, never faster than a quarter of a tick, so
+    // that the show time doesn't move back and the lights don't stutter
+    double maxStep = MasterTimer::tick() / 4.0;
+    m_clockCorrection += qBound(-maxStep, drift * AUDIOSYNC_GAIN, maxStep);
+}
+
 /************************************************************************
  * Intensity
  ************************************************************************/
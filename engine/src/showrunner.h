@@ -21,13 +21,16 @@
 #define SHOWRUNNER_H
 
 #include <QObject>
+#include <QVector>
 #include <QMutex>
+#include <QHash>
 #include <QMap>
 
 #include <function.h>
 
 class ShowFunction;
 class Function;
+class Audio;
 class Track;
 class Show;
 class Doc;
@@ -53,6 +56,15 @@ public:
     /** Stop the runner */
     void stop();
 
+    /**
+     * Move the playback position to $time (in milliseconds). The request is
+     * applied at the next write(): the functions still active at $time keep
+     * running, the other ones are stopped, and the ones becoming active
+     * are started with the right time offset. Audio and Video functions
+     * are always restarted, to move their playback to $time.
+     */
+    void seek(quint32 time);
+
     void write();
 
 private:
@@ -61,21 +73,49 @@ private:
     /** The reference of the show to play */
     Show* m_show;
 
-    /** The list of Functions of the show to play */
+    /** The list of Functions of the show to play, ordered by start time */
     QList <ShowFunction *> m_functions;
 
+    /** The ID of the Track of each item of m_functions */
+    QHash <ShowFunction *, quint32> m_functionTracks;
+
+    /**
+     * Interval index of m_functions. m_functions is seen as an implicit
+     * balanced binary tree, where the node of the range [lo, hi) is the
+     * middle item. Each entry holds the maximum stop time of the subtree
+     * rooted at the same index of m_functions.
+     */
+    QVector <quint32> m_maxStopTimes;
+
     /** Elapsed time since runner start. Used also to move the cursor in MultiTrackView */
     quint32 m_elapsedTime;
 
     /** Total time the runner has to run */
     quint32 m_totalRunTime;
 
-    /** List of the currently running Functions and their stop time */
+    /** List of the currently running Functions and their stop time, ordered by stop time */
     QList < QPair<Function *, quint32> > m_runningQueue;
 
     /** Index of the item in m_functions to be considered for playback */
     int m_currentFunctionIndex;
 
+private:
+    /** Fill m_maxStopTimes for the range [lo, hi) and return its maximum stop time */
+    quint32 buildIndex(int lo, int hi);
+
+    /** Append to $list the functions in the range [lo, hi) running at $time.
+     *  The range must be one built by buildIndex, as its midpoints are the
+     *  nodes of the tree: use [0, m_functions.count()) */
+    void activeFunctions(int lo, int hi, quint32 time, QList <ShowFunction *> &list) const;
+
+    /** Start $sf skipping the first $timeOffset milliseconds */
+    void startFunction(ShowFunction *sf, quint32 timeOffset);
+
+    /** Stop the running functions not active at $time and start the
+     *  missing ones, keeping the others running. Media functions are
+     *  restarted at the new position, except $keepRunning */
+    void applySeek(quint32 time, Function *keepRunning = NULL);
+
 private:
     FunctionParent functionParent() const;
 
@@ -83,6 +123,73 @@ signals:
     void timeChanged(quint32 time);
     void showFinished();
 
+    /************************************************************************
+     * Clock
+     ************************************************************************/
+private:
+    /** Get the show time corresponding to the current MasterTimer clock time */
+    quint32 clockPosition() const;
+
+private:
+    /** Mutex guarding the clock members below */
+    mutable QMutex m_clockMutex;
+
+    /** Show time at m_clockOrigin */
+    quint32 m_startPosition;
+
+    /** MasterTimer clock time when the show was at m_startPosition */
+    quint64 m_clockOrigin;
+
+    /** MasterTimer clock time when the runner has been paused */
+    quint64 m_pauseClockTime;
+
+    /** Flag set when the runner is paused */
+    bool m_paused;
+
+    /** Flag set when a seek has been requested and not applied yet */
+    bool m_seekRequested;
+
+    /** The requested seek position */
+    quint32 m_seekTime;
+
+    /** Flag set when the seek follows m_syncAudio, which keeps playing */
+    bool m_seekToAudio;
+
+    /** Milliseconds added to the MasterTimer clock to follow the audio */
+    double m_clockCorrection;
+
+    /************************************************************************
+     * Audio synchronization
+     ************************************************************************/
+public:
+    /**
+     * Enable or disable slaving the show clock to the position of the
+     * audio being played. When enabled (the default), the first Audio
+     * function started by the show becomes the reference, and the clock
+     * is slowly corrected towards its playback position, so the show
+     * doesn't drift from the music on long songs.
+     */
+    void setAudioSyncEnabled(bool enable);
+
+    /** Return true if the show clock follows the audio */
+    bool audioSyncEnabled() const;
+
+private:
+    /** Correct the clock towards the position of m_syncAudio, given the
+     *  current show $position. A persistent large difference requests a
+     *  seek to the audio position */
+    void syncToAudio(quint32 position);
+
+private:
+    bool m_audioSyncEnabled;
+
+    /** The Audio function the clock follows, and its show item */
+    Audio *m_syncAudio;
+    ShowFunction *m_syncFunction;
+
+    /** Number of consecutive writes with the audio too far to be slewed */
+    int m_syncDriftCount;
+
     /************************************************************************
      * Intensity
      ************************************************************************/
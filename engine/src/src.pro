@@ -64,7 +64,9 @@ greaterThan(QT_MAJOR_VERSION, 4) {
 }
 
 # Engine
-HEADERS += bus.h \
+HEADERS += bakedshow.h \
+           bakedstream.h \
+           bus.h \
            channelsgroup.h \
            channelmodifier.h \
            chaser.h \
@@ -75,6 +77,7 @@ HEADERS += bus.h \
            cuestack.h \
            doc.h \
            dmxdumpfactoryproperties.h \
+           dmxrecorder.h \
            dmxsource.h \
            efx.h \
            efxfixture.h \
@@ -93,6 +96,7 @@ HEADERS += bus.h \
            mastertimer.h \
            monitorproperties.h \
            outputpatch.h \
+           parallelfunctionwriter.h \
            qlcclipboard.h \
            qlcpoint.h \
            rgbalgorithm.h \
@@ -110,6 +114,8 @@ HEADERS += bus.h \
            show.h \
            showfunction.h \
            showrunner.h \
+           tickprofiler.h \
+           universesnapshot.h \
            track.h \
            universe.h
 
@@ -143,7 +149,9 @@ greaterThan(QT_MAJOR_VERSION, 4) {
 }
 
 # Engine
-SOURCES += bus.cpp \
+SOURCES += bakedshow.cpp \
+           bakedstream.cpp \
+           bus.cpp \
            channelsgroup.cpp \
            channelmodifier.cpp \
            chaser.cpp \
@@ -154,6 +162,7 @@ SOURCES += bus.cpp \
            cuestack.cpp \
            doc.cpp \
            dmxdumpfactoryproperties.cpp \
+           dmxrecorder.cpp \
            efx.cpp \
            efxfixture.cpp \
            fadechannel.cpp \
@@ -171,6 +180,7 @@ SOURCES += bus.cpp \
            mastertimer.cpp \
            monitorproperties.cpp \
            outputpatch.cpp \
+           parallelfunctionwriter.cpp \
            qlcclipboard.cpp \
            qlcpoint.cpp \
            rgbalgorithm.cpp \
@@ -186,6 +196,8 @@ SOURCES += bus.cpp \
            show.cpp \
            showfunction.cpp \
            showrunner.cpp \
+           tickprofiler.cpp \
+           universesnapshot.cpp \
            track.cpp \
            universe.cpp
 
@@ -0,0 +1,289 @@
+/*
+  Q Light Controller Plus
+  tickprofiler.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QMutexLocker>
+#include <QObject>
+#include <algorithm>
+
+#include "tickprofiler.h"
+
+/****************************************************************************
+ * RollingStatistics
+ ****************************************************************************/
+
+RollingStatistics::RollingStatistics()
+    : m_samples(TICKPROFILER_SAMPLES, 0)
+    , m_count(0)
+    , m_next(0)
+{
+}
+
+void RollingStatistics::add(quint32 value)
+{
+    m_samples[m_next] = value;
+    m_next = (m_next + 1) % m_samples.size();
+    if (m_count < m_samples.size())
+        m_count++;
+}
+
+void RollingStatistics::clear()
+{
+    m_count = 0;
+    m_next = 0;
+}
+
+TickStatistics RollingStatistics::statistics() const
+{
+    TickStatistics stats;
+    stats.m_p50 = stats.m_p99 = stats.m_max = 0;
+    stats.m_samples = m_count;
+
+    if (m_count == 0)
+        return stats;
+
+    QVector<quint32> sorted = m_samples.mid(0, m_count);
+    std::sort(sorted.begin(), sorted.end());
+
+    stats.m_p50 = sorted.at(((m_count - 1) * 50) / 100);
+    stats.m_p99 = sorted.at(((m_count - 1) * 99) / 100);
+    stats.m_max = sorted.last();
+
+    return stats;
+}
+
+/****************************************************************************
+ * TickProfiler
+ ****************************************************************************/
+
+TickProfiler::TickProfiler()
+    : m_tickStart(0)
+    , m_phaseStart(0)
+    , m_tickDuration(0)
+    , m_currentJitter(0)
+    , m_ticksCount(0)
+    , m_lateTicksCount(0)
+{
+    for (int i = 0; i < PhasesCount; i++)
+        m_currentPhases[i] = 0;
+
+    m_clock.start();
+}
+
+TickProfiler::~TickProfiler()
+{
+    qDeleteAll(m_functions);
+    qDeleteAll(m_sources);
+}
+
+QString TickProfiler::phaseToString(TickProfiler::Phase phase)
+{
+    switch (phase)
+    {
+        case BeatPhase: return QObject::tr("Beats");
+        case InputPhase: return QObject::tr("Input flush");
+        case FunctionsPhase: return QObject::tr("Functions");
+        case DMXSourcesPhase: return QObject::tr("DMX sources");
+        case FaderPhase: return QObject::tr("Fader");
+        case DumpPhase: return QObject::tr("Universes dump");
+        case TotalPhase: return QObject::tr("Total");
+        default: break;
+    }
+
+    return QString();
+}
+
+void TickProfiler::reset()
+{
+    QMutexLocker locker(&m_mutex);
+
+    m_ticksCount = 0;
+    m_lateTicksCount = 0;
+    for (int i = 0; i < PhasesCount; i++)
+        m_phases[i].clear();
+    m_jitter.clear();
+    qDeleteAll(m_functions);
+    m_functions.clear();
+    qDeleteAll(m_sources);
+    m_sources.clear();
+}
+
+quint32 TickProfiler::toMicroseconds(qint64 ns)
+{
+    if (ns < 0)
+        return 0;
+
+    return quint32(ns / 1000);
+}
+
+/****************************************************************************
+ * Recording
+ ****************************************************************************/
+
+qint64 TickProfiler::timestamp() const
+{
+    return m_clock.nsecsElapsed();
+}
+
+void TickProfiler::beginTick(qint64 tickDuration, qint64 scheduledTime)
+{
+    m_tickStart = timestamp();
+    m_phaseStart = m_tickStart;
+    m_tickDuration = tickDuration;
+    m_currentJitter = toMicroseconds(qAbs(m_tickStart - scheduledTime));
+
+    m_functionSamples.resize(0);
+    m_sourceSamples.resize(0);
+}
+
+void TickProfiler::endPhase(TickProfiler::Phase phase)
+{
+    qint64 now = timestamp();
+    m_currentPhases[phase] = toMicroseconds(now - m_phaseStart);
+    m_phaseStart = now;
+}
+
+void TickProfiler::addFunctionCost(quint32 id, qint64 start)
+{
+    addFunctionDuration(id, timestamp() - start);
+}
+
+void TickProfiler::addFunctionDuration(quint32 id, qint64 duration)
+{
+    CostSample sample;
+    sample.m_key = NULL;
+    sample.m_id = id;
+    sample.m_duration = toMicroseconds(duration);
+    m_functionSamples.append(sample);
+}
+
+void TickProfiler::addDMXSourceCost(const DMXSource *source, qint64 start)
+{
+    CostSample sample;
+    sample.m_key = source;
+    sample.m_id = 0;
+    sample.m_duration = toMicroseconds(timestamp() - start);
+    m_sourceSamples.append(sample);
+}
+
+void TickProfiler::endTick()
+{
+    qint64 total = timestamp() - m_tickStart;
+    m_currentPhases[TotalPhase] = toMicroseconds(total);
+
+    QMutexLocker locker(&m_mutex);
+
+    m_ticksCount++;
+    if (total > m_tickDuration)
+        m_lateTicksCount++;
+
+    for (int i = 0; i < PhasesCount; i++)
+        m_phases[i].add(m_currentPhases[i]);
+    m_jitter.add(m_currentJitter);
+
+    // a function can be written more than once per tick (e.g. restarted),
+    // so its samples are simply added to the ring
+    foreach (CostSample sample, m_functionSamples)
+    {
+        RollingStatistics *stats = m_functions.value(sample.m_id, NULL);
+        if (stats == NULL)
+        {
+            stats = new RollingStatistics();
+            m_functions[sample.m_id] = stats;
+        }
+        stats->add(sample.m_duration);
+    }
+
+    foreach (CostSample sample, m_sourceSamples)
+    {
+        const DMXSource *source = static_cast<const DMXSource *>(sample.m_key);
+        RollingStatistics *stats = m_sources.value(source, NULL);
+        if (stats == NULL)
+        {
+            stats = new RollingStatistics();
+            m_sources[source] = stats;
+        }
+        stats->add(sample.m_duration);
+    }
+}
+
+void TickProfiler::removeDMXSource(const DMXSource *source)
+{
+    QMutexLocker locker(&m_mutex);
+    delete m_sources.take(source);
+}
+
+/****************************************************************************
+ * Statistics
+ ****************************************************************************/
+
+quint64 TickProfiler::ticksCount()
+{
+    QMutexLocker locker(&m_mutex);
+    return m_ticksCount;
+}
+
+quint64 TickProfiler::lateTicksCount()
+{
+    QMutexLocker locker(&m_mutex);
+    return m_lateTicksCount;
+}
+
+TickStatistics TickProfiler::phaseStatistics(TickProfiler::Phase phase)
+{
+    QMutexLocker locker(&m_mutex);
+    return m_phases[phase].statistics();
+}
+
+TickStatistics TickProfiler::jitterStatistics()
+{
+    QMutexLocker locker(&m_mutex);
+    return m_jitter.statistics();
+}
+
+QList<quint32> TickProfiler::functions()
+{
+    QMutexLocker locker(&m_mutex);
+    return m_functions.keys();
+}
+
+TickStatistics TickProfiler::functionStatistics(quint32 id)
+{
+    QMutexLocker locker(&m_mutex);
+    RollingStatistics *stats = m_functions.value(id, NULL);
+    if (stats == NULL)
+        return RollingStatistics().statistics();
+
+    return stats->statistics();
+}
+
+QList<const DMXSource *> TickProfiler::dmxSources()
+{
+    QMutexLocker locker(&m_mutex);
+    return m_sources.keys();
+}
+
+TickStatistics TickProfiler::dmxSourceStatistics(const DMXSource *source)
+{
+    QMutexLocker locker(&m_mutex);
+    RollingStatistics *stats = m_sources.value(source, NULL);
+    if (stats == NULL)
+        return RollingStatistics().statistics();
+
+    return stats->statistics();
+}
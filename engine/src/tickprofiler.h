@@ -0,0 +1,199 @@
+/*
+  Q Light Controller Plus
+  tickprofiler.h
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef TICKPROFILER_H
+#define TICKPROFILER_H
+
+#include <QElapsedTimer>
+#include <QString>
+#include <QVector>
+#include <QMutex>
+#include <QHash>
+#include <QList>
+
+class DMXSource;
+
+/** @addtogroup engine Engine
+ * @{
+ */
+
+/** Number of samples kept by each rolling statistic */
+#define TICKPROFILER_SAMPLES 500
+
+/** Percentiles and maximum of a rolling statistic, in microseconds */
+typedef struct
+{
+    quint32 m_p50;
+    quint32 m_p99;
+    quint32 m_max;
+    quint32 m_samples;
+} TickStatistics;
+
+/**
+ * A fixed size ring of samples, used to compute percentiles
+ * of the last TICKPROFILER_SAMPLES recorded values
+ */
+class RollingStatistics
+{
+public:
+    RollingStatistics();
+
+    /** Add a new sample, dropping the oldest one if the ring is full */
+    void add(quint32 value);
+
+    /** Remove all the samples */
+    void clear();
+
+    /** Compute percentiles and maximum of the current samples */
+    TickStatistics statistics() const;
+
+private:
+    QVector<quint32> m_samples;
+    int m_count;
+    int m_next;
+};
+
+/**
+ * TickProfiler measures where the time of each MasterTimer tick goes.
+ * MasterTimer marks the end of each phase of a tick and the cost of each
+ * Function and DMXSource write. Samples are collected by the timer thread
+ * without locking, and committed once per tick so that statistics can be
+ * read from any other thread.
+ */
+class TickProfiler
+{
+public:
+    TickProfiler();
+    ~TickProfiler();
+
+    enum Phase
+    {
+        BeatPhase = 0,
+        InputPhase,
+        FunctionsPhase,
+        DMXSourcesPhase,
+        FaderPhase,
+        DumpPhase,
+        TotalPhase,
+        PhasesCount
+    };
+
+    /** Get a human readable name of the given phase */
+    static QString phaseToString(Phase phase);
+
+    /** Clear all the collected statistics */
+    void reset();
+
+    /*********************************************************************
+     * Recording (MasterTimer thread)
+     *********************************************************************/
+public:
+    /** Get the current profiler time in nanoseconds */
+    qint64 timestamp() const;
+
+    /**
+     * Mark the start of a tick.
+     *
+     * @param tickDuration The expected duration of a tick in nanoseconds
+     * @param scheduledTime The time (see timestamp()) MasterTimer scheduled
+     *        the tick at, from which the tick start delay is measured
+     */
+    void beginTick(qint64 tickDuration, qint64 scheduledTime);
+
+    /** Mark the end of the given phase, which is also the start of the next one */
+    void endPhase(Phase phase);
+
+    /** Record the write cost of the Function with the given $id, since $start */
+    void addFunctionCost(quint32 id, qint64 start);
+
+    /** Record a Function write cost, measured elsewhere, in nanoseconds */
+    void addFunctionDuration(quint32 id, qint64 duration);
+
+    /** Record the write cost of the given DMXSource, since $start */
+    void addDMXSourceCost(const DMXSource *source, qint64 start);
+
+    /** Mark the end of a tick and commit its samples */
+    void endTick();
+
+    /** Forget the statistics of a DMXSource that is going to be deleted */
+    void removeDMXSource(const DMXSource *source);
+
+    /*********************************************************************
+     * Statistics (any thread)
+     *********************************************************************/
+public:
+    /** Get the number of profiled ticks */
+    quint64 ticksCount();
+
+    /** Get the number of ticks that took longer than the tick duration */
+    quint64 lateTicksCount();
+
+    /** Get the statistics of a tick phase */
+    TickStatistics phaseStatistics(Phase phase);
+
+    /** Get the statistics of the tick start delay from its schedule */
+    TickStatistics jitterStatistics();
+
+    /** Get the IDs of the profiled functions */
+    QList<quint32> functions();
+
+    /** Get the write cost statistics of the Function with the given $id */
+    TickStatistics functionStatistics(quint32 id);
+
+    /** Get the profiled DMX sources */
+    QList<const DMXSource *> dmxSources();
+
+    /** Get the write cost statistics of the given DMXSource */
+    TickStatistics dmxSourceStatistics(const DMXSource *source);
+
+private:
+    typedef struct
+    {
+        const void *m_key;
+        quint32 m_id;
+        quint32 m_duration;
+    } CostSample;
+
+    static quint32 toMicroseconds(qint64 ns);
+
+private:
+    QElapsedTimer m_clock;
+
+    /** Values of the tick in progress, owned by the MasterTimer thread */
+    qint64 m_tickStart;
+    qint64 m_phaseStart;
+    qint64 m_tickDuration;
+    quint32 m_currentJitter;
+    quint32 m_currentPhases[PhasesCount];
+    QVector<CostSample> m_functionSamples;
+    QVector<CostSample> m_sourceSamples;
+
+    /** Committed statistics, guarded by m_mutex */
+    QMutex m_mutex;
+    quint64 m_ticksCount;
+    quint64 m_lateTicksCount;
+    RollingStatistics m_phases[PhasesCount];
+    RollingStatistics m_jitter;
+    QHash<quint32, RollingStatistics *> m_functions;
+    QHash<const DMXSource *, RollingStatistics *> m_sources;
+};
+
+/** @} */
+
+#endif
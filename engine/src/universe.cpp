@@ -46,6 +46,11 @@ Universe::Universe(quint32 id, GrandMaster *gm, QObject *parent)
     , m_grandMaster(gm)
     , m_passthrough(false)
     , m_monitor(false)
+    , m_sendOnChange(false)
+    , m_keepAliveInterval(UNIVERSE_KEEPALIVE_INTERVAL)
+    , m_dirtyStart(UNIVERSE_SIZE)
+    , m_dirtyEnd(0)
+    , m_tablesChanged(1)
     , m_inputPatch(NULL)
     , m_fbPatch(NULL)
     , m_channelsMask(new QByteArray(UNIVERSE_SIZE, char(0)))
@@ -58,14 +63,17 @@ Universe::Universe(quint32 id, GrandMaster *gm, QObject *parent)
     , m_postGMValues(new QByteArray(UNIVERSE_SIZE, char(0)))
     , m_lastPostGMValues(new QByteArray(UNIVERSE_SIZE, char(0)))
     , m_passthroughValues()
+    , m_deferredWrites(NULL)
 {
     m_relativeValues.fill(0, UNIVERSE_SIZE);
     m_modifiers.fill(NULL, UNIVERSE_SIZE);
+    m_channelTables.fill(0, UNIVERSE_SIZE);
 
     m_name = QString("Universe %1").arg(id + 1);
 
-    connect(m_grandMaster, SIGNAL(valueChanged(uchar)),
-            this, SLOT(slotGMValueChanged()));
+    if (m_grandMaster != NULL)
+        connect(m_grandMaster, SIGNAL(valueChanged(uchar)),
+                this, SLOT(slotGMValueChanged()));
 }
 
 Universe::~Universe()
@@ -116,6 +124,8 @@ ushort Universe::totalChannels()
 
 bool Universe::hasChanged()
 {
+    updatePostGMValues();
+
     bool changed =
         memcmp(m_lastPostGMValues->constData(), m_postGMValues->constData(), m_usedChannels) != 0;
     if (changed)
@@ -155,6 +165,35 @@ bool Universe::passthrough() const
     return m_passthrough;
 }
 
+void Universe::setSendOnChange(bool enable)
+{
+    if (enable == m_sendOnChange)
+        return;
+
+    qDebug() << "Set universe" << id() << "send-on-change to" << enable;
+    m_sendOnChange = enable;
+    emit sendOnChangeChanged();
+}
+
+bool Universe::sendOnChange() const
+{
+    return m_sendOnChange;
+}
+
+void Universe::setKeepAliveInterval(uint ms)
+{
+    if (ms == m_keepAliveInterval)
+        return;
+
+    m_keepAliveInterval = ms;
+    emit keepAliveIntervalChanged();
+}
+
+uint Universe::keepAliveInterval() const
+{
+    return m_keepAliveInterval;
+}
+
 void Universe::setMonitor(bool enable)
 {
     m_monitor = enable;
@@ -167,22 +206,8 @@ bool Universe::monitor() const
 
 void Universe::slotGMValueChanged()
 {
-    {
-        for (int i = 0; i < m_intensityChannels.size(); ++i)
-        {
-            int channel = m_intensityChannels.at(i);
-            updatePostGMValue(channel);
-        }
-    }
-
-    if (m_grandMaster->channelMode() == GrandMaster::AllChannels)
-    {
-        for (int i = 0; i < m_nonIntensityChannels.size(); ++i)
-        {
-            int channel = m_nonIntensityChannels.at(i);
-            updatePostGMValue(channel);
-        }
-    }
+    // Value and mode changes are applied with the next updatePostGMValues()
+    m_tablesChanged.storeRelease(1);
 }
 
 /************************************************************************
@@ -202,6 +227,10 @@ void Universe::reset()
     }
     zeroRelativeValues();
     m_modifiers.fill(NULL, UNIVERSE_SIZE);
+    updateTables();
+    // post-GM values have just been set, so discard the pending changes
+    m_dirtyStart = UNIVERSE_SIZE;
+    m_dirtyEnd = 0;
     m_passthrough = false; // not releasing m_passthroughValues, see comment in setPassthrough
 }
 
@@ -369,25 +398,121 @@ uchar Universe::applyPassthrough(int channel, uchar value)
     return value;
 }
 
-void Universe::updatePostGMValue(int channel)
+void Universe::setChannelDirty(int channel)
 {
-    uchar value = preGMValue(channel);
+    if (channel < m_dirtyStart)
+        m_dirtyStart = channel;
+    if (channel >= m_dirtyEnd)
+        m_dirtyEnd = channel + 1;
+}
 
-    value = applyRelative(channel, value);
+void Universe::updateTables()
+{
+    // a change arriving from now on is applied with the next update
+    m_tablesChanged.storeRelease(0);
 
-    if (value == 0)
+    // the first table is the identity, the second one is the Grand Master
+    m_tables.resize(512);
+    uchar *tables = reinterpret_cast<uchar *>(m_tables.data());
+    for (int v = 0; v < 256; v++)
     {
-        value = static_cast<uchar>(m_modifiedZeroValues->at(channel));
+        tables[v] = uchar(v);
+        tables[256 + v] = uchar(v);
     }
-    else
+
+    if (m_grandMaster != NULL)
+    {
+        for (int v = 0; v < 256; v++)
+        {
+            if (m_grandMaster->valueMode() == GrandMaster::Limit)
+                tables[256 + v] = MIN(uchar(v), m_grandMaster->value());
+            else
+                tables[256 + v] = uchar(floor((double(v) * m_grandMaster->fraction()) + 0.5));
+        }
+    }
+
+    bool allChannels = m_grandMaster != NULL &&
+                       m_grandMaster->channelMode() == GrandMaster::AllChannels;
+    bool intensityOnly = m_grandMaster != NULL &&
+                         m_grandMaster->channelMode() == GrandMaster::Intensity;
+
+    // modifier tables are shared by the channels using the same modifier
+    QHash<ChannelModifier *, int> modifierTables;
+    QHash<ChannelModifier *, int> modifierGMTables;
+
+    for (int i = 0; i < UNIVERSE_SIZE; i++)
+    {
+        bool gm = allChannels || (intensityOnly && (m_channelsMask->at(i) & Intensity));
+        ChannelModifier *modifier = m_modifiers.at(i);
+
+        if (modifier == NULL)
+        {
+            m_channelTables[i] = gm ? 256 : 0;
+            continue;
+        }
+
+        QHash<ChannelModifier *, int> &cache = gm ? modifierGMTables : modifierTables;
+        int offset = cache.value(modifier, -1);
+        if (offset == -1)
+        {
+            offset = m_tables.size();
+            m_tables.resize(offset + 256);
+            tables = reinterpret_cast<uchar *>(m_tables.data());
+            for (int v = 0; v < 256; v++)
+                tables[offset + v] = modifier->getValue(tables[(gm ? 256 : 0) + v]);
+            cache.insert(modifier, offset);
+        }
+        m_channelTables[i] = offset;
+    }
+
+    // every channel depends on the tables
+    m_dirtyStart = 0;
+    m_dirtyEnd = UNIVERSE_SIZE;
+}
+
+void Universe::updatePostGMValues()
+{
+    if (m_tablesChanged.loadAcquire())
+        updateTables();
+
+    if (m_dirtyStart >= m_dirtyEnd)
+        return;
+
+    int start = m_dirtyStart;
+    int count = m_dirtyEnd - m_dirtyStart;
+    m_dirtyStart = UNIVERSE_SIZE;
+    m_dirtyEnd = 0;
+
+    const uchar *pre = reinterpret_cast<const uchar *>(m_preGMValues->constData()) + start;
+    const short *relative = m_relativeValues.constData() + start;
+    const uchar *zero = reinterpret_cast<const uchar *>(m_modifiedZeroValues->constData()) + start;
+    const int *channelTables = m_channelTables.constData() + start;
+    const uchar *tables = reinterpret_cast<const uchar *>(m_tables.constData());
+    uchar *post = reinterpret_cast<uchar *>(m_postGMValues->data()) + start;
+    uchar values[UNIVERSE_SIZE];
+
+    // Each step is a simple loop over the whole range, so that the
+    // compiler can vectorize the ones that don't need a table lookup
+
+    // apply relative values
+    for (int i = 0; i < count; i++)
     {
-        value = applyGM(channel, value);
-        value = applyModifiers(channel, value);
+        int value = pre[i] + relative[i];
+        values[i] = uchar(CLAMP(value, 0, (int)UCHAR_MAX));
     }
 
-    value = applyPassthrough(channel, value);
+    // apply Grand Master and modifiers. Zero goes to the default value
+    for (int i = 0; i < count; i++)
+        post[i] = values[i] == 0 ? zero[i] : tables[channelTables[i] + values[i]];
 
-    (*m_postGMValues)[channel] = static_cast<char>(value);
+    // HTP merge with the input values
+    if (m_passthrough)
+    {
+        const uchar *passthrough =
+            reinterpret_cast<const uchar *>(m_passthroughValues->constData()) + start;
+        for (int i = 0; i < count; i++)
+            post[i] = qMax(post[i], passthrough[i]);
+    }
 }
 
 /************************************************************************
@@ -536,27 +661,38 @@ OutputPatch *Universe::feedbackPatch() const
     return m_fbPatch;
 }
 
-void Universe::dumpOutput(const QByteArray &data)
+void Universe::dumpOutput(const QByteArray &data, bool dataChanged)
 {
     if (m_outputPatchList.count() == 0)
         return;
 
+    // Unless in send-on-change mode, plugins always get fresh data.
+    // Otherwise, unchanged data is flagged as changed once in a while,
+    // to refresh devices that dropped a packet or have been reconnected
+    if (m_sendOnChange == false || m_totalChannelsChanged == true ||
+        m_keepAliveTimer.isValid() == false ||
+        m_keepAliveTimer.hasExpired(m_keepAliveInterval))
+        dataChanged = true;
+
+    if (dataChanged)
+        m_keepAliveTimer.start();
+
     foreach (OutputPatch *op, m_outputPatchList)
     {
         if (m_totalChannelsChanged == true)
             op->setPluginParameter(PLUGIN_UNIVERSECHANNELS, m_totalChannels);
 
         if (op->blackout())
-            op->dump(m_id, *m_modifiedZeroValues);
+            op->dump(m_id, *m_modifiedZeroValues, dataChanged);
         else
-            op->dump(m_id, data);
+            op->dump(m_id, data, dataChanged);
     }
     m_totalChannelsChanged = false;
 }
 
 void Universe::dumpBlackout()
 {
-    dumpOutput(*m_modifiedZeroValues);
+    dumpOutput(*m_modifiedZeroValues, true);
 }
 
 const QByteArray& Universe::blackoutData()
@@ -588,7 +724,7 @@ void Universe::slotInputValueChanged(quint32 universe, quint32 channel, uchar va
 
             (*m_passthroughValues)[channel] = value;
 
-            updatePostGMValue(channel);
+            setChannelDirty(channel);
         }
     }
     else
@@ -634,6 +770,9 @@ void Universe::setChannelCapability(ushort channel, QLCChannel::Group group, Cha
         m_intensityChannelsChanged = true;
     Utils::vectorRemove(m_nonIntensityChannels, channel);
 
+    // the Grand Master table depends on the channel being an intensity one
+    m_tablesChanged.storeRelease(1);
+
     if (forcedType != Undefined)
     {
         (*m_channelsMask)[channel] = char(forcedType);
@@ -712,6 +851,7 @@ void Universe::setChannelModifier(ushort channel, ChannelModifier *modifier)
         return;
 
     m_modifiers[channel] = modifier;
+    m_tablesChanged.storeRelease(1);
 
     if (modifier != NULL)
     {
@@ -727,7 +867,7 @@ void Universe::setChannelModifier(ushort channel, ChannelModifier *modifier)
             m_usedChannels = channel + 1;
     }
 
-    updatePostGMValue(channel);
+    setChannelDirty(channel);
 }
 
 ChannelModifier *Universe::channelModifier(ushort channel)
@@ -778,6 +918,12 @@ bool Universe::write(int channel, uchar value, bool forceLTP)
 
     //qDebug() << "Universe write channel" << channel << ", value:" << value;
 
+    if (m_deferredWrites != NULL)
+    {
+        deferWrite(channel, value, forceLTP ? DeferredForcedLTP : DeferredNormal);
+        return true;
+    }
+
     if (channel >= m_usedChannels)
         m_usedChannels = channel + 1;
 
@@ -789,7 +935,7 @@ bool Universe::write(int channel, uchar value, bool forceLTP)
 
     (*m_preGMValues)[channel] = char(value);
 
-    updatePostGMValue(channel);
+    setChannelDirty(channel);
 
     return true;
 }
@@ -798,6 +944,12 @@ bool Universe::writeRelative(int channel, uchar value)
 {
     Q_ASSERT(channel < UNIVERSE_SIZE);
 
+    if (m_deferredWrites != NULL)
+    {
+        deferWrite(channel, value, DeferredRelative);
+        return true;
+    }
+
     if (channel >= m_usedChannels)
         m_usedChannels = channel + 1;
 
@@ -806,13 +958,19 @@ bool Universe::writeRelative(int channel, uchar value)
 
     m_relativeValues[channel] += value - RELATIVE_ZERO;
 
-    updatePostGMValue(channel);
+    setChannelDirty(channel);
 
     return true;
 }
 
 bool Universe::writeBlended(int channel, uchar value, Universe::BlendMode blend)
 {
+    if (m_deferredWrites != NULL)
+    {
+        deferWrite(channel, value, DeferredBlended, blend);
+        return true;
+    }
+
     if (channel >= m_usedChannels)
         m_usedChannels = channel + 1;
 
@@ -857,11 +1015,60 @@ bool Universe::writeBlended(int channel, uchar value, Universe::BlendMode blend)
         break;
     }
 
-    updatePostGMValue(channel);
+    setChannelDirty(channel);
 
     return true;
 }
 
+/****************************************************************************
+ * Deferred writing
+ ****************************************************************************/
+
+void Universe::setDeferredWrites(QVector<DeferredWrite> *writes)
+{
+    m_deferredWrites = writes;
+}
+
+void Universe::applyDeferredWrites(const QList<Universe *> &universes,
+                                   const QVector<DeferredWrite> &writes)
+{
+    const DeferredWrite *dw = writes.constData();
+    for (int i = 0; i < writes.size(); i++, dw++)
+    {
+        if (dw->m_universe >= (quint32)universes.count())
+            continue;
+
+        Universe *universe = universes.at(dw->m_universe);
+
+        switch (dw->m_type)
+        {
+            case DeferredNormal:
+                universe->write(dw->m_channel, dw->m_value);
+            break;
+            case DeferredForcedLTP:
+                universe->write(dw->m_channel, dw->m_value, true);
+            break;
+            case DeferredRelative:
+                universe->writeRelative(dw->m_channel, dw->m_value);
+            break;
+            case DeferredBlended:
+                universe->writeBlended(dw->m_channel, dw->m_value, BlendMode(dw->m_blendMode));
+            break;
+        }
+    }
+}
+
+void Universe::deferWrite(int channel, uchar value, DeferredWriteType type, BlendMode blend)
+{
+    DeferredWrite dw;
+    dw.m_universe = m_id;
+    dw.m_channel = ushort(channel);
+    dw.m_value = value;
+    dw.m_type = uchar(type);
+    dw.m_blendMode = uchar(blend);
+    m_deferredWrites->append(dw);
+}
+
 /*********************************************************************
  * Load & Save
  *********************************************************************/
@@ -892,6 +1099,24 @@ bool Universe::loadXML(QXmlStreamReader &root, int index, InputOutputMap *ioMap)
         setPassthrough(false);
     }
 
+    if (attrs.hasAttribute(KXMLQLCUniverseSendOnChange))
+    {
+        if (attrs.value(KXMLQLCUniverseSendOnChange).toString() == KXMLQLCTrue ||
+            attrs.value(KXMLQLCUniverseSendOnChange).toString() == "1")
+            setSendOnChange(true);
+        else
+            setSendOnChange(false);
+    }
+    else
+    {
+        setSendOnChange(false);
+    }
+
+    if (attrs.hasAttribute(KXMLQLCUniverseKeepAlive))
+        setKeepAliveInterval(attrs.value(KXMLQLCUniverseKeepAlive).toString().toUInt());
+    else
+        setKeepAliveInterval(UNIVERSE_KEEPALIVE_INTERVAL);
+
     while (root.readNextStartElement())
     {
         qDebug() << "Universe tag:" << root.name();
@@ -1025,6 +1250,13 @@ bool Universe::saveXML(QXmlStreamWriter *doc) const
     if (passthrough() == true)
         doc->writeAttribute(KXMLQLCUniversePassthrough, KXMLQLCTrue);
 
+    if (sendOnChange() == true)
+    {
+        doc->writeAttribute(KXMLQLCUniverseSendOnChange, KXMLQLCTrue);
+        if (keepAliveInterval() != UNIVERSE_KEEPALIVE_INTERVAL)
+            doc->writeAttribute(KXMLQLCUniverseKeepAlive, QString::number(keepAliveInterval()));
+    }
+
     if (inputPatch() != NULL)
     {
         savePatchXML(doc, KXMLQLCUniverseInputPatch, inputPatch()->pluginName(),
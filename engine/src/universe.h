@@ -22,6 +22,8 @@
 #define UNIVERSE_H
 
 #include <QScopedPointer>
+#include <QElapsedTimer>
+#include <QAtomicInt>
 #include <QByteArray>
 #include <QSet>
 
@@ -42,10 +44,15 @@ class InputPatch;
 
 #define UNIVERSE_SIZE 512
 
+/** Default maximum time in ms between two output writes in send-on-change mode */
+#define UNIVERSE_KEEPALIVE_INTERVAL 1000
+
 #define KXMLQLCUniverse "Universe"
 #define KXMLQLCUniverseName "Name"
 #define KXMLQLCUniverseID "ID"
 #define KXMLQLCUniversePassthrough "Passthrough"
+#define KXMLQLCUniverseSendOnChange "SendOnChange"
+#define KXMLQLCUniverseKeepAlive "KeepAlive"
 
 #define KXMLQLCUniverseInputPatch "Input"
 #define KXMLQLCUniverseOutputPatch "Output"
@@ -56,6 +63,17 @@ class InputPatch;
 #define KXMLQLCUniverseProfileName "Profile"
 #define KXMLQLCUniversePluginParameters "PluginParameters"
 
+/** A Universe write operation that has been recorded instead of being applied,
+ *  so that it can be replayed later in a deterministic order */
+typedef struct
+{
+    quint32 m_universe;     //! Index of the universe the value is written to
+    ushort m_channel;       //! Channel index within the universe
+    uchar m_value;          //! The value to write
+    uchar m_type;           //! The write method, as in Universe::DeferredWriteType
+    uchar m_blendMode;      //! The blend mode of a blended write
+} DeferredWrite;
+
 /** Universe class contains input/output data for one DMX universe
  */
 class Universe: public QObject
@@ -66,6 +84,8 @@ class Universe: public QObject
     Q_PROPERTY(QString name READ name WRITE setName NOTIFY nameChanged)
     Q_PROPERTY(quint32 id READ id CONSTANT)
     Q_PROPERTY(bool passthrough READ passthrough WRITE setPassthrough NOTIFY passthroughChanged)
+    Q_PROPERTY(bool sendOnChange READ sendOnChange WRITE setSendOnChange NOTIFY sendOnChangeChanged)
+    Q_PROPERTY(uint keepAliveInterval READ keepAliveInterval WRITE setKeepAliveInterval NOTIFY keepAliveIntervalChanged)
     Q_PROPERTY(InputPatch *inputPatch READ inputPatch NOTIFY inputPatchChanged)
     Q_PROPERTY(int outputPatchesCount READ outputPatchesCount NOTIFY outputPatchesCountChanged)
     Q_PROPERTY(bool hasFeedbacks READ hasFeedbacks NOTIFY hasFeedbacksChanged)
@@ -146,6 +166,30 @@ public:
      */
     bool monitor() const;
 
+    /**
+     * Enable or disable the send-on-change mode for this universe.
+     * When enabled, output plugins are told when the data they receive
+     * is unchanged, so they can skip the transmission. The data is anyway
+     * flagged as changed every keepAliveInterval() ms.
+     */
+    void setSendOnChange(bool enable);
+
+    /**
+     * Returns if the universe is in send-on-change mode
+     */
+    bool sendOnChange() const;
+
+    /**
+     * Set the maximum time in milliseconds between two output writes
+     * flagged as changed, when in send-on-change mode
+     */
+    void setKeepAliveInterval(uint ms);
+
+    /**
+     * Returns the send-on-change keep alive interval in milliseconds
+     */
+    uint keepAliveInterval() const;
+
     uchar applyPassthrough(int channel, uchar value);
 
 protected slots:
@@ -167,11 +211,30 @@ protected:
 
     uchar applyRelative(int channel, uchar value);
     uchar applyModifiers(int channel, uchar value);
-    void updatePostGMValue(int channel);
+
+    /** Mark $channel post-GM value as outdated, to be computed by updatePostGMValues() */
+    void setChannelDirty(int channel);
+
+    /**
+     * Rebuild the lookup tables used to compute post-GM values,
+     * combining the Grand Master with each channel's ChannelModifier
+     */
+    void updateTables();
+
+public:
+    /**
+     * Compute the post-GM values of all the channels changed since the last call,
+     * rebuilding the lookup tables first if needed. This is done in a single pass
+     * over the dirty range by the thread writing the universe, at the end of a
+     * MasterTimer tick.
+     */
+    void updatePostGMValues();
 
 signals:
     void nameChanged();
     void passthroughChanged();
+    void sendOnChangeChanged();
+    void keepAliveIntervalChanged();
 
 protected:
     /** The universe ID */
@@ -184,6 +247,29 @@ protected:
     bool m_passthrough;
     /** Flag to monitor the universe changes */
     bool m_monitor;
+    /** Flag to notify output plugins only of changed data */
+    bool m_sendOnChange;
+    /** Maximum time in ms between two changed output writes */
+    uint m_keepAliveInterval;
+    /** Time elapsed since the last output write flagged as changed */
+    QElapsedTimer m_keepAliveTimer;
+
+    /** First and last + 1 channels whose post-GM value must be computed */
+    int m_dirtyStart;
+    int m_dirtyEnd;
+
+    /** Flag raised when the lookup tables must be rebuilt. This is set by
+     *  the Grand Master from the UI thread, and cleared by the writer thread */
+    QAtomicInt m_tablesChanged;
+
+    /**
+     * Lookup tables of 256 entries each: the identity, the Grand Master
+     * and one for each combination of ChannelModifier and Grand Master in use
+     */
+    QByteArray m_tables;
+
+    /** The offset in m_tables of each channel's lookup table */
+    QVector<int> m_channelTables;
 
     /************************************************************************
      * Patches
@@ -229,8 +315,11 @@ public:
 
     /**
      * This is the actual function that writes data to an output patch
+     *
+     * @param data The values to write
+     * @param dataChanged true if $data differs from the last dump
      */
-    void dumpOutput(const QByteArray& data);
+    void dumpOutput(const QByteArray& data, bool dataChanged);
 
     /**
      * @brief dumpBlackout
@@ -347,7 +436,8 @@ public:
 
     /**
      * Get the current post-Grand-Master value (used by functions and everyone
-     * else INSIDE QLC+) at specified address.
+     * else INSIDE QLC+) at specified address, as computed by the last
+     * updatePostGMValues() call.
      *
      * @return The current value at address
      */
@@ -357,7 +447,8 @@ public:
      * Get the current post-Grand-Master values (to be written to output HW)
      * Don't write to the returned array to prevent copying. Not that it would
      * do anything to UniverseArray's internal values, but it would be just
-     * pointless waste of CPU time.
+     * pointless waste of CPU time. The values are the ones computed by the
+     * last updatePostGMValues() call.
      *
      * @return The current values
      */
@@ -375,7 +466,8 @@ public:
 
     /**
      * Get the current pre-Grand-Master value (used by functions and everyone
-     * else INSIDE QLC+) at specified address.
+     * else INSIDE QLC+) at specified address, as computed by the last
+     * updatePostGMValues() call.
      *
      * @return The current value at address
      */
@@ -497,6 +589,46 @@ public:
      */
     bool writeBlended(int channel, uchar value, BlendMode blend = NormalBlend);
 
+    /************************************************************************
+     * Deferred writing
+     ************************************************************************/
+public:
+    enum DeferredWriteType
+    {
+        DeferredNormal = 0,
+        DeferredForcedLTP,
+        DeferredRelative,
+        DeferredBlended
+    };
+
+    /**
+     * Record all the following write, writeRelative and writeBlended calls
+     * into $writes instead of applying them to this Universe.
+     * This is used to run Functions concurrently, and apply their results
+     * later in the same order the serial path would.
+     *
+     * @param writes The list to append writes to, or NULL to write normally
+     */
+    void setDeferredWrites(QVector<DeferredWrite> *writes);
+
+    /**
+     * Apply a list of recorded writes to $universes, in recording order
+     *
+     * @param universes The universes to write to, indexed by ID
+     * @param writes The writes recorded with setDeferredWrites
+     */
+    static void applyDeferredWrites(const QList<Universe *>& universes,
+                                    const QVector<DeferredWrite>& writes);
+
+protected:
+    /** Record a deferred write into m_deferredWrites */
+    void deferWrite(int channel, uchar value, DeferredWriteType type,
+                    BlendMode blend = NormalBlend);
+
+protected:
+    /** If not NULL, writes are recorded here instead of being applied */
+    QVector<DeferredWrite> *m_deferredWrites;
+
     /*********************************************************************
      * Load & Save
      *********************************************************************/
@@ -0,0 +1,234 @@
+/*
+  Q Light Controller Plus
+  universesnapshot.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <string.h>
+
+#include "universesnapshot.h"
+#include "universe.h"
+
+struct UniverseSnapshot::Frame
+{
+    Frame()
+        : m_ref(0)
+        , m_serial(0)
+        , m_universesCount(0)
+    {
+    }
+
+    /** The number of snapshots referencing this frame */
+    QAtomicInt m_ref;
+    quint64 m_serial;
+    int m_universesCount;
+
+    /** Post-GM and pre-GM values, UNIVERSE_SIZE bytes per universe */
+    QVector<uchar> m_postGMValues;
+    QVector<uchar> m_preGMValues;
+    QVector<int> m_channelsCount;
+    QVector<quint64> m_changeSerials;
+};
+
+/****************************************************************************
+ * UniverseSnapshot
+ ****************************************************************************/
+
+UniverseSnapshot::UniverseSnapshot()
+    : m_frame(NULL)
+{
+}
+
+UniverseSnapshot::UniverseSnapshot(Frame *frame)
+    : m_frame(frame)
+{
+}
+
+UniverseSnapshot::UniverseSnapshot(const UniverseSnapshot &snapshot)
+    : m_frame(snapshot.m_frame)
+{
+    if (m_frame != NULL)
+        m_frame->m_ref.ref();
+}
+
+UniverseSnapshot::~UniverseSnapshot()
+{
+    if (m_frame != NULL)
+        m_frame->m_ref.deref();
+}
+
+UniverseSnapshot &UniverseSnapshot::operator=(const UniverseSnapshot &snapshot)
+{
+    if (snapshot.m_frame != NULL)
+        snapshot.m_frame->m_ref.ref();
+    if (m_frame != NULL)
+        m_frame->m_ref.deref();
+    m_frame = snapshot.m_frame;
+
+    return *this;
+}
+
+bool UniverseSnapshot::isNull() const
+{
+    return m_frame == NULL;
+}
+
+quint64 UniverseSnapshot::serial() const
+{
+    return m_frame == NULL ? 0 : m_frame->m_serial;
+}
+
+int UniverseSnapshot::universesCount() const
+{
+    return m_frame == NULL ? 0 : m_frame->m_universesCount;
+}
+
+int UniverseSnapshot::channelsCount(int universe) const
+{
+    if (universe < 0 || universe >= universesCount())
+        return 0;
+
+    return m_frame->m_channelsCount.at(universe);
+}
+
+quint64 UniverseSnapshot::changeSerial(int universe) const
+{
+    if (universe < 0 || universe >= universesCount())
+        return 0;
+
+    return m_frame->m_changeSerials.at(universe);
+}
+
+const uchar *UniverseSnapshot::postGMValues(int universe) const
+{
+    if (universe < 0 || universe >= universesCount())
+        return NULL;
+
+    return m_frame->m_postGMValues.constData() + universe * UNIVERSE_SIZE;
+}
+
+const uchar *UniverseSnapshot::preGMValues(int universe) const
+{
+    if (universe < 0 || universe >= universesCount())
+        return NULL;
+
+    return m_frame->m_preGMValues.constData() + universe * UNIVERSE_SIZE;
+}
+
+QByteArray UniverseSnapshot::rawData(int universe) const
+{
+    if (universe < 0 || universe >= universesCount())
+        return QByteArray();
+
+    return QByteArray::fromRawData(reinterpret_cast<const char *>(postGMValues(universe)),
+                                   channelsCount(universe));
+}
+
+/****************************************************************************
+ * UniverseSnapshotBuffer
+ ****************************************************************************/
+
+UniverseSnapshotBuffer::UniverseSnapshotBuffer()
+    : m_writeFrame(NULL)
+    , m_latest(NULL)
+    , m_serial(0)
+{
+}
+
+UniverseSnapshotBuffer::~UniverseSnapshotBuffer()
+{
+    qDeleteAll(m_frames);
+}
+
+UniverseSnapshot UniverseSnapshotBuffer::latest() const
+{
+    forever
+    {
+        UniverseSnapshot::Frame *frame = m_latest.loadAcquire();
+        if (frame == NULL)
+            return UniverseSnapshot();
+
+        // Reference the frame, then check it is still the latest one.
+        // If so, the publisher can't recycle it anymore. Otherwise it
+        // might be being refilled, so drop it and try again
+        frame->m_ref.ref();
+        if (m_latest.loadAcquire() == frame)
+            return UniverseSnapshot(frame);
+
+        frame->m_ref.deref();
+    }
+}
+
+void UniverseSnapshotBuffer::beginFrame(int universesCount)
+{
+    UniverseSnapshot::Frame *latest = m_latest.loadAcquire();
+    m_writeFrame = NULL;
+
+    foreach (UniverseSnapshot::Frame *frame, m_frames)
+    {
+        if (frame != latest && frame->m_ref.loadAcquire() == 0)
+        {
+            m_writeFrame = frame;
+            break;
+        }
+    }
+
+    if (m_writeFrame == NULL)
+    {
+        m_writeFrame = new UniverseSnapshot::Frame();
+        m_frames.append(m_writeFrame);
+    }
+
+    UniverseSnapshot::Frame *frame = m_writeFrame;
+    frame->m_universesCount = universesCount;
+    frame->m_postGMValues.resize(universesCount * UNIVERSE_SIZE);
+    frame->m_preGMValues.resize(universesCount * UNIVERSE_SIZE);
+    frame->m_channelsCount.resize(universesCount);
+    frame->m_changeSerials.resize(universesCount);
+
+    // unchanged universes keep the serial of their last change
+    for (int i = 0; i < universesCount; i++)
+    {
+        if (latest != NULL && i < latest->m_universesCount)
+            frame->m_changeSerials[i] = latest->m_changeSerials.at(i);
+        else
+            frame->m_changeSerials[i] = m_serial + 1;
+    }
+}
+
+void UniverseSnapshotBuffer::setUniverse(int index, const uchar *postGM, const uchar *preGM,
+                                         int channelsCount, bool changed)
+{
+    UniverseSnapshot::Frame *frame = m_writeFrame;
+    if (frame == NULL || index < 0 || index >= frame->m_universesCount)
+        return;
+
+    memcpy(frame->m_postGMValues.data() + index * UNIVERSE_SIZE, postGM, UNIVERSE_SIZE);
+    memcpy(frame->m_preGMValues.data() + index * UNIVERSE_SIZE, preGM, UNIVERSE_SIZE);
+    frame->m_channelsCount[index] = channelsCount;
+    if (changed)
+        frame->m_changeSerials[index] = m_serial + 1;
+}
+
+void UniverseSnapshotBuffer::publish()
+{
+    if (m_writeFrame == NULL)
+        return;
+
+    m_writeFrame->m_serial = ++m_serial;
+    m_latest.storeRelease(m_writeFrame);
+    m_writeFrame = NULL;
+}
@@ -0,0 +1,151 @@
+/*
+  Q Light Controller Plus
+  universesnapshot.h
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef UNIVERSESNAPSHOT_H
+#define UNIVERSESNAPSHOT_H
+
+#include <QAtomicPointer>
+#include <QByteArray>
+#include <QAtomicInt>
+#include <QVector>
+#include <QList>
+
+class UniverseSnapshotBuffer;
+
+/** @addtogroup engine Engine
+ * @{
+ */
+
+/**
+ * An immutable copy of the values of all the universes, as they were
+ * at the end of a MasterTimer tick.
+ *
+ * UniverseSnapshot is a lightweight handle: copying it only increments
+ * the reference count of the underlying frame, which is recycled by
+ * the engine once no snapshot references it anymore.
+ * Snapshots must not outlive the UniverseSnapshotBuffer they come from.
+ */
+class UniverseSnapshot
+{
+    friend class UniverseSnapshotBuffer;
+
+public:
+    UniverseSnapshot();
+    UniverseSnapshot(const UniverseSnapshot& snapshot);
+    ~UniverseSnapshot();
+
+    UniverseSnapshot& operator=(const UniverseSnapshot& snapshot);
+
+    /** Return true if this snapshot doesn't hold any frame */
+    bool isNull() const;
+
+    /** Get the serial number of the frame. It grows by one on each publication */
+    quint64 serial() const;
+
+    /** Get the number of universes in the frame */
+    int universesCount() const;
+
+    /** Get the number of used channels of $universe */
+    int channelsCount(int universe) const;
+
+    /**
+     * Get the serial number of the last frame in which the post-GM
+     * values of $universe have changed
+     */
+    quint64 changeSerial(int universe) const;
+
+    /** Get the UNIVERSE_SIZE post-GM values of $universe */
+    const uchar *postGMValues(int universe) const;
+
+    /** Get the UNIVERSE_SIZE pre-GM values of $universe */
+    const uchar *preGMValues(int universe) const;
+
+    /**
+     * Get the used post-GM values of $universe, without copying them.
+     * The returned array is valid as long as this snapshot exists,
+     * so it must not be stored.
+     */
+    QByteArray rawData(int universe) const;
+
+private:
+    struct Frame;
+
+    /** Create a snapshot adopting a reference to $frame */
+    explicit UniverseSnapshot(Frame *frame);
+
+    Frame *m_frame;
+};
+
+/**
+ * UniverseSnapshotBuffer publishes UniverseSnapshots.
+ *
+ * The publisher fills a free frame and makes it the latest one with an
+ * atomic pointer swap, so readers can get the latest snapshot from any
+ * thread without locking and without allocating. Frames are recycled
+ * when they are not the latest and no snapshot references them, so once
+ * the pool has grown to the number of concurrent readers, publishing
+ * doesn't allocate either.
+ *
+ * Calls to beginFrame(), setUniverse() and publish() must not run
+ * concurrently: InputOutputMap serializes them with its universe mutex.
+ */
+class UniverseSnapshotBuffer
+{
+public:
+    UniverseSnapshotBuffer();
+    ~UniverseSnapshotBuffer();
+
+    /** Get the latest published snapshot. Can be called from any thread */
+    UniverseSnapshot latest() const;
+
+    /** Start filling a new frame of $universesCount universes */
+    void beginFrame(int universesCount);
+
+    /**
+     * Copy the values of a universe into the frame being filled
+     *
+     * @param index The universe index
+     * @param postGM The UNIVERSE_SIZE post-GM values
+     * @param preGM The UNIVERSE_SIZE pre-GM values
+     * @param channelsCount The number of used channels
+     * @param changed true if the post-GM values changed since the last frame
+     */
+    void setUniverse(int index, const uchar *postGM, const uchar *preGM,
+                     int channelsCount, bool changed);
+
+    /** Make the frame being filled the latest one */
+    void publish();
+
+private:
+    /** The frame being filled, or NULL */
+    UniverseSnapshot::Frame *m_writeFrame;
+
+    /** The latest published frame */
+    QAtomicPointer<UniverseSnapshot::Frame> m_latest;
+
+    /** All the allocated frames */
+    QList<UniverseSnapshot::Frame *> m_frames;
+
+    /** The serial number of the latest published frame */
+    quint64 m_serial;
+};
+
+/** @} */
+
+#endif
@@ -0,0 +1,26 @@
+include(../../../variables.pri)
+include(../../../coverage.pri)
+TEMPLATE = app
+LANGUAGE = C++
+TARGET   = audiocapture_test
+
+QT      += testlib
+greaterThan(QT_MAJOR_VERSION, 4): QT += multimedia
+CONFIG  -= app_bundle
+
+DEPENDPATH   += ../../src
+INCLUDEPATH  += ../../../plugins/interfaces
+INCLUDEPATH  += ../../src
+INCLUDEPATH  += ../../audio/src
+QMAKE_LIBDIR += ../../src ../../audio/src
+LIBS         += -lqlcplusengine -lqlcplusaudio
+
+# the spectrum is computed only when the audio library is built with FFTW
+!android:!ios {
+  system(pkg-config --exists fftw3) {
+    DEFINES += HAS_FFTW3
+  }
+}
+
+SOURCES += audiocapture_test.cpp
+HEADERS += audiocapture_test.h
@@ -0,0 +1,183 @@
+/*
+  Q Light Controller Plus - Unit test
+  audiocapture_test.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QtTest>
+#include <qmath.h>
+
+#define private public
+#include "audiocapture_test.h"
+#include "audiocapture.h"
+#undef private
+
+#if QT_VERSION < QT_VERSION_CHECK(5, 0, 0)
+#define SKIP_WITHOUT_FFTW() QSKIP("The spectrum is computed only with FFTW", SkipSingle)
+#else
+#define SKIP_WITHOUT_FFTW() QSKIP("The spectrum is computed only with FFTW")
+#endif
+
+#define SAMPLE_RATE 44100
+
+/* The bin of the 2048 samples FFT at the center of the third of 4 bands:
+ * the 232 bins up to SPECTRUM_MAX_FREQUENCY are split in bands of 58 bins */
+#define BAND_2_BIN 145
+
+/** An audio capture without device, fed with synthetic PCM */
+class AudioCaptureStub : public AudioCapture
+{
+public:
+    AudioCaptureStub() : AudioCapture(NULL)
+    {
+        // a known format, whatever the settings
+        m_sampleRate = SAMPLE_RATE;
+        m_channels = 1;
+        m_captureSize = AUDIO_DEFAULT_BUFFER_SIZE;
+    }
+
+    /** Fill the capture buffer with a sine at the frequency of the FFT $bin */
+    void feedSine(int bin, double amplitude)
+    {
+        for (unsigned int i = 0; i < m_captureSize; i++)
+            m_audioBuffer[i] = int16_t(qRound(amplitude * qSin(2 * M_PI * bin * i / m_captureSize)));
+    }
+
+    /** Request $number bands without starting the capture thread */
+    void enableBands(int number)
+    {
+        m_bandsData[number].m_registerCounter.ref();
+    }
+
+    qint64 latency() { return 0; }
+#if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
+    void setVolume(qreal volume) { Q_UNUSED(volume) }
+#endif
+    void suspend() { }
+    void resume() { }
+
+protected:
+    bool initialize() { return false; }
+    void uninitialize() { }
+    bool readAudio(int maxSize) { Q_UNUSED(maxSize) return false; }
+};
+
+void AudioCapture_Test::initial()
+{
+    AudioCaptureStub capture;
+    double bands[FREQ_SUBBANDS_MAX_NUMBER];
+    double maxMagnitude = 0;
+    quint32 power = 0;
+
+    QCOMPARE(capture.defaultBarsNumber(), FREQ_SUBBANDS_DEFAULT_NUMBER);
+
+    // invalid numbers of bands
+    QVERIFY(capture.latestSpectrum(0, bands, maxMagnitude, power) == false);
+    QVERIFY(capture.latestSpectrum(FREQ_SUBBANDS_MAX_NUMBER + 1, bands, maxMagnitude, power) == false);
+
+    // nothing computed yet
+    capture.enableBands(4);
+    QVERIFY(capture.latestSpectrum(4, bands, maxMagnitude, power) == false);
+}
+
+void AudioCapture_Test::ring()
+{
+#ifndef HAS_FFTW3
+    SKIP_WITHOUT_FFTW();
+#else
+    AudioCaptureStub capture;
+    double bands[FREQ_SUBBANDS_MAX_NUMBER];
+    double maxMagnitude = 0;
+    quint32 power = 0;
+
+    capture.enableBands(4);
+    capture.enableBands(16);
+
+    for (int n = 1; n <= 2 * SPECTRUM_RING_SIZE + 1; n++)
+    {
+        // a louder signal at each buffer, to tell the frames apart
+        capture.feedSine(BAND_2_BIN, 1000.0 * n);
+        capture.processData();
+
+        // each registered number of bands publishes a frame per buffer
+        QCOMPARE(capture.m_bandsData[4].m_sequence.loadAcquire(), n);
+        QCOMPARE(capture.m_bandsData[16].m_sequence.loadAcquire(), n);
+        QCOMPARE(capture.m_bandsData[8].m_sequence.loadAcquire(), 0);
+
+        const SpectrumFrame &frame = capture.m_bandsData[4].m_frames[n % SPECTRUM_RING_SIZE];
+        QVERIFY(capture.latestSpectrum(4, bands, maxMagnitude, power) == true);
+        QCOMPARE(maxMagnitude, frame.m_maxMagnitude);
+        QCOMPARE(power, frame.m_power);
+        for (int b = 0; b < 4; b++)
+            QCOMPARE(bands[b], frame.m_bands[b]);
+    }
+
+    // the previous frames are still in the ring, untouched
+    int sequence = capture.m_bandsData[4].m_sequence.loadAcquire();
+    for (int age = 1; age < SPECTRUM_RING_SIZE; age++)
+    {
+        const SpectrumFrame &older = capture.m_bandsData[4].m_frames[(sequence - age) % SPECTRUM_RING_SIZE];
+        const SpectrumFrame &newer = capture.m_bandsData[4].m_frames[(sequence - age + 1) % SPECTRUM_RING_SIZE];
+        QVERIFY(older.m_maxMagnitude < newer.m_maxMagnitude);
+        QVERIFY(older.m_power < newer.m_power);
+    }
+
+    // registering again after all the clients left starts afresh. The
+    // other registered client keeps the capture thread from starting
+    capture.m_bandsData[4].m_registerCounter.deref();
+    capture.m_registeredCount = 1;
+    capture.registerBandsNumber(4);
+    QCOMPARE(capture.m_bandsData[4].m_sequence.loadAcquire(), 0);
+    QVERIFY(capture.latestSpectrum(4, bands, maxMagnitude, power) == false);
+#endif
+}
+
+void AudioCapture_Test::bands()
+{
+#ifndef HAS_FFTW3
+    SKIP_WITHOUT_FFTW();
+#else
+    AudioCaptureStub capture;
+    double bands[FREQ_SUBBANDS_MAX_NUMBER];
+    double maxMagnitude = 0;
+    quint32 power = 0;
+
+    capture.enableBands(4);
+
+    capture.feedSine(BAND_2_BIN, 10000);
+    capture.processData();
+    QVERIFY(capture.latestSpectrum(4, bands, maxMagnitude, power) == true);
+
+    // the power is the average of the absolute samples: 2 / pi of the amplitude
+    QVERIFY(qAbs(double(power) - 20000 / M_PI) < 50);
+
+    // all the energy is in the band holding the sine
+    QCOMPARE(maxMagnitude, bands[2]);
+    QVERIFY(bands[2] > 0);
+    QVERIFY(bands[0] < bands[2] / 1000);
+    QVERIFY(bands[1] < bands[2] / 1000);
+    QVERIFY(bands[3] < bands[2] / 1000);
+
+    // silence has no magnitude
+    capture.feedSine(BAND_2_BIN, 0);
+    capture.processData();
+    QVERIFY(capture.latestSpectrum(4, bands, maxMagnitude, power) == true);
+    QCOMPARE(power, quint32(0));
+    QCOMPARE(maxMagnitude, 0.0);
+#endif
+}
+
+QTEST_MAIN(AudioCapture_Test)
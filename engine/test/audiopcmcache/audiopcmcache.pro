@@ -0,0 +1,19 @@
+include(../../../variables.pri)
+include(../../../coverage.pri)
+TEMPLATE = app
+LANGUAGE = C++
+TARGET   = audiopcmcache_test
+
+QT      += testlib
+greaterThan(QT_MAJOR_VERSION, 4): QT += multimedia
+CONFIG  -= app_bundle
+
+DEPENDPATH   += ../../src
+INCLUDEPATH  += ../../../plugins/interfaces
+INCLUDEPATH  += ../../src
+INCLUDEPATH  += ../../audio/src
+QMAKE_LIBDIR += ../../src ../../audio/src
+LIBS         += -lqlcplusengine -lqlcplusaudio
+
+SOURCES += audiopcmcache_test.cpp
+HEADERS += audiopcmcache_test.h
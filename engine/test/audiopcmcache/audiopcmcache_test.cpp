@@ -0,0 +1,154 @@
+/*
+  Q Light Controller Plus - Unit test
+  audiopcmcache_test.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QtTest>
+
+#include "audiopcmcache_test.h"
+#include "audioplugincache.h"
+#define private public
+#include "audiopcmcache.h"
+#undef private
+
+/** Add to $cache an entry of $size bytes of 16 bit stereo audio at 1000 Hz */
+static void addEntry(AudioPCMCache *cache, const QString &fileName, int size)
+{
+    AudioPCMCache::CacheEntry entry;
+    entry.m_data = QByteArray(size, 0);
+    entry.m_parameters = AudioParameters(1000, 2, PCM_S16LE);
+    entry.m_lastUsed = ++cache->m_useCounter;
+
+    QMutexLocker locker(&cache->m_mutex);
+    QVERIFY(cache->makeRoom(size) == true);
+    cache->m_entries.insert(fileName, entry);
+    cache->m_usage += size;
+}
+
+void AudioPCMCache_Test::initTestCase()
+{
+    m_cache = new AudioPluginCache(this);
+}
+
+void AudioPCMCache_Test::cleanupTestCase()
+{
+    delete m_cache;
+}
+
+void AudioPCMCache_Test::decoder()
+{
+    // 2 seconds of 16 bit stereo at 1000 Hz
+    QByteArray pcm;
+    for (int i = 0; i < 2000 * 4; i++)
+        pcm.append(char(i / 4));
+
+    AudioDecoderPCMCache dec(pcm, AudioParameters(1000, 2, PCM_S16LE));
+    QCOMPARE(dec.totalTime(), qint64(2000));
+    QCOMPARE(dec.bitrate(), 32);
+
+    char buffer[16];
+    QCOMPARE(dec.read(buffer, sizeof(buffer)), qint64(16));
+    QCOMPARE(int(buffer[0]), 0);
+    QCOMPARE(int(buffer[15]), 3);
+
+    // 10 ms are 10 frames
+    dec.seek(10);
+    QCOMPARE(dec.read(buffer, 4), qint64(4));
+    QCOMPARE(int(buffer[0]), 10);
+
+    // reads stop at the end of the data
+    dec.seek(1999);
+    QCOMPARE(dec.read(buffer, sizeof(buffer)), qint64(4));
+    QCOMPARE(dec.read(buffer, sizeof(buffer)), qint64(0));
+
+    dec.seek(5000);
+    QCOMPARE(dec.read(buffer, sizeof(buffer)), qint64(0));
+
+    // copies share the data and have their own position
+    AudioDecoder *copy = dec.createCopy();
+    QCOMPARE(copy->totalTime(), qint64(2000));
+    QCOMPARE(copy->read(buffer, 4), qint64(4));
+    QCOMPARE(int(buffer[0]), 0);
+    delete copy;
+}
+
+void AudioPCMCache_Test::budget()
+{
+    AudioPCMCache *cache = m_cache->pcmCache();
+    QVERIFY(cache != NULL);
+
+    // the budget doesn't depend on the user settings from here on
+    cache->setBudget(qint64(64) * 1024 * 1024);
+    QCOMPARE(cache->budget(), qint64(64) * 1024 * 1024);
+
+    // a budget of 0 disables the cache
+    cache->setBudget(0);
+    QCOMPARE(cache->budget(), qint64(0));
+    cache->request("foo.wav");
+    QVERIFY(cache->m_queue.isEmpty());
+    QVERIFY(cache->contains("foo.wav") == false);
+    QVERIFY(cache->createDecoder("foo.wav") == NULL);
+
+    cache->setBudget(-1);
+    QCOMPARE(cache->budget(), qint64(0));
+
+    // files bigger than the whole budget don't fit
+    cache->setBudget(100);
+    QMutexLocker locker(&cache->m_mutex);
+    QVERIFY(cache->makeRoom(101) == false);
+    QVERIFY(cache->makeRoom(100) == true);
+}
+
+void AudioPCMCache_Test::eviction()
+{
+    AudioPCMCache *cache = m_cache->pcmCache();
+    cache->clear();
+    cache->setBudget(100);
+
+    addEntry(cache, "a.wav", 40);
+    addEntry(cache, "b.wav", 40);
+    QCOMPARE(cache->usage(), qint64(80));
+
+    // using a.wav makes b.wav the least recently used
+    AudioDecoder *dec = cache->createDecoder("a.wav");
+    QVERIFY(dec != NULL);
+    QCOMPARE(dec->totalTime(), qint64(10));
+
+    addEntry(cache, "c.wav", 40);
+    QVERIFY(cache->contains("a.wav") == true);
+    QVERIFY(cache->contains("b.wav") == false);
+    QVERIFY(cache->contains("c.wav") == true);
+    QCOMPARE(cache->usage(), qint64(80));
+
+    // shrinking the budget evicts until the data fits
+    cache->setBudget(50);
+    QVERIFY(cache->contains("a.wav") == false);
+    QVERIFY(cache->contains("c.wav") == true);
+    QCOMPARE(cache->usage(), qint64(40));
+
+    // the decoder keeps playing the evicted data
+    char buffer[8];
+    QCOMPARE(dec->read(buffer, sizeof(buffer)), qint64(8));
+    delete dec;
+
+    cache->clear();
+    QCOMPARE(cache->usage(), qint64(0));
+    QVERIFY(cache->contains("c.wav") == false);
+    QVERIFY(cache->createDecoder("c.wav") == NULL);
+}
+
+QTEST_MAIN(AudioPCMCache_Test)
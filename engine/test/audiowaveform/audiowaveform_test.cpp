@@ -0,0 +1,245 @@
+/*
+  Q Light Controller Plus - Unit test
+  audiowaveform_test.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QtTest>
+#include <QTemporaryDir>
+#include <QFile>
+#include <QDir>
+
+#include "audiowaveform_test.h"
+#include "audioplugincache.h"
+#define private public
+#include "audiowaveform.h"
+#undef private
+
+#define CACHE_FILE "audiowaveform_test.peaks"
+
+/** Fill $waveform with 5 blocks of 2 channels lasting 1 second each:
+ *  channel 0 peaks grow by 10 at each block, channel 1 is constant */
+static void fillWaveform(AudioWaveform &waveform)
+{
+    QByteArray entries;
+    for (int i = 0; i < 5; i++)
+    {
+        entries.append(char(-i * 10));
+        entries.append(char(i * 10));
+        entries.append(char(i * 20));
+
+        entries.append(char(-1));
+        entries.append(char(1));
+        entries.append(char(100));
+    }
+
+    waveform.m_channels = 2;
+    waveform.m_sampleRate = AUDIOWAVEFORM_BLOCK_SIZE;
+    waveform.m_framesCount = 5 * AUDIOWAVEFORM_BLOCK_SIZE;
+    waveform.m_levels.clear();
+    waveform.m_levels.append(entries);
+    waveform.buildLevels();
+    waveform.m_ready.storeRelease(1);
+}
+
+void AudioWaveform_Test::initTestCase()
+{
+    m_cache = new AudioPluginCache(this);
+}
+
+void AudioWaveform_Test::cleanupTestCase()
+{
+    QFile::remove(QDir::tempPath() + QDir::separator() + CACHE_FILE);
+    delete m_cache;
+}
+
+void AudioWaveform_Test::initial()
+{
+    AudioWaveform waveform(m_cache, "foo.wav");
+    QVERIFY(waveform.isReady() == false);
+    QCOMPARE(waveform.channels(), 0);
+    QCOMPARE(waveform.sampleRate(), quint32(0));
+    QCOMPARE(waveform.duration(), qint64(0));
+
+    QVector<WaveformPeak> result;
+    QVERIFY(waveform.peaks(0, 0, 1000, 10, result) == false);
+    QCOMPARE(result.count(), 10);
+
+    QVERIFY(AudioWaveform::cacheFileName("this_file_does_not_exist").isEmpty());
+}
+
+void AudioWaveform_Test::levels()
+{
+    AudioWaveform waveform(m_cache, "foo.wav");
+    fillWaveform(waveform);
+
+    QVERIFY(waveform.isReady() == true);
+    QCOMPARE(waveform.channels(), 2);
+    QCOMPARE(waveform.duration(), qint64(5000));
+
+    // 5, 3, 2 and 1 entries of 2 channels
+    QCOMPARE(waveform.m_levels.count(), 4);
+    QCOMPARE(waveform.m_levels.at(1).size(), 3 * 2 * 3);
+    QCOMPARE(waveform.m_levels.at(2).size(), 2 * 2 * 3);
+    QCOMPARE(waveform.m_levels.at(3).size(), 1 * 2 * 3);
+
+    const QByteArray &level1 = waveform.m_levels.at(1);
+    QCOMPARE(int(qint8(level1.at(0))), -10);
+    QCOMPARE(int(qint8(level1.at(1))), 10);
+    QCOMPARE(int(quint8(level1.at(2))), 14);
+    QCOMPARE(int(qint8(level1.at(6))), -30);
+    QCOMPARE(int(qint8(level1.at(7))), 30);
+    QCOMPARE(int(quint8(level1.at(8))), 51);
+
+    // the last entry has no sibling
+    QCOMPARE(int(qint8(level1.at(12))), -40);
+    QCOMPARE(int(quint8(level1.at(14))), 80);
+
+    const QByteArray &level3 = waveform.m_levels.at(3);
+    QCOMPARE(int(qint8(level3.at(0))), -40);
+    QCOMPARE(int(qint8(level3.at(1))), 40);
+    QCOMPARE(int(qint8(level3.at(3))), -1);
+    QCOMPARE(int(qint8(level3.at(4))), 1);
+    QCOMPARE(int(quint8(level3.at(5))), 100);
+}
+
+void AudioWaveform_Test::peaks()
+{
+    AudioWaveform waveform(m_cache, "foo.wav");
+    fillWaveform(waveform);
+
+    QVector<WaveformPeak> result;
+
+    // one peak per block
+    QVERIFY(waveform.peaks(0, 0, 5000, 5, result) == true);
+    QCOMPARE(result.count(), 5);
+    for (int i = 0; i < 5; i++)
+    {
+        QCOMPARE(int(result.at(i).m_min), -i * 10);
+        QCOMPARE(int(result.at(i).m_max), i * 10);
+        QCOMPARE(int(result.at(i).m_rms), i * 20);
+    }
+
+    // two blocks per peak, taken from the upper level
+    QVERIFY(waveform.peaks(0, 0, 4000, 2, result) == true);
+    QCOMPARE(int(result.at(0).m_max), 10);
+    QCOMPARE(int(result.at(0).m_rms), 14);
+    QCOMPARE(int(result.at(1).m_max), 30);
+    QCOMPARE(int(result.at(1).m_rms), 51);
+
+    // more peaks than blocks
+    QVERIFY(waveform.peaks(0, 2000, 3000, 4, result) == true);
+    for (int i = 0; i < 4; i++)
+        QCOMPARE(int(result.at(i).m_max), 20);
+
+    // all the channels
+    QVERIFY(waveform.peaks(-1, 0, 1000, 1, result) == true);
+    QCOMPARE(int(result.at(0).m_min), -1);
+    QCOMPARE(int(result.at(0).m_max), 1);
+    QCOMPARE(int(result.at(0).m_rms), 71);
+
+    // past the end
+    QVERIFY(waveform.peaks(1, 5000, 6000, 2, result) == true);
+    QCOMPARE(int(result.at(0).m_max), 0);
+    QCOMPARE(int(result.at(1).m_rms), 0);
+
+    // invalid arguments
+    QVERIFY(waveform.peaks(2, 0, 1000, 1, result) == false);
+    QVERIFY(waveform.peaks(0, 1000, 1000, 1, result) == false);
+    QVERIFY(waveform.peaks(0, 0, 1000, 0, result) == false);
+}
+
+void AudioWaveform_Test::cache()
+{
+    QString path = QDir::tempPath() + QDir::separator() + CACHE_FILE;
+
+    AudioWaveform waveform(m_cache, "foo.wav");
+    fillWaveform(waveform);
+    QVERIFY(waveform.save(path) == true);
+    QVERIFY(QFile::exists(path + ".tmp") == false);
+
+    AudioWaveform loaded(m_cache, "foo.wav");
+    QVERIFY(loaded.load(path) == true);
+    QCOMPARE(loaded.m_channels, 2);
+    QCOMPARE(loaded.m_sampleRate, quint32(AUDIOWAVEFORM_BLOCK_SIZE));
+    QCOMPARE(loaded.m_framesCount, quint64(5 * AUDIOWAVEFORM_BLOCK_SIZE));
+    QCOMPARE(loaded.m_levels.count(), waveform.m_levels.count());
+    for (int i = 0; i < loaded.m_levels.count(); i++)
+        QVERIFY(loaded.m_levels.at(i) == waveform.m_levels.at(i));
+
+    // a truncated cache is discarded
+    QFile file(path);
+    QVERIFY(file.open(QIODevice::ReadWrite) == true);
+    file.resize(file.size() - 1);
+    file.close();
+
+    AudioWaveform truncated(m_cache, "foo.wav");
+    QVERIFY(truncated.load(path) == false);
+    QVERIFY(truncated.m_levels.isEmpty());
+
+    // so is a cache of another version
+    QVERIFY(waveform.save(path) == true);
+    QVERIFY(file.open(QIODevice::ReadWrite) == true);
+    file.seek(8);
+    file.write("\x02\x00\x00\x00", 4);
+    file.close();
+
+    AudioWaveform version(m_cache, "foo.wav");
+    QVERIFY(version.load(path) == false);
+}
+
+void AudioWaveform_Test::cacheFileName()
+{
+    QTemporaryDir dir;
+    QString fileName = dir.path() + QDir::separator() + "waveform.wav";
+    QByteArray data(3 * 65536, 'a');
+
+    QFile file(fileName);
+    QVERIFY(file.open(QIODevice::WriteOnly) == true);
+    file.write(data);
+    file.close();
+
+    QString name = AudioWaveform::cacheFileName(fileName);
+    QVERIFY(name.isEmpty() == false);
+    QVERIFY(name.endsWith(".peaks"));
+    QCOMPARE(AudioWaveform::cacheFileName(fileName), name);
+
+    // an edit in the middle changes neither the size nor the edges
+    QDateTime mtime = QFileInfo(fileName).lastModified();
+    QVERIFY(file.open(QIODevice::ReadWrite) == true);
+    file.seek(data.size() / 2);
+    file.write("b", 1);
+    file.close();
+
+#if QT_VERSION >= QT_VERSION_CHECK(5, 10, 0)
+    QVERIFY(file.open(QIODevice::ReadWrite) == true);
+    QVERIFY(file.setFileTime(mtime.addSecs(10), QFileDevice::FileModificationTime) == true);
+    file.close();
+#else
+    while (QFileInfo(fileName).lastModified() == mtime)
+    {
+        QTest::qWait(100);
+        QVERIFY(file.open(QIODevice::ReadWrite) == true);
+        file.seek(data.size() / 2);
+        file.write("c", 1);
+        file.close();
+    }
+#endif
+
+    QVERIFY(AudioWaveform::cacheFileName(fileName) != name);
+}
+
+QTEST_MAIN(AudioWaveform_Test)
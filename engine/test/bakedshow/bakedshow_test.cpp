@@ -0,0 +1,311 @@
+/*
+  Q Light Controller Plus - Unit test
+  bakedshow_test.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QXmlStreamReader>
+#include <QXmlStreamWriter>
+#include <QtTest>
+
+#define private public
+#include "bakedshow_test.h"
+#include "inputoutputmap.h"
+#include "mastertimer.h"
+#include "bakedstream.h"
+#include "bakedshow.h"
+#include "universe.h"
+#include "fixture.h"
+#include "scene.h"
+#include "doc.h"
+#undef private
+
+#define TICK 20
+#define FRAMES 10
+
+/* Channel 0 ramps up, channel 1 is an intensity channel at 100
+ * and channel 2 is never used by the stream */
+static bool writeStream(const QString &fileName)
+{
+    BakedStreamWriter writer;
+    if (writer.open(fileName, 1, TICK) == false)
+        return false;
+
+    QByteArray values(UNIVERSE_SIZE, 0);
+    for (int f = 0; f < FRAMES; f++)
+    {
+        values[0] = char(f * 10);
+        values[1] = char(100);
+
+        if (writer.writeFrame(reinterpret_cast<const uchar *>(values.constData())) == false)
+            return false;
+    }
+
+    return writer.close();
+}
+
+static uchar value(Universe *universe, int channel)
+{
+    return uchar(universe->preGMValues().at(channel));
+}
+
+void BakedShow_Test::initTestCase()
+{
+    m_doc = new Doc(this);
+    m_doc->setWorkspacePath(m_dir.path());
+    QVERIFY(writeStream(m_dir.filePath("show.qxb")) == true);
+}
+
+void BakedShow_Test::cleanupTestCase()
+{
+    delete m_doc;
+}
+
+void BakedShow_Test::cleanup()
+{
+    m_doc->clearContents();
+}
+
+void BakedShow_Test::initial()
+{
+    BakedShow bs(m_doc);
+    QCOMPARE(bs.type(), Function::BakedShowType);
+    QCOMPARE(bs.name(), QString("New Baked Show"));
+    QCOMPARE(bs.sourceFileName(), QString());
+    QCOMPARE(bs.totalDuration(), quint32(0));
+    QCOMPARE(bs.runOrder(), Function::SingleShot);
+}
+
+void BakedShow_Test::sourceFile()
+{
+    BakedShow bs(m_doc);
+
+    QVERIFY(bs.setSourceFileName(m_dir.filePath("missing.qxb")) == false);
+    QCOMPARE(bs.name(), QString("File not found"));
+    QCOMPARE(bs.totalDuration(), quint32(0));
+
+    QVERIFY(bs.setSourceFileName(m_dir.filePath("show.qxb")) == true);
+    QCOMPARE(bs.name(), QString("show.qxb"));
+    QCOMPARE(bs.totalDuration(), quint32(FRAMES * TICK));
+
+    // only the channels used by the stream are written
+    QCOMPARE(bs.m_usedChannels.count(), 1);
+    QCOMPARE(bs.m_usedChannels.at(0).count(), 2);
+    QCOMPARE(bs.m_usedChannels.at(0).at(0), 0);
+    QCOMPARE(bs.m_usedChannels.at(0).at(1), 1);
+}
+
+void BakedShow_Test::loadSave()
+{
+    BakedShow *bs = new BakedShow(m_doc);
+    QVERIFY(bs->setSourceFileName(m_dir.filePath("show.qxb")) == true);
+    bs->setName("Baked");
+    m_doc->addFunction(bs);
+
+    QBuffer buffer;
+    buffer.open(QIODevice::WriteOnly | QIODevice::Text);
+    QXmlStreamWriter xmlWriter(&buffer);
+    QVERIFY(bs->saveXML(&xmlWriter) == true);
+    xmlWriter.setDevice(NULL);
+    buffer.close();
+
+    buffer.open(QIODevice::ReadOnly | QIODevice::Text);
+    QXmlStreamReader xmlReader(&buffer);
+    xmlReader.readNextStartElement();
+
+    QCOMPARE(xmlReader.name().toString(), QString("Function"));
+    QCOMPARE(xmlReader.attributes().value("Type").toString(), QString("BakedShow"));
+    QCOMPARE(xmlReader.attributes().value("Name").toString(), QString("Baked"));
+
+    // the file is stored relative to the workspace
+    xmlReader.readNextStartElement();
+    while (xmlReader.name() != "Source")
+    {
+        xmlReader.skipCurrentElement();
+        xmlReader.readNextStartElement();
+    }
+    QCOMPARE(xmlReader.readElementText(), QString("show.qxb"));
+
+    buffer.seek(0);
+    xmlReader.setDevice(&buffer);
+    xmlReader.readNextStartElement();
+
+    BakedShow bs2(m_doc);
+    QVERIFY(bs2.loadXML(xmlReader) == true);
+    QCOMPARE(bs2.sourceFileName(), m_dir.filePath("show.qxb"));
+    QCOMPARE(bs2.totalDuration(), quint32(FRAMES * TICK));
+    QCOMPARE(bs2.runOrder(), Function::SingleShot);
+
+    // not a Baked Show
+    buffer.close();
+    buffer.setData(QByteArray("<Function Type=\"Scene\" Name=\"Foo\"/>"));
+    buffer.open(QIODevice::ReadOnly | QIODevice::Text);
+    xmlReader.setDevice(&buffer);
+    xmlReader.readNextStartElement();
+
+    BakedShow bs3(m_doc);
+    QVERIFY(bs3.loadXML(xmlReader) == false);
+}
+
+void BakedShow_Test::write()
+{
+    MasterTimer *timer = m_doc->masterTimer();
+    QList<Universe *> universes = m_doc->inputOutputMap()->universes();
+    Universe *universe = universes.at(0);
+    universe->setChannelCapability(1, QLCChannel::Intensity);
+
+    BakedShow bs(m_doc);
+    QVERIFY(bs.setSourceFileName(m_dir.filePath("show.qxb")) == true);
+
+    universe->write(2, 77);
+
+    timer->setVirtualClockTime(1000);
+    bs.preRun(timer);
+    bs.write(timer, universes);
+    QCOMPARE(value(universe, 0), uchar(0));
+    QCOMPARE(value(universe, 1), uchar(100));
+    QCOMPARE(value(universe, 2), uchar(77));
+
+    timer->setVirtualClockTime(1040);
+    bs.write(timer, universes);
+    QCOMPARE(value(universe, 0), uchar(20));
+
+    // a late tick doesn't delay the playback
+    timer->setVirtualClockTime(1110);
+    bs.write(timer, universes);
+    QCOMPARE(value(universe, 0), uchar(50));
+
+    // the intensity only scales the intensity channels
+    bs.adjustAttribute(0.5, Function::Intensity);
+    universe->zeroIntensityChannels();
+    timer->setVirtualClockTime(1120);
+    bs.write(timer, universes);
+    QCOMPARE(value(universe, 0), uchar(60));
+    QCOMPARE(value(universe, 1), uchar(50));
+    QCOMPARE(value(universe, 2), uchar(77));
+
+    // the end of the stream stops the function
+    QVERIFY(bs.stopped() == false);
+    timer->setVirtualClockTime(1000 + FRAMES * TICK);
+    bs.write(timer, universes);
+    QVERIFY(bs.stopped() == true);
+    QCOMPARE(value(universe, 0), uchar(60));
+
+    bs.postRun(timer, universes);
+
+    // started by a Show with a time offset
+    bs.m_elapsed = 3 * TICK;
+    timer->setVirtualClockTime(2000);
+    bs.preRun(timer);
+    bs.write(timer, universes);
+    QCOMPARE(value(universe, 0), uchar(30));
+    bs.postRun(timer, universes);
+}
+
+void BakedShow_Test::pauseSeek()
+{
+    MasterTimer *timer = m_doc->masterTimer();
+    QList<Universe *> universes = m_doc->inputOutputMap()->universes();
+    Universe *universe = universes.at(0);
+
+    BakedShow bs(m_doc);
+    QVERIFY(bs.setSourceFileName(m_dir.filePath("show.qxb")) == true);
+
+    timer->setVirtualClockTime(0);
+    bs.preRun(timer);
+    timer->setVirtualClockTime(40);
+    bs.write(timer, universes);
+    QCOMPARE(value(universe, 0), uchar(20));
+
+    // the time spent in pause is not played
+    bs.setPause(true);
+    timer->setVirtualClockTime(100);
+    bs.write(timer, universes);
+    timer->setVirtualClockTime(1000);
+    bs.write(timer, universes);
+    QCOMPARE(value(universe, 0), uchar(20));
+
+    bs.setPause(false);
+    timer->setVirtualClockTime(1020);
+    bs.write(timer, universes);
+    QCOMPARE(value(universe, 0), uchar(30));
+
+    // forward and backward seeks
+    bs.seek(8 * TICK);
+    bs.write(timer, universes);
+    QCOMPARE(value(universe, 0), uchar(80));
+
+    bs.seek(TICK);
+    timer->setVirtualClockTime(1040);
+    bs.write(timer, universes);
+    QCOMPARE(value(universe, 0), uchar(10));
+
+    timer->setVirtualClockTime(1080);
+    bs.write(timer, universes);
+    QCOMPARE(value(universe, 0), uchar(30));
+
+    // seeking past the end stops the function
+    bs.seek(FRAMES * TICK);
+    bs.write(timer, universes);
+    QVERIFY(bs.stopped() == true);
+
+    bs.postRun(timer, universes);
+}
+
+void BakedShow_Test::baker()
+{
+    Fixture *fxi = new Fixture(m_doc);
+    fxi->setAddress(0);
+    fxi->setUniverse(0);
+    fxi->setChannels(4);
+    QVERIFY(m_doc->addFixture(fxi) == true);
+
+    Scene *scene = new Scene(m_doc);
+    scene->setValue(fxi->id(), 0, 200);
+    QVERIFY(m_doc->addFunction(scene) == true);
+    quint32 duration = 10 * MasterTimer::tick();
+
+    // functions that don't exist are not baked
+    BakedShowBaker invalid(m_doc, Function::invalidId(), m_dir.filePath("invalid.qxb"), duration);
+    QVERIFY(invalid.bake() == false);
+    QVERIFY(invalid.isBaked() == false);
+
+    // rendering on the worker thread
+    BakedShowBaker baker(m_doc, scene->id(), m_dir.filePath("baked.qxb"), duration);
+    QCOMPARE(baker.fileName(), m_dir.filePath("baked.qxb"));
+    baker.start();
+    QVERIFY(baker.wait(10000) == true);
+    QVERIFY(baker.isBaked() == true);
+    QCOMPARE(baker.progress(), 100);
+
+    BakedShow bs(m_doc);
+    QVERIFY(bs.setSourceFileName(baker.fileName()) == true);
+    QCOMPARE(bs.totalDuration(), duration);
+
+    BakedStreamReader reader;
+    QVERIFY(reader.open(baker.fileName()) == true);
+    QVERIFY(reader.seek(reader.framesCount() - 1) == true);
+    QCOMPARE(reader.values(0)[0], uchar(200));
+    reader.close();
+
+    // a cancelled rendering leaves no file behind
+    BakedShowBaker cancelled(m_doc, scene->id(), m_dir.filePath("cancelled.qxb"), duration);
+    cancelled.cancel();
+    QVERIFY(cancelled.bake() == false);
+    QVERIFY(QFile::exists(m_dir.filePath("cancelled.qxb")) == false);
+}
+
+QTEST_MAIN(BakedShow_Test)
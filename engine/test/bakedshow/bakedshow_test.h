@@ -0,0 +1,49 @@
+/*
+  Q Light Controller Plus - Unit test
+  bakedshow_test.h
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef BAKEDSHOW_TEST_H
+#define BAKEDSHOW_TEST_H
+
+#include <QTemporaryDir>
+#include <QObject>
+
+class Doc;
+
+class BakedShow_Test : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void cleanup();
+
+    void initial();
+    void sourceFile();
+    void loadSave();
+    void write();
+    void pauseSeek();
+    void baker();
+
+private:
+    Doc *m_doc;
+    QTemporaryDir m_dir;
+};
+
+#endif
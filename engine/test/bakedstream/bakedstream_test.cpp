@@ -0,0 +1,181 @@
+/*
+  Q Light Controller Plus - Unit test
+  bakedstream_test.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QtTest>
+#include <QtEndian>
+
+#include "bakedstream_test.h"
+#include "bakedstream.h"
+#include "universe.h"
+
+#define UNIVERSES 2
+#define FRAMES 60
+#define KEYFRAME_INTERVAL 25
+
+/* The value of each channel of the test stream at $frame */
+static uchar frameValue(int frame, int universe, int channel)
+{
+    // channels 100-199 of the first universe stay at zero
+    if (universe == 0 && channel >= 100 && channel < 200)
+        return 0;
+    // a few channels change at each frame, the others every 10 frames
+    if (channel % 50 == 0)
+        return uchar(frame * 3 + universe);
+    return uchar(frame / 10 + channel);
+}
+
+static bool writeStream(const QString &fileName)
+{
+    BakedStreamWriter writer;
+    if (writer.open(fileName, UNIVERSES, 20, KEYFRAME_INTERVAL) == false)
+        return false;
+
+    QByteArray values(UNIVERSES * UNIVERSE_SIZE, 0);
+    for (int f = 0; f < FRAMES; f++)
+    {
+        for (int u = 0; u < UNIVERSES; u++)
+            for (int i = 0; i < UNIVERSE_SIZE; i++)
+                values[u * UNIVERSE_SIZE + i] = char(frameValue(f, u, i));
+
+        if (writer.writeFrame(reinterpret_cast<const uchar *>(values.constData())) == false)
+            return false;
+    }
+
+    if (writer.framesCount() != FRAMES)
+        return false;
+
+    return writer.close();
+}
+
+static bool checkFrame(const BakedStreamReader &reader, int frame)
+{
+    for (int u = 0; u < UNIVERSES; u++)
+        for (int i = 0; i < UNIVERSE_SIZE; i++)
+            if (reader.values(u)[i] != frameValue(frame, u, i))
+                return false;
+
+    return true;
+}
+
+void BakedStream_Test::initial()
+{
+    BakedStreamReader reader;
+    QVERIFY(reader.isOpen() == false);
+    QCOMPARE(reader.framesCount(), quint32(0));
+    QCOMPARE(reader.currentFrame(), qint64(-1));
+    QVERIFY(reader.seek(0) == false);
+    QVERIFY(reader.values(0) == NULL);
+
+    BakedStreamWriter writer;
+    QVERIFY(writer.writeFrame(NULL) == false);
+    QVERIFY(writer.close() == false);
+    QVERIFY(writer.open(m_dir.filePath("zero.qxb"), 0, 20) == false);
+}
+
+void BakedStream_Test::writeRead()
+{
+    QString fileName = m_dir.filePath("stream.qxb");
+    QVERIFY(writeStream(fileName) == true);
+
+    // delta frames must be much smaller than the full frames
+    QVERIFY(QFileInfo(fileName).size() < FRAMES * UNIVERSES * UNIVERSE_SIZE / 2);
+
+    BakedStreamReader reader;
+    QVERIFY(reader.open(fileName) == true);
+    QVERIFY(reader.isOpen() == true);
+    QCOMPARE(reader.tick(), quint32(20));
+    QCOMPARE(reader.universesCount(), UNIVERSES);
+    QCOMPARE(reader.framesCount(), quint32(FRAMES));
+    QCOMPARE(reader.duration(), quint32(FRAMES * 20));
+
+    for (int f = 0; f < FRAMES; f++)
+    {
+        QVERIFY(reader.seek(f) == true);
+        QCOMPARE(reader.currentFrame(), qint64(f));
+        QVERIFY(checkFrame(reader, f) == true);
+    }
+    QVERIFY(reader.seek(FRAMES) == false);
+
+    QVERIFY(reader.isChannelUsed(0, 50) == true);
+    QVERIFY(reader.isChannelUsed(0, 150) == false);
+    QVERIFY(reader.isChannelUsed(1, 150) == true);
+    QVERIFY(reader.isChannelUsed(2, 150) == false);
+
+    reader.close();
+    QVERIFY(reader.isOpen() == false);
+}
+
+void BakedStream_Test::seek()
+{
+    QString fileName = m_dir.filePath("seek.qxb");
+    QVERIFY(writeStream(fileName) == true);
+
+    BakedStreamReader reader;
+    QVERIFY(reader.open(fileName) == true);
+
+    // backwards, across key frames and within the same key frame interval
+    int frames[] = { 59, 3, 26, 24, 49, 50, 0, 37, 38, 12 };
+    for (unsigned int i = 0; i < sizeof(frames) / sizeof(int); i++)
+    {
+        QVERIFY(reader.seek(frames[i]) == true);
+        QVERIFY(checkFrame(reader, frames[i]) == true);
+    }
+}
+
+void BakedStream_Test::invalidFile()
+{
+    BakedStreamReader reader;
+    QVERIFY(reader.open(m_dir.filePath("missing.qxb")) == false);
+
+    QString fileName = m_dir.filePath("garbage.qxb");
+    QFile file(fileName);
+    QVERIFY(file.open(QIODevice::WriteOnly) == true);
+    file.write(QByteArray(100, 'x'));
+    file.close();
+    QVERIFY(reader.open(fileName) == false);
+
+    // a truncated stream has no valid index
+    fileName = m_dir.filePath("truncated.qxb");
+    QVERIFY(writeStream(fileName) == true);
+    QFile truncated(fileName);
+    QVERIFY(truncated.resize(truncated.size() - 100) == true);
+    QVERIFY(reader.open(fileName) == false);
+    QVERIFY(reader.isOpen() == false);
+
+    // a frame offset pointing outside of the file
+    fileName = m_dir.filePath("offset.qxb");
+    QVERIFY(writeStream(fileName) == true);
+    QFile corrupted(fileName);
+    QVERIFY(corrupted.open(QIODevice::ReadWrite) == true);
+    QVERIFY(corrupted.seek(32) == true);
+    quint64 indexOffset = qFromLittleEndian<quint64>(
+                reinterpret_cast<const uchar *>(corrupted.read(8).constData()));
+    uchar offset[8];
+    qToLittleEndian<quint64>(Q_UINT64_C(0xFFFFFFFFFFFFFFF0), offset);
+    QVERIFY(corrupted.seek(indexOffset) == true);
+    corrupted.write(reinterpret_cast<const char *>(offset), 8);
+    corrupted.close();
+
+    QVERIFY(reader.open(fileName) == true);
+    QVERIFY(reader.seek(0) == false);
+    QVERIFY(reader.seek(1) == false);
+    QCOMPARE(reader.currentFrame(), qint64(-1));
+}
+
+QTEST_MAIN(BakedStream_Test)
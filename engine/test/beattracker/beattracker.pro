@@ -0,0 +1,18 @@
+include(../../../variables.pri)
+include(../../../coverage.pri)
+TEMPLATE = app
+LANGUAGE = C++
+TARGET   = beattracker_test
+
+QT      += testlib
+CONFIG  -= app_bundle
+
+DEPENDPATH   += ../../src
+INCLUDEPATH  += ../../../plugins/interfaces
+INCLUDEPATH  += ../../src
+INCLUDEPATH  += ../../audio/src
+QMAKE_LIBDIR += ../../src ../../audio/src
+LIBS         += -lqlcplusengine -lqlcplusaudio
+
+SOURCES += beattracker_test.cpp
+HEADERS += beattracker_test.h
@@ -0,0 +1,128 @@
+/*
+  Q Light Controller Plus - Unit test
+  beattracker_test.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QtTest>
+#include <qmath.h>
+
+#include "beattracker_test.h"
+#include "beattracker.h"
+
+/* Duration of a frame of 512 samples at 44100Hz, in microseconds */
+#define FRAME_PERIOD 11610
+
+/* Time of the first beat of the synthetic signals */
+#define BEAT_OFFSET 123456
+
+/** Return the onset strength of the frame at $time of a beat every $period
+ *  microseconds: 1 in the frame holding a beat, random up to $noise in the others */
+static double onset(qint64 time, double period, double noise)
+{
+    double beat = BEAT_OFFSET + qFloor((time + FRAME_PERIOD / 2.0 - BEAT_OFFSET) / period) * period;
+    if (qAbs(beat - time) <= FRAME_PERIOD / 2.0)
+        return 1.0;
+
+    // a deterministic pseudo random noise
+    static quint32 seed = 1;
+    seed = seed * 1103515245 + 12345;
+    return noise * ((seed >> 16) & 0x7FFF) / 32767.0;
+}
+
+void BeatTracker_Test::initial()
+{
+    BeatTracker tracker;
+    QVERIFY(tracker.isLocked() == false);
+    QCOMPARE(tracker.bpm(), 0);
+    QCOMPARE(tracker.beatPeriod(), 0.0);
+    QCOMPARE(tracker.nextBeatTime(1000), qint64(-1));
+
+    // not prepared yet
+    QVERIFY(tracker.processOnset(1.0, 0) == false);
+}
+
+void BeatTracker_Test::steadyTempo_data()
+{
+    QTest::addColumn<int>("bpm");
+    QTest::addColumn<double>("noise");
+
+    QTest::newRow("120") << 120 << 0.0;
+    QTest::newRow("128") << 128 << 0.0;
+    QTest::newRow("95") << 95 << 0.0;
+    QTest::newRow("150") << 150 << 0.0;
+    QTest::newRow("128 noisy") << 128 << 0.5;
+    QTest::newRow("100 noisy") << 100 << 0.5;
+}
+
+void BeatTracker_Test::steadyTempo()
+{
+    QFETCH(int, bpm);
+    QFETCH(double, noise);
+
+    BeatTracker tracker;
+    tracker.reset(FRAME_PERIOD);
+
+    double period = 60000000.0 / bpm;
+    qint64 time = 0;
+
+    // 15 seconds of music
+    for (; time < 15000000; time += FRAME_PERIOD)
+        tracker.processOnset(onset(time, period, noise), time);
+
+    QVERIFY(tracker.isLocked() == true);
+    QVERIFY(qAbs(tracker.bpm() - bpm) <= 1);
+
+    // the predicted beat must be within half a MasterTimer tick
+    qint64 truth = BEAT_OFFSET + qCeil((time - BEAT_OFFSET) / period) * period;
+    qint64 nextBeat = tracker.nextBeatTime(time);
+    QVERIFY(nextBeat > time);
+    QVERIFY2(qAbs(nextBeat - truth) < 10000,
+             QString("predicted %1, expected %2").arg(nextBeat).arg(truth).toUtf8().constData());
+}
+
+void BeatTracker_Test::silence()
+{
+    BeatTracker tracker;
+    tracker.reset(FRAME_PERIOD);
+
+    for (qint64 time = 0; time < 10000000; time += FRAME_PERIOD)
+        QVERIFY(tracker.processOnset(0, time) == false);
+
+    QCOMPARE(tracker.bpm(), 0);
+}
+
+void BeatTracker_Test::spectrum()
+{
+    BeatTracker tracker;
+    tracker.reset(FRAME_PERIOD);
+
+    double period = 60000000.0 / 120;
+    double magnitude[16];
+
+    // a kick drum on a steady background
+    for (qint64 time = 0; time < 15000000; time += FRAME_PERIOD)
+    {
+        for (int i = 0; i < 16; i++)
+            magnitude[i] = 100.0 + 5000.0 * onset(time, period, 0) * (i < 4 ? 1 : 0);
+        tracker.processSpectrum(magnitude, 16, time);
+    }
+
+    QVERIFY(tracker.isLocked() == true);
+    QCOMPARE(tracker.bpm(), 120);
+}
+
+QTEST_MAIN(BeatTracker_Test)
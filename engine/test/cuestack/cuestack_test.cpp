@@ -787,115 +787,115 @@ void CueStack_Test::switchCue()
 
     // Do nothing with invalid cue indices
     cs.switchCue(-1, -1, ua);
-    QCOMPARE(cs.m_fader->channels().size(), 0);
+    QCOMPARE(cs.m_fader->count(), 0);
     cs.switchCue(-1, 3, ua);
-    QCOMPARE(cs.m_fader->channels().size(), 0);
+    QCOMPARE(cs.m_fader->count(), 0);
 
     // Switch to cue one
     cs.switchCue(3, 0, ua);
-    QCOMPARE(cs.m_fader->channels().size(), 5);
+    QCOMPARE(cs.m_fader->count(), 5);
 
     FadeChannel fc;
     fc.setChannel(m_doc, 0);
-    QCOMPARE(cs.m_fader->channels()[fc].start(), uchar(0));
-    QCOMPARE(cs.m_fader->channels()[fc].current(), uchar(0));
-    QCOMPARE(cs.m_fader->channels()[fc].target(), uchar(255));
-    QCOMPARE(cs.m_fader->channels()[fc].channel(), uint(0));
-    QCOMPARE(cs.m_fader->channels()[fc].fadeTime(), uint(20));
+    QCOMPARE(cs.m_fader->channel(fc).start(), uchar(0));
+    QCOMPARE(cs.m_fader->channel(fc).current(), uchar(0));
+    QCOMPARE(cs.m_fader->channel(fc).target(), uchar(255));
+    QCOMPARE(cs.m_fader->channel(fc).channel(), uint(0));
+    QCOMPARE(cs.m_fader->channel(fc).fadeTime(), uint(20));
 
     fc.setChannel(m_doc, 1);
-    QCOMPARE(cs.m_fader->channels()[fc].start(), uchar(0));
-    QCOMPARE(cs.m_fader->channels()[fc].current(), uchar(0));
-    QCOMPARE(cs.m_fader->channels()[fc].target(), uchar(255));
-    QCOMPARE(cs.m_fader->channels()[fc].channel(), uint(1));
-    QCOMPARE(cs.m_fader->channels()[fc].fadeTime(), uint(20));
+    QCOMPARE(cs.m_fader->channel(fc).start(), uchar(0));
+    QCOMPARE(cs.m_fader->channel(fc).current(), uchar(0));
+    QCOMPARE(cs.m_fader->channel(fc).target(), uchar(255));
+    QCOMPARE(cs.m_fader->channel(fc).channel(), uint(1));
+    QCOMPARE(cs.m_fader->channel(fc).fadeTime(), uint(20));
 
     fc.setChannel(m_doc, 10);
-    QCOMPARE(cs.m_fader->channels()[fc].start(), uchar(0));
-    QCOMPARE(cs.m_fader->channels()[fc].current(), uchar(0));
-    QCOMPARE(cs.m_fader->channels()[fc].target(), uchar(255));
-    QCOMPARE(cs.m_fader->channels()[fc].channel(), uint(10));
-    QCOMPARE(cs.m_fader->channels()[fc].fadeTime(), uint(20));
+    QCOMPARE(cs.m_fader->channel(fc).start(), uchar(0));
+    QCOMPARE(cs.m_fader->channel(fc).current(), uchar(0));
+    QCOMPARE(cs.m_fader->channel(fc).target(), uchar(255));
+    QCOMPARE(cs.m_fader->channel(fc).channel(), uint(10));
+    QCOMPARE(cs.m_fader->channel(fc).fadeTime(), uint(20));
 
     fc.setChannel(m_doc, 11);
-    QCOMPARE(cs.m_fader->channels()[fc].start(), uchar(0));
-    QCOMPARE(cs.m_fader->channels()[fc].current(), uchar(0));
-    QCOMPARE(cs.m_fader->channels()[fc].target(), uchar(255));
-    QCOMPARE(cs.m_fader->channels()[fc].channel(), uint(11));
-    QCOMPARE(cs.m_fader->channels()[fc].fadeTime(), uint(20));
+    QCOMPARE(cs.m_fader->channel(fc).start(), uchar(0));
+    QCOMPARE(cs.m_fader->channel(fc).current(), uchar(0));
+    QCOMPARE(cs.m_fader->channel(fc).target(), uchar(255));
+    QCOMPARE(cs.m_fader->channel(fc).channel(), uint(11));
+    QCOMPARE(cs.m_fader->channel(fc).fadeTime(), uint(20));
 
     fc.setChannel(m_doc, 500);
-    QCOMPARE(cs.m_fader->channels()[fc].start(), uchar(0));
-    QCOMPARE(cs.m_fader->channels()[fc].current(), uchar(0));
-    QCOMPARE(cs.m_fader->channels()[fc].target(), uchar(255));
-    QCOMPARE(cs.m_fader->channels()[fc].channel(), uint(500));
-    QCOMPARE(cs.m_fader->channels()[fc].fadeTime(), uint(20));
+    QCOMPARE(cs.m_fader->channel(fc).start(), uchar(0));
+    QCOMPARE(cs.m_fader->channel(fc).current(), uchar(0));
+    QCOMPARE(cs.m_fader->channel(fc).target(), uchar(255));
+    QCOMPARE(cs.m_fader->channel(fc).channel(), uint(500));
+    QCOMPARE(cs.m_fader->channel(fc).fadeTime(), uint(20));
 
     fc.setChannel(m_doc, 3);
-    QCOMPARE(cs.m_fader->channels()[fc].channel(), QLCChannel::invalid());
+    QCOMPARE(cs.m_fader->channel(fc).channel(), QLCChannel::invalid());
     fc.setChannel(m_doc, 4);
-    QCOMPARE(cs.m_fader->channels()[fc].channel(), QLCChannel::invalid());
+    QCOMPARE(cs.m_fader->channel(fc).channel(), QLCChannel::invalid());
 
     fc.setChannel(m_doc, 0);
-    cs.m_fader->m_channels[fc].setCurrent(127);
+    cs.m_fader->m_currents[cs.m_fader->indexOf(fc)] = 127;
     fc.setChannel(m_doc, 1);
-    cs.m_fader->m_channels[fc].setCurrent(127);
+    cs.m_fader->m_currents[cs.m_fader->indexOf(fc)] = 127;
     fc.setChannel(m_doc, 10);
-    cs.m_fader->m_channels[fc].setCurrent(127);
+    cs.m_fader->m_currents[cs.m_fader->indexOf(fc)] = 127;
     fc.setChannel(m_doc, 11);
-    cs.m_fader->m_channels[fc].setCurrent(127);
+    cs.m_fader->m_currents[cs.m_fader->indexOf(fc)] = 127;
     fc.setChannel(m_doc, 500);
-    cs.m_fader->m_channels[fc].setCurrent(127);
+    cs.m_fader->m_currents[cs.m_fader->indexOf(fc)] = 127;
 
     // Switch to cue two
     cs.switchCue(0, 1, ua);
-    QCOMPARE(cs.m_fader->channels().size(), 7);
+    QCOMPARE(cs.m_fader->count(), 7);
 
     fc.setChannel(m_doc, 0);
-    QCOMPARE(cs.m_fader->channels()[fc].start(), uchar(127));
-    QCOMPARE(cs.m_fader->channels()[fc].current(), uchar(127));
-    QCOMPARE(cs.m_fader->channels()[fc].target(), uchar(0));
-    QCOMPARE(cs.m_fader->channels()[fc].channel(), uint(0));
-    QCOMPARE(cs.m_fader->channels()[fc].fadeTime(), uint(40));
+    QCOMPARE(cs.m_fader->channel(fc).start(), uchar(127));
+    QCOMPARE(cs.m_fader->channel(fc).current(), uchar(127));
+    QCOMPARE(cs.m_fader->channel(fc).target(), uchar(0));
+    QCOMPARE(cs.m_fader->channel(fc).channel(), uint(0));
+    QCOMPARE(cs.m_fader->channel(fc).fadeTime(), uint(40));
 
     fc.setChannel(m_doc, 1);
-    QCOMPARE(cs.m_fader->channels()[fc].start(), uchar(127));
-    QCOMPARE(cs.m_fader->channels()[fc].current(), uchar(127));
-    QCOMPARE(cs.m_fader->channels()[fc].target(), uchar(0));
-    QCOMPARE(cs.m_fader->channels()[fc].channel(), uint(1));
-    QCOMPARE(cs.m_fader->channels()[fc].fadeTime(), uint(40));
+    QCOMPARE(cs.m_fader->channel(fc).start(), uchar(127));
+    QCOMPARE(cs.m_fader->channel(fc).current(), uchar(127));
+    QCOMPARE(cs.m_fader->channel(fc).target(), uchar(0));
+    QCOMPARE(cs.m_fader->channel(fc).channel(), uint(1));
+    QCOMPARE(cs.m_fader->channel(fc).fadeTime(), uint(40));
 
     fc.setChannel(m_doc, 11); // LTP channel also in the next cue
-    QCOMPARE(cs.m_fader->channels()[fc].start(), uchar(127));
-    QCOMPARE(cs.m_fader->channels()[fc].current(), uchar(127));
-    QCOMPARE(cs.m_fader->channels()[fc].target(), uchar(255));
-    QCOMPARE(cs.m_fader->channels()[fc].channel(), uint(11));
-    QCOMPARE(cs.m_fader->channels()[fc].fadeTime(), uint(60));
+    QCOMPARE(cs.m_fader->channel(fc).start(), uchar(127));
+    QCOMPARE(cs.m_fader->channel(fc).current(), uchar(127));
+    QCOMPARE(cs.m_fader->channel(fc).target(), uchar(255));
+    QCOMPARE(cs.m_fader->channel(fc).channel(), uint(11));
+    QCOMPARE(cs.m_fader->channel(fc).fadeTime(), uint(60));
 
     fc.setChannel(m_doc, 500);
-    QCOMPARE(cs.m_fader->channels()[fc].start(), uchar(127));
-    QCOMPARE(cs.m_fader->channels()[fc].current(), uchar(127));
-    QCOMPARE(cs.m_fader->channels()[fc].target(), uchar(255));
-    QCOMPARE(cs.m_fader->channels()[fc].channel(), uint(500));
-    QCOMPARE(cs.m_fader->channels()[fc].fadeTime(), uint(60));
+    QCOMPARE(cs.m_fader->channel(fc).start(), uchar(127));
+    QCOMPARE(cs.m_fader->channel(fc).current(), uchar(127));
+    QCOMPARE(cs.m_fader->channel(fc).target(), uchar(255));
+    QCOMPARE(cs.m_fader->channel(fc).channel(), uint(500));
+    QCOMPARE(cs.m_fader->channel(fc).fadeTime(), uint(60));
 
     fc.setChannel(m_doc, 3);
-    QCOMPARE(cs.m_fader->channels()[fc].start(), uchar(0));
-    QCOMPARE(cs.m_fader->channels()[fc].current(), uchar(0));
-    QCOMPARE(cs.m_fader->channels()[fc].target(), uchar(255));
-    QCOMPARE(cs.m_fader->channels()[fc].channel(), uint(3));
-    QCOMPARE(cs.m_fader->channels()[fc].fadeTime(), uint(60));
+    QCOMPARE(cs.m_fader->channel(fc).start(), uchar(0));
+    QCOMPARE(cs.m_fader->channel(fc).current(), uchar(0));
+    QCOMPARE(cs.m_fader->channel(fc).target(), uchar(255));
+    QCOMPARE(cs.m_fader->channel(fc).channel(), uint(3));
+    QCOMPARE(cs.m_fader->channel(fc).fadeTime(), uint(60));
 
     fc.setChannel(m_doc, 4);
-    QCOMPARE(cs.m_fader->channels()[fc].start(), uchar(0));
-    QCOMPARE(cs.m_fader->channels()[fc].current(), uchar(0));
-    QCOMPARE(cs.m_fader->channels()[fc].target(), uchar(255));
-    QCOMPARE(cs.m_fader->channels()[fc].channel(), uint(4));
-    QCOMPARE(cs.m_fader->channels()[fc].fadeTime(), uint(60));
+    QCOMPARE(cs.m_fader->channel(fc).start(), uchar(0));
+    QCOMPARE(cs.m_fader->channel(fc).current(), uchar(0));
+    QCOMPARE(cs.m_fader->channel(fc).target(), uchar(255));
+    QCOMPARE(cs.m_fader->channel(fc).channel(), uint(4));
+    QCOMPARE(cs.m_fader->channel(fc).fadeTime(), uint(60));
 
     // Stop
     cs.switchCue(1, -1, ua);
-    QCOMPARE(cs.m_fader->channels().size(), 7);
+    QCOMPARE(cs.m_fader->count(), 7);
 
     MasterTimer mt(m_doc);
     cs.postRun(&mt);
@@ -946,7 +946,7 @@ void CueStack_Test::postRun()
 
     // Switch to cue one
     cs.switchCue(-1, 0, ua);
-    QCOMPARE(cs.m_fader->channels().size(), 5);
+    QCOMPARE(cs.m_fader->count(), 5);
 
     QSignalSpy cueSpy(&cs, SIGNAL(currentCueChanged(int)));
     QSignalSpy stopSpy(&cs, SIGNAL(stopped()));
@@ -960,14 +960,14 @@ void CueStack_Test::postRun()
     QCOMPARE(stopSpy.size(), 1);
 
     // Only HTP channels go to MasterTimer's GenericFader
-    QCOMPARE(mt.m_fader->channels().size(), 3);
+    QCOMPARE(mt.m_fader->count(), 3);
     FadeChannel fc;
     fc.setChannel(m_doc, 0);
-    QCOMPARE(mt.m_fader->channels().contains(fc), true);
+    QCOMPARE(mt.m_fader->contains(fc), true);
     fc.setChannel(m_doc, 1);
-    QCOMPARE(mt.m_fader->channels().contains(fc), true);
+    QCOMPARE(mt.m_fader->contains(fc), true);
     fc.setChannel(m_doc, 500);
-    QCOMPARE(mt.m_fader->channels().contains(fc), true);
+    QCOMPARE(mt.m_fader->contains(fc), true);
 }
 
 void CueStack_Test::write()
@@ -1005,11 +1005,11 @@ void CueStack_Test::write()
     QCOMPARE(cs.currentIndex(), -1);
     cs.write(ua);
     QCOMPARE(cs.currentIndex(), 0);
-    QCOMPARE(cs.m_fader->channels().size(), 1);
+    QCOMPARE(cs.m_fader->count(), 1);
     FadeChannel fc;
     fc.setChannel(m_doc, 0);
-    QCOMPARE(cs.m_fader->channels()[fc].channel(), uint(0));
-    QCOMPARE(cs.m_fader->channels()[fc].target(), uchar(255));
+    QCOMPARE(cs.m_fader->channel(fc).channel(), uint(0));
+    QCOMPARE(cs.m_fader->channel(fc).target(), uchar(255));
 
     cs.previousCue();
     QCOMPARE(cs.currentIndex(), 0);
@@ -1017,11 +1017,11 @@ void CueStack_Test::write()
     QCOMPARE(cs.currentIndex(), 1);
 
     fc.setChannel(m_doc, 0);
-    QCOMPARE(cs.m_fader->channels()[fc].channel(), uint(0));
-    QCOMPARE(cs.m_fader->channels()[fc].target(), uchar(0));
+    QCOMPARE(cs.m_fader->channel(fc).channel(), uint(0));
+    QCOMPARE(cs.m_fader->channel(fc).target(), uchar(0));
     fc.setChannel(m_doc, 1);
-    QCOMPARE(cs.m_fader->channels()[fc].channel(), uint(1));
-    QCOMPARE(cs.m_fader->channels()[fc].target(), uchar(255));
+    QCOMPARE(cs.m_fader->channel(fc).channel(), uint(1));
+    QCOMPARE(cs.m_fader->channel(fc).target(), uchar(255));
 
     MasterTimer mt(m_doc);
     cs.postRun(&mt);
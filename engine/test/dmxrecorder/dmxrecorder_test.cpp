@@ -0,0 +1,346 @@
+/*
+  Q Light Controller Plus - Unit test
+  dmxrecorder_test.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QtTest>
+#include <QtEndian>
+
+#include "dmxrecorder_test.h"
+#include "inputoutputmap.h"
+#include "dmxrecorder.h"
+#include "universe.h"
+#include "doc.h"
+
+typedef struct
+{
+    quint8 m_type;
+    qint64 m_timestamp;
+    //! universe, first channel and values of each run
+    QList< QPair<int, QPair<int, QByteArray> > > m_runs;
+} Record;
+
+static bool readRecords(const QString &fileName, QList<Record> &records)
+{
+    QFile file(fileName);
+    if (file.open(QIODevice::ReadOnly) == false)
+        return false;
+
+    QByteArray data = file.readAll();
+    const uchar *ptr = reinterpret_cast<const uchar *>(data.constData());
+    const uchar *end = ptr + data.size();
+
+    if (data.size() < DMXRECORDER_HEADER_SIZE || data.left(8) != DMXRECORDER_MAGIC ||
+        qFromLittleEndian<quint32>(ptr + 8) != DMXRECORDER_VERSION)
+        return false;
+
+    ptr += DMXRECORDER_HEADER_SIZE;
+
+    while (ptr < end)
+    {
+        Record record;
+        record.m_type = ptr[0];
+        record.m_timestamp = qFromLittleEndian<qint64>(ptr + 1);
+        int runsCount = qFromLittleEndian<quint16>(ptr + 9);
+        ptr += 11;
+
+        for (int i = 0; i < runsCount; i++)
+        {
+            int universe = qFromLittleEndian<quint16>(ptr);
+            int start = qFromLittleEndian<quint16>(ptr + 2);
+            int length = qFromLittleEndian<quint16>(ptr + 4);
+            QByteArray values(reinterpret_cast<const char *>(ptr + 6), length);
+            record.m_runs.append(qMakePair(universe, qMakePair(start, values)));
+            ptr += 6 + length;
+        }
+
+        if (ptr > end)
+            return false;
+
+        records.append(record);
+    }
+
+    return true;
+}
+
+void DMXRecorder_Test::initTestCase()
+{
+    m_doc = new Doc(this);
+}
+
+void DMXRecorder_Test::cleanupTestCase()
+{
+    delete m_doc;
+}
+
+void DMXRecorder_Test::initial()
+{
+    DMXRecorder recorder(m_doc->inputOutputMap());
+    QVERIFY(recorder.isRecording() == false);
+    QCOMPARE(recorder.framesCount(), quint64(0));
+    QCOMPARE(recorder.droppedFramesCount(), quint64(0));
+
+    QVERIFY(recorder.startRecording(m_dir.filePath("missing/record.qxr")) == false);
+    QVERIFY(recorder.isRecording() == false);
+
+    // stopping an idle recorder is harmless
+    recorder.stopRecording();
+}
+
+void DMXRecorder_Test::recordOutput()
+{
+    InputOutputMap *iom = m_doc->inputOutputMap();
+    int universesCount = int(iom->universesCount());
+    QString fileName = m_dir.filePath("output.qxr");
+
+    // publish a first snapshot with all the universes
+    iom->dumpUniverses();
+
+    DMXRecorder recorder(iom);
+    QVERIFY(recorder.startRecording(fileName) == true);
+    QVERIFY(recorder.isRecording() == true);
+    QVERIFY(recorder.startRecording(fileName) == false);
+
+    QList<Universe*> unis = iom->claimUniverses();
+    unis[0]->write(3, 100);
+    unis[1]->write(10, 50);
+    unis[1]->write(11, 60);
+    iom->releaseUniverses();
+    iom->dumpUniverses();
+
+    unis = iom->claimUniverses();
+    unis[0]->write(3, 200);
+    iom->releaseUniverses();
+    iom->dumpUniverses();
+
+    // nothing changed, nothing published
+    iom->dumpUniverses();
+
+    recorder.stopRecording();
+    QVERIFY(recorder.isRecording() == false);
+    QCOMPARE(recorder.framesCount(), quint64(3));
+    QCOMPARE(recorder.droppedFramesCount(), quint64(0));
+
+    QList<Record> records;
+    QVERIFY(readRecords(fileName, records) == true);
+    QCOMPARE(records.count(), 3);
+
+    // a key frame with all the universes
+    QCOMPARE(records.at(0).m_type, quint8(DMXRecorder::OutputRecord | DMXRecorder::KeyFrameFlag));
+    QCOMPARE(records.at(0).m_runs.count(), universesCount);
+    QCOMPARE(records.at(0).m_runs.at(0).second.second, QByteArray(UNIVERSE_SIZE, 0));
+
+    // then only the changes
+    QCOMPARE(records.at(1).m_type, quint8(DMXRecorder::OutputRecord));
+    QCOMPARE(records.at(1).m_runs.count(), 2);
+    QCOMPARE(records.at(1).m_runs.at(0).first, 0);
+    QCOMPARE(records.at(1).m_runs.at(0).second.first, 3);
+    QCOMPARE(records.at(1).m_runs.at(0).second.second, QByteArray(1, char(100)));
+    QCOMPARE(records.at(1).m_runs.at(1).first, 1);
+    QCOMPARE(records.at(1).m_runs.at(1).second.first, 10);
+    QCOMPARE(records.at(1).m_runs.at(1).second.second, QByteArray("\x32\x3c"));
+
+    QCOMPARE(records.at(2).m_type, quint8(DMXRecorder::OutputRecord));
+    QCOMPARE(records.at(2).m_runs.count(), 1);
+    QCOMPARE(records.at(2).m_runs.at(0).second.second, QByteArray(1, char(200)));
+
+    QVERIFY(records.at(0).m_timestamp <= records.at(1).m_timestamp);
+    QVERIFY(records.at(1).m_timestamp <= records.at(2).m_timestamp);
+
+    unis = iom->claimUniverses();
+    unis[0]->reset();
+    unis[1]->reset();
+    iom->releaseUniverses();
+    iom->dumpUniverses();
+}
+
+void DMXRecorder_Test::recordInput()
+{
+    InputOutputMap *iom = m_doc->inputOutputMap();
+    QString fileName = m_dir.filePath("input.qxr");
+
+    DMXRecorder recorder(iom);
+    QVERIFY(recorder.startRecording(fileName, true) == true);
+
+    emit iom->inputValueChanged(1, 5, 77);
+
+    recorder.stopRecording();
+
+    QList<Record> records;
+    QVERIFY(readRecords(fileName, records) == true);
+
+    Record input;
+    input.m_type = 0;
+    foreach (Record record, records)
+    {
+        if (record.m_type & DMXRecorder::InputRecord)
+            input = record;
+    }
+
+    // the input values of the first two universes, as a key frame
+    QCOMPARE(input.m_type, quint8(DMXRecorder::InputRecord | DMXRecorder::KeyFrameFlag));
+    QCOMPARE(input.m_runs.count(), 2);
+    QCOMPARE(input.m_runs.at(1).first, 1);
+    QCOMPARE(input.m_runs.at(1).second.second.at(5), char(77));
+    QCOMPARE(input.m_runs.at(0).second.second, QByteArray(UNIVERSE_SIZE, 0));
+}
+
+void DMXRecorder_Test::inputChanges()
+{
+    InputOutputMap *iom = m_doc->inputOutputMap();
+    QString fileName = m_dir.filePath("changes.qxr");
+
+    DMXRecorder recorder(iom);
+    QVERIFY(recorder.startRecording(fileName, true) == true);
+
+    // fast movements of the same channel must not be coalesced
+    emit iom->inputValueChanged(0, 7, 10);
+    emit iom->inputValueChanged(0, 7, 20);
+    emit iom->inputValueChanged(0, 7, 30);
+    emit iom->inputValueChanged(0, 8, 40);
+
+    recorder.stopRecording();
+    QCOMPARE(recorder.droppedInputsCount(), quint64(0));
+
+    QList<Record> records;
+    QVERIFY(readRecords(fileName, records) == true);
+
+    QList<Record> inputs;
+    foreach (Record record, records)
+    {
+        if (record.m_type & DMXRecorder::InputRecord)
+            inputs.append(record);
+    }
+
+    // the changes drained together share a record, unless a channel changes again
+    QVERIFY(inputs.count() >= 3 && inputs.count() <= 4);
+    QCOMPARE(inputs.at(0).m_type, quint8(DMXRecorder::InputRecord | DMXRecorder::KeyFrameFlag));
+    QCOMPARE(inputs.at(0).m_runs.at(0).second.second.at(7), char(10));
+
+    QByteArray values(UNIVERSE_SIZE, 0);
+    QList<char> channel7;
+    for (int i = 0; i < inputs.count(); i++)
+    {
+        if (i > 0)
+        {
+            QCOMPARE(inputs.at(i).m_type, quint8(DMXRecorder::InputRecord));
+            QVERIFY(inputs.at(i - 1).m_timestamp <= inputs.at(i).m_timestamp);
+        }
+
+        for (int r = 0; r < inputs.at(i).m_runs.count(); r++)
+        {
+            QPair<int, QByteArray> run = inputs.at(i).m_runs.at(r).second;
+            QCOMPARE(inputs.at(i).m_runs.at(r).first, 0);
+            values.replace(run.first, run.second.size(), run.second);
+        }
+        channel7.append(values.at(7));
+    }
+
+    QCOMPARE(channel7.mid(0, 3), QList<char>() << char(10) << char(20) << char(30));
+    QCOMPARE(values.at(8), char(40));
+}
+
+void DMXRecorder_Test::roundTrip()
+{
+    InputOutputMap *iom = m_doc->inputOutputMap();
+    int universesCount = int(iom->universesCount());
+    QString fileName = m_dir.filePath("roundtrip" KExtDMXRecording);
+
+    iom->dumpUniverses();
+
+    DMXRecorder recorder(iom);
+    QVERIFY(recorder.startRecording(fileName, true) == true);
+
+    QList<Universe*> unis = iom->claimUniverses();
+    unis[0]->write(0, 1);
+    unis[0]->write(511, 2);
+    unis[1]->write(100, 3);
+    iom->releaseUniverses();
+    iom->dumpUniverses();
+
+    emit iom->inputValueChanged(1, 9, 99);
+
+    unis = iom->claimUniverses();
+    unis[0]->write(0, 4);
+    iom->releaseUniverses();
+    iom->dumpUniverses();
+
+    recorder.stopRecording();
+
+    DMXRecordingReader reader;
+    QVERIFY(reader.isOpen() == false);
+    QVERIFY(reader.readRecord() == false);
+    QVERIFY(reader.open(m_dir.filePath("missing" KExtDMXRecording)) == false);
+
+    QVERIFY(reader.open(fileName) == true);
+    QVERIFY(reader.isOpen() == true);
+    QVERIFY(reader.startTime() > 0);
+
+    QList<QByteArray> outputs;
+    QByteArray input;
+    qint64 lastOutput = -1;
+
+    while (reader.readRecord())
+    {
+        if (reader.recordType() == DMXRecorder::InputRecord)
+        {
+            QVERIFY(reader.isKeyFrame() == true);
+            QCOMPARE(reader.universesCount(DMXRecorder::InputRecord), 2);
+            input = QByteArray(reinterpret_cast<const char *>(reader.values(DMXRecorder::InputRecord, 1)),
+                               UNIVERSE_SIZE);
+            continue;
+        }
+
+        QVERIFY(reader.timestamp() >= lastOutput);
+        lastOutput = reader.timestamp();
+
+        QCOMPARE(reader.isKeyFrame(), outputs.isEmpty());
+        QCOMPARE(reader.universesCount(DMXRecorder::OutputRecord), universesCount);
+        QVERIFY(reader.values(DMXRecorder::OutputRecord, universesCount) == NULL);
+
+        QByteArray frame;
+        for (int u = 0; u < universesCount; u++)
+            frame.append(reinterpret_cast<const char *>(reader.values(DMXRecorder::OutputRecord, u)),
+                         UNIVERSE_SIZE);
+        outputs.append(frame);
+    }
+
+    // the decoded frames hold all the values, not only the changes
+    QCOMPARE(outputs.count(), 3);
+    QCOMPARE(outputs.at(0), QByteArray(universesCount * UNIVERSE_SIZE, 0));
+
+    QCOMPARE(outputs.at(1).at(0), char(1));
+    QCOMPARE(outputs.at(1).at(511), char(2));
+    QCOMPARE(outputs.at(1).at(UNIVERSE_SIZE + 100), char(3));
+
+    QCOMPARE(outputs.at(2).at(0), char(4));
+    QCOMPARE(outputs.at(2).at(511), char(2));
+    QCOMPARE(outputs.at(2).at(UNIVERSE_SIZE + 100), char(3));
+
+    QCOMPARE(input.at(9), char(99));
+
+    reader.close();
+    QVERIFY(reader.isOpen() == false);
+
+    unis = iom->claimUniverses();
+    unis[0]->reset();
+    unis[1]->reset();
+    iom->releaseUniverses();
+    iom->dumpUniverses();
+}
+
+QTEST_MAIN(DMXRecorder_Test)
@@ -2132,6 +2132,42 @@ void EFX_Test::widthHeightOffset()
     QVERIFY(max == 189);
 }
 
+void EFX_Test::pathTable()
+{
+    EFX e(m_doc);
+    QVERIFY(e.m_pathTableChanged == true);
+
+    // Not sampled yet: points are calculated
+    float x = 0, y = 0, tx = 0, ty = 0;
+    e.calculateTablePoint(Function::Forward, 0, 1.0, &tx, &ty);
+    e.calculatePoint(Function::Forward, 0, 1.0, &x, &y);
+    QCOMPARE(tx, x);
+    QCOMPARE(ty, y);
+
+    QList<EFX::Algorithm> algos;
+    algos << EFX::Circle << EFX::Eight << EFX::Line << EFX::Diamond << EFX::Leaf << EFX::Lissajous;
+
+    foreach (EFX::Algorithm algo, algos)
+    {
+        e.setAlgorithm(algo);
+        QVERIFY(e.m_pathTableChanged == true);
+        e.updatePathTable();
+        QVERIFY(e.m_pathTableChanged == false);
+        QCOMPARE(e.m_pathX.size(), EFX_PATH_TABLE_SIZE + 1);
+
+        for (float i = 0; i < M_PI * 2; i += 0.01)
+        {
+            e.calculateTablePoint(Function::Backward, 45, i, &tx, &ty);
+            e.calculatePoint(Function::Backward, 45, i, &x, &y);
+            QVERIFY(qAbs(tx - x) < 0.01);
+            QVERIFY(qAbs(ty - y) < 0.01);
+        }
+    }
+
+    e.setXFrequency(5);
+    QVERIFY(e.m_pathTableChanged == true);
+}
+
 void EFX_Test::rotateAndScale()
 {
     EFX efx(m_doc);
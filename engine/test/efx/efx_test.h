@@ -70,6 +70,7 @@ private slots:
 
     void rotateAndScale();
     void widthHeightOffset();
+    void pathTable();
 
     void copyFrom();
     void createCopy();
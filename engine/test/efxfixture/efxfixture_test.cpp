@@ -453,6 +453,7 @@ void EFXFixture_Test::setPoint8bit()
 
     QList<Universe*> ua;
     ua.append(new Universe(0, new GrandMaster()));
+    ef.start(NULL, ua); // resolves the channels
     ef.setPointPanTilt (ua, 5.4, 1.5); // PMSB: 5, PLSB: 0.4, TMSB: 1 (102), TLSB: 0.5(127)
     QCOMPARE((int)ua[0]->preGMValues()[m_fixture8bitAddress + 0], 5);
     QCOMPARE((int)ua[0]->preGMValues()[m_fixture8bitAddress + 1], 1);
@@ -468,6 +469,7 @@ void EFXFixture_Test::setPoint16bit()
 
     QList<Universe*> ua;
     ua.append(new Universe(0, new GrandMaster()));
+    ef.start(NULL, ua); // resolves the channels
     ef.setPointPanTilt(ua, 5.4, 1.5); // PMSB: 5, PLSB: 0.4, TMSB: 1 (102), TLSB: 0.5(127)
     QCOMPARE((int)ua[0]->preGMValues()[m_fixture16bitAddress + 0], 5);
     QCOMPARE((int)ua[0]->preGMValues()[m_fixture16bitAddress + 1], 1);
@@ -483,6 +485,7 @@ void EFXFixture_Test::setPointPanOnly()
 
     QList<Universe*> ua;
     ua.append(new Universe(0, new GrandMaster()));
+    ef.start(NULL, ua); // resolves the channels
     ef.setPointPanTilt(ua, 5.4, 1.5); // PMSB: 5, PLSB: 0.4, TMSB: 1 (102), TLSB: 0.5(127)
     QCOMPARE((int)ua[0]->preGMValues()[m_fixturePanOnlyAddress + 0], 5); /* Pan */
     QCOMPARE((int)ua[0]->preGMValues()[m_fixturePanOnlyAddress + 1], 0);
@@ -498,6 +501,7 @@ void EFXFixture_Test::setPointLedBar()
 
     QList<Universe*> ua;
     ua.append(new Universe(0, new GrandMaster()));
+    ef.start(NULL, ua); // resolves the channels
     ef.setPointPanTilt(ua, 5.4, 1.5); // PMSB: 5, PLSB: 0.4, TMSB: 1 (102), TLSB: 0.5(127)
     QCOMPARE((int)ua[0]->preGMValues()[m_fixtureLedBarAddress + 0], 1); /* Tilt */
     QCOMPARE((int)ua[0]->preGMValues()[m_fixtureLedBarAddress + 1], 0);
@@ -505,6 +509,68 @@ void EFXFixture_Test::setPointLedBar()
     QCOMPARE((int)ua[0]->preGMValues()[m_fixtureLedBarAddress + 3], 0);
 }
 
+void EFXFixture_Test::setPointRGB()
+{
+    EFX e(m_doc);
+    e.m_fader = new GenericFader(m_doc);
+    e.m_fader->setKeepZeroChannels(true);
+    EFXFixture ef(&e);
+    ef.setHead(GroupHead(m_fixtureLedBar, 0));
+    ef.setMode(EFXFixture::RGB);
+
+    QList<Universe*> ua;
+    ua.append(new Universe(0, new GrandMaster()));
+    ef.start(NULL, ua); // resolves the channels and their fader slots
+    QCOMPARE(ef.m_intensityIndex, -1);
+    QCOMPARE(e.m_fader->count(), 3);
+    for (int i = 0; i < 3; i++)
+    {
+        QVERIFY(ef.m_rgbIndices[i] >= 0);
+        QCOMPARE(e.m_fader->m_identities[ef.m_rgbIndices[i]].m_channel, ef.m_rgbChannels[i]);
+    }
+
+    // Every step updates the same slots in place
+    ef.setPointRGB(ua, 10, 10);
+    ef.setPointRGB(ua, 200, 60);
+    QCOMPARE(e.m_fader->count(), 3);
+
+    QColor pixel = EFXFixture::m_rgbGradient.pixel(200, 60);
+    QCOMPARE(int(e.m_fader->m_targets[ef.m_rgbIndices[0]]), pixel.red());
+    QCOMPARE(int(e.m_fader->m_targets[ef.m_rgbIndices[1]]), pixel.green());
+    QCOMPARE(int(e.m_fader->m_targets[ef.m_rgbIndices[2]]), pixel.blue());
+
+    delete e.m_fader;
+    e.m_fader = NULL;
+}
+
+void EFXFixture_Test::fixtureChanged()
+{
+    EFX e(m_doc);
+    e.setDuration(0);
+    EFXFixture* ef = new EFXFixture(&e);
+    ef->setHead(GroupHead(m_fixture8bit, 0));
+    e.addFixture(ef);
+
+    QList<Universe*> ua;
+    ua.append(new Universe(0, new GrandMaster()));
+    ef->start(NULL, ua);
+    quint32 panOffset = ef->m_panMsbChannel - m_fixture8bitAddress;
+
+    // The running head picks the new address at the next step
+    m_doc->fixture(m_fixture8bit)->setAddress(400);
+    e.slotFixtureChanged(m_fixture8bit);
+    QVERIFY(ef->m_channelsChanged.loadAcquire() == 1);
+    QCOMPARE(ef->m_panMsbChannel, m_fixture8bitAddress + panOffset);
+
+    ef->nextStep(NULL, ua);
+    QVERIFY(ef->m_channelsChanged.loadAcquire() == 0);
+    QCOMPARE(ef->m_panMsbChannel, quint32(400) + panOffset);
+
+    // Other fixtures are ignored
+    e.slotFixtureChanged(m_fixture16bit);
+    QVERIFY(ef->m_channelsChanged.loadAcquire() == 0);
+}
+
 void EFXFixture_Test::nextStepLoop()
 {
     QList<Universe*> ua;
@@ -51,6 +51,8 @@ private slots:
     void setPoint16bit();
     void setPointPanOnly();
     void setPointLedBar();
+    void setPointRGB();
+    void fixtureChanged();
 
     void startOffset();
     void nextStepLoop();
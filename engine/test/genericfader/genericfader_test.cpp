@@ -73,53 +73,53 @@ void GenericFader_Test::addRemove()
     FadeChannel wrong;
     fc.setFixture(m_doc, 0);
 
-    QCOMPARE(fader.m_channels.count(), 0);
-    QVERIFY(fader.m_channels.contains(fc) == false);
+    QCOMPARE(fader.count(), 0);
+    QVERIFY(fader.contains(fc) == false);
 
     fader.add(fc);
-    QVERIFY(fader.m_channels.contains(fc) == true);
-    QCOMPARE(fader.m_channels.count(), 1);
+    QVERIFY(fader.contains(fc) == true);
+    QCOMPARE(fader.count(), 1);
 
     fader.remove(wrong);
-    QVERIFY(fader.m_channels.contains(fc) == true);
-    QCOMPARE(fader.m_channels.count(), 1);
+    QVERIFY(fader.contains(fc) == true);
+    QCOMPARE(fader.count(), 1);
 
     fader.remove(fc);
-    QVERIFY(fader.m_channels.contains(fc) == false);
-    QCOMPARE(fader.m_channels.count(), 0);
+    QVERIFY(fader.contains(fc) == false);
+    QCOMPARE(fader.count(), 0);
 
     fc.setChannel(m_doc, 0);
     fader.add(fc);
-    QVERIFY(fader.m_channels.contains(fc) == true);
+    QVERIFY(fader.contains(fc) == true);
 
     fc.setChannel(m_doc, 1);
     fader.add(fc);
-    QVERIFY(fader.m_channels.contains(fc) == true);
+    QVERIFY(fader.contains(fc) == true);
 
     fc.setChannel(m_doc, 2);
     fader.add(fc);
-    QVERIFY(fader.m_channels.contains(fc) == true);
-    QCOMPARE(fader.m_channels.count(), 3);
+    QVERIFY(fader.contains(fc) == true);
+    QCOMPARE(fader.count(), 3);
 
     fader.removeAll();
-    QCOMPARE(fader.m_channels.count(), 0);
+    QCOMPARE(fader.count(), 0);
 
     fc.setFixture(m_doc, 0);
     fc.setChannel(m_doc, 0);
     fc.setTarget(127);
     fader.add(fc);
-    QCOMPARE(fader.m_channels.size(), 1);
-    QCOMPARE(fader.m_channels[fc].target(), uchar(127));
+    QCOMPARE(fader.count(), 1);
+    QCOMPARE(fader.channel(fc).target(), uchar(127));
 
     fc.setTarget(63);
     fader.add(fc);
-    QCOMPARE(fader.m_channels.size(), 1);
-    QCOMPARE(fader.m_channels[fc].target(), uchar(63));
+    QCOMPARE(fader.count(), 1);
+    QCOMPARE(fader.channel(fc).target(), uchar(63));
 
     fc.setCurrent(63);
     fader.add(fc);
-    QCOMPARE(fader.m_channels.size(), 1);
-    QCOMPARE(fader.m_channels[fc].target(), uchar(63));
+    QCOMPARE(fader.count(), 1);
+    QCOMPARE(fader.channel(fc).target(), uchar(63));
 }
 
 void GenericFader_Test::writeZeroFade()
@@ -212,4 +212,167 @@ void GenericFader_Test::adjustIntensity()
     }
 }
 
+void GenericFader_Test::writeRemove()
+{
+    QList<Universe*> ua;
+    ua.append(new Universe(0, new GrandMaster()));
+    GenericFader fader(m_doc);
+
+    // Channels without a fixture are HTP, with absolute addresses
+    FadeChannel fc;
+    fc.setStart(0);
+    fc.setFadeTime(0);
+
+    fc.setChannel(m_doc, 100);
+    fc.setTarget(0);
+    fader.add(fc);
+
+    fc.setChannel(m_doc, 101);
+    fc.setTarget(200);
+    fader.add(fc);
+
+    fc.setChannel(m_doc, 102);
+    fc.setTarget(0);
+    fader.add(fc);
+
+    fc.setChannel(m_doc, 103);
+    fc.setTarget(100);
+    fc.setFlashing(true);
+    fader.add(fc);
+
+    QCOMPARE(fader.count(), 4);
+
+    fader.write(ua);
+    QCOMPARE(uchar(ua[0]->preGMValues()[101]), uchar(200));
+    QCOMPARE(uchar(ua[0]->preGMValues()[103]), uchar(100));
+
+    // Zero HTP channels and flashing channels are removed once written
+    QCOMPARE(fader.count(), 1);
+    fc.setChannel(m_doc, 100);
+    QVERIFY(fader.contains(fc) == false);
+    fc.setChannel(m_doc, 102);
+    QVERIFY(fader.contains(fc) == false);
+    fc.setChannel(m_doc, 103);
+    QVERIFY(fader.contains(fc) == false);
+
+    // The remaining channel is still found, with its values
+    fc.setChannel(m_doc, 101);
+    QVERIFY(fader.contains(fc) == true);
+    QCOMPARE(fader.channel(fc).current(), uchar(200));
+    QCOMPARE(fader.channel(fc).target(), uchar(200));
+    QCOMPARE(fader.channels().count(), 1);
+    QCOMPARE(fader.channels().at(0).channel(), quint32(101));
+
+    // Adding after a removal keeps the lookup consistent
+    fc.setChannel(m_doc, 104);
+    fc.setFlashing(false);
+    fader.add(fc);
+    QCOMPARE(fader.count(), 2);
+    QVERIFY(fader.contains(fc) == true);
+    fader.remove(fc);
+    QVERIFY(fader.contains(fc) == false);
+    fc.setChannel(m_doc, 101);
+    QVERIFY(fader.contains(fc) == true);
+    QCOMPARE(fader.count(), 1);
+}
+
+void GenericFader_Test::startValues()
+{
+    QList<Universe*> ua;
+    ua.append(new Universe(0, new GrandMaster()));
+    ua[0]->write(10, 77);
+
+    GenericFader fader(m_doc);
+    FadeChannel fc;
+    fc.setFixture(m_doc, 0);
+    fc.setFadeTime(500);
+
+    // LTP channel
+    fc.setChannel(m_doc, 0);
+    fc.setTarget(100);
+    fader.add(fc);
+
+    // HTP channel
+    fc.setChannel(m_doc, 5);
+    fc.setTarget(200);
+    fader.add(fc);
+
+    // HTP channels start from zero, LTP ones from the universe
+    fader.setStartValues(NULL, ua);
+    QCOMPARE(int(fader.m_starts.at(0)), 77);
+    QCOMPARE(int(fader.m_currents.at(0)), 77);
+    QCOMPARE(int(fader.m_starts.at(1)), 0);
+
+    // unless another fader holds them
+    GenericFader other(m_doc);
+    fc.setCurrent(50);
+    other.add(fc);
+
+    fader.m_elapsed[1] = 100;
+    fader.setStartValues(&other, ua);
+    QCOMPARE(int(fader.m_starts.at(0)), 77);
+    QCOMPARE(int(fader.m_starts.at(1)), 50);
+    QCOMPARE(int(fader.m_currents.at(1)), 50);
+    QCOMPARE(fader.m_elapsed.at(1), uint(0));
+
+    fader.setFadeTime(1000);
+    QCOMPARE(fader.m_fadeTimes.at(0), uint(1000));
+    QCOMPARE(fader.m_fadeTimes.at(1), uint(1000));
+
+    // the channels that can't fade jump to their target
+    m_doc->fixture(0)->setChannelCanFade(0, false);
+    fc.setChannel(m_doc, 0);
+    fc.setTarget(100);
+    fader.forceAdd(fc);
+    fader.setFadeTime(1000);
+    QCOMPARE(fader.m_fadeTimes.at(0), uint(0));
+    QCOMPARE(fader.m_fadeTimes.at(1), uint(1000));
+}
+
+void GenericFader_Test::channelIndex()
+{
+    QList<Universe*> ua;
+    ua.append(new Universe(0, new GrandMaster()));
+    GenericFader fader(m_doc);
+
+    FadeChannel fc;
+    fc.setFixture(m_doc, 0);
+    fc.setChannel(m_doc, 5);
+
+    int index = fader.channelIndex(fc);
+    QCOMPARE(index, 0);
+    QCOMPARE(fader.count(), 1);
+    QCOMPARE(fader.channelIndex(fc), 0);
+    QCOMPARE(fader.count(), 1);
+
+    fc.setChannel(m_doc, 0);
+    QCOMPARE(fader.channelIndex(fc), 1);
+
+    // a new target fades from the current value
+    fader.setTarget(index, 200, 1000);
+    QCOMPARE(int(fader.m_starts.at(index)), 0);
+    QCOMPARE(int(fader.m_targets.at(index)), 200);
+    fader.write(ua);
+    fader.write(ua);
+    uchar current = fader.m_currents.at(index);
+    QVERIFY(current > 0);
+
+    // the same target keeps fading
+    fader.setTarget(index, 200, 1000);
+    QCOMPARE(fader.m_elapsed.at(index), uint(2 * MasterTimer::tick()));
+
+    fader.setTarget(index, 0, 0);
+    QCOMPARE(fader.m_starts.at(index), current);
+    QCOMPARE(fader.m_elapsed.at(index), uint(0));
+
+    // zero HTP channels are removed, unless asked to keep them
+    fader.setKeepZeroChannels(true);
+    fader.write(ua);
+    QCOMPARE(fader.count(), 2);
+
+    fader.setKeepZeroChannels(false);
+    fader.write(ua);
+    QCOMPARE(fader.count(), 1);
+}
+
 QTEST_APPLESS_MAIN(GenericFader_Test)
@@ -36,6 +36,9 @@ private slots:
     void writeZeroFade();
     void writeLoop();
     void adjustIntensity();
+    void writeRemove();
+    void startValues();
+    void channelIndex();
 
 private:
     Doc* m_doc;
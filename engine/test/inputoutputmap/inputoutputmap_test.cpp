@@ -653,7 +653,10 @@ void InputOutputMap_Test::claimReleaseDumpReset()
         unis[3]->write(i, 'd');
     iom.releaseUniverses();
 
+    // the plugin of the 4 universes is flushed once per dump
+    int flushCount = stub->m_flushCount;
     iom.dumpUniverses();
+    QCOMPARE(stub->m_flushCount, flushCount + 1);
 
     for (int i = 0; i < 512; i++)
         QCOMPARE(stub->m_universe.data()[i], 'a');
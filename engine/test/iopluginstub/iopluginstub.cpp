@@ -33,6 +33,8 @@ void IOPluginStub::init()
     m_configureCalled = 0;
     m_canConfigure = false;
     m_universe = QByteArray(int(4 * 512), char(0));
+    m_changedWritesCount = 0;
+    m_flushCount = 0;
 }
 
 QString IOPluginStub::name()
@@ -86,13 +88,21 @@ QString IOPluginStub::outputInfo(quint32 output)
     return QString("This is a plugin stub for testing.");
 }
 
-void IOPluginStub::writeUniverse(quint32 universe, quint32 output, const QByteArray &data)
+void IOPluginStub::writeUniverse(quint32 universe, quint32 output, const QByteArray &data, bool dataChanged)
 {
     Q_UNUSED(universe)
 
+    if (dataChanged)
+        m_changedWritesCount++;
+
     m_universe = m_universe.replace(output * 512, data.size(), data);
 }
 
+void IOPluginStub::flushOutputs()
+{
+    m_flushCount++;
+}
+
 /*****************************************************************************
  * Inputs
  *****************************************************************************/
@@ -70,7 +70,10 @@ public:
     QString outputInfo(quint32 output);
 
     /** @reimp */
-    void writeUniverse(quint32 universe, quint32 output, const QByteArray& data);
+    void writeUniverse(quint32 universe, quint32 output, const QByteArray& data, bool dataChanged);
+
+    /** @reimp */
+    void flushOutputs();
 
 public:
     /** List of outputs that have been opened */
@@ -79,6 +82,12 @@ public:
     /** Fake universe buffer */
     QByteArray m_universe;
 
+    /** Number of writes flagged as changed */
+    int m_changedWritesCount;
+
+    /** Number of flushOutputs calls */
+    int m_flushCount;
+
     /*********************************************************************
      * Inputs
      *********************************************************************/
@@ -5,6 +5,11 @@ LANGUAGE = C++
 TARGET   = mastertimer_test
 
 QT      += testlib
+qmlui {
+  QT += qml
+} else {
+  QT += script
+}
 CONFIG  -= app_bundle
 
 DEPENDPATH   += ../../src
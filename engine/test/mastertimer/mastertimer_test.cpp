@@ -21,12 +21,20 @@
 
 #define private public
 #include "mastertimer_test.h"
+#include "qlcfixturemode.h"
+#include "qlcfixturedef.h"
 #include "dmxsource_stub.h"
 #include "function_stub.h"
+#include "fixturegroup.h"
 #include "mastertimer.h"
+#include "efxfixture.h"
 #include "qlcchannel.h"
+#include "rgbmatrix.h"
+#include "rgbplain.h"
 #include "universe.h"
+#include "fixture.h"
 #include "qlcfile.h"
+#include "efx.h"
 #include "doc.h"
 #undef private
 
@@ -367,4 +375,234 @@ void MasterTimer_Test::restart()
     mt->stopAllFunctions();
 }
 
+void MasterTimer_Test::clock()
+{
+    MasterTimer* mt = m_doc->masterTimer();
+    QVERIFY(mt->m_virtualClock == false);
+
+    quint64 time = mt->clockTime();
+    QTest::qWait(30);
+    QVERIFY(mt->clockTime() >= time + 30);
+
+    mt->setVirtualClockTime(1000);
+    QCOMPARE(mt->clockTime(), quint64(1000));
+    QTest::qWait(30);
+    QCOMPARE(mt->clockTime(), quint64(1000));
+
+    mt->setVirtualClockTime(1020);
+    QCOMPARE(mt->clockTime(), quint64(1020));
+}
+
+void MasterTimer_Test::scheduledBeat()
+{
+    MasterTimer* mt = m_doc->masterTimer();
+    quint64 time = 2000;
+    quint64 tick = MasterTimer::tick();
+
+    mt->setBeatSourceType(MasterTimer::External);
+    mt->setVirtualClockTime(time);
+
+    QSignalSpy spy(mt, SIGNAL(beat()));
+
+    // a beat between two ticks is fired by the closest one
+    mt->requestBeatAt(time + 2 * tick - tick / 4);
+    mt->timerTick();
+    QCOMPARE(spy.count(), 0);
+
+    mt->setVirtualClockTime(time + tick);
+    mt->timerTick();
+    QCOMPARE(spy.count(), 0);
+
+    mt->setVirtualClockTime(time + 2 * tick);
+    mt->timerTick();
+    QCOMPARE(spy.count(), 1);
+
+    // only once
+    mt->setVirtualClockTime(time + 3 * tick);
+    mt->timerTick();
+    QCOMPARE(spy.count(), 1);
+
+    // the beat fired early: predicting it again must not fire it twice
+    quint64 beat = quint64(mt->beatTimeDuration());
+    QVERIFY(beat > 4 * tick);
+    mt->requestBeatAt(time + 2 * tick + tick / 4);
+    mt->setVirtualClockTime(time + 4 * tick);
+    mt->timerTick();
+    QCOMPARE(spy.count(), 1);
+
+    // the next beat fires
+    time += 2 * tick + beat;
+    mt->requestBeatAt(time);
+    mt->setVirtualClockTime(time);
+    mt->timerTick();
+    QCOMPARE(spy.count(), 2);
+
+    // changing the beat source drops the scheduled beat
+    time += beat;
+    mt->requestBeatAt(time);
+    mt->setBeatSourceType(MasterTimer::None);
+    mt->setBeatSourceType(MasterTimer::External);
+    mt->setVirtualClockTime(time);
+    mt->timerTick();
+    QCOMPARE(spy.count(), 2);
+
+    // and forgets the last beat fired
+    mt->requestBeatAt(time);
+    mt->timerTick();
+    QCOMPARE(spy.count(), 3);
+
+    mt->setBeatSourceType(MasterTimer::None);
+}
+
+void MasterTimer_Test::requestBpmNumber()
+{
+    // a timer of its own, driven by hand
+    MasterTimer mt(m_doc);
+    QSignalSpy spy(&mt, SIGNAL(bpmNumberChanged(int)));
+    QCOMPARE(mt.bpmNumber(), 120);
+    QCOMPARE(mt.beatTimeDuration(), 500);
+
+    // the request is reported right away, but applied by the next tick
+    mt.requestBpmNumber(150);
+    QCOMPARE(mt.bpmNumber(), 150);
+    QCOMPARE(mt.beatTimeDuration(), 400);
+    QCOMPARE(mt.m_currentBPM, 120);
+    QCOMPARE(mt.m_beatTimeDuration, 500);
+    QCOMPARE(spy.count(), 0);
+
+    mt.timerTick();
+    QCOMPARE(mt.m_currentBPM, 150);
+    QCOMPARE(mt.m_beatTimeDuration, 400);
+    QVERIFY(mt.m_requestedBPM.loadAcquire() == 0);
+    QCOMPARE(spy.count(), 1);
+    QCOMPARE(spy.at(0).at(0).toInt(), 150);
+
+    // only the last request counts
+    mt.requestBpmNumber(100);
+    mt.requestBpmNumber(200);
+    mt.timerTick();
+    QCOMPARE(mt.bpmNumber(), 200);
+    QCOMPARE(mt.beatTimeDuration(), 300);
+    QCOMPARE(spy.count(), 2);
+
+    // the same BPM number, or an invalid one, changes nothing
+    mt.requestBpmNumber(200);
+    mt.requestBpmNumber(0);
+    mt.timerTick();
+    QCOMPARE(mt.bpmNumber(), 200);
+    QCOMPARE(spy.count(), 2);
+}
+
+QList<QByteArray> MasterTimer_Test::runFunctions(MasterTimer *timer, QList<Function *> functions, int ticks)
+{
+    QList<QByteArray> values;
+    QList<Universe*> ua;
+    ua.append(new Universe(0, new GrandMaster()));
+
+    foreach (Function *function, functions)
+        function->start(timer, FunctionParent::master());
+
+    for (int i = 0; i < ticks; i++)
+    {
+        ua[0]->zeroIntensityChannels();
+        timer->timerTickFunctions(ua);
+        values.append(ua[0]->preGMValues());
+    }
+
+    foreach (Function *function, functions)
+        function->stop(FunctionParent::master());
+    timer->timerTickFunctions(ua);
+    Q_ASSERT(timer->runningFunctions() == 0);
+
+    qDeleteAll(ua);
+    return values;
+}
+
+void MasterTimer_Test::parallelWrite()
+{
+    // a timer of its own, driven by hand
+    MasterTimer mt(m_doc);
+    QList<Function *> functions;
+
+    QLCFixtureDef* def = m_doc->fixtureDefCache()->fixtureDef("Futurelight", "DJScan250");
+    QVERIFY(def != NULL);
+    QLCFixtureMode* mode = def->modes().first();
+    QVERIFY(mode != NULL);
+
+    quint32 address = 0;
+    QList<quint32> heads;
+    for (int i = 0; i < 4; i++)
+    {
+        Fixture* fxi = new Fixture(m_doc);
+        fxi->setFixtureDefinition(def, mode);
+        fxi->setAddress(address);
+        address += fxi->channels();
+        m_doc->addFixture(fxi);
+        heads << fxi->id();
+    }
+
+    def = m_doc->fixtureDefCache()->fixtureDef("Stairville", "LED PAR56");
+    QVERIFY(def != NULL);
+    mode = def->modes().first();
+    QVERIFY(mode != NULL);
+
+    FixtureGroup* grp = new FixtureGroup(m_doc);
+    grp->setSize(QSize(4, 1));
+    m_doc->addFixtureGroup(grp);
+    for (int i = 0; i < 4; i++)
+    {
+        Fixture* fxi = new Fixture(m_doc);
+        fxi->setFixtureDefinition(def, mode);
+        fxi->setAddress(address);
+        address += fxi->channels();
+        m_doc->addFixture(fxi);
+        grp->assignFixture(fxi->id());
+    }
+
+    // the last EFX shares its heads with the other two, so the running
+    // order decides the values of those channels
+    QList<EFX::Algorithm> algorithms;
+    algorithms << EFX::Circle << EFX::Eight << EFX::Lissajous;
+    QList<int> pairs;
+    pairs << 0 << 2 << 1 << 3 << 2 << 1;
+    for (int i = 0; i < 3; i++)
+    {
+        EFX *efx = new EFX(m_doc);
+        efx->setAlgorithm(algorithms.at(i));
+        efx->setDuration(400 + i * 100);
+        m_doc->addFunction(efx);
+
+        for (int h = 0; h < 2; h++)
+        {
+            EFXFixture *ef = new EFXFixture(efx);
+            ef->setHead(GroupHead(heads.at(pairs.at(i * 2 + h)), 0));
+            efx->addFixture(ef);
+        }
+        functions << efx;
+    }
+
+    RGBMatrix *mtx = new RGBMatrix(m_doc);
+    mtx->setFixtureGroup(grp->id());
+    mtx->setAlgorithm(new RGBPlain(m_doc));
+    mtx->setStartColor(Qt::cyan);
+    mtx->setFadeInSpeed(200);
+    mtx->setDuration(300);
+    m_doc->addFunction(mtx);
+    functions << mtx;
+
+    mt.setParallelWrite(false);
+    QList<QByteArray> serial = runFunctions(&mt, functions, 50);
+
+    mt.setParallelWrite(true);
+    QList<QByteArray> parallel = runFunctions(&mt, functions, 50);
+    QVERIFY(mt.m_parallelWriter != NULL);
+
+    QCOMPARE(serial.count(), parallel.count());
+    for (int i = 0; i < serial.count(); i++)
+        QCOMPARE(parallel.at(i), serial.at(i));
+
+    // the functions did write something
+    QVERIFY(serial.last() != QByteArray(serial.last().size(), char(0)));
+}
+
 QTEST_MAIN(MasterTimer_Test)
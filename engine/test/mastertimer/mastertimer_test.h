@@ -22,6 +22,8 @@
 
 #include <QObject>
 
+class MasterTimer;
+class Function;
 class Doc;
 class MasterTimer_Test : public QObject
 {
@@ -43,6 +45,14 @@ private slots:
     void stopAllFunctions();
     void stop();
     void restart();
+    void clock();
+    void scheduledBeat();
+    void requestBpmNumber();
+    void parallelWrite();
+
+private:
+    /** Run $functions for $ticks ticks and return the universe after each */
+    QList<QByteArray> runFunctions(MasterTimer *timer, QList<Function *> functions, int ticks);
 
 private:
     Doc* m_doc;
@@ -114,14 +114,14 @@ void OutputPatch_Test::dump()
     QVERIFY(stub->m_universe[169] == (char) 0);
     QVERIFY(stub->m_universe[511] == (char) 0);
 
-    op->dump(0, uni);
+    op->dump(0, uni, true);
     QVERIFY(stub->m_universe[0] == (char) 100);
     QVERIFY(stub->m_universe[169] == (char) 50);
     QVERIFY(stub->m_universe[511] == (char) 25);
 
     /* Test the pause state */
     op->setPaused(true);
-    op->dump(0, uni);
+    op->dump(0, uni, true);
     QVERIFY(stub->m_universe[0] == (char) 100);
     QVERIFY(stub->m_universe[169] == (char) 50);
     QVERIFY(stub->m_universe[511] == (char) 25);
@@ -130,13 +130,13 @@ void OutputPatch_Test::dump()
     uni[169] = 2;
     uni[511] = 3;
 
-    op->dump(0, uni);
+    op->dump(0, uni, true);
     QVERIFY(stub->m_universe[0] == (char) 100);
     QVERIFY(stub->m_universe[169] == (char) 50);
     QVERIFY(stub->m_universe[511] == (char) 25);
 
     op->setPaused(false);
-    op->dump(0, uni);
+    op->dump(0, uni, true);
     QVERIFY(stub->m_universe[0] == (char) 1);
     QVERIFY(stub->m_universe[169] == (char) 2);
     QVERIFY(stub->m_universe[511] == (char) 3);
@@ -144,4 +144,41 @@ void OutputPatch_Test::dump()
     delete op;
 }
 
+void OutputPatch_Test::dumpUnchanged()
+{
+    QByteArray uni(512, char(0));
+
+    OutputPatch* op = new OutputPatch(0, this);
+
+    IOPluginStub* stub = static_cast<IOPluginStub*>
+                                (m_doc->ioPluginCache()->plugins().at(0));
+    QVERIFY(stub != NULL);
+
+    /* the first dump after patching is always flagged as changed */
+    op->set(stub, 0);
+    int count = stub->m_changedWritesCount;
+    op->dump(0, uni, false);
+    QCOMPARE(stub->m_changedWritesCount, count + 1);
+
+    op->dump(0, uni, false);
+    QCOMPARE(stub->m_changedWritesCount, count + 1);
+
+    op->dump(0, uni, true);
+    QCOMPARE(stub->m_changedWritesCount, count + 2);
+
+    /* blackout and pause changes force a write */
+    op->setBlackout(true);
+    op->dump(0, uni, false);
+    QCOMPARE(stub->m_changedWritesCount, count + 3);
+
+    op->setPaused(true);
+    op->dump(0, uni, false);
+    QCOMPARE(stub->m_changedWritesCount, count + 4);
+
+    op->dump(0, uni, false);
+    QCOMPARE(stub->m_changedWritesCount, count + 4);
+
+    delete op;
+}
+
 QTEST_APPLESS_MAIN(OutputPatch_Test)
@@ -19,6 +19,7 @@
 */
 
 #include <QtTest>
+#include <QThreadPool>
 #include <QXmlStreamReader>
 #include <QXmlStreamWriter>
 
@@ -28,9 +29,11 @@
 #include "qlcfixturemode.h"
 #include "qlcfixturedef.h"
 #include "fixturegroup.h"
+#include "genericfader.h"
 #include "mastertimer.h"
 #include "rgbmatrix.h"
 #include "fixture.h"
+#include "universe.h"
 #include "qlcfile.h"
 #include "doc.h"
 #undef private
@@ -174,6 +177,123 @@ void RGBMatrix_Test::previewMaps()
     }
 }
 
+void RGBMatrix_Test::prerender()
+{
+    RGBMatrix mtx(m_doc);
+    QVERIFY(mtx.algorithm() != NULL);
+    QVERIFY(mtx.algorithm()->isCacheable() == true);
+
+    mtx.setFixtureGroup(0);
+    mtx.m_group = m_doc->fixtureGroup(0);
+    mtx.setStartColor(Qt::red);
+    mtx.setEndColor(Qt::blue);
+    mtx.setDirection(Function::Backward);
+    mtx.setRunOrder(Function::SingleShot);
+
+    // The matrices share the same pool
+    RGBMatrix other(m_doc);
+    QVERIFY(mtx.prerenderPool() == other.prerenderPool());
+
+    mtx.startPrerender();
+    RGBMatrix::prerenderPool()->waitForDone();
+    mtx.stopPrerender();
+    QVERIFY(mtx.m_prerenderState.isNull());
+
+    // All the steps are cached, with the colors of a backward playback
+    QCOMPARE(mtx.algorithm()->m_mapsCache.count(), 5);
+
+    RGBMatrixStep handler;
+    handler.initializeDirection(Function::Backward, Qt::red, Qt::blue, 5);
+    QCOMPARE(handler.currentStepIndex(), 4);
+    for (int i = 0; i < 5; i++)
+    {
+        QPair<quint64, quint64> key((quint64(5) << 32) | 5,
+                                    (quint64(handler.stepColor().rgb()) << 32) | quint32(handler.currentStepIndex()));
+        QVERIFY(mtx.algorithm()->m_mapsCache.contains(key));
+        handler.checkNextStep(Function::SingleShot, Qt::red, Qt::blue, 5);
+    }
+
+    // Stopping a matrix that is not pre-rendering does nothing
+    mtx.stopPrerender();
+    other.stopPrerender();
+
+    // Cancelling doesn't wait, and a new pre-rendering waits for
+    // the cancelled one in the pool
+    mtx.algorithm()->clearMapsCache();
+    mtx.startPrerender();
+    QSharedPointer<RGBMatrix::PrerenderState> first = mtx.m_prerenderState;
+    mtx.cancelPrerender();
+    QVERIFY(mtx.m_prerenderState == first);
+
+    mtx.startPrerender();
+    QVERIFY(mtx.m_prerenderState != first);
+    RGBMatrix::prerenderPool()->waitForDone();
+    QCOMPARE(mtx.algorithm()->m_mapsCache.count(), 5);
+
+    mtx.stopPrerender();
+    QVERIFY(mtx.m_prerenderState.isNull());
+}
+
+void RGBMatrix_Test::mapChannels()
+{
+    RGBMatrix mtx(m_doc);
+    mtx.setFixtureGroup(0);
+    mtx.setFadeInSpeed(0);
+    mtx.setFadeOutSpeed(0);
+    FixtureGroup *grp = m_doc->fixtureGroup(0);
+    QVERIFY(grp != NULL);
+
+    mtx.m_fader = new GenericFader(m_doc);
+    mtx.m_fader->setKeepZeroChannels(true);
+
+    QList<Universe*> ua;
+    ua.append(new Universe(0, new GrandMaster()));
+
+    // each pixel is a PAR with RGB channels and no dimmer
+    RGBMap map(5, QVector<uint>(5, QColor(Qt::red).rgb()));
+    mtx.updateMapChannels(map, grp);
+    QVERIFY(mtx.m_pixelMapChanged == false);
+    QCOMPARE(mtx.m_pixelMap.count(), 25);
+    QCOMPARE(mtx.m_fader->count(), 75);
+
+    const RGBMatrix::PixelChannels &pixel = mtx.m_pixelMap.at(0);
+    QCOMPARE(pixel.m_colorsCount, 3);
+    QCOMPARE(pixel.m_dimmersCount, 0);
+    QCOMPARE(int(mtx.m_fader->m_targets.at(pixel.m_colors[0])), 255);
+    QCOMPARE(int(mtx.m_fader->m_targets.at(pixel.m_colors[1])), 0);
+    QCOMPARE(int(mtx.m_fader->m_targets.at(pixel.m_colors[2])), 0);
+
+    // the channels at zero stay, so that the indices remain valid
+    mtx.m_fader->write(ua);
+    QCOMPARE(mtx.m_fader->count(), 75);
+    QCOMPARE(int(mtx.m_fader->m_currents.at(pixel.m_colors[0])), 255);
+
+    // the next step fades from the current values
+    map = RGBMap(5, QVector<uint>(5, QColor(Qt::blue).rgb()));
+    mtx.updateMapChannels(map, grp);
+    QCOMPARE(mtx.m_fader->count(), 75);
+    QCOMPARE(int(mtx.m_fader->m_starts.at(pixel.m_colors[0])), 255);
+    QCOMPARE(int(mtx.m_fader->m_targets.at(pixel.m_colors[0])), 0);
+    QCOMPARE(int(mtx.m_fader->m_targets.at(pixel.m_colors[2])), 255);
+
+    // a fixture change resolves the pixels again, on the same channels
+    mtx.slotFixtureChanged(grp->fixtureList().first());
+    QVERIFY(mtx.m_pixelMapChanged == true);
+    mtx.updateMapChannels(map, grp);
+    QVERIFY(mtx.m_pixelMapChanged == false);
+    QCOMPARE(mtx.m_fader->count(), 75);
+
+    // changes of other groups are ignored
+    mtx.slotFixtureGroupChanged(42);
+    QVERIFY(mtx.m_pixelMapChanged == false);
+    mtx.slotFixtureGroupChanged(0);
+    QVERIFY(mtx.m_pixelMapChanged == true);
+
+    delete mtx.m_fader;
+    mtx.m_fader = NULL;
+    qDeleteAll(ua);
+}
+
 void RGBMatrix_Test::loadSave()
 {
     RGBMatrix* mtx = new RGBMatrix(m_doc);
@@ -42,6 +42,8 @@ private slots:
     void color();
     void copy();
     void previewMaps();
+    void prerender();
+    void mapChannels();
     void loadSave();
 
 private:
@@ -46,7 +46,12 @@ void RGBScript_Test::cleanupTestCase()
 void RGBScript_Test::initial()
 {
     RGBScript script(m_doc);
+#ifdef QT_QML_LIB
+    QVERIFY(script.m_engine != NULL);
+    QVERIFY(script.s_enginePool.contains(script.m_engine));
+#else
     QVERIFY(script.s_engine == NULL);
+#endif
     QCOMPARE(script.m_apiVersion, 0);
     QCOMPARE(script.m_fileName, QString());
     QCOMPARE(script.m_contents, QString());
@@ -194,4 +199,69 @@ void RGBScript_Test::rgbMap()
     }
 }
 
+void RGBScript_Test::rgbMapTypedArray()
+{
+#ifdef QT_QML_LIB
+    // A flat Uint32Array, filled with the color on the step column
+    QString code("( function() { var foo = new Object; foo.apiVersion = 1;"
+                 "foo.rgbMap = function(width, height, rgb, step) {"
+                 "  var map = new Uint32Array(width * height);"
+                 "  for (var y = 0; y < height; y++) map[y * width + step] = rgb;"
+                 "  return map; };"
+                 "foo.rgbMapStepCount = function(width, height) { return width; };"
+                 "return foo; } )()");
+    RGBScript s(m_doc);
+    s.m_contents = code;
+    QCOMPARE(s.evaluate(), true);
+
+    RGBMap map = s.rgbMap(QSize(4, 3), QColor(Qt::green).rgb(), 2);
+    QCOMPARE(map.size(), 3);
+    for (int y = 0; y < 3; y++)
+    {
+        QCOMPARE(map[y].size(), 4);
+        for (int x = 0; x < 4; x++)
+        {
+            if (x == 2)
+                QCOMPARE(map[y][x], QColor(Qt::green).rgb());
+            else
+                QCOMPARE(map[y][x], uint(0));
+        }
+    }
+
+    // Other typed arrays of the same element size are not taken as colors
+    s.m_contents = code.replace("Uint32Array", "Float32Array");
+    QCOMPARE(s.evaluate(), true);
+    QVERIFY(s.rgbMap(QSize(4, 3), QColor(Qt::green).rgb(), 2).isEmpty());
+#endif
+}
+
+void RGBScript_Test::assignment()
+{
+#ifdef QT_QML_LIB
+    int scriptsCount = 0;
+    foreach (RGBScript::PooledEngine *engine, RGBScript::s_enginePool)
+        scriptsCount += engine->m_scriptsCount;
+
+    {
+        RGBScript s(m_doc);
+        s = m_doc->rgbScriptsCache()->script("Stripes");
+        s = m_doc->rgbScriptsCache()->script("Stripes");
+        QCOMPARE(s.fileName(), QString("stripes.js"));
+        QVERIFY(s.m_rgbMap.isCallable() == true);
+        QVERIFY(s.m_engine->m_scriptsCount > 0);
+
+        // self assignment keeps the script working
+        RGBScript &ref = s;
+        s = ref;
+        QVERIFY(s.m_rgbMap.isCallable() == true);
+    }
+
+    // every engine is released once
+    int count = 0;
+    foreach (RGBScript::PooledEngine *engine, RGBScript::s_enginePool)
+        count += engine->m_scriptsCount;
+    QCOMPARE(count, scriptsCount);
+#endif
+}
+
 QTEST_MAIN(RGBScript_Test)
@@ -41,6 +41,8 @@ private slots:
     void evaluateInvalidApiVersion();
     void rgbMapStepCount();
     void rgbMap();
+    void rgbMapTypedArray();
+    void assignment();
 
 private:
     Doc * m_doc;
@@ -424,4 +424,57 @@ void RGBText_Test::verticalScroll()
     }
 }
 
+void RGBText_Test::mapsCache()
+{
+    RGBText text(m_doc);
+    text.setText("QLC");
+    text.setAnimationStyle(RGBText::StaticLetters);
+    QVERIFY(text.isCacheable() == true);
+    QCOMPARE(text.m_mapsCache.size(), 0);
+    int totalSize = RGBAlgorithm::mapsCacheTotalSize();
+
+    QRgb color(0xFFFFFFFF);
+    RGBMap map = text.cachedRgbMap(QSize(10, 10), color, 0);
+    QCOMPARE(map, text.rgbMap(QSize(10, 10), color, 0));
+    QCOMPARE(text.m_mapsCache.size(), 1);
+    QCOMPARE(text.m_mapsCacheSize, int(10 * 10 * sizeof(uint)));
+    QCOMPARE(RGBAlgorithm::mapsCacheTotalSize(), totalSize + int(10 * 10 * sizeof(uint)));
+
+    // Same arguments, the map comes from the cache
+    QCOMPARE(text.cachedRgbMap(QSize(10, 10), color, 0), map);
+    QCOMPARE(text.m_mapsCache.size(), 1);
+
+    // Any different argument is a different map
+    text.cachedRgbMap(QSize(10, 10), color, 1);
+    text.cachedRgbMap(QSize(10, 10), 0xFFFF0000, 0);
+    text.cachedRgbMap(QSize(10, 11), color, 0);
+    QCOMPARE(text.m_mapsCache.size(), 4);
+
+    // Changing a setting invalidates the cache
+    text.setText("QLC+");
+    QCOMPARE(text.m_mapsCache.size(), 0);
+    QCOMPARE(text.m_mapsCacheSize, 0);
+    QCOMPARE(RGBAlgorithm::mapsCacheTotalSize(), totalSize);
+    QVERIFY(text.isMapsCacheFull() == false);
+
+    // The budget is shared by all the algorithms
+    {
+        RGBText other(m_doc);
+        other.setText("QLC");
+        other.cachedRgbMap(QSize(10, 10), color, 0);
+        text.cachedRgbMap(QSize(10, 10), color, 0);
+        QCOMPARE(RGBAlgorithm::mapsCacheTotalSize(), totalSize + int(2 * 10 * 10 * sizeof(uint)));
+    }
+    QCOMPARE(RGBAlgorithm::mapsCacheTotalSize(), totalSize + int(10 * 10 * sizeof(uint)));
+
+    // Once it is used up, the maps are computed but not cached
+    int available = RGBMAP_CACHE_BUDGET - RGBAlgorithm::mapsCacheTotalSize();
+    RGBAlgorithm::s_mapsCacheTotalSize.fetchAndAddOrdered(available);
+    QVERIFY(text.isMapsCacheFull() == true);
+    QCOMPARE(text.cachedRgbMap(QSize(10, 10), color, 1), text.rgbMap(QSize(10, 10), color, 1));
+    QCOMPARE(text.m_mapsCache.size(), 1);
+    QCOMPARE(RGBAlgorithm::mapsCacheTotalSize(), RGBMAP_CACHE_BUDGET);
+    RGBAlgorithm::s_mapsCacheTotalSize.fetchAndAddOrdered(-available);
+}
+
 QTEST_MAIN(RGBText_Test)
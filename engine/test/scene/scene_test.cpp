@@ -154,6 +154,57 @@ void Scene_Test::values()
     QVERIFY(s.values().size() == 0);
 }
 
+void Scene_Test::compileValues()
+{
+    Scene s(m_doc);
+    s.setValue(1, 2, 3);
+    s.setValue(4, 5, 6);
+    QVERIFY(s.m_valuesChanged == true);
+
+    s.compileValues();
+    QVERIFY(s.m_valuesChanged == false);
+    QCOMPARE(s.m_compiledFader.count(), 2);
+    QList<FadeChannel> channels = s.m_compiledFader.channels();
+    QCOMPARE(channels.at(0).fixture(), quint32(1));
+    QCOMPARE(channels.at(0).channel(), quint32(2));
+    QCOMPARE(channels.at(0).target(), uchar(3));
+    QCOMPARE(channels.at(1).fixture(), quint32(4));
+    QCOMPARE(channels.at(1).channel(), quint32(5));
+    QCOMPARE(channels.at(1).target(), uchar(6));
+
+    /* Same value, nothing to compile */
+    s.setValue(1, 2, 3);
+    QVERIFY(s.m_valuesChanged == false);
+
+    s.setValue(1, 2, 15);
+    QVERIFY(s.m_valuesChanged == true);
+    s.compileValues();
+    QCOMPARE(s.m_compiledFader.channels().at(0).target(), uchar(15));
+
+    s.unsetValue(4, 5);
+    QVERIFY(s.m_valuesChanged == true);
+    s.compileValues();
+    QCOMPARE(s.m_compiledFader.count(), 1);
+
+    /* Fixture changes invalidate the compiled values */
+    s.slotFixtureChanged(1);
+    QVERIFY(s.m_valuesChanged == true);
+
+    /* Doc forwards the fixture changes to its scenes */
+    Fixture *fxi = new Fixture(m_doc);
+    fxi->setChannels(4);
+    m_doc->addFixture(fxi);
+
+    Scene *s2 = new Scene(m_doc);
+    s2->setValue(fxi->id(), 0, 255);
+    m_doc->addFunction(s2);
+    s2->compileValues();
+    QVERIFY(s2->m_valuesChanged == false);
+
+    fxi->setAddress(100);
+    QVERIFY(s2->m_valuesChanged == true);
+}
+
 void Scene_Test::colorValue()
 {
     Doc* doc = new Doc(this);
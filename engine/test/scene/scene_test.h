@@ -35,6 +35,7 @@ private slots:
 
     void initial();
     void values();
+    void compileValues();
     void colorValue();
     void channelGroup();
     void fixtureRemoval();
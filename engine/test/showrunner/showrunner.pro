@@ -0,0 +1,20 @@
+include(../../../variables.pri)
+include(../../../coverage.pri)
+TEMPLATE = app
+LANGUAGE = C++
+TARGET   = showrunner_test
+
+QT      += testlib
+greaterThan(QT_MAJOR_VERSION, 4): QT += multimedia
+CONFIG  -= app_bundle
+
+DEPENDPATH   += ../../src
+INCLUDEPATH  += ../../../plugins/interfaces
+INCLUDEPATH  += ../../src
+INCLUDEPATH  += ../../audio/src
+INCLUDEPATH  += ../mastertimer
+QMAKE_LIBDIR += ../../src ../../audio/src
+LIBS         += -lqlcplusengine -lqlcplusaudio
+
+SOURCES += showrunner_test.cpp ../mastertimer/mastertimer_stub.cpp
+HEADERS += showrunner_test.h ../mastertimer/mastertimer_stub.h
@@ -0,0 +1,463 @@
+/*
+  Q Light Controller Plus - Unit test
+  showrunner_test.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QtTest>
+
+#define private public
+#define protected public
+#include "showrunner_test.h"
+#include "audiorenderer.h"
+#include "audiopcmcache.h"
+#include "mastertimer.h"
+#include "showrunner.h"
+#include "showfunction.h"
+#include "track.h"
+#include "audio.h"
+#include "scene.h"
+#include "show.h"
+#include "doc.h"
+#undef protected
+#undef private
+
+/** A renderer that plays nothing, with a settable latency */
+class RendererStub : public AudioRenderer
+{
+public:
+    RendererStub() : AudioRenderer(), m_latency(0) { }
+
+    bool initialize(quint32, int, AudioFormat) { return true; }
+    qint64 latency() { return m_latency; }
+    void drain() { }
+    void reset() { }
+    void suspend() { }
+    void resume() { }
+    qint64 writeAudio(unsigned char *, qint64 maxSize) { return maxSize; }
+
+    /** Make playbackPosition() return $msec, without extrapolation */
+    void setPosition(qint64 msec)
+    {
+        QMutexLocker locker(&m_positionMutex);
+        m_playedPosition = m_writtenPosition = msec * 1000;
+        m_positionTimer.start();
+    }
+
+    qint64 m_latency;
+};
+
+/** Add to $show an Audio starting with the show, and return it */
+static Audio *addSyncAudio(Doc *doc, Show *show)
+{
+    Audio *audio = new Audio(doc);
+    doc->addFunction(audio);
+
+    ShowFunction *sf = show->tracks().first()->createShowFunction(audio->id());
+    sf->setStartTime(0);
+    sf->setDuration(4000);
+
+    return audio;
+}
+
+void ShowRunner_Test::initTestCase()
+{
+    m_doc = new Doc(this);
+}
+
+void ShowRunner_Test::cleanupTestCase()
+{
+    delete m_doc;
+}
+
+void ShowRunner_Test::init()
+{
+    m_doc->masterTimer()->setVirtualClockTime(0);
+
+    m_show = new Show(m_doc);
+    m_doc->addFunction(m_show);
+
+    Track *track = new Track();
+    m_show->addTrack(track);
+
+    /* 0    500  800  1000 1200      2500  3000      4000
+     * |--A------------|
+     *      |--B-----------------------|
+     *           |--C-------|
+     *                                       |--D-------|
+     */
+    quint32 times[4][2] = { { 0, 1000 }, { 500, 2000 }, { 800, 400 }, { 3000, 1000 } };
+
+    for (int i = 0; i < 4; i++)
+    {
+        m_scenes[i] = new Scene(m_doc);
+        m_doc->addFunction(m_scenes[i]);
+
+        ShowFunction *sf = track->createShowFunction(m_scenes[i]->id());
+        sf->setStartTime(times[i][0]);
+        sf->setDuration(times[i][1]);
+    }
+}
+
+void ShowRunner_Test::cleanup()
+{
+    m_doc->clearContents();
+}
+
+void ShowRunner_Test::index()
+{
+    ShowRunner runner(m_doc, m_show->id());
+
+    QCOMPARE(runner.m_functions.count(), 4);
+    QCOMPARE(runner.m_totalRunTime, quint32(4000));
+
+    // C is the root, B the root of [A, B] and D the one of [D]
+    QCOMPARE(runner.m_maxStopTimes.count(), 4);
+    QCOMPARE(runner.m_maxStopTimes.at(0), quint32(1000));
+    QCOMPARE(runner.m_maxStopTimes.at(1), quint32(2500));
+    QCOMPARE(runner.m_maxStopTimes.at(2), quint32(4000));
+    QCOMPARE(runner.m_maxStopTimes.at(3), quint32(4000));
+
+    QList<ShowFunction *> list;
+    runner.activeFunctions(0, 4, 0, list);
+    QCOMPARE(list.count(), 1);
+    QCOMPARE(list.at(0)->functionID(), m_scenes[0]->id());
+
+    list.clear();
+    runner.activeFunctions(0, 4, 900, list);
+    QCOMPARE(list.count(), 3);
+    QCOMPARE(list.at(0)->functionID(), m_scenes[0]->id());
+    QCOMPARE(list.at(1)->functionID(), m_scenes[1]->id());
+    QCOMPARE(list.at(2)->functionID(), m_scenes[2]->id());
+
+    // the stop time is not included
+    list.clear();
+    runner.activeFunctions(0, 4, 1000, list);
+    QCOMPARE(list.count(), 2);
+    QCOMPARE(list.at(0)->functionID(), m_scenes[1]->id());
+    QCOMPARE(list.at(1)->functionID(), m_scenes[2]->id());
+
+    list.clear();
+    runner.activeFunctions(0, 4, 2700, list);
+    QCOMPARE(list.count(), 0);
+
+    list.clear();
+    runner.activeFunctions(0, 4, 3500, list);
+    QCOMPARE(list.count(), 1);
+    QCOMPARE(list.at(0)->functionID(), m_scenes[3]->id());
+
+    list.clear();
+    runner.activeFunctions(0, 4, 5000, list);
+    QCOMPARE(list.count(), 0);
+}
+
+void ShowRunner_Test::seek()
+{
+    Scene *a = m_scenes[0];
+    Scene *b = m_scenes[1];
+    Scene *c = m_scenes[2];
+    Scene *d = m_scenes[3];
+
+    ShowRunner runner(m_doc, m_show->id());
+    runner.setAudioSyncEnabled(false);
+
+    runner.write();
+    QCOMPARE(runner.m_elapsedTime, quint32(0));
+    QCOMPARE(runner.m_currentFunctionIndex, 1);
+    QCOMPARE(runner.m_runningQueue.count(), 1);
+    QCOMPARE(runner.m_runningQueue.at(0).first, (Function *)a);
+    QCOMPARE(a->stopped(), false);
+
+    // seek into the overlapping functions: A keeps running,
+    // B and C start with the time already elapsed
+    a->m_elapsed = 12345;
+    runner.seek(900);
+    runner.write();
+    QCOMPARE(runner.m_elapsedTime, quint32(900));
+    QCOMPARE(runner.m_currentFunctionIndex, 3);
+    QCOMPARE(runner.m_runningQueue.count(), 3);
+    QCOMPARE(runner.m_runningQueue.at(0).first, (Function *)a);
+    QCOMPARE(runner.m_runningQueue.at(1).first, (Function *)c);
+    QCOMPARE(runner.m_runningQueue.at(2).first, (Function *)b);
+    QCOMPARE(a->stopped(), false);
+    QCOMPARE(a->m_elapsed, quint32(12345));
+    QCOMPARE(b->m_elapsed, quint32(400));
+    QCOMPARE(c->m_elapsed, quint32(100));
+
+    // seek across the end of A: B and C keep running
+    b->m_elapsed = 12345;
+    c->m_elapsed = 12345;
+    runner.seek(1100);
+    runner.write();
+    QCOMPARE(runner.m_elapsedTime, quint32(1100));
+    QCOMPARE(runner.m_currentFunctionIndex, 3);
+    QCOMPARE(runner.m_runningQueue.count(), 2);
+    QCOMPARE(runner.m_runningQueue.at(0).first, (Function *)c);
+    QCOMPARE(runner.m_runningQueue.at(1).first, (Function *)b);
+    QCOMPARE(a->stopped(), true);
+    QCOMPARE(b->m_elapsed, quint32(12345));
+    QCOMPARE(c->m_elapsed, quint32(12345));
+
+    // seek out of the overlapping functions
+    runner.seek(3500);
+    runner.write();
+    QCOMPARE(runner.m_elapsedTime, quint32(3500));
+    QCOMPARE(runner.m_currentFunctionIndex, 4);
+    QCOMPARE(runner.m_runningQueue.count(), 1);
+    QCOMPARE(runner.m_runningQueue.at(0).first, (Function *)d);
+    QCOMPARE(b->stopped(), true);
+    QCOMPARE(c->stopped(), true);
+    QCOMPARE(d->stopped(), false);
+    QCOMPARE(d->m_elapsed, quint32(500));
+
+    // seek back: the functions starting later are left to write()
+    runner.seek(600);
+    runner.write();
+    QCOMPARE(runner.m_elapsedTime, quint32(600));
+    QCOMPARE(runner.m_currentFunctionIndex, 2);
+    QCOMPARE(runner.m_runningQueue.count(), 2);
+    QCOMPARE(runner.m_runningQueue.at(0).first, (Function *)a);
+    QCOMPARE(runner.m_runningQueue.at(1).first, (Function *)b);
+    QCOMPARE(d->stopped(), true);
+    QCOMPARE(a->m_elapsed, quint32(600));
+    QCOMPARE(b->m_elapsed, quint32(100));
+
+    // the clock runs from the seek position
+    m_doc->masterTimer()->setVirtualClockTime(250);
+    runner.write();
+    QCOMPARE(runner.m_elapsedTime, quint32(850));
+    QCOMPARE(runner.m_currentFunctionIndex, 3);
+    QCOMPARE(runner.m_runningQueue.count(), 3);
+    QCOMPARE(runner.m_runningQueue.at(1).first, (Function *)c);
+    QCOMPARE(c->stopped(), false);
+    QCOMPARE(c->m_elapsed, quint32(50));
+
+    runner.stop();
+    QCOMPARE(runner.m_runningQueue.count(), 0);
+}
+
+void ShowRunner_Test::seekLongFunction()
+{
+    Show *show = new Show(m_doc);
+    m_doc->addFunction(show);
+
+    Track *track = new Track();
+    show->addTrack(track);
+
+    /* Short functions around a long one:
+     * 0  10  20  30  100                         1000
+     * |-||-||-||-|   |-----------------------------|
+     *                      300  400  500
+     *                      |-|  |-|  |-|
+     */
+    quint32 times[8][2] = { { 0, 10 }, { 10, 10 }, { 20, 10 }, { 30, 10 },
+                            { 100, 900 }, { 300, 10 }, { 400, 10 }, { 500, 10 } };
+    Scene *scenes[8];
+
+    for (int i = 0; i < 8; i++)
+    {
+        scenes[i] = new Scene(m_doc);
+        m_doc->addFunction(scenes[i]);
+
+        ShowFunction *sf = track->createShowFunction(scenes[i]->id());
+        sf->setStartTime(times[i][0]);
+        sf->setDuration(times[i][1]);
+    }
+
+    ShowRunner runner(m_doc, show->id());
+    runner.setAudioSyncEnabled(false);
+
+    QList<ShowFunction *> list;
+    runner.activeFunctions(0, 8, 200, list);
+    QCOMPARE(list.count(), 1);
+    QCOMPARE(list.at(0)->functionID(), scenes[4]->id());
+
+    list.clear();
+    runner.activeFunctions(0, 8, 405, list);
+    QCOMPARE(list.count(), 2);
+    QCOMPARE(list.at(0)->functionID(), scenes[4]->id());
+    QCOMPARE(list.at(1)->functionID(), scenes[6]->id());
+
+    // the long function starts when the show starts from its middle
+    runner.seek(200);
+    runner.write();
+    QCOMPARE(runner.m_elapsedTime, quint32(200));
+    QCOMPARE(runner.m_currentFunctionIndex, 5);
+    QCOMPARE(runner.m_runningQueue.count(), 1);
+    QCOMPARE(runner.m_runningQueue.at(0).first, (Function *)scenes[4]);
+    QCOMPARE(scenes[4]->stopped(), false);
+    QCOMPARE(scenes[4]->m_elapsed, quint32(100));
+
+    runner.seek(405);
+    runner.write();
+    QCOMPARE(runner.m_currentFunctionIndex, 7);
+    QCOMPARE(runner.m_runningQueue.count(), 2);
+    QCOMPARE(runner.m_runningQueue.at(0).first, (Function *)scenes[6]);
+    QCOMPARE(runner.m_runningQueue.at(1).first, (Function *)scenes[4]);
+    QCOMPARE(scenes[6]->m_elapsed, quint32(5));
+
+    runner.stop();
+    QCOMPARE(runner.m_runningQueue.count(), 0);
+}
+
+void ShowRunner_Test::audioSync()
+{
+    Audio *audio = addSyncAudio(m_doc, m_show);
+    RendererStub renderer;
+    double maxStep = MasterTimer::tick() / 4.0;
+
+    ShowRunner runner(m_doc, m_show->id());
+    runner.write();
+    QCOMPARE(runner.m_syncAudio, audio);
+    audio->m_audio_out = &renderer;
+
+    // nothing played yet
+    runner.syncToAudio(0);
+    QCOMPARE(runner.m_clockCorrection, 0.0);
+
+    // small differences are corrected by a fraction
+    renderer.setPosition(40);
+    runner.syncToAudio(0);
+    QCOMPARE(runner.m_clockCorrection, 2.0);
+
+    // larger ones never faster than the slew limit, both ways
+    renderer.setPosition(400);
+    runner.syncToAudio(0);
+    QCOMPARE(runner.m_clockCorrection, 2.0 + maxStep);
+
+    renderer.setPosition(0);
+    runner.syncToAudio(400);
+    QCOMPARE(runner.m_clockCorrection, 2.0);
+
+    // the correction moves the show clock
+    m_doc->masterTimer()->setVirtualClockTime(100);
+    runner.m_clockCorrection = 10;
+    QCOMPARE(runner.clockPosition(), quint32(110));
+
+    // nothing is corrected while paused
+    renderer.setPosition(140);
+    runner.setPause(true);
+    runner.syncToAudio(110);
+    QCOMPARE(runner.m_clockCorrection, 10.0);
+    runner.setPause(false);
+
+    audio->m_audio_out = NULL;
+    runner.stop();
+}
+
+void ShowRunner_Test::audioSyncJump()
+{
+    Scene *b = m_scenes[1];
+    Scene *d = m_scenes[3];
+    Audio *audio = addSyncAudio(m_doc, m_show);
+    RendererStub renderer;
+
+    ShowRunner runner(m_doc, m_show->id());
+    runner.write();
+    QCOMPARE(runner.m_syncAudio, audio);
+    audio->m_audio_out = &renderer;
+
+    m_doc->masterTimer()->setVirtualClockTime(600);
+    runner.write();
+    QCOMPARE(runner.m_elapsedTime, quint32(600));
+    QCOMPARE(b->stopped(), false);
+
+    // a large difference is not followed if it doesn't persist
+    renderer.setPosition(3200);
+    for (int i = 0; i < 5; i++)
+        runner.syncToAudio(600);
+    QCOMPARE(runner.m_syncDriftCount, 5);
+
+    renderer.setPosition(600);
+    runner.syncToAudio(600);
+    QCOMPARE(runner.m_syncDriftCount, 0);
+    QCOMPARE(runner.m_seekRequested, false);
+
+    // then the clock doesn't slew, it seeks to the audio position
+    renderer.setPosition(3200);
+    for (int i = 0; i < 9; i++)
+        runner.syncToAudio(600);
+    QCOMPARE(runner.m_seekRequested, false);
+    QCOMPARE(runner.m_clockCorrection, 0.0);
+
+    runner.write();
+    QCOMPARE(runner.m_elapsedTime, quint32(3200));
+    QCOMPARE(runner.m_clockCorrection, 0.0);
+    QCOMPARE(runner.m_syncDriftCount, 0);
+
+    // the functions follow the seek, the audio keeps playing
+    QCOMPARE(b->stopped(), true);
+    QCOMPARE(d->stopped(), false);
+    QCOMPARE(d->m_elapsed, quint32(200));
+    QCOMPARE(runner.m_runningQueue.count(), 2);
+    QCOMPARE(runner.m_runningQueue.at(0).first, (Function *)audio);
+    QCOMPARE(runner.m_runningQueue.at(1).first, (Function *)d);
+    QCOMPARE(audio->stopped(), false);
+    QCOMPARE(runner.m_syncAudio, audio);
+
+    // the show follows the audio from there
+    m_doc->masterTimer()->setVirtualClockTime(700);
+    renderer.setPosition(3300);
+    runner.write();
+    QCOMPARE(runner.m_elapsedTime, quint32(3300));
+
+    audio->m_audio_out = NULL;
+    runner.stop();
+}
+
+void ShowRunner_Test::rendererPosition()
+{
+    // 2 seconds of 16 bit stereo at 1000 Hz: 4 bytes per millisecond
+    QByteArray pcm(2000 * 4, 0);
+    AudioDecoderPCMCache decoder(pcm, AudioParameters(1000, 2, PCM_S16LE));
+
+    RendererStub renderer;
+    renderer.setDecoder(&decoder);
+    QCOMPARE(renderer.playbackPosition(), qint64(-1));
+
+    // 1 second written after a seek to 500ms, 50ms still in the device
+    renderer.m_latency = 50;
+    renderer.setStartPosition(500);
+    renderer.m_bytesWritten = 1000 * 4;
+    renderer.updatePosition();
+    QCOMPARE(renderer.m_writtenPosition, qint64(1500000));
+    QCOMPARE(renderer.m_playedPosition, qint64(1450000));
+
+    qint64 position = renderer.playbackPosition();
+    QVERIFY(position >= 1450 && position < 1500);
+
+    // the device keeps playing between writes...
+    QTest::qSleep(30);
+    QVERIFY(renderer.playbackPosition() >= 1480);
+
+    // ...but not beyond what has been written
+    QTest::qSleep(50);
+    QCOMPARE(renderer.playbackPosition(), qint64(1500));
+
+    // and not for longer than AUDIO_POSITION_MAX_EXTRAPOLATION
+    renderer.m_latency = 500;
+    renderer.updatePosition();
+    QCOMPARE(renderer.m_playedPosition, qint64(1000000));
+    QTest::qSleep(AUDIO_POSITION_MAX_EXTRAPOLATION + 50);
+    QCOMPARE(renderer.playbackPosition(), qint64(1000 + AUDIO_POSITION_MAX_EXTRAPOLATION));
+
+    // the latency can't move the position before the start
+    renderer.m_latency = 2000;
+    renderer.updatePosition();
+    QCOMPARE(renderer.m_playedPosition, qint64(500000));
+}
+
+QTEST_APPLESS_MAIN(ShowRunner_Test)
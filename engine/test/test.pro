@@ -1,4 +1,10 @@
 TEMPLATE = subdirs
+SUBDIRS += audiocapture
+SUBDIRS += audiopcmcache
+SUBDIRS += audiowaveform
+SUBDIRS += bakedshow
+SUBDIRS += bakedstream
+SUBDIRS += beattracker
 SUBDIRS += bus
 SUBDIRS += chaser
 SUBDIRS += chaserrunner
@@ -6,6 +12,7 @@ SUBDIRS += chaserstep
 SUBDIRS += collection
 SUBDIRS += cue
 SUBDIRS += cuestack
+SUBDIRS += dmxrecorder
 SUBDIRS += doc
 SUBDIRS += efx
 SUBDIRS += efxfixture
@@ -40,7 +47,10 @@ SUBDIRS += scene
 SUBDIRS += scenevalue
 !qmlui: SUBDIRS += script
 SUBDIRS += sequence
+SUBDIRS += showrunner
+SUBDIRS += tickprofiler
 SUBDIRS += universe
+SUBDIRS += universesnapshot
 
 # Stubs
 SUBDIRS += iopluginstub
@@ -0,0 +1,158 @@
+/*
+  Q Light Controller Plus - Unit test
+  tickprofiler_test.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QtTest>
+
+#include "tickprofiler_test.h"
+#include "tickprofiler.h"
+#include "dmxsource.h"
+
+class DMXSourceStub : public DMXSource
+{
+public:
+    void writeDMX(MasterTimer *timer, QList<Universe*> universes)
+    {
+        Q_UNUSED(timer);
+        Q_UNUSED(universes);
+    }
+};
+
+void TickProfiler_Test::rollingStatistics()
+{
+    RollingStatistics rs;
+    TickStatistics stats = rs.statistics();
+    QCOMPARE(stats.m_samples, quint32(0));
+    QCOMPARE(stats.m_max, quint32(0));
+
+    for (quint32 i = 100; i >= 1; i--)
+        rs.add(i);
+
+    stats = rs.statistics();
+    QCOMPARE(stats.m_samples, quint32(100));
+    QCOMPARE(stats.m_p50, quint32(50));
+    QCOMPARE(stats.m_p99, quint32(99));
+    QCOMPARE(stats.m_max, quint32(100));
+}
+
+void TickProfiler_Test::rollingStatisticsWrap()
+{
+    RollingStatistics rs;
+
+    rs.add(1000000);
+    for (int i = 0; i < TICKPROFILER_SAMPLES; i++)
+        rs.add(10);
+
+    /* the oldest sample has been dropped */
+    TickStatistics stats = rs.statistics();
+    QCOMPARE(stats.m_samples, quint32(TICKPROFILER_SAMPLES));
+    QCOMPARE(stats.m_p50, quint32(10));
+    QCOMPARE(stats.m_max, quint32(10));
+
+    rs.clear();
+    QCOMPARE(rs.statistics().m_samples, quint32(0));
+}
+
+void TickProfiler_Test::ticks()
+{
+    TickProfiler tp;
+    QCOMPARE(tp.ticksCount(), quint64(0));
+    QCOMPARE(tp.lateTicksCount(), quint64(0));
+
+    /* a tick long enough for anything */
+    tp.beginTick(qint64(1000) * 1000000, tp.timestamp());
+    for (int i = TickProfiler::BeatPhase; i < TickProfiler::TotalPhase; i++)
+        tp.endPhase(TickProfiler::Phase(i));
+    tp.endTick();
+
+    QCOMPARE(tp.ticksCount(), quint64(1));
+    QCOMPARE(tp.lateTicksCount(), quint64(0));
+    QCOMPARE(tp.phaseStatistics(TickProfiler::DumpPhase).m_samples, quint32(1));
+    QCOMPARE(tp.jitterStatistics().m_samples, quint32(1));
+    QCOMPARE(tp.jitterStatistics().m_max, quint32(0));
+
+    /* a tick that cannot be on time */
+    tp.beginTick(0, tp.timestamp());
+    QTest::qSleep(2);
+    tp.endTick();
+
+    QCOMPARE(tp.ticksCount(), quint64(2));
+    QCOMPARE(tp.lateTicksCount(), quint64(1));
+    QVERIFY(tp.phaseStatistics(TickProfiler::TotalPhase).m_max >= 2000);
+
+    QCOMPARE(TickProfiler::phaseToString(TickProfiler::FunctionsPhase), QString("Functions"));
+}
+
+void TickProfiler_Test::jitter()
+{
+    TickProfiler tp;
+
+    /* a tick started 3ms after MasterTimer scheduled it */
+    tp.beginTick(qint64(20) * 1000000, tp.timestamp() - 3000000);
+    tp.endTick();
+
+    QCOMPARE(tp.jitterStatistics().m_samples, quint32(1));
+    QVERIFY(tp.jitterStatistics().m_max >= 3000);
+    QVERIFY(tp.jitterStatistics().m_max < 20000);
+    QCOMPARE(tp.lateTicksCount(), quint64(0));
+}
+
+void TickProfiler_Test::costs()
+{
+    TickProfiler tp;
+    DMXSourceStub source;
+
+    tp.beginTick(qint64(20) * 1000000, tp.timestamp());
+    tp.addFunctionDuration(42, 3000000);
+    tp.addFunctionDuration(7, 1000);
+    tp.addDMXSourceCost(&source, tp.timestamp());
+
+    /* nothing is visible until the tick is committed */
+    QVERIFY(tp.functions().isEmpty());
+    tp.endTick();
+
+    QCOMPARE(tp.functions().count(), 2);
+    QVERIFY(tp.functions().contains(42));
+    QCOMPARE(tp.functionStatistics(42).m_max, quint32(3000));
+    QCOMPARE(tp.functionStatistics(7).m_p50, quint32(1));
+    QCOMPARE(tp.functionStatistics(99).m_samples, quint32(0));
+
+    QCOMPARE(tp.dmxSources().count(), 1);
+    QCOMPARE(tp.dmxSourceStatistics(&source).m_samples, quint32(1));
+
+    tp.removeDMXSource(&source);
+    QCOMPARE(tp.dmxSources().count(), 0);
+}
+
+void TickProfiler_Test::reset()
+{
+    TickProfiler tp;
+
+    tp.beginTick(0, tp.timestamp());
+    tp.addFunctionDuration(1, 1000);
+    tp.endTick();
+    QCOMPARE(tp.ticksCount(), quint64(1));
+
+    tp.reset();
+    QCOMPARE(tp.ticksCount(), quint64(0));
+    QCOMPARE(tp.lateTicksCount(), quint64(0));
+    QVERIFY(tp.functions().isEmpty());
+    QCOMPARE(tp.phaseStatistics(TickProfiler::TotalPhase).m_samples, quint32(0));
+}
+
+QTEST_APPLESS_MAIN(TickProfiler_Test)
@@ -26,6 +26,7 @@
 #include "universe.h"
 #undef protected
 
+#include "channelmodifier.h"
 #include "grandmaster.h"
 
 void Universe_Test::init()
@@ -57,6 +58,7 @@ void Universe_Test::initial()
 
     QCOMPARE(preGM.count(), 512);
 
+    m_uni->updatePostGMValues();
     QByteArray const * postGM = m_uni->postGMValues();
     QVERIFY(postGM != NULL);
     QCOMPARE(postGM->count(), 512);
@@ -106,6 +108,7 @@ void Universe_Test::blendModes()
     QVERIFY(m_uni->write(0, 255) == true);
     QVERIFY(m_uni->write(4, 128) == true);
     QVERIFY(m_uni->write(9, 100) == true);
+    m_uni->updatePostGMValues();
     QCOMPARE(quint8(m_uni->postGMValues()->at(0)), quint8(255));
     QCOMPARE(quint8(m_uni->postGMValues()->at(4)), quint8(128));
     QCOMPARE(quint8(m_uni->postGMValues()->at(9)), quint8(100));
@@ -113,25 +116,31 @@ void Universe_Test::blendModes()
 
     /* check masking on 0 remains 0 */
     QVERIFY(m_uni->writeBlended(11, 128, Universe::MaskBlend) == true);
+    m_uni->updatePostGMValues();
     QCOMPARE(quint8(m_uni->postGMValues()->at(11)), quint8(0));
 
     /* check 180 masked on 128 gets halved */
     QVERIFY(m_uni->writeBlended(4, 180, Universe::MaskBlend) == true);
+    m_uni->updatePostGMValues();
     QCOMPARE(quint8(m_uni->postGMValues()->at(4)), quint8(90));
 
     /* chek adding 50 to 100 is actually 150 */
     QVERIFY(m_uni->writeBlended(9, 50, Universe::AdditiveBlend) == true);
+    m_uni->updatePostGMValues();
     QCOMPARE(quint8(m_uni->postGMValues()->at(9)), quint8(150));
 
     /* chek subtracting 55 to 255 is actually 200 */
     QVERIFY(m_uni->writeBlended(0, 55, Universe::SubtractiveBlend) == true);
+    m_uni->updatePostGMValues();
     QCOMPARE(quint8(m_uni->postGMValues()->at(0)), quint8(200));
 
     QVERIFY(m_uni->writeBlended(0, 255, Universe::SubtractiveBlend) == true);
+    m_uni->updatePostGMValues();
     QCOMPARE(quint8(m_uni->postGMValues()->at(0)), quint8(0));
 
     /* check an unknown blend mode */
     QVERIFY(m_uni->writeBlended(9, 255, Universe::BlendMode(42)) == true);
+    m_uni->updatePostGMValues();
     QCOMPARE(quint8(m_uni->postGMValues()->at(9)), quint8(150));
 }
 
@@ -152,6 +161,7 @@ void Universe_Test::grandMasterIntensityReduce()
     m_uni->write(4, 50);
 
     m_gm->setValue(63);
+    m_uni->updatePostGMValues();
     QCOMPARE(int(m_uni->postGMValues()->at(0)), int(2));
     QCOMPARE(int(m_uni->postGMValues()->at(1)), int(5));
     QCOMPARE(int(m_uni->postGMValues()->at(2)), int(30));
@@ -179,6 +189,7 @@ void Universe_Test::grandMasterIntensityLimit()
     m_gm->setValueMode(GrandMaster::Limit);
 
     m_gm->setValue(63);
+    m_uni->updatePostGMValues();
     QCOMPARE(quint8(m_uni->postGMValues()->at(0)), quint8(10));
     QCOMPARE(quint8(m_uni->postGMValues()->at(1)), quint8(20));
     QCOMPARE(quint8(m_uni->postGMValues()->at(2)), quint8(30));
@@ -186,6 +197,7 @@ void Universe_Test::grandMasterIntensityLimit()
     QCOMPARE(quint8(m_uni->postGMValues()->at(4)), quint8(50));
 
     m_gm->setValue(5);
+    m_uni->updatePostGMValues();
     QCOMPARE(quint8(m_uni->postGMValues()->at(0)), quint8(5));
     QCOMPARE(quint8(m_uni->postGMValues()->at(1)), quint8(5));
     QCOMPARE(quint8(m_uni->postGMValues()->at(2)), quint8(30));
@@ -213,6 +225,7 @@ void Universe_Test::grandMasterAllChannelsReduce()
     m_gm->setChannelMode(GrandMaster::AllChannels);
 
     m_gm->setValue(63);
+    m_uni->updatePostGMValues();
     QCOMPARE(int(m_uni->postGMValues()->at(0)), int(2));
     QCOMPARE(int(m_uni->postGMValues()->at(1)), int(5));
     QCOMPARE(int(m_uni->postGMValues()->at(2)), int(7));
@@ -241,6 +254,7 @@ void Universe_Test::grandMasterAllChannelsLimit()
     m_gm->setValueMode(GrandMaster::Limit);
 
     m_gm->setValue(63);
+    m_uni->updatePostGMValues();
     QCOMPARE(quint8(m_uni->postGMValues()->at(0)), quint8(10));
     QCOMPARE(quint8(m_uni->postGMValues()->at(1)), quint8(20));
     QCOMPARE(quint8(m_uni->postGMValues()->at(2)), quint8(30));
@@ -248,6 +262,7 @@ void Universe_Test::grandMasterAllChannelsLimit()
     QCOMPARE(quint8(m_uni->postGMValues()->at(4)), quint8(50));
 
     m_gm->setValue(5);
+    m_uni->updatePostGMValues();
     QCOMPARE(quint8(m_uni->postGMValues()->at(0)), quint8(5));
     QCOMPARE(quint8(m_uni->postGMValues()->at(1)), quint8(5));
     QCOMPARE(quint8(m_uni->postGMValues()->at(2)), quint8(5));
@@ -297,6 +312,92 @@ void Universe_Test::applyGM()
     }
 }
 
+void Universe_Test::postGMTables()
+{
+    ChannelModifier inverted;
+    QList< QPair<uchar, uchar> > map;
+    map << QPair<uchar, uchar>(0, 255) << QPair<uchar, uchar>(255, 0);
+    inverted.setModifierMap(map);
+
+    m_uni->setChannelCapability(0, QLCChannel::Intensity);
+    m_uni->setChannelCapability(1, QLCChannel::Pan);
+    m_uni->setChannelCapability(2, QLCChannel::Intensity);
+    m_uni->setChannelCapability(3, QLCChannel::Pan);
+    m_uni->setChannelModifier(0, &inverted);
+    m_uni->setChannelModifier(1, &inverted);
+    m_uni->setChannelModifier(3, &inverted);
+
+    m_uni->write(0, 100);
+    m_uni->write(1, 100);
+    m_uni->write(2, 100);
+
+    m_uni->updatePostGMValues();
+    QCOMPARE(quint8(m_uni->postGMValue(0)), quint8(155));
+    QCOMPARE(quint8(m_uni->postGMValue(1)), quint8(155));
+    QCOMPARE(quint8(m_uni->postGMValue(2)), quint8(100));
+    /* zero goes to the modified zero value */
+    m_uni->updatePostGMValues();
+    QCOMPARE(quint8(m_uni->postGMValue(3)), quint8(255));
+
+    /* Grand Master is applied before the modifier */
+    m_gm->setValue(127);
+    m_uni->updatePostGMValues();
+    QCOMPARE(quint8(m_uni->postGMValue(0)), quint8(205));
+    QCOMPARE(quint8(m_uni->postGMValue(1)), quint8(155));
+    QCOMPARE(quint8(m_uni->postGMValue(2)), quint8(50));
+    QCOMPARE(quint8(m_uni->postGMValue(3)), quint8(255));
+
+    /* mode changes are applied without writing again */
+    m_gm->setChannelMode(GrandMaster::AllChannels);
+    m_uni->updatePostGMValues();
+    QCOMPARE(quint8(m_uni->postGMValue(0)), quint8(205));
+    QCOMPARE(quint8(m_uni->postGMValue(1)), quint8(205));
+    QCOMPARE(quint8(m_uni->postGMValue(2)), quint8(50));
+
+    /* relative values are applied before the tables */
+    m_uni->writeRelative(1, 137);
+    m_uni->updatePostGMValues();
+    QCOMPARE(quint8(m_uni->postGMValue(1)), quint8(200));
+
+    /* removing a modifier gives back the plain Grand Master value */
+    m_uni->setChannelModifier(0, NULL);
+    m_uni->updatePostGMValues();
+    QCOMPARE(quint8(m_uni->postGMValue(0)), quint8(50));
+}
+
+void Universe_Test::postGMUpdate()
+{
+    m_uni->setChannelCapability(0, QLCChannel::Intensity);
+    m_uni->setChannelCapability(1, QLCChannel::Pan);
+
+    m_uni->write(0, 100);
+    m_uni->write(1, 100);
+
+    /* the getters don't compute anything */
+    QCOMPARE(quint8(m_uni->postGMValue(0)), quint8(0));
+    QCOMPARE(quint8(m_uni->postGMValues()->at(1)), quint8(0));
+
+    m_uni->updatePostGMValues();
+    QCOMPARE(quint8(m_uni->postGMValue(0)), quint8(100));
+    QCOMPARE(quint8(m_uni->postGMValues()->at(1)), quint8(100));
+
+    /* a Grand Master change only flags the tables... */
+    m_gm->setValue(127);
+    QVERIFY(m_uni->m_tablesChanged.loadAcquire() == 1);
+    QCOMPARE(quint8(m_uni->postGMValue(0)), quint8(100));
+
+    /* ...which are rebuilt by the writer */
+    m_uni->updatePostGMValues();
+    QVERIFY(m_uni->m_tablesChanged.loadAcquire() == 0);
+    QCOMPARE(quint8(m_uni->postGMValue(0)), quint8(50));
+    QCOMPARE(quint8(m_uni->postGMValue(1)), quint8(100));
+
+    /* hasChanged() updates the values too */
+    m_uni->write(1, 30);
+    QVERIFY(m_uni->hasChanged() == true);
+    QCOMPARE(quint8(m_uni->postGMValue(1)), quint8(30));
+}
+
 void Universe_Test::write()
 {
     m_uni->setChannelCapability(0, QLCChannel::Intensity);
@@ -305,30 +406,35 @@ void Universe_Test::write()
     m_uni->setChannelCapability(UNIVERSE_SIZE - 1, QLCChannel::Intensity);
 
     QVERIFY(m_uni->write(UNIVERSE_SIZE - 1, 255) == true);
+    m_uni->updatePostGMValues();
     QCOMPARE(quint8(m_uni->postGMValues()->at(UNIVERSE_SIZE - 1)), quint8(255));
     QCOMPARE(quint8(m_uni->postGMValues()->at(9)), quint8(0));
     QCOMPARE(quint8(m_uni->postGMValues()->at(4)), quint8(0));
     QCOMPARE(quint8(m_uni->postGMValues()->at(0)), quint8(0));
 
     QVERIFY(m_uni->write(9, 255) == true);
+    m_uni->updatePostGMValues();
     QCOMPARE(quint8(m_uni->postGMValues()->at(UNIVERSE_SIZE - 1)), quint8(255));
     QCOMPARE(quint8(m_uni->postGMValues()->at(9)), quint8(255));
     QCOMPARE(quint8(m_uni->postGMValues()->at(4)), quint8(0));
     QCOMPARE(quint8(m_uni->postGMValues()->at(0)), quint8(0));
 
     QVERIFY(m_uni->write(0, 255) == true);
+    m_uni->updatePostGMValues();
     QCOMPARE(quint8(m_uni->postGMValues()->at(UNIVERSE_SIZE - 1)), quint8(255));
     QCOMPARE(quint8(m_uni->postGMValues()->at(9)), quint8(255));
     QCOMPARE(quint8(m_uni->postGMValues()->at(4)), quint8(0));
     QCOMPARE(quint8(m_uni->postGMValues()->at(0)), quint8(255));
 
     m_gm->setValue(127);
+    m_uni->updatePostGMValues();
     QCOMPARE(quint8(m_uni->postGMValues()->at(UNIVERSE_SIZE - 1)), quint8(127));
     QCOMPARE(quint8(m_uni->postGMValues()->at(9)), quint8(127));
     QCOMPARE(quint8(m_uni->postGMValues()->at(4)), quint8(0));
     QCOMPARE(quint8(m_uni->postGMValues()->at(0)), quint8(127));
 
     QVERIFY(m_uni->write(4, 200) == true);
+    m_uni->updatePostGMValues();
     QCOMPARE(quint8(m_uni->postGMValues()->at(UNIVERSE_SIZE - 1)), quint8(127));
     QCOMPARE(quint8(m_uni->postGMValues()->at(9)), quint8(127));
     QCOMPARE(quint8(m_uni->postGMValues()->at(4)), quint8(100));
@@ -342,6 +448,7 @@ void Universe_Test::writeRelative()
     QCOMPARE(m_uni->m_relativeValues[9], short(0));
     QCOMPARE(m_uni->m_relativeValues[4], short(0));
     QCOMPARE(m_uni->m_relativeValues[0], short(0));
+    m_uni->updatePostGMValues();
     QCOMPARE(quint8(m_uni->postGMValues()->at(9)), quint8(0));
     QCOMPARE(quint8(m_uni->postGMValues()->at(4)), quint8(0));
     QCOMPARE(quint8(m_uni->postGMValues()->at(0)), quint8(0));
@@ -351,6 +458,7 @@ void Universe_Test::writeRelative()
     QCOMPARE(m_uni->m_relativeValues[9], short(128)); // 0 + 128
     QCOMPARE(m_uni->m_relativeValues[4], short(0));
     QCOMPARE(m_uni->m_relativeValues[0], short(0));
+    m_uni->updatePostGMValues();
     QCOMPARE(quint8(m_uni->postGMValues()->at(9)), quint8(128));
     QCOMPARE(quint8(m_uni->postGMValues()->at(4)), quint8(0));
     QCOMPARE(quint8(m_uni->postGMValues()->at(0)), quint8(0));
@@ -360,6 +468,7 @@ void Universe_Test::writeRelative()
     QCOMPARE(m_uni->m_relativeValues[9], short(1)); // 128 - 127
     QCOMPARE(m_uni->m_relativeValues[4], short(0));
     QCOMPARE(m_uni->m_relativeValues[0], short(0));
+    m_uni->updatePostGMValues();
     QCOMPARE(quint8(m_uni->postGMValues()->at(9)), quint8(1));
     QCOMPARE(quint8(m_uni->postGMValues()->at(4)), quint8(0));
     QCOMPARE(quint8(m_uni->postGMValues()->at(0)), quint8(0));
@@ -368,30 +477,76 @@ void Universe_Test::writeRelative()
     QCOMPARE(m_uni->m_relativeValues[9], short(0));
 
     QVERIFY(m_uni->write(9, 85) == true);
+    m_uni->updatePostGMValues();
     QCOMPARE(quint8(m_uni->postGMValues()->at(9)), quint8(85));
 
     QVERIFY(m_uni->writeRelative(9, 117) == true);
     QCOMPARE(m_uni->m_relativeValues[9], short(-10));
 
+    m_uni->updatePostGMValues();
     QCOMPARE(quint8(m_uni->postGMValues()->at(9)), quint8(75));
     QVERIFY(m_uni->write(9, 65) == true);
+    m_uni->updatePostGMValues();
     QCOMPARE(quint8(m_uni->postGMValues()->at(9)), quint8(55));
 
     m_uni->reset();
 
     QVERIFY(m_uni->write(9, 255) == true);
+    m_uni->updatePostGMValues();
     QCOMPARE(quint8(m_uni->postGMValues()->at(9)), quint8(255));
     QVERIFY(m_uni->writeRelative(9, 255) == true);
+    m_uni->updatePostGMValues();
     QCOMPARE(quint8(m_uni->postGMValues()->at(9)), quint8(255));
 
     m_uni->reset();
 
     QVERIFY(m_uni->write(9, 0) == true);
+    m_uni->updatePostGMValues();
     QCOMPARE(quint8(m_uni->postGMValues()->at(9)), quint8(0));
     QVERIFY(m_uni->writeRelative(9, 0) == true);
+    m_uni->updatePostGMValues();
     QCOMPARE(quint8(m_uni->postGMValues()->at(9)), quint8(0));
 }
 
+void Universe_Test::deferredWrites()
+{
+    m_uni->setChannelCapability(0, QLCChannel::Intensity);
+    m_uni->setChannelCapability(1, QLCChannel::Pan);
+
+    QVector<DeferredWrite> writes;
+    m_uni->setDeferredWrites(&writes);
+
+    QVERIFY(m_uni->write(0, 200) == true);
+    QVERIFY(m_uni->write(0, 100) == true);
+    QVERIFY(m_uni->write(1, 50) == true);
+    QVERIFY(m_uni->writeRelative(1, 137) == true);
+    QVERIFY(m_uni->writeBlended(0, 128, Universe::MaskBlend) == true);
+
+    m_uni->setDeferredWrites(NULL);
+
+    /* nothing has been applied yet */
+    QCOMPARE(writes.count(), 5);
+    m_uni->updatePostGMValues();
+    QCOMPARE(quint8(m_uni->postGMValues()->at(0)), quint8(0));
+    QCOMPARE(quint8(m_uni->postGMValues()->at(1)), quint8(0));
+    QCOMPARE(m_uni->usedChannels(), ushort(0));
+
+    QCOMPARE(writes.at(0).m_universe, quint32(0));
+    QCOMPARE(writes.at(2).m_channel, ushort(1));
+    QCOMPARE(writes.at(3).m_type, uchar(Universe::DeferredRelative));
+    QCOMPARE(writes.at(4).m_blendMode, uchar(Universe::MaskBlend));
+
+    /* replay gives the same result as the direct writes */
+    QList<Universe *> universes;
+    universes << m_uni;
+    Universe::applyDeferredWrites(universes, writes);
+
+    m_uni->updatePostGMValues();
+    QCOMPARE(quint8(m_uni->postGMValues()->at(0)), quint8(100));
+    QCOMPARE(quint8(m_uni->postGMValues()->at(1)), quint8(60));
+    QCOMPARE(m_uni->usedChannels(), ushort(2));
+}
+
 void Universe_Test::reset()
 {
     int i;
@@ -402,11 +557,13 @@ void Universe_Test::reset()
     for (i = 0; i < 128; i++)
     {
         m_uni->write(i, 200);
+        m_uni->updatePostGMValues();
         QCOMPARE(quint8(m_uni->postGMValues()->at(i)), quint8(200));
     }
 
     // Reset channels 10-127 (512 shouldn't cause a crash)
     m_uni->reset(10, 512);
+    m_uni->updatePostGMValues();
     for (i = 0; i < 10; i++)
         QCOMPARE(quint8(m_uni->postGMValues()->at(i)), quint8(200));
     for (i = 10; i < 128; i++)
@@ -414,6 +571,7 @@ void Universe_Test::reset()
 
     // Reset all
     m_uni->reset();
+    m_uni->updatePostGMValues();
     for (i = 0; i < 128; i++)
         QCOMPARE((int)m_uni->postGMValues()->at(i), 0);
 }
@@ -467,6 +625,33 @@ void Universe_Test::loadPassthroughTrue()
     QCOMPARE(m_uni->passthrough(), true);
 }
 
+void Universe_Test::loadSendOnChange()
+{
+    QCOMPARE(m_uni->sendOnChange(), false);
+    QCOMPARE(m_uni->keepAliveInterval(), uint(UNIVERSE_KEEPALIVE_INTERVAL));
+
+    QBuffer buffer;
+    buffer.open(QIODevice::WriteOnly | QIODevice::Text);
+    QXmlStreamWriter xmlWriter(&buffer);
+
+    xmlWriter.writeStartElement("Universe");
+    xmlWriter.writeAttribute("Name", "Universe 123");
+    xmlWriter.writeAttribute("SendOnChange", "True");
+    xmlWriter.writeAttribute("KeepAlive", "800");
+
+    xmlWriter.writeEndDocument();
+    xmlWriter.setDevice(NULL);
+    buffer.close();
+
+    buffer.open(QIODevice::ReadOnly | QIODevice::Text);
+    QXmlStreamReader xmlReader(&buffer);
+    xmlReader.readNextStartElement();
+
+    QVERIFY(m_uni->loadXML(xmlReader, 0, 0) == true);
+    QCOMPARE(m_uni->sendOnChange(), true);
+    QCOMPARE(m_uni->keepAliveInterval(), uint(800));
+}
+
 void Universe_Test::loadPassthrough1()
 {
     QBuffer buffer;
@@ -611,6 +796,7 @@ void Universe_Test::setGMValueEfficiency()
         m_gm->setValue(127);
     }
 
+    m_uni->updatePostGMValues();
     for (i = 0; i < 512; i++)
         QCOMPARE(int(m_uni->postGMValues()->at(i)), int(100));
 }
@@ -629,6 +815,7 @@ void Universe_Test::writeEfficiency()
             m_uni->write(i, 200);
     }
 
+    m_uni->updatePostGMValues();
     for (i = 0; i < 512; i++)
         QCOMPARE(int(m_uni->postGMValues()->at(i)), int(100));
 }
@@ -682,6 +869,7 @@ void Universe_Test::zeroIntensityChannelsEfficiency()
         m_uni->zeroIntensityChannels();
     }
 
+    m_uni->updatePostGMValues();
     for (i = 0; i < 512; i++)
         QCOMPARE(int(m_uni->postGMValues()->at(i)), int(0));
 }
@@ -705,6 +893,7 @@ void Universe_Test::zeroIntensityChannelsEfficiency2()
         m_uni->zeroIntensityChannels();
     }
 
+    m_uni->updatePostGMValues();
     for (i = 0; i < 512; i++)
     {
         if (i % 2)
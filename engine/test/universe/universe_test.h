@@ -42,12 +42,16 @@ private slots:
     void grandMasterAllChannelsReduce();
     void grandMasterAllChannelsLimit();
     void applyGM();
+    void postGMTables();
+    void postGMUpdate();
     void write();
     void writeRelative();
+    void deferredWrites();
     void reset();
 
     void loadEmpty();
     void loadPassthroughTrue();
+    void loadSendOnChange();
     void loadPassthrough1();
     void loadPassthroughFalse();
     void loadWrong();
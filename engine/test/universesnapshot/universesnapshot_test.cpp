@@ -0,0 +1,134 @@
+/*
+  Q Light Controller Plus - Unit test
+  universesnapshot_test.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QtTest>
+
+#include "universesnapshot_test.h"
+#include "universesnapshot.h"
+#include "universe.h"
+
+static void publishFrame(UniverseSnapshotBuffer &buffer, int count, uchar value, bool changed)
+{
+    QByteArray post(UNIVERSE_SIZE, char(value));
+    QByteArray pre(UNIVERSE_SIZE, char(value / 2));
+
+    buffer.beginFrame(count);
+    for (int i = 0; i < count; i++)
+        buffer.setUniverse(i, reinterpret_cast<const uchar *>(post.constData()),
+                           reinterpret_cast<const uchar *>(pre.constData()), 16, changed);
+    buffer.publish();
+}
+
+void UniverseSnapshot_Test::initial()
+{
+    UniverseSnapshot snapshot;
+    QVERIFY(snapshot.isNull() == true);
+    QCOMPARE(snapshot.serial(), quint64(0));
+    QCOMPARE(snapshot.universesCount(), 0);
+    QVERIFY(snapshot.postGMValues(0) == NULL);
+    QVERIFY(snapshot.rawData(0).isEmpty());
+
+    UniverseSnapshotBuffer buffer;
+    QVERIFY(buffer.latest().isNull() == true);
+}
+
+void UniverseSnapshot_Test::publish()
+{
+    UniverseSnapshotBuffer buffer;
+    publishFrame(buffer, 2, 100, true);
+
+    UniverseSnapshot snapshot = buffer.latest();
+    QVERIFY(snapshot.isNull() == false);
+    QCOMPARE(snapshot.serial(), quint64(1));
+    QCOMPARE(snapshot.universesCount(), 2);
+    QCOMPARE(snapshot.channelsCount(1), 16);
+    QCOMPARE(snapshot.channelsCount(2), 0);
+    QCOMPARE(snapshot.postGMValues(1)[511], uchar(100));
+    QCOMPARE(snapshot.preGMValues(1)[0], uchar(50));
+
+    QByteArray data = snapshot.rawData(0);
+    QCOMPARE(data.size(), 16);
+    QCOMPARE(uchar(data.at(15)), uchar(100));
+
+    /* copies share the same frame */
+    UniverseSnapshot copy = snapshot;
+    QVERIFY(copy.postGMValues(0) == snapshot.postGMValues(0));
+}
+
+void UniverseSnapshot_Test::changeSerials()
+{
+    UniverseSnapshotBuffer buffer;
+    publishFrame(buffer, 2, 10, true);
+    QCOMPARE(buffer.latest().changeSerial(0), quint64(1));
+
+    /* unchanged universes keep the serial of their last change */
+    publishFrame(buffer, 2, 10, false);
+    UniverseSnapshot snapshot = buffer.latest();
+    QCOMPARE(snapshot.serial(), quint64(2));
+    QCOMPARE(snapshot.changeSerial(0), quint64(1));
+    QCOMPARE(snapshot.changeSerial(1), quint64(1));
+
+    /* new universes are always changed */
+    publishFrame(buffer, 3, 10, false);
+    snapshot = buffer.latest();
+    QCOMPARE(snapshot.changeSerial(1), quint64(1));
+    QCOMPARE(snapshot.changeSerial(2), quint64(3));
+
+    buffer.beginFrame(3);
+    for (int i = 0; i < 3; i++)
+        buffer.setUniverse(i, snapshot.postGMValues(i), snapshot.preGMValues(i), 16, i == 1);
+    buffer.publish();
+
+    snapshot = buffer.latest();
+    QCOMPARE(snapshot.changeSerial(0), quint64(1));
+    QCOMPARE(snapshot.changeSerial(1), quint64(4));
+    QCOMPARE(snapshot.changeSerial(2), quint64(3));
+}
+
+void UniverseSnapshot_Test::heldSnapshot()
+{
+    UniverseSnapshotBuffer buffer;
+    publishFrame(buffer, 1, 1, true);
+
+    /* a referenced snapshot is never overwritten */
+    UniverseSnapshot held = buffer.latest();
+    for (int i = 2; i < 10; i++)
+        publishFrame(buffer, 1, uchar(i), true);
+
+    QCOMPARE(held.serial(), quint64(1));
+    QCOMPARE(held.postGMValues(0)[0], uchar(1));
+    QCOMPARE(buffer.latest().serial(), quint64(9));
+    QCOMPARE(buffer.latest().postGMValues(0)[0], uchar(9));
+}
+
+void UniverseSnapshot_Test::recycle()
+{
+    UniverseSnapshotBuffer buffer;
+    publishFrame(buffer, 1, 1, true);
+    publishFrame(buffer, 1, 2, true);
+
+    /* with no readers, two frames are enough */
+    const uchar *first = buffer.latest().postGMValues(0);
+    publishFrame(buffer, 1, 3, true);
+    publishFrame(buffer, 1, 4, true);
+    QVERIFY(buffer.latest().postGMValues(0) == first);
+    QCOMPARE(buffer.latest().postGMValues(0)[0], uchar(4));
+}
+
+QTEST_APPLESS_MAIN(UniverseSnapshot_Test)
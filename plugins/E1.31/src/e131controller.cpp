@@ -42,12 +42,17 @@ E131Controller::E131Controller(QNetworkInterface const& interface, QNetworkAddre
     m_UdpSocket->setMulticastInterface(m_interface);
     // Don't send multicast to self
     m_UdpSocket->setSocketOption(QAbstractSocket::MulticastLoopbackOption, false);
+
+    m_sourcesTimer.setInterval(1000);
+    connect(&m_sourcesTimer, SIGNAL(timeout()),
+            this, SLOT(slotCheckSources()));
 }
 
 E131Controller::~E131Controller()
 {
     qDebug() << Q_FUNC_INFO;
     qDeleteAll(m_dmxValuesMap);
+    qDeleteAll(m_mergers);
 }
 
 QString E131Controller::getNetworkIP()
@@ -80,6 +85,7 @@ void E131Controller::addUniverse(quint32 universe, E131Controller::Type type)
         info.outputUniverse = universe + 1;
         info.outputTransmissionMode = Full;
         info.outputPriority = E131_PRIORITY_DEFAULT;
+        info.outputSyncUniverse = 0;
         info.type = type;
         m_universeMap[universe] = info;
     }
@@ -98,7 +104,20 @@ void E131Controller::removeUniverse(quint32 universe, E131Controller::Type type)
     {
         UniverseInfo& info = m_universeMap[universe];
         if (type == Input)
+        {
             info.inputSocket.clear();
+            delete m_mergers.take(universe);
+            releaseSyncSockets();
+
+            QHash<QPair<quint32, QByteArray>, PendingDmx>::iterator it = m_pendingDmx.begin();
+            while (it != m_pendingDmx.end())
+            {
+                if (it.key().first == universe)
+                    it = m_pendingDmx.erase(it);
+                else
+                    ++it;
+            }
+        }
 
         if (info.type == type)
             m_universeMap.take(universe);
@@ -120,6 +139,7 @@ void E131Controller::setInputMulticast(quint32 universe, bool multicast)
     info.inputMulticast = multicast;
 
     info.inputSocket.clear();
+    releaseSyncSockets();
     if (multicast)
         info.inputSocket = getInputSocket(true, info.inputMcastAddress, E131_DEFAULT_PORT);
     else
@@ -161,6 +181,13 @@ QSharedPointer<QUdpSocket> E131Controller::getInputSocket(bool multicast, QHostA
     return inputSocket;
 }
 
+void E131Controller::releaseSyncSockets()
+{
+    // the sockets still needed are joined again by the next
+    // packet that refers to their synchronization universe
+    m_syncSockets.clear();
+}
+
 void E131Controller::setInputMCastAddress(quint32 universe, QString address)
 {
     if (m_universeMap.contains(universe) == false)
@@ -267,6 +294,15 @@ void E131Controller::setOutputPriority(quint32 universe, quint32 e131Priority)
     m_universeMap[universe].outputPriority = e131Priority;
 }
 
+void E131Controller::setOutputSyncUniverse(quint32 universe, quint32 syncUni)
+{
+    if (m_universeMap.contains(universe) == false)
+        return;
+
+    QMutexLocker locker(&m_dataMutex);
+    m_universeMap[universe].outputSyncUniverse = syncUni;
+}
+
 void E131Controller::setOutputTransmissionMode(quint32 universe, E131Controller::TransmissionMode mode)
 {
     if (m_universeMap.contains(universe) == false)
@@ -345,6 +381,8 @@ void E131Controller::sendDmx(const quint32 universe, const QByteArray &data)
     quint16 outPort = E131_DEFAULT_PORT;
     quint32 outUniverse = universe;
     quint32 outPriority = E131_PRIORITY_DEFAULT;
+    quint16 outSyncUniverse = 0;
+    bool outMulticast = true;
     TransmissionMode transmitMode = Full;
 
     if (m_universeMap.contains(universe))
@@ -361,6 +399,8 @@ void E131Controller::sendDmx(const quint32 universe, const QByteArray &data)
         }
         outUniverse = info.outputUniverse;
         outPriority = info.outputPriority;
+        outSyncUniverse = info.outputSyncUniverse;
+        outMulticast = info.outputMulticast;
         transmitMode = TransmissionMode(info.outputTransmissionMode);
     }
     else
@@ -370,21 +410,59 @@ void E131Controller::sendDmx(const quint32 universe, const QByteArray &data)
     {
         QByteArray wholeuniverse(512, 0);
         wholeuniverse.replace(0, data.length(), data);
-        m_packetizer->setupE131Dmx(dmxPacket, outUniverse, outPriority, wholeuniverse);
+        m_packetizer->setupE131Dmx(dmxPacket, outUniverse, outPriority, wholeuniverse, outSyncUniverse);
     }
     else
-        m_packetizer->setupE131Dmx(dmxPacket, outUniverse, outPriority, data);
+        m_packetizer->setupE131Dmx(dmxPacket, outUniverse, outPriority, data, outSyncUniverse);
+
+    // a universe is queued once per frame, so a frame
+    // that has not been flushed is sent before this one
+    if (m_outputBatch.count() >= m_universeMap.count())
+        m_packetSent += m_outputBatch.flush(m_UdpSocket.data());
+
+    m_outputBatch.append(dmxPacket, outAddress, outPort);
 
-    qint64 sent = m_UdpSocket->writeDatagram(dmxPacket.data(), dmxPacket.size(),
-                                             outAddress, outPort);
-    if (sent < 0)
+    if (outSyncUniverse != 0)
     {
-        qDebug() << "sendDmx failed";
-        qDebug() << "Errno: " << m_UdpSocket->error();
-        qDebug() << "Errmsg: " << m_UdpSocket->errorString();
+        // multicast Synchronization packets go to the address of their universe
+        SyncTarget target;
+        target.universe = outSyncUniverse;
+        if (outMulticast)
+            target.address = QHostAddress(quint32(0xEFFF0000 | outSyncUniverse));
+        else
+            target.address = outAddress;
+        target.port = outPort;
+
+        bool queued = false;
+        foreach (SyncTarget const& pending, m_pendingSync)
+        {
+            if (pending.universe == target.universe &&
+                pending.address == target.address && pending.port == target.port)
+            {
+                queued = true;
+                break;
+            }
+        }
+
+        if (queued == false)
+            m_pendingSync.append(target);
     }
-    else
-        m_packetSent++;
+}
+
+void E131Controller::flushDmx()
+{
+    QMutexLocker locker(&m_dataMutex);
+
+    // Synchronization packets follow the DMX packets of the frame
+    foreach (SyncTarget const& target, m_pendingSync)
+    {
+        QByteArray syncPacket;
+        m_packetizer->setupE131Sync(syncPacket, target.universe);
+        m_outputBatch.append(syncPacket, target.address, target.port);
+    }
+    m_pendingSync.resize(0);
+
+    m_packetSent += m_outputBatch.flush(m_UdpSocket.data());
 }
 
 void E131Controller::processPendingPackets()
@@ -401,35 +479,71 @@ void E131Controller::processPendingPackets()
 
         QByteArray dmxData;
         quint32 e131universe;
+        quint16 syncUniverse;
+        QByteArray cid;
+        int priority;
+        uchar sequence, options;
         if (m_packetizer->checkPacket(datagram)
-                && m_packetizer->fillDMXdata(datagram, dmxData, e131universe))
+                && m_packetizer->fillDMXdata(datagram, dmxData, e131universe)
+                && m_packetizer->fillSourceData(datagram, cid, priority, sequence, options))
         {
             qDebug() << "Received packet with size: " << datagram.size() << ", from: " << senderAddress.toString()
                 << ", for E1.31 universe: " << e131universe;
             ++m_packetReceived;
 
+            // preview data is meant for visualizers, not for the stage
+            if (options & E131_OPTION_PREVIEW)
+                continue;
+
+            // alternate START codes, like the per-address priority (0xDD),
+            // don't carry DMX levels
+            if (datagram.size() < 126 || datagram.at(125) != 0)
+                continue;
+
+            syncUniverse = m_packetizer->syncUniverse(datagram);
+
             for (QMap<quint32, UniverseInfo>::iterator it = m_universeMap.begin(); it != m_universeMap.end(); ++it)
             {
                 quint32 universe = it.key();
                 UniverseInfo const& info = it.value();
                 if (info.inputSocket == socket && info.inputUniverse == e131universe)
                 {
-                    QByteArray *dmxValues;
-                    if (m_dmxValuesMap.contains(universe) == false)
-                        m_dmxValuesMap[universe] = new QByteArray(512, 0);
-                    dmxValues = m_dmxValuesMap[universe];
+                    // the source is going away: drop it from the merge right away
+                    if (options & E131_OPTION_TERMINATED)
+                    {
+                        E131Merger *merger = m_mergers.value(universe, NULL);
+                        m_pendingDmx.remove(qMakePair(universe, cid));
+                        if (merger != NULL && merger->removeSource(cid))
+                            applyDmx(universe, merger->values());
+                        continue;
+                    }
 
-                    for (int i = 0; i < dmxData.length(); i++)
+                    // listen to the multicast Synchronization packets the sender will send
+                    if (syncUniverse != 0 && info.inputMulticast && m_syncSockets.contains(syncUniverse) == false)
+                        m_syncSockets[syncUniverse] = getInputSocket(true, QHostAddress(quint32(0xEFFF0000 | syncUniverse)),
+                                                                      E131_DEFAULT_PORT);
+
+                    QHash<quint16, QElapsedTimer>::const_iterator syncIt = m_inputSyncTimers.constFind(syncUniverse);
+                    if (syncUniverse != 0 && syncIt != m_inputSyncTimers.constEnd() &&
+                        syncIt.value().hasExpired(E131_SYNC_TIMEOUT) == false)
                     {
-                        if (dmxValues->at(i) != dmxData.at(i))
-                        {
-                            dmxValues->replace(i, 1, (const char *)(dmxData.data() + i), 1);
-                            emit valueChanged(universe, m_line, i, (uchar)dmxData.at(i));
-                        }
+                        // deep copy the CID, as it points to the datagram
+                        PendingDmx &pending = m_pendingDmx[qMakePair(universe, QByteArray(cid.constData(), cid.size()))];
+                        pending.syncUniverse = syncUniverse;
+                        pending.priority = priority;
+                        pending.sequence = sequence;
+                        pending.data = dmxData;
                     }
+                    else
+                        mergeDmx(universe, cid, priority, sequence, dmxData);
                 }
             }
         }
+        else if (m_packetizer->fillSyncData(datagram, syncUniverse))
+        {
+            ++m_packetReceived;
+            applySync(syncUniverse);
+        }
         else
         {
             qDebug() << "Received packet with size: " << datagram.size() << ", from: " << senderAddress.toString()
@@ -437,3 +551,62 @@ void E131Controller::processPendingPackets()
         }
     }
 }
+
+void E131Controller::mergeDmx(quint32 universe, QByteArray const& cid, int priority,
+                              uchar sequence, QByteArray const& dmxData)
+{
+    E131Merger *merger = m_mergers.value(universe, NULL);
+    if (merger == NULL)
+    {
+        merger = new E131Merger();
+        m_mergers[universe] = merger;
+        m_sourcesTimer.start();
+    }
+
+    if (merger->updateSource(cid, priority, sequence, dmxData))
+        applyDmx(universe, merger->values());
+}
+
+void E131Controller::applyDmx(quint32 universe, QByteArray const& dmxData)
+{
+    QByteArray *dmxValues;
+    if (m_dmxValuesMap.contains(universe) == false)
+        m_dmxValuesMap[universe] = new QByteArray(512, 0);
+    dmxValues = m_dmxValuesMap[universe];
+
+    for (int i = 0; i < dmxData.length(); i++)
+    {
+        if (dmxValues->at(i) != dmxData.at(i))
+        {
+            dmxValues->replace(i, 1, (const char *)(dmxData.data() + i), 1);
+            emit valueChanged(universe, m_line, i, (uchar)dmxData.at(i));
+        }
+    }
+}
+
+void E131Controller::applySync(quint16 syncUniverse)
+{
+    m_inputSyncTimers[syncUniverse].start();
+
+    QHash<QPair<quint32, QByteArray>, PendingDmx>::iterator it = m_pendingDmx.begin();
+    while (it != m_pendingDmx.end())
+    {
+        PendingDmx const& pending = it.value();
+        if (pending.syncUniverse == syncUniverse)
+        {
+            mergeDmx(it.key().first, it.key().second, pending.priority, pending.sequence, pending.data);
+            it = m_pendingDmx.erase(it);
+        }
+        else
+            ++it;
+    }
+}
+
+void E131Controller::slotCheckSources()
+{
+    for (QMap<quint32, E131Merger*>::iterator it = m_mergers.begin(); it != m_mergers.end(); ++it)
+    {
+        if (it.value()->removeExpiredSources())
+            applyDmx(it.key(), it.value()->values());
+    }
+}
@@ -29,13 +29,20 @@
 #else
 #include <QtNetwork>
 #endif
+#include <QElapsedTimer>
 #include <QMutex>
 #include <QTimer>
 
 #include "e131packetizer.h"
+#include "e131merger.h"
+#include "datagrambatch.h"
 
 #define E131_DEFAULT_PORT     5568
 
+/** Receivers go back to apply data immediately when Synchronization
+ *  packets stop arriving for this time, in milliseconds */
+#define E131_SYNC_TIMEOUT     2500
+
 typedef struct
 {
     bool inputMulticast;
@@ -51,6 +58,7 @@ typedef struct
     quint16 outputUniverse;
     int outputTransmissionMode;
     int outputPriority;
+    quint16 outputSyncUniverse;
 
     int type;
 } UniverseInfo;
@@ -73,9 +81,12 @@ public:
 
     ~E131Controller();
 
-    /** Send DMX data to a specific port/universe */
+    /** Queue DMX data for a specific port/universe, to be sent by flushDmx */
     void sendDmx(const quint32 universe, const QByteArray& data);
 
+    /** Send the DMX data queued by sendDmx since the last call */
+    void flushDmx();
+
     /** Return the controller IP address */
     QString getNetworkIP();
 
@@ -115,6 +126,11 @@ public:
     /** Set a specific E1.31 output priority for the given QLC+ universe */
     void setOutputPriority(quint32 universe, quint32 e131Priority);
 
+    /** Set the E1.31 synchronization universe for the given QLC+ universe.
+     *  When not 0, a Synchronization packet for it follows each frame,
+     *  so that receivers apply all the universes at the same time */
+    void setOutputSyncUniverse(quint32 universe, quint32 syncUni);
+
     /** Set the transmission mode of the ArtNet DMX packets over the network.
      *  It can be 'Full', which transmits always 512 channels, or
      *  'Partial', which transmits only the channels actually used in a
@@ -149,6 +165,10 @@ public:
 private:
     QSharedPointer<QUdpSocket> getInputSocket(bool multicast, QHostAddress const& address, quint16 port);
 
+    /** Drop the sockets receiving the Synchronization packets,
+     *  when the input universes they were joined for change */
+    void releaseSyncSockets();
+
 private:
     /** The network interface associated to this controller */
     QNetworkInterface m_interface;
@@ -179,10 +199,64 @@ private:
      *  variables that could be used to transmit/receive data */
     QMutex m_dataMutex;
 
+    /** The E1.31 packets queued by sendDmx */
+    DatagramBatch m_outputBatch;
+
+    typedef struct
+    {
+        quint16 universe;       //! The synchronization universe
+        QHostAddress address;   //! Where to send the Synchronization packet
+        quint16 port;           //! The destination port
+    } SyncTarget;
+
+    /** The Synchronization packets to send at the next flushDmx */
+    QVector<SyncTarget> m_pendingSync;
+
+    typedef struct
+    {
+        quint16 syncUniverse;   //! The synchronization universe to wait for
+        int priority;           //! The priority of the packet
+        uchar sequence;         //! The sequence number of the packet
+        QByteArray data;        //! The received DMX values
+    } PendingDmx;
+
+    /** Started at each Synchronization packet received, per synchronization
+     *  universe. Until it expires, the data referring to that universe is
+     *  held back until its Synchronization packet */
+    QHash<quint16, QElapsedTimer> m_inputSyncTimers;
+
+    /** The received data waiting for a Synchronization packet,
+     *  per QLC+ universe and source CID */
+    QHash<QPair<quint32, QByteArray>, PendingDmx> m_pendingDmx;
+
+    /** The sockets receiving the multicast Synchronization packets */
+    QHash<quint16, QSharedPointer<QUdpSocket> > m_syncSockets;
+
+    /** The merge of the sources sending to each input QLC+ universe */
+    QMap<quint32, E131Merger*> m_mergers;
+
+    /** Periodically drops the sources that stopped sending */
+    QTimer m_sourcesTimer;
+
+private:
+    /** Merge $dmxData, sent by the source $cid, into the given QLC+ universe
+     *  and emit the resulting values that changed */
+    void mergeDmx(quint32 universe, QByteArray const& cid, int priority,
+                  uchar sequence, QByteArray const& dmxData);
+
+    /** Emit the values of $dmxData that changed for the given QLC+ universe */
+    void applyDmx(quint32 universe, QByteArray const& dmxData);
+
+    /** Apply the data waiting for a Synchronization packet of $syncUniverse */
+    void applySync(quint16 syncUniverse);
+
 private slots:
     /** Async event raised when new packets have been received */
     void processPendingPackets();
 
+    /** Drop the sources that timed out and apply the new merged values */
+    void slotCheckSources();
+
 signals:
     void valueChanged(quint32 universe, quint32 input, quint32 channel, uchar value);
 };
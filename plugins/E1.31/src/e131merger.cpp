@@ -0,0 +1,152 @@
+/*
+  Q Light Controller Plus
+  e131merger.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include "e131merger.h"
+
+#include <QVarLengthArray>
+#include <QDebug>
+#include <string.h>
+
+#define DMX_CHANNELS 512
+
+E131Merger::E131Merger()
+    : m_values(DMX_CHANNELS, 0)
+{
+}
+
+E131Merger::~E131Merger()
+{
+}
+
+bool E131Merger::updateSource(QByteArray const& cid, int priority, uchar sequence, QByteArray const& values)
+{
+    QHash<QByteArray, Source>::iterator it = m_sources.find(cid);
+    if (it == m_sources.end())
+    {
+        qDebug() << "[E1.31] new source" << cid.toHex() << "priority" << priority;
+
+        Source source;
+        source.priority = priority;
+        source.sequence = sequence;
+        source.values = QByteArray(DMX_CHANNELS, 0);
+
+        // deep copy the key, as $cid might point to a datagram
+        it = m_sources.insert(QByteArray(cid.constData(), cid.size()), source);
+    }
+    else
+    {
+        // as E1.31 mandates, discard the packets up to 20 sequence numbers behind
+        int diff = qint8(sequence - it.value().sequence);
+        if (diff <= 0 && diff > -20)
+            return false;
+    }
+
+    Source &source = it.value();
+    source.priority = priority;
+    source.sequence = sequence;
+    source.lastSeen.start();
+
+    // the buffer is not shared, so this doesn't allocate
+    int count = qMin(values.size(), DMX_CHANNELS);
+    char *buffer = source.values.data();
+    memcpy(buffer, values.constData(), count);
+    if (count < DMX_CHANNELS)
+        memset(buffer + count, 0, DMX_CHANNELS - count);
+
+    // expire the sources while this universe is active
+    bool expired = removeExpiredSources();
+
+    return merge() || expired;
+}
+
+bool E131Merger::removeSource(QByteArray const& cid)
+{
+    if (m_sources.remove(cid) == 0)
+        return false;
+
+    qDebug() << "[E1.31] source" << cid.toHex() << "terminated";
+
+    return merge();
+}
+
+bool E131Merger::removeExpiredSources()
+{
+    bool removed = false;
+
+    QHash<QByteArray, Source>::iterator it = m_sources.begin();
+    while (it != m_sources.end())
+    {
+        if (it.value().lastSeen.hasExpired(E131_SOURCE_TIMEOUT))
+        {
+            qDebug() << "[E1.31] source" << it.key().toHex() << "timed out";
+            it = m_sources.erase(it);
+            removed = true;
+        }
+        else
+            ++it;
+    }
+
+    return removed ? merge() : false;
+}
+
+int E131Merger::sourcesCount() const
+{
+    return m_sources.count();
+}
+
+QByteArray const& E131Merger::values() const
+{
+    return m_values;
+}
+
+bool E131Merger::merge()
+{
+    if (m_sources.isEmpty())
+        return false;
+
+    int topPriority = -1;
+    foreach (Source const& source, m_sources)
+        topPriority = qMax(topPriority, source.priority);
+
+    // the sources with the highest priority, merged HTP
+    QVarLengthArray<const uchar *, 8> winners;
+    foreach (Source const& source, m_sources)
+    {
+        if (source.priority == topPriority)
+            winners.append((const uchar *)source.values.constData());
+    }
+
+    bool changed = false;
+    uchar *merged = (uchar *)m_values.data();
+
+    for (int i = 0; i < DMX_CHANNELS; i++)
+    {
+        uchar value = 0;
+        for (int s = 0; s < winners.count(); s++)
+            value = qMax(value, winners[s][i]);
+
+        if (merged[i] != value)
+        {
+            merged[i] = value;
+            changed = true;
+        }
+    }
+
+    return changed;
+}
@@ -0,0 +1,87 @@
+/*
+  Q Light Controller Plus
+  e131merger.h
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef E131MERGER_H
+#define E131MERGER_H
+
+#include <QElapsedTimer>
+#include <QByteArray>
+#include <QHash>
+
+/** A source is dropped when no data arrives from it
+ *  for this time, in milliseconds */
+#define E131_SOURCE_TIMEOUT 2500
+
+/**
+ * E131Merger merges the data that several E1.31 sources send to the
+ * same universe. Sources are identified by their CID. Only the sources
+ * with the highest priority are considered, and their values are merged
+ * HTP (highest takes precedence).
+ */
+class E131Merger
+{
+public:
+    E131Merger();
+    ~E131Merger();
+
+    /**
+     * Update the values of a source.
+     *
+     * @param cid the CID of the source
+     * @param priority the priority of the packet (0-200)
+     * @param sequence the sequence number of the packet. Packets older
+     *        than the last one received from the source are discarded
+     * @param values the DMX values of the packet
+     * @return true if the merged values changed
+     */
+    bool updateSource(QByteArray const& cid, int priority, uchar sequence, QByteArray const& values);
+
+    /** Remove the source with the given CID.
+     *  Return true if the merged values changed */
+    bool removeSource(QByteArray const& cid);
+
+    /** Remove the sources not heard for more than E131_SOURCE_TIMEOUT.
+     *  Return true if the merged values changed */
+    bool removeExpiredSources();
+
+    /** Return the number of sources currently merged */
+    int sourcesCount() const;
+
+    /** Return the merged values. They are left untouched
+     *  when the last source goes away */
+    QByteArray const& values() const;
+
+private:
+    /** Compute the merged values. Return true if they changed */
+    bool merge();
+
+private:
+    typedef struct
+    {
+        int priority;           //! The priority of the last packet
+        uchar sequence;         //! The sequence number of the last packet
+        QByteArray values;      //! The last values, always 512 bytes
+        QElapsedTimer lastSeen; //! Started at each packet
+    } Source;
+
+    QHash<QByteArray, Source> m_sources;
+    QByteArray m_values;
+};
+
+#endif
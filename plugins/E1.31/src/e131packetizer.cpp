@@ -149,7 +149,8 @@ E131Packetizer::~E131Packetizer()
  * Sender functions
  *********************************************************************/
 
-void E131Packetizer::setupE131Dmx(QByteArray& data, const int &universe, const int &priority, const QByteArray &values)
+void E131Packetizer::setupE131Dmx(QByteArray& data, const int &universe, const int &priority,
+                                  const QByteArray &values, const int &syncUniverse)
 {
     data.clear();
     data.append(m_commonHeader);
@@ -169,6 +170,9 @@ void E131Packetizer::setupE131Dmx(QByteArray& data, const int &universe, const i
 
     data[108] = (char) priority;
 
+    data[109] = (char)(syncUniverse >> 8);
+    data[110] = (char)(syncUniverse & 0x00FF);
+
     data[111] = m_sequence[universe];
 
     data[113] = (char)(universe >> 8);
@@ -186,6 +190,47 @@ void E131Packetizer::setupE131Dmx(QByteArray& data, const int &universe, const i
         m_sequence[universe]++;
 }
 
+void E131Packetizer::setupE131Sync(QByteArray& data, const int &syncUniverse)
+{
+    // the root layer is the same as DMX packets, up to the CID
+    data.clear();
+    data.append(m_commonHeader.left(38));
+
+    int rootLayerSize = E131_SYNC_PACKET_SIZE - 16;
+    int e131LayerSize = E131_SYNC_PACKET_SIZE - 38;
+
+    data[16] = 0x70 | (char)(rootLayerSize >> 8);
+    data[17] = (char)(rootLayerSize & 0x00FF);
+
+    // Identifies RLP Data as 1.31 extended Protocol PDU
+    data[21] = 0x08;
+
+    // Framing layer flags & PDU length (bytes 38-39)
+    data.append((char)(0x70 | (e131LayerSize >> 8)));
+    data.append((char)(e131LayerSize & 0x00FF));
+
+    // Identifies 1.31 data as Synchronization PDU
+    data.append((char)0x00);
+    data.append((char)0x00);
+    data.append((char)0x00);
+    data.append((char)0x01);
+
+    // sequence counter (byte 44)
+    uchar &sequence = m_syncSequence[syncUniverse];
+    if (sequence == 0)
+        sequence = 1;
+    data.append((char)sequence);
+    sequence = (sequence == 0xff) ? 1 : sequence + 1;
+
+    // Synchronization universe (bytes 45-46)
+    data.append((char)(syncUniverse >> 8));
+    data.append((char)(syncUniverse & 0x00FF));
+
+    // reserved
+    data.append('\0');
+    data.append('\0');
+}
+
 bool E131Packetizer::checkPacket(QByteArray &data)
 {
     /* An E1.31 packet must be at least 125 bytes long */
@@ -224,3 +269,45 @@ bool E131Packetizer::fillDMXdata(QByteArray& data, QByteArray &dmx, quint32 &uni
     dmx.append(data.mid(126, length - 1));
     return true;
 }
+
+quint16 E131Packetizer::syncUniverse(QByteArray &data)
+{
+    if (data.length() < 125)
+        return 0;
+
+    return (quint16(uchar(data[109])) << 8) | uchar(data[110]);
+}
+
+bool E131Packetizer::fillSourceData(QByteArray &data, QByteArray &cid, int &priority,
+                                    uchar &sequence, uchar &options)
+{
+    if (data.length() < 125)
+        return false;
+
+    // the CID refers to the datagram, it is copied only for new sources
+    cid = QByteArray::fromRawData(data.constData() + 22, 16);
+    priority = uchar(data[108]);
+    sequence = uchar(data[111]);
+    options = uchar(data[112]);
+
+    return true;
+}
+
+bool E131Packetizer::fillSyncData(QByteArray &data, quint16 &syncUniverse)
+{
+    if (data.length() < E131_SYNC_PACKET_SIZE)
+        return false;
+
+    if (data[4] != (char)0x41 || data[5] != (char)0x53 || data[6] != (char)0x43 ||
+        data[7] != (char)0x2D || data[8] != (char)0x45 || data[9] != (char)0x31 ||
+        data[10] != (char)0x2E || data[11] != (char)0x31 || data[12] != (char)0x37 ||
+        data[13] != (char)0x00 || data[14] != (char)0x00 || data[15] != (char)0x00)
+            return false;
+    if (data[18] != (char)0x00 || data[19] != (char)0x00 || data[20] != (char)0x00 || data[21] != (char)0x08)
+        return false;
+    if (data[40] != (char)0x00 || data[41] != (char)0x00 || data[42] != (char)0x00 || data[43] != (char)0x01)
+        return false;
+
+    syncUniverse = (quint16(uchar(data[45])) << 8) | uchar(data[46]);
+    return true;
+}
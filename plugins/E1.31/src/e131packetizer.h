@@ -27,6 +27,13 @@
 
 #define E131_PRIORITY_DEFAULT 100
 
+/** Size of an E1.31 Synchronization packet */
+#define E131_SYNC_PACKET_SIZE 49
+
+/** E1.31 DMX packet options */
+#define E131_OPTION_PREVIEW     0x80
+#define E131_OPTION_TERMINATED  0x40
+
 class E131Packetizer
 {
     /*********************************************************************
@@ -41,8 +48,13 @@ public:
      * Sender functions
      *********************************************************************/
 
-    /** Prepare an E1.31 DMX packet */
-    void setupE131Dmx(QByteArray& data, const int& universe, const int& priority, const QByteArray &values);
+    /** Prepare an E1.31 DMX packet. When 'syncUniverse' is not 0, receivers
+     *  hold the data until a Synchronization packet for that universe */
+    void setupE131Dmx(QByteArray& data, const int& universe, const int& priority,
+                      const QByteArray &values, const int& syncUniverse = 0);
+
+    /** Prepare an E1.31 Synchronization packet for 'syncUniverse' */
+    void setupE131Sync(QByteArray& data, const int& syncUniverse);
 
     /*********************************************************************
      * Receiver functions
@@ -53,9 +65,23 @@ public:
 
     bool fillDMXdata(QByteArray& data, QByteArray& dmx, quint32 &universe);
 
+    /** Return the synchronization universe of an E1.31 DMX packet,
+     *  or 0 if the data must be applied immediately */
+    quint16 syncUniverse(QByteArray& data);
+
+    /** Retrieve the source CID, the priority, the sequence number
+     *  and the options of an E1.31 DMX packet */
+    bool fillSourceData(QByteArray& data, QByteArray& cid, int& priority,
+                        uchar& sequence, uchar& options);
+
+    /** Verify the validity of an E1.31 Synchronization packet
+     *  and store its synchronization universe in 'syncUniverse' */
+    bool fillSyncData(QByteArray& data, quint16 &syncUniverse);
+
 private:
     QByteArray m_commonHeader;
     QHash<int, uchar> m_sequence;
+    QHash<int, uchar> m_syncSequence;
 };
 
 #endif
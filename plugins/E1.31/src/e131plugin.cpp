@@ -191,16 +191,31 @@ void E131Plugin::closeOutput(quint32 output, quint32 universe)
     }
 }
 
-void E131Plugin::writeUniverse(quint32 universe, quint32 output, const QByteArray &data)
+void E131Plugin::writeUniverse(quint32 universe, quint32 output, const QByteArray &data, bool dataChanged)
 {
     if (output >= (quint32)m_IOmapping.count())
         return;
 
+    // nothing new to transmit
+    if (dataChanged == false)
+        return;
+
     E131Controller *controller = m_IOmapping[output].controller;
     if (controller != NULL)
         controller->sendDmx(universe, data);
 }
 
+void E131Plugin::flushOutputs()
+{
+    // index the lines, as copying them would allocate at each frame
+    for (int i = 0; i < m_IOmapping.count(); i++)
+    {
+        E131Controller *controller = m_IOmapping.at(i).controller;
+        if (controller != NULL)
+            controller->flushDmx();
+    }
+}
+
 /*************************************************************************
   * Inputs
   *************************************************************************/
@@ -345,6 +360,8 @@ void E131Plugin::setParameter(quint32 universe, quint32 line, Capability type,
             controller->setOutputTransmissionMode(universe, E131Controller::stringToTransmissionMode(value.toString()));
         else if (name == E131_PRIORITY)
             controller->setOutputPriority(universe, value.toUInt());
+        else if (name == E131_SYNCUNIVERSE)
+            controller->setOutputSyncUniverse(universe, value.toUInt());
         else
             qWarning() << Q_FUNC_INFO << name << "is not a valid E1.31 output parameter";
     }
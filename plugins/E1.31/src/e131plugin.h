@@ -44,6 +44,7 @@ typedef struct
 #define E131_UNIVERSE "universe"
 #define E131_TRANSMITMODE "transmitMode"
 #define E131_PRIORITY "priority"
+#define E131_SYNCUNIVERSE "syncUniverse"
 
 class E131Plugin : public QLCIOPlugin
 {
@@ -93,7 +94,10 @@ public:
     QString outputInfo(quint32 output);
 
     /** @reimp */
-    void writeUniverse(quint32 universe, quint32 output, const QByteArray& data);
+    void writeUniverse(quint32 universe, quint32 output, const QByteArray& data, bool dataChanged);
+
+    /** @reimp */
+    void flushOutputs();
 
     /*************************************************************************
      * Inputs
@@ -0,0 +1,205 @@
+/*
+  Q Light Controller Plus
+  e131_test.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QTest>
+
+#define private public
+#include "e131_test.h"
+#include "e131packetizer.h"
+#include "e131merger.h"
+#undef private
+
+/****************************************************************************
+ * E1.31 tests
+ ****************************************************************************/
+
+void E131_Test::setupE131Dmx()
+{
+    E131Packetizer ep;
+    QByteArray data;
+    const QByteArray fifty(50, 10);
+
+    ep.setupE131Dmx(data, 1, 150, fifty, 0x0102);
+
+    QCOMPARE(data.size(), 126 + 50);
+    QVERIFY(ep.checkPacket(data) == true);
+
+    QByteArray dmx;
+    quint32 universe = 0;
+    QVERIFY(ep.fillDMXdata(data, dmx, universe) == true);
+    QCOMPARE(universe, quint32(1));
+    QCOMPARE(dmx, fifty);
+
+    QCOMPARE(ep.syncUniverse(data), quint16(0x0102));
+
+    QByteArray cid;
+    int priority = 0;
+    uchar sequence = 0, options = 0;
+    QVERIFY(ep.fillSourceData(data, cid, priority, sequence, options) == true);
+    QCOMPARE(cid.size(), 16);
+    QCOMPARE(priority, 150);
+    QCOMPARE(int(sequence), 1);
+    QCOMPARE(int(options), 0);
+
+    // without a synchronization universe the data is applied immediately
+    ep.setupE131Dmx(data, 1, 100, fifty);
+    QCOMPARE(ep.syncUniverse(data), quint16(0));
+    QCOMPARE(int(uchar(data.at(111))), 2);
+
+    // a DMX packet is not a Synchronization packet
+    quint16 syncUniverse = 0;
+    QVERIFY(ep.fillSyncData(data, syncUniverse) == false);
+}
+
+void E131_Test::setupE131Sync()
+{
+    E131Packetizer ep;
+    QByteArray data;
+
+    ep.setupE131Sync(data, 0x0102);
+
+    QCOMPARE(data.size(), E131_SYNC_PACKET_SIZE);
+    QCOMPARE(data.mid(4, 9), QByteArray("ASC-E1.17"));
+
+    // root layer and framing layer lengths
+    QCOMPARE(int(uchar(data.at(16))), 0x70);
+    QCOMPARE(int(uchar(data.at(17))), E131_SYNC_PACKET_SIZE - 16);
+    QCOMPARE(int(uchar(data.at(38))), 0x70);
+    QCOMPARE(int(uchar(data.at(39))), E131_SYNC_PACKET_SIZE - 38);
+
+    // extended root vector and Synchronization framing vector
+    QCOMPARE(int(data.at(21)), 0x08);
+    QCOMPARE(int(data.at(43)), 0x01);
+
+    // the sequence starts from 1, the synchronization universe follows it
+    QCOMPARE(int(data.at(44)), 1);
+    QCOMPARE(int(data.at(45)), 0x01);
+    QCOMPARE(int(data.at(46)), 0x02);
+    QCOMPARE(int(data.at(47)), 0);
+    QCOMPARE(int(data.at(48)), 0);
+
+    // sync packets are shorter than the DMX ones
+    QVERIFY(ep.checkPacket(data) == false);
+
+    // each synchronization universe has its own sequence
+    ep.setupE131Sync(data, 0x0102);
+    QCOMPARE(int(data.at(44)), 2);
+
+    ep.setupE131Sync(data, 7);
+    QCOMPARE(int(data.at(44)), 1);
+
+    // 0 is skipped when the sequence wraps
+    ep.m_syncSequence[7] = 0xff;
+    ep.setupE131Sync(data, 7);
+    QCOMPARE(int(uchar(data.at(44))), 0xff);
+    ep.setupE131Sync(data, 7);
+    QCOMPARE(int(data.at(44)), 1);
+}
+
+void E131_Test::fillSyncData()
+{
+    E131Packetizer ep;
+    QByteArray data;
+    quint16 syncUniverse = 0;
+
+    ep.setupE131Sync(data, 63999);
+    QVERIFY(ep.fillSyncData(data, syncUniverse) == true);
+    QCOMPARE(syncUniverse, quint16(63999));
+
+    // truncated packets are rejected
+    QByteArray truncated = data.left(E131_SYNC_PACKET_SIZE - 1);
+    syncUniverse = 0;
+    QVERIFY(ep.fillSyncData(truncated, syncUniverse) == false);
+    QCOMPARE(syncUniverse, quint16(0));
+
+    // as well as anything that isn't an E1.17 packet
+    QByteArray broken = data;
+    broken[4] = 'X';
+    QVERIFY(ep.fillSyncData(broken, syncUniverse) == false);
+
+    // or a Synchronization packet
+    broken = data;
+    broken[21] = 0x04;
+    QVERIFY(ep.fillSyncData(broken, syncUniverse) == false);
+
+    broken = data;
+    broken[43] = 0x02;
+    QVERIFY(ep.fillSyncData(broken, syncUniverse) == false);
+}
+
+void E131_Test::merger()
+{
+    E131Merger merger;
+    const QByteArray a(16, 'a');
+    const QByteArray b(16, 'b');
+    const QByteArray c(16, 'c');
+
+    QCOMPARE(merger.values().size(), 512);
+    QCOMPARE(merger.sourcesCount(), 0);
+
+    QVERIFY(merger.updateSource(a, 100, 1, QByteArray(512, 10)) == true);
+    QCOMPARE(int(merger.values().at(0)), 10);
+    QCOMPARE(merger.sourcesCount(), 1);
+
+    // the highest priority wins, even with lower values
+    QVERIFY(merger.updateSource(b, 150, 1, QByteArray(512, 5)) == true);
+    QCOMPARE(int(merger.values().at(0)), 5);
+    QCOMPARE(merger.sourcesCount(), 2);
+
+    QVERIFY(merger.updateSource(a, 100, 2, QByteArray(512, 100)) == false);
+    QCOMPARE(int(merger.values().at(0)), 5);
+
+    // sources with the same priority are merged HTP,
+    // and the values they don't send are zero
+    QVERIFY(merger.updateSource(c, 150, 1, QByteArray(1, 200)) == true);
+    QCOMPARE(int(uchar(merger.values().at(0))), 200);
+    QCOMPARE(int(merger.values().at(1)), 5);
+    QCOMPARE(int(merger.values().at(511)), 5);
+
+    // repeated and late packets are discarded
+    QVERIFY(merger.updateSource(c, 150, 1, QByteArray(1, 50)) == false);
+    QVERIFY(merger.updateSource(c, 150, 0xff, QByteArray(1, 50)) == false);
+    QCOMPARE(int(uchar(merger.values().at(0))), 200);
+
+    QVERIFY(merger.updateSource(c, 150, 2, QByteArray(1, 50)) == true);
+    QCOMPARE(int(merger.values().at(0)), 50);
+
+    // a sequence far behind means the source restarted
+    QVERIFY(merger.updateSource(c, 150, uchar(2 - 30), QByteArray(1, 60)) == true);
+    QCOMPARE(int(merger.values().at(0)), 60);
+
+    // a terminated source leaves the merge right away
+    QVERIFY(merger.removeSource(c) == true);
+    QCOMPARE(int(merger.values().at(0)), 5);
+    QCOMPARE(merger.sourcesCount(), 2);
+    QVERIFY(merger.removeSource(c) == false);
+
+    // sources not heard for a while time out
+    QTest::qSleep(E131_SOURCE_TIMEOUT + 100);
+    QVERIFY(merger.updateSource(a, 100, 3, QByteArray(512, 100)) == true);
+    QCOMPARE(merger.sourcesCount(), 1);
+    QCOMPARE(int(merger.values().at(0)), 100);
+
+    // the values stay when the last source goes away
+    QVERIFY(merger.removeSource(a) == false);
+    QCOMPARE(merger.sourcesCount(), 0);
+    QCOMPARE(int(merger.values().at(0)), 100);
+}
+
+QTEST_MAIN(E131_Test)
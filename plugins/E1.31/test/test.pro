@@ -0,0 +1,18 @@
+include(../../../variables.pri)
+include(../../../coverage.pri)
+
+TEMPLATE = app
+LANGUAGE = C++
+TARGET   = e131_test
+
+QT      += core testlib network
+QT      -= gui
+LIBS    += -L../src -le131
+
+INCLUDEPATH += ../../interfaces
+INCLUDEPATH += ../src
+DEPENDPATH  += ../src
+
+# Test sources
+HEADERS += e131_test.h ../../interfaces/qlcioplugin.h
+SOURCES += e131_test.cpp ../src/e131packetizer.cpp ../src/e131merger.cpp ../../interfaces/qlcioplugin.cpp
@@ -40,8 +40,11 @@ ArtNetController::ArtNetController(QNetworkInterface const& interface, QNetworkA
     , m_line(line)
     , m_udpSocket(udpSocket)
     , m_packetizer(new ArtNetPacketizer())
+    , m_syncPending(false)
     , m_pollTimer(NULL)
 {
+    m_packetizer->setupArtNetSync(m_syncPacket);
+
     if (m_ipAddr == QHostAddress::LocalHost)
     {
         m_broadcastAddr = QHostAddress::LocalHost;
@@ -65,10 +68,9 @@ ArtNetController::~ArtNetController()
 ArtNetController::Type ArtNetController::type()
 {
     int type = Unknown;
-    foreach(UniverseInfo info, m_universeMap.values())
-    {
-        type |= info.type;
-    }
+    QMap<quint32, UniverseInfo>::const_iterator it = m_universeMap.constBegin();
+    for (; it != m_universeMap.constEnd(); ++it)
+        type |= it.value().type;
 
     return Type(type);
 }
@@ -117,7 +119,11 @@ void ArtNetController::addUniverse(quint32 universe, ArtNetController::Type type
         info.outputAddress = m_broadcastAddr;
         info.outputUniverse = universe;
         info.outputTransmissionMode = Full;
+        info.outputSync = false;
         info.type = type;
+
+        QMutexLocker locker(&m_dataMutex);
+        setupOutputPacket(info, 512);
         m_universeMap[universe] = info;
     }
 
@@ -205,7 +211,9 @@ bool ArtNetController::setOutputUniverse(quint32 universe, quint32 artnetUni)
         return false;
 
     QMutexLocker locker(&m_dataMutex);
-    m_universeMap[universe].outputUniverse = artnetUni;
+    UniverseInfo &info = m_universeMap[universe];
+    info.outputUniverse = artnetUni;
+    setupOutputPacket(info, 512);
 
     return universe == artnetUni;
 }
@@ -216,11 +224,25 @@ bool ArtNetController::setTransmissionMode(quint32 universe, ArtNetController::T
         return false;
 
     QMutexLocker locker(&m_dataMutex);
-    m_universeMap[universe].outputTransmissionMode = int(mode);
+    UniverseInfo &info = m_universeMap[universe];
+    info.outputTransmissionMode = int(mode);
+    // in Partial mode, sendDmx resizes the packet to the data it gets
+    setupOutputPacket(info, 512);
 
     return mode == ArtNetController::Full;
 }
 
+bool ArtNetController::setOutputSync(quint32 universe, bool enable)
+{
+    if (!m_universeMap.contains(universe))
+        return false;
+
+    QMutexLocker locker(&m_dataMutex);
+    m_universeMap[universe].outputSync = enable;
+
+    return enable == false;
+}
+
 QString ArtNetController::transmissionModeToString(ArtNetController::TransmissionMode mode)
 {
     switch (mode)
@@ -256,40 +278,57 @@ UniverseInfo *ArtNetController::getUniverseInfo(quint32 universe)
     return NULL;
 }
 
+void ArtNetController::setupOutputPacket(UniverseInfo &info, int channels)
+{
+    m_packetizer->setupArtNetDmxTemplate(info.outputPacket, info.outputUniverse, channels);
+}
+
 void ArtNetController::sendDmx(const quint32 universe, const QByteArray &data)
 {
     QMutexLocker locker(&m_dataMutex);
-    QByteArray dmxPacket;
-    QHostAddress outAddress = m_broadcastAddr;
-    quint32 outUniverse = universe;
-    TransmissionMode transmitMode = Full;
 
-    if (m_universeMap.contains(universe))
+    QMap<quint32, UniverseInfo>::iterator it = m_universeMap.find(universe);
+    if (it != m_universeMap.end())
     {
-        UniverseInfo info = m_universeMap[universe];
-        outAddress = info.outputAddress;
-        outUniverse = info.outputUniverse;
-        transmitMode = TransmissionMode(info.outputTransmissionMode);
-    }
+        UniverseInfo &info = it.value();
+
+        // a universe is queued once per frame, so a frame that has
+        // not been flushed is sent before its packets get updated
+        if (m_outputBatch.count() >= m_universeMap.count())
+            m_packetSent += m_outputBatch.flush(m_udpSocket.data());
 
-    if (transmitMode == Full)
+        if (info.outputTransmissionMode == Partial &&
+            info.outputPacket.size() != ARTNET_DMX_HEADER_SIZE + ArtNetPacketizer::dmxDataLength(data.length()))
+            setupOutputPacket(info, data.length());
+
+        m_packetizer->updateArtNetDmx(info.outputPacket, data);
+        m_outputBatch.append(info.outputPacket, info.outputAddress, ARTNET_PORT);
+
+        if (info.outputSync)
+            m_syncPending = true;
+    }
+    else
     {
+        QByteArray dmxPacket;
         QByteArray wholeuniverse(512, 0);
         wholeuniverse.replace(0, data.length(), data);
-        m_packetizer->setupArtNetDmx(dmxPacket, outUniverse, wholeuniverse);
+        m_packetizer->setupArtNetDmx(dmxPacket, universe, wholeuniverse);
+        m_outputBatch.append(dmxPacket, m_broadcastAddr, ARTNET_PORT);
     }
-    else
-        m_packetizer->setupArtNetDmx(dmxPacket, outUniverse, data);
+}
 
-    qint64 sent = m_udpSocket->writeDatagram(dmxPacket, outAddress, ARTNET_PORT);
-    if (sent < 0)
+void ArtNetController::flushDmx()
+{
+    QMutexLocker locker(&m_dataMutex);
+
+    // ArtSync follows the ArtDmx packets of the frame and is always broadcast
+    if (m_syncPending)
     {
-        qWarning() << "sendDmx failed";
-        qWarning() << "Errno: " << m_udpSocket->error();
-        qWarning() << "Errmgs: " << m_udpSocket->errorString();
+        m_outputBatch.append(m_syncPacket, m_broadcastAddr, ARTNET_PORT);
+        m_syncPending = false;
     }
-    else
-        m_packetSent++;
+
+    m_packetSent += m_outputBatch.flush(m_udpSocket.data());
 }
 
 bool ArtNetController::handleArtNetPollReply(QByteArray const& datagram, QHostAddress const& senderAddress)
@@ -351,26 +390,15 @@ bool ArtNetController::handleArtNetDmx(QByteArray const& datagram, QHostAddress
 
         if ((info.type & Input) && info.inputUniverse == artnetUniverse)
         {
-            QByteArray *dmxValues;
-            if (m_dmxValuesMap.contains(universe) == false)
-                m_dmxValuesMap[universe] = new QByteArray(512, 0);
-            dmxValues = m_dmxValuesMap[universe];
-
 #if _DEBUG_RECEIVED_PACKETS
             qDebug() << "[ArtNet] -> universe" << (universe + 1);
 #endif
+            // in synchronous mode, the data is applied by the next ArtSync
+            if (m_inputSyncTimer.isValid() && !m_inputSyncTimer.hasExpired(ARTNET_SYNC_TIMEOUT))
+                m_pendingDmx[universe] = dmxData;
+            else
+                applyDmx(universe, dmxData);
 
-            for (int i = 0; i < dmxData.length(); i++)
-            {
-                if (dmxValues->at(i) != dmxData.at(i))
-                {
-#if _DEBUG_RECEIVED_PACKETS
-                    qDebug() << "[ArtNet] a value differs";
-#endif
-                    dmxValues->replace(i, 1, (const char *)(dmxData.data() + i), 1);
-                    emit valueChanged(universe, m_line, i, (uchar)dmxData.at(i));
-                }
-            }
             ++m_packetReceived;
             return true;
         }
@@ -378,6 +406,51 @@ bool ArtNetController::handleArtNetDmx(QByteArray const& datagram, QHostAddress
     return false;
 }
 
+bool ArtNetController::handleArtNetSync(QByteArray const& datagram, QHostAddress const& senderAddress)
+{
+    Q_UNUSED(datagram);
+
+#if _DEBUG_RECEIVED_PACKETS
+    qDebug() << "[ArtNet] ArtSync received";
+#endif
+
+    // ArtSync sent by QLC+ itself
+    if (senderAddress == m_ipAddr)
+        return false;
+
+    m_inputSyncTimer.start();
+
+    for (QHash<quint32, QByteArray>::const_iterator it = m_pendingDmx.constBegin();
+         it != m_pendingDmx.constEnd(); ++it)
+        applyDmx(it.key(), it.value());
+    m_pendingDmx.clear();
+
+    ++m_packetReceived;
+
+    // let the controllers of the other interfaces sync as well
+    return false;
+}
+
+void ArtNetController::applyDmx(quint32 universe, QByteArray const& dmxData)
+{
+    QByteArray *dmxValues;
+    if (m_dmxValuesMap.contains(universe) == false)
+        m_dmxValuesMap[universe] = new QByteArray(512, 0);
+    dmxValues = m_dmxValuesMap[universe];
+
+    for (int i = 0; i < dmxData.length(); i++)
+    {
+        if (dmxValues->at(i) != dmxData.at(i))
+        {
+#if _DEBUG_RECEIVED_PACKETS
+            qDebug() << "[ArtNet] a value differs";
+#endif
+            dmxValues->replace(i, 1, (const char *)(dmxData.data() + i), 1);
+            emit valueChanged(universe, m_line, i, (uchar)dmxData.at(i));
+        }
+    }
+}
+
 bool ArtNetController::handlePacket(QByteArray const& datagram, QHostAddress const& senderAddress)
 {
 #if _DEBUG_RECEIVED_PACKETS
@@ -394,6 +467,8 @@ bool ArtNetController::handlePacket(QByteArray const& datagram, QHostAddress con
                 return handleArtNetPoll(datagram, senderAddress);
             case ARTNET_DMX:
                 return handleArtNetDmx(datagram, senderAddress);
+            case ARTNET_SYNC:
+                return handleArtNetSync(datagram, senderAddress);
             default:
                 qDebug() << "[ArtNet] opCode not supported yet (" << opCode << ")";
                 break;
@@ -29,13 +29,19 @@
 #else
 #include <QtNetwork>
 #endif
+#include <QElapsedTimer>
 #include <QMutex>
 #include <QTimer>
 
 #include "artnetpacketizer.h"
+#include "datagrambatch.h"
 
 #define ARTNET_PORT      6454
 
+/** Nodes go back to output data immediately when ArtSync
+ *  packets stop arriving for this time, in milliseconds */
+#define ARTNET_SYNC_TIMEOUT 4000
+
 typedef struct
 {
     ushort inputUniverse;
@@ -43,6 +49,11 @@ typedef struct
     QHostAddress outputAddress;
     ushort outputUniverse;
     int outputTransmissionMode;
+    bool outputSync;
+
+    /** ArtDmx packet built once with the output parameters,
+     *  whose data is updated in place at each transmission */
+    QByteArray outputPacket;
 
     int type;
 } UniverseInfo;
@@ -66,9 +77,12 @@ public:
 
     ~ArtNetController();
 
-    /** Send DMX data to a specific port/universe */
+    /** Queue DMX data for a specific port/universe, to be sent by flushDmx */
     void sendDmx(const quint32 universe, const QByteArray& data);
 
+    /** Send the DMX data queued by sendDmx since the last call */
+    void flushDmx();
+
     /** Return the controller IP address */
     QString getNetworkIP();
 
@@ -100,6 +114,12 @@ public:
      *  Return true if this restores default transmission mode */
     bool setTransmissionMode(quint32 universe, TransmissionMode mode);
 
+    /** Enable or disable the transmission of an ArtSync packet after
+     *  each frame including the given QLC+ universe, so that nodes
+     *  output all the universes of a frame at the same time.
+     *  Return true if this restores default (disabled) */
+    bool setOutputSync(quint32 universe, bool enable);
+
     /** Converts a TransmissionMode value into a human readable string */
     static QString transmissionModeToString(TransmissionMode mode);
 
@@ -171,12 +191,36 @@ private:
      *  variables that could be used to transmit/receive data */
     QMutex m_dataMutex;
 
+    /** The ArtDmx packets queued by sendDmx */
+    DatagramBatch m_outputBatch;
+
+    /** The ArtSync packet sent by flushDmx */
+    QByteArray m_syncPacket;
+
+    /** True when a universe queued since the last flushDmx needs an ArtSync */
+    bool m_syncPending;
+
+    /** Started at each ArtSync received. Until it expires, the received
+     *  ArtDmx data is held back until the next ArtSync */
+    QElapsedTimer m_inputSyncTimer;
+
+    /** The ArtDmx data waiting for an ArtSync, per QLC+ universe */
+    QHash<quint32, QByteArray> m_pendingDmx;
+
     QTimer* m_pollTimer;
 
 private:
+    /** Rebuild the ArtDmx packet of $info with room for $channels values.
+     *  Must be called with m_dataMutex locked */
+    void setupOutputPacket(UniverseInfo &info, int channels);
+
     bool handleArtNetPollReply(QByteArray const& datagram, QHostAddress const& senderAddress);
     bool handleArtNetPoll(QByteArray const& datagram, QHostAddress const& senderAddress);
     bool handleArtNetDmx(QByteArray const& datagram, QHostAddress const& senderAddress);
+    bool handleArtNetSync(QByteArray const& datagram, QHostAddress const& senderAddress);
+
+    /** Emit the values of $dmxData that changed for the given QLC+ universe */
+    void applyDmx(quint32 universe, QByteArray const& dmxData);
 
 public:
     // Handle a packet received to the ArtNet port.
@@ -21,6 +21,7 @@
 
 #include <QStringList>
 #include <QDebug>
+#include <string.h>
 
 ArtNetPacketizer::ArtNetPacketizer()
 {
@@ -143,6 +144,64 @@ void ArtNetPacketizer::setupArtNetDmx(QByteArray& data, const int &universe, con
         m_sequence[universe]++;
 }
 
+void ArtNetPacketizer::setupArtNetSync(QByteArray& data)
+{
+    data.clear();
+    data.append(m_commonHeader);
+    const char opCodeMSB = (ARTNET_SYNC >> 8);
+    data[9] = opCodeMSB;
+    data.append('\0'); // Aux1
+    data.append('\0'); // Aux2
+}
+
+void ArtNetPacketizer::setupArtNetDmxTemplate(QByteArray& data, const int &universe, const int &channels)
+{
+    char sequence = 0;
+    if (data.size() >= ARTNET_DMX_HEADER_SIZE)
+        sequence = data.at(ARTNET_DMX_SEQUENCE_POS);
+
+    int len = dmxDataLength(channels);
+
+    data.clear();
+    data.reserve(ARTNET_DMX_HEADER_SIZE + len);
+    data.append(m_commonHeader);
+    const char opCodeMSB = (ARTNET_DMX >> 8);
+    data[9] = opCodeMSB;
+    data.append(sequence); // Sequence
+    data.append('\0'); // Physical
+    data.append((char)(universe & 0x00FF));
+    data.append((char)(universe >> 8));
+    data.append((char)(len >> 8));
+    data.append((char)(len & 0x00FF));
+    data.append(QByteArray(len, 0));
+}
+
+void ArtNetPacketizer::updateArtNetDmx(QByteArray& data, const QByteArray &values)
+{
+    int len = data.size() - ARTNET_DMX_HEADER_SIZE;
+    if (len <= 0)
+        return;
+
+    char *packet = data.data();
+
+    // 0 means that sequencing is disabled, so wrap to 1
+    uchar sequence = (uchar)packet[ARTNET_DMX_SEQUENCE_POS];
+    packet[ARTNET_DMX_SEQUENCE_POS] = (char)(sequence == 0xff ? 1 : sequence + 1);
+
+    int count = qMin(values.length(), len);
+    memcpy(packet + ARTNET_DMX_HEADER_SIZE, values.constData(), count);
+    if (count < len)
+        memset(packet + ARTNET_DMX_HEADER_SIZE + count, 0, len - count);
+}
+
+int ArtNetPacketizer::dmxDataLength(int channels)
+{
+    if (channels <= 0)
+        return 2;
+
+    return channels + (channels % 2);
+}
+
 /*********************************************************************
  * Receiver functions
  *********************************************************************/
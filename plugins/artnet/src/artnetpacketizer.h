@@ -31,6 +31,7 @@
 #define ARTNET_COMMAND        0x2400
 #define ARTNET_DMX            0x5000
 #define ARTNET_NZS            0x5100
+#define ARTNET_SYNC           0x5200
 #define ARTNET_ADDRESS        0x6000
 #define ARTNET_INPUT          0x7000
 #define ARTNET_TODREQUEST     0x8000
@@ -62,6 +63,11 @@
 
 #define ARTNET_CODE_STR "Art-Net"
 
+/** Size of an ArtDmx header, the DMX data starts right after it */
+#define ARTNET_DMX_HEADER_SIZE  18
+/** Position of the sequence number in an ArtDmx packet */
+#define ARTNET_DMX_SEQUENCE_POS 12
+
 typedef struct
 {
     QString shortName;
@@ -91,6 +97,24 @@ public:
     /** Prepare an ArtNetDmx packet */
     void setupArtNetDmx(QByteArray& data, const int& universe, const QByteArray &values);
 
+    /** Prepare an ArtNetSync packet, which tells the nodes to output
+     *  the ArtNetDmx data received since the previous one */
+    void setupArtNetSync(QByteArray& data);
+
+    /** Prepare an ArtNetDmx packet with room for 'channels' zeroed values,
+     *  to be filled by updateArtNetDmx at each transmission.
+     *  If 'data' is already an ArtNetDmx packet, its sequence number is kept */
+    void setupArtNetDmxTemplate(QByteArray& data, const int& universe, const int& channels);
+
+    /** Copy 'values' into an ArtNetDmx packet prepared by setupArtNetDmxTemplate
+     *  and advance its sequence number. The packet is updated in place, so
+     *  no memory is allocated as long as 'data' is not shared */
+    void updateArtNetDmx(QByteArray& data, const QByteArray& values);
+
+    /** Return the length of the ArtNetDmx data needed to transmit
+     *  'channels' values. It must be even, in the range 2-512 */
+    static int dmxDataLength(int channels);
+
     /*********************************************************************
      * Receiver functions
      *********************************************************************/
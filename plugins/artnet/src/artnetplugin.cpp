@@ -203,16 +203,31 @@ void ArtNetPlugin::closeOutput(quint32 output, quint32 universe)
     }
 }
 
-void ArtNetPlugin::writeUniverse(quint32 universe, quint32 output, const QByteArray &data)
+void ArtNetPlugin::writeUniverse(quint32 universe, quint32 output, const QByteArray &data, bool dataChanged)
 {
     if (output >= (quint32)m_IOmapping.count())
         return;
 
+    // nothing new to transmit
+    if (dataChanged == false)
+        return;
+
     ArtNetController *controller = m_IOmapping.at(output).controller;
     if (controller != NULL)
         controller->sendDmx(universe, data);
 }
 
+void ArtNetPlugin::flushOutputs()
+{
+    // index the lines, as copying them would allocate at each frame
+    for (int i = 0; i < m_IOmapping.count(); i++)
+    {
+        ArtNetController *controller = m_IOmapping.at(i).controller;
+        if (controller != NULL)
+            controller->flushDmx();
+    }
+}
+
 /*************************************************************************
   * Inputs
   *************************************************************************/
@@ -351,6 +366,8 @@ void ArtNetPlugin::setParameter(quint32 universe, quint32 line, Capability type,
             unset = controller->setOutputUniverse(universe, value.toUInt());
         else if (name == ARTNET_TRANSMITMODE)
             unset = controller->setTransmissionMode(universe, ArtNetController::stringToTransmissionMode(value.toString()));
+        else if (name == ARTNET_OUTPUTSYNC)
+            unset = controller->setOutputSync(universe, value.toBool());
         else
         {
             qWarning() << Q_FUNC_INFO << name << "is not a valid ArtNet output parameter";
@@ -41,6 +41,7 @@ typedef struct
 #define ARTNET_OUTPUTIP "outputIP"
 #define ARTNET_OUTPUTUNI "outputUni"
 #define ARTNET_TRANSMITMODE "transmitMode"
+#define ARTNET_OUTPUTSYNC "outputSync"
 
 class ArtNetPlugin : public QLCIOPlugin
 {
@@ -89,7 +90,10 @@ public:
     QString outputInfo(quint32 output);
 
     /** @reimp */
-    void writeUniverse(quint32 universe, quint32 output, const QByteArray& data);
+    void writeUniverse(quint32 universe, quint32 output, const QByteArray& data, bool dataChanged);
+
+    /** @reimp */
+    void flushOutputs();
 
     /*************************************************************************
      * Inputs
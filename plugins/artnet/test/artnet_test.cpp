@@ -62,4 +62,70 @@ void ArtNet_Test::setupArtNetDmx()
     QCOMPARE(data.data(), "Art-Net");
 }
 
+void ArtNet_Test::artNetDmxTemplate()
+{
+    ArtNetPacketizer ap;
+
+    QByteArray data;
+    const QByteArray fifty(50, 10);
+    const QByteArray fiftyone(51, 10);
+
+    ap.setupArtNetDmxTemplate(data, 0x0102, 512);
+
+    QCOMPARE(data.size(), ARTNET_DMX_HEADER_SIZE + 512);
+    QCOMPARE(data.data(), "Art-Net");
+    QCOMPARE(int(data.at(9)), ARTNET_DMX >> 8);
+    QCOMPARE(int(data.at(14)), 0x02);
+    QCOMPARE(int(data.at(15)), 0x01);
+    QCOMPARE(int(data.at(16)), 0x02);
+    QCOMPARE(int(data.at(17)), 0x00);
+
+    // the sequence starts from 1 and the values missing are zeroed
+    const char *packet = data.constData();
+    ap.updateArtNetDmx(data, fifty);
+    QVERIFY(data.constData() == packet);
+    QCOMPARE(int(data.at(ARTNET_DMX_SEQUENCE_POS)), 1);
+    QCOMPARE(int(data.at(ARTNET_DMX_HEADER_SIZE + 49)), 10);
+    QCOMPARE(int(data.at(ARTNET_DMX_HEADER_SIZE + 50)), 0);
+
+    ap.updateArtNetDmx(data, fifty);
+    QCOMPARE(int(data.at(ARTNET_DMX_SEQUENCE_POS)), 2);
+
+    // 0 is skipped when the sequence wraps
+    data[ARTNET_DMX_SEQUENCE_POS] = (char)0xff;
+    ap.updateArtNetDmx(data, fifty);
+    QCOMPARE(int(data.at(ARTNET_DMX_SEQUENCE_POS)), 1);
+
+    // rebuilding keeps the sequence and pads the data to an even length
+    ap.setupArtNetDmxTemplate(data, 0, fiftyone.length());
+    QCOMPARE(data.size(), ARTNET_DMX_HEADER_SIZE + 52);
+    QCOMPARE(int(data.at(ARTNET_DMX_SEQUENCE_POS)), 1);
+
+    ap.updateArtNetDmx(data, fiftyone);
+    QCOMPARE(int(data.at(ARTNET_DMX_HEADER_SIZE + 50)), 10);
+    QCOMPARE(int(data.at(ARTNET_DMX_HEADER_SIZE + 51)), 0);
+
+    QCOMPARE(ArtNetPacketizer::dmxDataLength(0), 2);
+    QCOMPARE(ArtNetPacketizer::dmxDataLength(1), 2);
+    QCOMPARE(ArtNetPacketizer::dmxDataLength(512), 512);
+}
+
+void ArtNet_Test::setupArtNetSync()
+{
+    ArtNetPacketizer ap;
+    QByteArray data;
+
+    ap.setupArtNetSync(data);
+
+    QCOMPARE(data.size(), 14);
+    QCOMPARE(data.data(), "Art-Net");
+
+    int code = 0;
+    QVERIFY(ap.checkPacketAndCode(data, code) == true);
+    QCOMPARE(code, ARTNET_SYNC);
+    QCOMPARE(int(data.at(11)), 0x0e);
+    QCOMPARE(int(data.at(12)), 0);
+    QCOMPARE(int(data.at(13)), 0);
+}
+
 QTEST_MAIN(ArtNet_Test)
@@ -180,8 +180,10 @@ QString DMXUSB::outputInfo(quint32 output)
     return str;
 }
 
-void DMXUSB::writeUniverse(quint32 universe, quint32 output, const QByteArray &data)
+void DMXUSB::writeUniverse(quint32 universe, quint32 output, const QByteArray &data, bool dataChanged)
 {
+    Q_UNUSED(dataChanged)
+
     if (output < quint32(m_outputs.size()))
     {
         QByteArray wholeuniverse(512, 0);
@@ -126,11 +126,12 @@ QString DummyPlugin::outputInfo(quint32 output)
     return str;
 }
 
-void DummyPlugin::writeUniverse(quint32 universe, quint32 output, const QByteArray &data)
+void DummyPlugin::writeUniverse(quint32 universe, quint32 output, const QByteArray &data, bool dataChanged)
 {
     Q_UNUSED(universe)
     Q_UNUSED(output)
     Q_UNUSED(data)
+    Q_UNUSED(dataChanged)
 
     /** Check for output index validity and, in case, return.
      *
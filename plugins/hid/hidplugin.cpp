@@ -209,9 +209,10 @@ QString HIDPlugin::outputInfo(quint32 output)
     return str;
 }
 
-void HIDPlugin::writeUniverse(quint32 universe, quint32 output, const QByteArray &data)
+void HIDPlugin::writeUniverse(quint32 universe, quint32 output, const QByteArray &data, bool dataChanged)
 {
     Q_UNUSED(universe);
+    Q_UNUSED(dataChanged);
 
     if (output != QLCIOPlugin::invalidLine())
     {
@@ -0,0 +1,131 @@
+/*
+  Q Light Controller Plus
+  datagrambatch.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QUdpSocket>
+#include <QDebug>
+#include <string.h>
+
+#include "datagrambatch.h"
+
+#ifdef DATAGRAMBATCH_SENDMMSG
+  #include <arpa/inet.h>
+#endif
+
+DatagramBatch::DatagramBatch()
+{
+}
+
+DatagramBatch::~DatagramBatch()
+{
+}
+
+void DatagramBatch::append(const QByteArray &data, const QHostAddress &address, quint16 port)
+{
+    Datagram datagram;
+    datagram.m_data = data;
+    datagram.m_address = address;
+    datagram.m_port = port;
+    m_datagrams.append(datagram);
+}
+
+int DatagramBatch::count() const
+{
+    return m_datagrams.count();
+}
+
+int DatagramBatch::flush(QUdpSocket *socket)
+{
+    int count = m_datagrams.count();
+    if (count == 0)
+        return 0;
+
+    int sent = 0;
+
+#ifdef DATAGRAMBATCH_SENDMMSG
+    int fd = int(socket->socketDescriptor());
+
+    m_headers.resize(count);
+    m_vectors.resize(count);
+    m_addresses.resize(count);
+
+    // sendmmsg() handles IPv4 destinations, the others go through Qt
+    int batched = 0;
+    while (fd != -1 && batched < count &&
+           m_datagrams.at(batched).m_address.protocol() == QAbstractSocket::IPv4Protocol)
+    {
+        const Datagram &datagram = m_datagrams.at(batched);
+
+        struct sockaddr_in &addr = m_addresses[batched];
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(datagram.m_port);
+        addr.sin_addr.s_addr = htonl(datagram.m_address.toIPv4Address());
+
+        struct iovec &vector = m_vectors[batched];
+        vector.iov_base = const_cast<char *>(datagram.m_data.constData());
+        vector.iov_len = size_t(datagram.m_data.size());
+
+        struct mmsghdr &header = m_headers[batched];
+        memset(&header, 0, sizeof(header));
+        header.msg_hdr.msg_name = &addr;
+        header.msg_hdr.msg_namelen = sizeof(addr);
+        header.msg_hdr.msg_iov = &vector;
+        header.msg_hdr.msg_iovlen = 1;
+
+        batched++;
+    }
+
+    while (sent < batched)
+    {
+        int result = sendmmsg(fd, m_headers.data() + sent, unsigned(batched - sent), 0);
+        if (result <= 0)
+            break;
+        sent += result;
+    }
+
+    // whatever sendmmsg() didn't send is retried with Qt, which reports the errors
+    sent += writeDatagrams(socket, sent);
+#else
+    sent = writeDatagrams(socket, 0);
+#endif
+
+    // resize() keeps the capacity, so the next frame doesn't allocate
+    m_datagrams.resize(0);
+
+    return sent;
+}
+
+int DatagramBatch::writeDatagrams(QUdpSocket *socket, int index)
+{
+    int sent = 0;
+
+    for (int i = index; i < m_datagrams.count(); i++)
+    {
+        const Datagram &datagram = m_datagrams.at(i);
+        if (socket->writeDatagram(datagram.m_data, datagram.m_address, datagram.m_port) < 0)
+        {
+            qWarning() << "[DatagramBatch] unable to send to" << datagram.m_address.toString()
+                       << ":" << socket->errorString();
+            continue;
+        }
+        sent++;
+    }
+
+    return sent;
+}
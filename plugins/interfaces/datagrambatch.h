@@ -0,0 +1,82 @@
+/*
+  Q Light Controller Plus
+  datagrambatch.h
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef DATAGRAMBATCH_H
+#define DATAGRAMBATCH_H
+
+#include <QHostAddress>
+#include <QByteArray>
+#include <QVector>
+
+#if defined(Q_OS_LINUX) && !defined(Q_OS_ANDROID)
+  #define DATAGRAMBATCH_SENDMMSG
+  #include <sys/socket.h>
+  #include <netinet/in.h>
+#endif
+
+class QUdpSocket;
+
+/**
+ * DatagramBatch collects the UDP datagrams of a whole frame, to send
+ * them all at once with flush(). On Linux they are sent with a single
+ * sendmmsg() call, elsewhere with one QUdpSocket::writeDatagram each.
+ *
+ * The queued datagrams are implicitly shared copies, so queueing a
+ * packet buffer which is reused at each frame doesn't allocate anything.
+ */
+class DatagramBatch
+{
+public:
+    DatagramBatch();
+    ~DatagramBatch();
+
+    /** Queue $data to be sent to $address:$port at the next flush() */
+    void append(const QByteArray &data, const QHostAddress &address, quint16 port);
+
+    /** Return the number of the queued datagrams */
+    int count() const;
+
+    /** Send all the queued datagrams through $socket and empty the queue.
+     *  Return the number of datagrams successfully sent */
+    int flush(QUdpSocket *socket);
+
+private:
+    /** Send the queued datagrams from $index on with writeDatagram */
+    int writeDatagrams(QUdpSocket *socket, int index);
+
+private:
+    typedef struct
+    {
+        QByteArray m_data;          //! The datagram payload
+        QHostAddress m_address;     //! The destination address
+        quint16 m_port;             //! The destination port
+    } Datagram;
+
+    /** The queued datagrams. Its capacity is reused across frames */
+    QVector<Datagram> m_datagrams;
+
+#ifdef DATAGRAMBATCH_SENDMMSG
+    /** The sendmmsg() arguments, reused across frames */
+    QVector<struct mmsghdr> m_headers;
+    QVector<struct iovec> m_vectors;
+    QVector<struct sockaddr_in> m_addresses;
+#endif
+};
+
+#endif
@@ -200,8 +200,19 @@ public:
      *
      * @param output The output universe to write to
      * @param universe The universe data to write
+     * @param dataChanged false if data is the same of the previous call,
+     *        so the plugin can skip the transmission. QLC+ periodically
+     *        sets it to true anyway, to keep devices refreshed
      */
-    virtual void writeUniverse(quint32 universe, quint32 output, const QByteArray& data);
+    virtual void writeUniverse(quint32 universe, quint32 output, const QByteArray& data, bool dataChanged);
+
+    /**
+     * Called once all the universes of a frame have been written with
+     * writeUniverse. Plugins queueing the data of each universe can
+     * transmit the whole frame at once from here.
+     * The default implementation does nothing.
+     */
+    virtual void flushOutputs();
 
     /*************************************************************************
      * Inputs
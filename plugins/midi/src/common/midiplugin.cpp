@@ -179,9 +179,10 @@ QString MidiPlugin::outputInfo(quint32 output)
     return str;
 }
 
-void MidiPlugin::writeUniverse(quint32 universe, quint32 output, const QByteArray &data)
+void MidiPlugin::writeUniverse(quint32 universe, quint32 output, const QByteArray &data, bool dataChanged)
 {
     Q_UNUSED(universe)
+    Q_UNUSED(dataChanged)
 
     MidiOutputDevice* dev = outputDevice(output);
     if (dev != NULL)
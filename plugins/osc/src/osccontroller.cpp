@@ -240,7 +240,6 @@ quint16 OSCController::getHash(QString path)
 void OSCController::sendDmx(const quint32 universe, const QByteArray &dmxData)
 {
     QMutexLocker locker(&m_dataMutex);
-    QByteArray dmxPacket;
     QHostAddress outAddress = QHostAddress::Null;
     quint32 outPort = 7700 + universe;
 
@@ -250,28 +249,61 @@ void OSCController::sendDmx(const quint32 universe, const QByteArray &dmxData)
         outPort = m_universeMap[universe].outputPort;
     }
 
-    for (int i = 0; i < dmxData.length(); i++)
+    QMap<quint32, QByteArray *>::iterator it = m_dmxValuesMap.find(universe);
+    if (it == m_dmxValuesMap.end())
+        it = m_dmxValuesMap.insert(universe, new QByteArray(512, 0));
+    QByteArray *dmxValues = it.value();
+
+    QByteArray dmxMessage;
+    QByteArray bundle;
+    int messages = 0;
+
+    for (int i = 0; i < dmxData.length() && i < dmxValues->length(); i++)
     {
-        if (m_dmxValuesMap.contains(universe) == false)
-            m_dmxValuesMap[universe] = new QByteArray(512, 0);
+        if (dmxData[i] == dmxValues->at(i))
+            continue;
 
-        QByteArray *dmxValues = m_dmxValuesMap[universe];
+        (*dmxValues)[i] = dmxData[i];
+        m_packetizer->setupOSCDmx(dmxMessage, universe, i, dmxData[i]);
 
-        if (dmxData[i] != dmxValues->at(i))
+        if (messages == 0)
+            m_packetizer->setupOSCBundle(bundle);
+
+        // send the current bundle when the message doesn't fit in it
+        if (m_packetizer->addBundleMessage(bundle, dmxMessage) == false)
         {
-            dmxValues->replace(i, 1, (const char *)(dmxData.data() + i), 1);
-            m_packetizer->setupOSCDmx(dmxPacket, universe, i, dmxData[i]);
-            qint64 sent = m_outputSocket->writeDatagram(dmxPacket.data(), dmxPacket.size(),
-                                                     outAddress, outPort);
-            if (sent < 0)
-            {
-                qDebug() << "[OSC] sendDmx failed. Errno: " << m_outputSocket->error();
-                qDebug() << "Errmgs: " << m_outputSocket->errorString();
-            }
-            else
-                m_packetSent++;
+            sendBundle(bundle, messages, outAddress, outPort);
+            m_packetizer->setupOSCBundle(bundle);
+            m_packetizer->addBundleMessage(bundle, dmxMessage);
+            messages = 0;
         }
+        messages++;
     }
+
+    if (messages > 0)
+        sendBundle(bundle, messages, outAddress, outPort);
+}
+
+void OSCController::sendBundle(QByteArray const& bundle, int messages, QHostAddress const& address, quint16 port)
+{
+    const char *data = bundle.constData();
+    qint64 size = bundle.size();
+
+    if (messages == 1)
+    {
+        // skip the bundle header and the message size
+        data += OSC_BUNDLE_HEADER_SIZE + 4;
+        size -= OSC_BUNDLE_HEADER_SIZE + 4;
+    }
+
+    qint64 sent = m_outputSocket->writeDatagram(data, size, address, port);
+    if (sent < 0)
+    {
+        qDebug() << "[OSC] sendDmx failed. Errno: " << m_outputSocket->error();
+        qDebug() << "Errmgs: " << m_outputSocket->errorString();
+    }
+    else
+        m_packetSent++;
 }
 
 void OSCController::sendFeedback(const quint32 universe, quint32 channel, uchar value, const QString &key)
@@ -120,7 +120,8 @@ public:
     /** Get the number of packets received by this controller */
     quint64 getPacketReceivedNumber() const;
 
-    /** Send DMX data to a specific universe */
+    /** Send DMX data to a specific universe. The values changed since the
+     *  previous call are packed in as few OSC bundles as possible */
     void sendDmx(const quint32 universe, const QByteArray& dmxData);
 
     /** Send a feedback using the specified path and value */
@@ -129,6 +130,10 @@ public:
 private:
     QSharedPointer<QUdpSocket> getInputSocket(quint16 port);
 
+    /** Send an OSC bundle containing $messages messages. A bundle
+     *  with a single message is sent as a plain message */
+    void sendBundle(QByteArray const& bundle, int messages, QHostAddress const& address, quint16 port);
+
 protected:
     /** Calculate a 16bit unsigned hash as a unique representation
      *  of a OSC path. If new, the hash is added to the hash map (m_hashMap) */
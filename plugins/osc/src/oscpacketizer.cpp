@@ -56,6 +56,32 @@ void OSCPacketizer::setupOSCDmx(QByteArray &data, quint32 universe, quint32 chan
     data.append(*(((char *)&fVal) + 0));
 }
 
+void OSCPacketizer::setupOSCBundle(QByteArray &data)
+{
+    data.clear();
+    data.append("#bundle");
+    data.append((char)0x00);
+
+    // time tag 1 means 'immediately'
+    data.append(QByteArray(7, 0x00));
+    data.append((char)0x01);
+}
+
+bool OSCPacketizer::addBundleMessage(QByteArray &data, const QByteArray &message)
+{
+    int size = message.size();
+    if (data.size() > OSC_BUNDLE_HEADER_SIZE && data.size() + 4 + size > OSC_BUNDLE_MAX_SIZE)
+        return false;
+
+    data.append((char)(size >> 24));
+    data.append((char)((size >> 16) & 0xFF));
+    data.append((char)((size >> 8) & 0xFF));
+    data.append((char)(size & 0xFF));
+    data.append(message);
+
+    return true;
+}
+
 void OSCPacketizer::setupOSCGeneric(QByteArray &data, QString &path, QString types, QByteArray &values)
 {
     data.clear();
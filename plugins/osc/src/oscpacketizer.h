@@ -26,6 +26,13 @@
 #ifndef OSCPACKETIZER_H
 #define OSCPACKETIZER_H
 
+/** Size of the '#bundle' string and time tag starting an OSC bundle */
+#define OSC_BUNDLE_HEADER_SIZE  16
+
+/** Maximum size of an OSC bundle, to fit in a 1500 bytes
+ *  Ethernet MTU together with the IPv4 and UDP headers */
+#define OSC_BUNDLE_MAX_SIZE     1472
+
 class OSCPacketizer
 {
     /*********************************************************************
@@ -56,6 +63,26 @@ public:
      */
     void setupOSCDmx(QByteArray& data, quint32 universe, quint32 channel, uchar value);
 
+    /**
+     * Prepare an empty OSC bundle, whose messages are to be
+     * executed immediately. Messages are added with addBundleMessage.
+     *
+     * @param data the bundle composed by this function
+     */
+    void setupOSCBundle(QByteArray& data);
+
+    /**
+     * Append a message to an OSC bundle prepared by setupOSCBundle.
+     * A bundle holding messages already is never grown beyond
+     * OSC_BUNDLE_MAX_SIZE: the message is then left out, to be sent
+     * in a new bundle.
+     *
+     * @param data the bundle where to append the message
+     * @param message the OSC message to append
+     * @return false if the message doesn't fit in the bundle
+     */
+    bool addBundleMessage(QByteArray& data, const QByteArray& message);
+
     /**
      * Prepare an generic OSC message using the specified $path.
      * Values are appended to the message as specified by their $types.
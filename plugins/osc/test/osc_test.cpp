@@ -0,0 +1,153 @@
+/*
+  Q Light Controller Plus
+  osc_test.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QTest>
+
+#define private public
+#include "osc_test.h"
+#include "oscpacketizer.h"
+#undef private
+
+/* Size of a DMX message, whatever the channel: the path is padded
+ * to 12 bytes, followed by the ",f" type tags and the float value */
+#define DMX_MESSAGE_SIZE 20
+
+/****************************************************************************
+ * OSC tests
+ ****************************************************************************/
+
+void OSC_Test::setupOSCDmx()
+{
+    OSCPacketizer op;
+    QByteArray data;
+
+    op.setupOSCDmx(data, 0, 5, 255);
+    QCOMPARE(data.size(), DMX_MESSAGE_SIZE);
+    QCOMPARE(data.left(12), QByteArray("/0/dmx/5\0\0\0\0", 12));
+    QCOMPARE(data.mid(12, 4), QByteArray(",f\0\0", 4));
+
+    op.setupOSCDmx(data, 0, 511, 0);
+    QCOMPARE(data.size(), DMX_MESSAGE_SIZE);
+    QCOMPARE(data.left(12), QByteArray("/0/dmx/511\0\0", 12));
+}
+
+void OSC_Test::setupOSCBundle()
+{
+    OSCPacketizer op;
+    QByteArray data("garbage");
+
+    op.setupOSCBundle(data);
+
+    // '#bundle' and the 'immediately' time tag
+    QCOMPARE(data.size(), OSC_BUNDLE_HEADER_SIZE);
+    QCOMPARE(data.left(8), QByteArray("#bundle\0", 8));
+    QCOMPARE(data.mid(8), QByteArray("\0\0\0\0\0\0\0\1", 8));
+}
+
+void OSC_Test::addBundleMessage()
+{
+    OSCPacketizer op;
+    QByteArray bundle;
+    QByteArray message;
+
+    op.setupOSCBundle(bundle);
+
+    op.setupOSCDmx(message, 1, 7, 51);
+    QVERIFY(op.addBundleMessage(bundle, message) == true);
+    op.setupOSCDmx(message, 1, 300, 0);
+    QVERIFY(op.addBundleMessage(bundle, message) == true);
+
+    // each element is prefixed by its big endian size
+    QCOMPARE(bundle.size(), OSC_BUNDLE_HEADER_SIZE + 2 * (4 + DMX_MESSAGE_SIZE));
+    QCOMPARE(bundle.mid(OSC_BUNDLE_HEADER_SIZE, 4), QByteArray("\0\0\0\x14", 4));
+    QCOMPARE(bundle.mid(OSC_BUNDLE_HEADER_SIZE + 4, 12), QByteArray("/1/dmx/7\0\0\0\0", 12));
+    QCOMPARE(bundle.mid(OSC_BUNDLE_HEADER_SIZE + 4 + DMX_MESSAGE_SIZE, 4), QByteArray("\0\0\0\x14", 4));
+    QCOMPARE(bundle.right(DMX_MESSAGE_SIZE), message);
+
+    // the receiver gets the messages back
+    QList<QPair<QString, QByteArray> > messages = op.parsePacket(bundle);
+    QCOMPARE(messages.count(), 2);
+    QCOMPARE(messages.at(0).first, QString("/1/dmx/7"));
+    QCOMPARE(uchar(messages.at(0).second.at(0)), uchar(51));
+    QCOMPARE(messages.at(1).first, QString("/1/dmx/300"));
+    QCOMPARE(uchar(messages.at(1).second.at(0)), uchar(0));
+
+    // a message bigger than the MTU still goes in an empty bundle
+    QByteArray big(OSC_BUNDLE_MAX_SIZE, 'x');
+    QVERIFY(op.addBundleMessage(bundle, big) == false);
+    QCOMPARE(bundle.size(), OSC_BUNDLE_HEADER_SIZE + 2 * (4 + DMX_MESSAGE_SIZE));
+
+    op.setupOSCBundle(bundle);
+    QVERIFY(op.addBundleMessage(bundle, big) == true);
+    QCOMPARE(bundle.size(), OSC_BUNDLE_HEADER_SIZE + 4 + OSC_BUNDLE_MAX_SIZE);
+}
+
+void OSC_Test::bundleSplit()
+{
+    OSCPacketizer op;
+    QByteArray message;
+    QByteArray bundle;
+    QList<QByteArray> bundles;
+    QList<int> counts;
+    int messages = 0;
+
+    // a full universe, split as OSCController::sendDmx does
+    for (int i = 0; i < 512; i++)
+    {
+        op.setupOSCDmx(message, 0, i, 255);
+
+        if (messages == 0)
+            op.setupOSCBundle(bundle);
+
+        if (op.addBundleMessage(bundle, message) == false)
+        {
+            bundles.append(bundle);
+            counts.append(messages);
+            op.setupOSCBundle(bundle);
+            QVERIFY(op.addBundleMessage(bundle, message) == true);
+            messages = 0;
+        }
+        messages++;
+    }
+    bundles.append(bundle);
+    counts.append(messages);
+
+    // (1472 - 16) / (4 + 20) = 60 messages fit in a bundle
+    int perBundle = (OSC_BUNDLE_MAX_SIZE - OSC_BUNDLE_HEADER_SIZE) / (4 + DMX_MESSAGE_SIZE);
+    QCOMPARE(perBundle, 60);
+    QCOMPARE(bundles.count(), 9);
+
+    int channel = 0;
+    for (int b = 0; b < bundles.count(); b++)
+    {
+        QVERIFY(bundles.at(b).size() <= OSC_BUNDLE_MAX_SIZE);
+        QVERIFY(bundles.at(b).startsWith(QByteArray("#bundle\0", 8)));
+        QCOMPARE(counts.at(b), b < bundles.count() - 1 ? perBundle : 512 - 8 * perBundle);
+        QCOMPARE(bundles.at(b).size(), OSC_BUNDLE_HEADER_SIZE + counts.at(b) * (4 + DMX_MESSAGE_SIZE));
+
+        // no message is lost or split across bundles
+        QList<QPair<QString, QByteArray> > parsed = op.parsePacket(bundles.at(b));
+        QCOMPARE(parsed.count(), counts.at(b));
+        for (int m = 0; m < parsed.count(); m++, channel++)
+            QCOMPARE(parsed.at(m).first, QString("/0/dmx/%1").arg(channel));
+    }
+    QCOMPARE(channel, 512);
+}
+
+QTEST_MAIN(OSC_Test)
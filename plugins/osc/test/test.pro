@@ -0,0 +1,18 @@
+include(../../../variables.pri)
+include(../../../coverage.pri)
+
+TEMPLATE = app
+LANGUAGE = C++
+TARGET   = osc_test
+
+QT      += core testlib network
+QT      -= gui
+LIBS    += -L../src -losc
+
+INCLUDEPATH += ../../interfaces
+INCLUDEPATH += ../src
+DEPENDPATH  += ../src
+
+# Test sources
+HEADERS += osc_test.h ../../interfaces/qlcioplugin.h
+SOURCES += osc_test.cpp ../src/oscpacketizer.cpp ../../interfaces/qlcioplugin.cpp
@@ -181,8 +181,10 @@ QString SPIPlugin::outputInfo(quint32 output)
     return str;
 }
 
-void SPIPlugin::writeUniverse(quint32 universe, quint32 output, const QByteArray &data)
+void SPIPlugin::writeUniverse(quint32 universe, quint32 output, const QByteArray &data, bool dataChanged)
 {
+    Q_UNUSED(dataChanged)
+
     if (output != 0 || m_spifd == -1)
         return;
 
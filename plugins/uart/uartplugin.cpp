@@ -127,9 +127,10 @@ QString UARTPlugin::outputInfo(quint32 output)
     return str;
 }
 
-void UARTPlugin::writeUniverse(quint32 universe, quint32 output, const QByteArray &data)
+void UARTPlugin::writeUniverse(quint32 universe, quint32 output, const QByteArray &data, bool dataChanged)
 {
     Q_UNUSED(universe)
+    Q_UNUSED(dataChanged)
 
     if (output < quint32(m_widgets.count()))
         m_widgets.at(output)->writeUniverse(data);
@@ -119,9 +119,10 @@ QString UDMX::outputInfo(quint32 output)
     return str;
 }
 
-void UDMX::writeUniverse(quint32 universe, quint32 output, const QByteArray &data)
+void UDMX::writeUniverse(quint32 universe, quint32 output, const QByteArray &data, bool dataChanged)
 {
     Q_UNUSED(universe)
+    Q_UNUSED(dataChanged)
 
     if (output < quint32(m_devices.size()))
         m_devices.at(output)->outputDMX(data);
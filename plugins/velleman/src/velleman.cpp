@@ -146,9 +146,10 @@ QString Velleman::outputInfo(quint32 output)
     return str;
 }
 
-void Velleman::writeUniverse(quint32 universe, quint32 output, const QByteArray &data)
+void Velleman::writeUniverse(quint32 universe, quint32 output, const QByteArray &data, bool dataChanged)
 {
     Q_UNUSED(universe)
+    Q_UNUSED(dataChanged)
 
     if (output != 0 || m_currentlyOpen == false || data.isEmpty())
         return;
@@ -0,0 +1,79 @@
+/*
+  Q Light Controller Plus
+  bakedshoweditor.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QQmlContext>
+#include <QUrl>
+
+#include "bakedshoweditor.h"
+#include "bakedshow.h"
+#include "doc.h"
+
+BakedShowEditor::BakedShowEditor(QQuickView *view, Doc *doc, QObject *parent)
+    : FunctionEditor(view, doc, parent)
+    , m_bakedShow(NULL)
+{
+    m_view->rootContext()->setContextProperty("bakedShowEditor", this);
+}
+
+void BakedShowEditor::setFunctionID(quint32 ID)
+{
+    m_bakedShow = qobject_cast<BakedShow *>(m_doc->function(ID));
+    FunctionEditor::setFunctionID(ID);
+    if (m_bakedShow != NULL)
+        connect(m_bakedShow, SIGNAL(sourceFileNameChanged()),
+                this, SIGNAL(streamInfoChanged()));
+}
+
+QString BakedShowEditor::sourceFileName() const
+{
+    if (m_bakedShow == NULL)
+        return "";
+
+    return m_bakedShow->sourceFileName();
+}
+
+void BakedShowEditor::setSourceFileName(QString sourceFileName)
+{
+    if (sourceFileName.startsWith("file:"))
+        sourceFileName = QUrl(sourceFileName).toLocalFile();
+
+    if (m_bakedShow == NULL || m_bakedShow->sourceFileName() == sourceFileName)
+        return;
+
+    if (m_bakedShow->isRunning())
+        m_bakedShow->stopAndWait();
+
+    m_bakedShow->setSourceFileName(sourceFileName);
+    m_doc->setModified();
+    emit sourceFileNameChanged(sourceFileName);
+    emit streamInfoChanged();
+}
+
+QVariant BakedShowEditor::streamInfo() const
+{
+    QVariantMap infoMap;
+
+    if (m_bakedShow == NULL)
+        return QVariant();
+
+    infoMap.insert("duration", Function::speedToString(m_bakedShow->totalDuration()));
+    infoMap.insert("universes", m_bakedShow->universesCount());
+
+    return QVariant::fromValue(infoMap);
+}
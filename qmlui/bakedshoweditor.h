@@ -0,0 +1,56 @@
+/*
+  Q Light Controller Plus
+  bakedshoweditor.h
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef BAKEDSHOWEDITOR_H
+#define BAKEDSHOWEDITOR_H
+
+#include "functioneditor.h"
+
+class BakedShow;
+
+class BakedShowEditor : public FunctionEditor
+{
+    Q_OBJECT
+
+    Q_PROPERTY(QString sourceFileName READ sourceFileName WRITE setSourceFileName NOTIFY sourceFileNameChanged)
+    Q_PROPERTY(QVariant streamInfo READ streamInfo NOTIFY streamInfoChanged)
+
+public:
+    BakedShowEditor(QQuickView *view, Doc *doc, QObject *parent = 0);
+
+    /** Set the ID of the BakedShow being edited */
+    void setFunctionID(quint32 ID);
+
+    /** Get/Set the baked stream file name of this BakedShow function */
+    QString sourceFileName() const;
+    void setSourceFileName(QString sourceFileName);
+
+    /** Get the information of the currently loaded baked stream */
+    QVariant streamInfo() const;
+
+signals:
+    void sourceFileNameChanged(QString sourceFileName);
+    void streamInfoChanged();
+
+private:
+    /** Reference of the BakedShow currently being edited */
+    BakedShow *m_bakedShow;
+};
+
+#endif // BAKEDSHOWEDITOR_H
@@ -49,6 +49,7 @@ ContextManager::ContextManager(QQuickView *view, Doc *doc,
     , m_positionPicking(false)
     , m_universeFilter(Universe::invalid())
     , m_editingEnabled(false)
+    , m_lastSnapshotSerial(0)
     , m_dumpChannelMask(0)
 {
     m_view->rootContext()->setContextProperty("contextManager", this);
@@ -90,8 +91,8 @@ ContextManager::ContextManager(QQuickView *view, Doc *doc,
     connect(m_fixtureManager, &FixtureManager::colorChanged, this, &ContextManager::slotColorChanged);
     connect(m_fixtureManager, &FixtureManager::positionTypeValueChanged, this, &ContextManager::slotPositionChanged);
     connect(m_fixtureManager, &FixtureManager::presetChanged, this, &ContextManager::slotPresetChanged);
-    //connect(m_doc->inputOutputMap(), &InputOutputMap::universesWritten, this, &ContextManager::slotUniversesWritten);
-    connect(m_doc->inputOutputMap(), SIGNAL(universesWritten(int,QByteArray)), this, SLOT(slotUniversesWritten(int,QByteArray)));
+    connect(m_doc->inputOutputMap(), &InputOutputMap::universesSnapshotPublished,
+            this, &ContextManager::slotUniversesSnapshotPublished);
     connect(m_functionManager, &FunctionManager::isEditingChanged, this, &ContextManager::slotFunctionEditingChanged);
 }
 
@@ -1264,26 +1265,38 @@ void ContextManager::slotPresetChanged(const QLCChannel *channel, quint8 value)
     }
 }
 
-void ContextManager::slotUniversesWritten(int idx, const QByteArray &ua)
+void ContextManager::slotUniversesSnapshotPublished()
 {
-    for (Fixture *fixture : m_doc->fixtures())
+    UniverseSnapshot snapshot = m_doc->inputOutputMap()->snapshot();
+
+    for (int idx = 0; idx < snapshot.universesCount(); idx++)
     {
-        if (fixture->universe() != (quint32)idx)
+        if (snapshot.changeSerial(idx) <= m_lastSnapshotSerial)
             continue;
 
-        QByteArray prevValues;
-        prevValues.append(fixture->channelValues());
+        const QByteArray ua = snapshot.rawData(idx);
 
-        if (fixture->setChannelValues(ua) == true)
+        for (Fixture *fixture : m_doc->fixtures())
         {
-            if (m_DMXView->isEnabled())
-                m_DMXView->updateFixture(fixture);
-            if (m_2DView->isEnabled())
-                m_2DView->updateFixture(fixture, prevValues);
-            if (m_3DView->isEnabled())
-                m_3DView->updateFixture(fixture, prevValues);
+            if (fixture->universe() != (quint32)idx)
+                continue;
+
+            QByteArray prevValues;
+            prevValues.append(fixture->channelValues());
+
+            if (fixture->setChannelValues(ua) == true)
+            {
+                if (m_DMXView->isEnabled())
+                    m_DMXView->updateFixture(fixture);
+                if (m_2DView->isEnabled())
+                    m_2DView->updateFixture(fixture, prevValues);
+                if (m_3DView->isEnabled())
+                    m_3DView->updateFixture(fixture, prevValues);
+            }
         }
     }
+
+    m_lastSnapshotSerial = snapshot.serial();
 }
 
 void ContextManager::slotFunctionEditingChanged(bool status)
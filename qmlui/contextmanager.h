@@ -225,9 +225,9 @@ protected slots:
     void slotPositionChanged(int type, int degrees);
     void slotPresetChanged(const QLCChannel *channel, quint8 value);
 
-    /** Invoked by the QLC+ engine to inform the UI that the Universe at $idx
-     *  has changed */
-    void slotUniversesWritten(int idx, const QByteArray& ua);
+    /** Invoked by the QLC+ engine to inform the UI that a snapshot
+     *  with changed Universes has been published */
+    void slotUniversesSnapshotPublished();
 
     /** Invoked when Function editing begins or ends in the Function Manager.
      *  Context Manager doesn't care much about Functions, it just needs
@@ -247,6 +247,9 @@ private:
     /** A flag indicating if a Function is currently being edited */
     bool m_editingEnabled;
 
+    /** Serial of the last universe snapshot used to update the fixtures */
+    quint64 m_lastSnapshotSerial;
+
     /** A multihash containing the selected fixtures' capabilities by channel type */
     /** The hash is: int (channel type) , SceneValue (Fixture ID and channel) */
     QMultiHash<int, SceneValue> m_channelsMap;
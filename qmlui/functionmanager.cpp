@@ -22,6 +22,7 @@
 #include <QDebug>
 
 #include "audioplugincache.h"
+#include "bakedshoweditor.h"
 #include "genericdmxsource.h"
 #include "collectioneditor.h"
 #include "functionmanager.h"
@@ -42,6 +43,7 @@
 #include "sequence.h"
 #include "chaser.h"
 #include "scene.h"
+#include "bakedshow.h"
 #include "audio.h"
 #include "video.h"
 #include "show.h"
@@ -420,6 +422,7 @@ QString FunctionManager::functionIcon(int type)
         case Function::ScriptType: return "qrc:/script.svg";
         case Function::RGBMatrixType: return "qrc:/rgbmatrix.svg";
         case Function::ShowType: return "qrc:/showmanager.svg";
+        case Function::BakedShowType: return "qrc:/bakedshow.svg";
         case Function::AudioType: return "qrc:/audio.svg";
         case Function::VideoType: return "qrc:/video.svg";
     }
@@ -519,6 +522,7 @@ QString FunctionManager::getEditorResource(int funcID)
         case Function::CollectionType: return "qrc:/CollectionEditor.qml";
         case Function::RGBMatrixType: return "qrc:/RGBMatrixEditor.qml";
         case Function::ShowType: return "qrc:/ShowManager.qml";
+        case Function::BakedShowType: return "qrc:/BakedShowEditor.qml";
         case Function::ScriptType: return "qrc:/ScriptEditor.qml";
         case Function::AudioType: return "qrc:/AudioEditor.qml";
         case Function::VideoType: return "qrc:/VideoEditor.qml";
@@ -611,6 +615,11 @@ void FunctionManager::setEditorFunction(quint32 fID, bool requestUI, bool back)
             m_currentEditor = new VideoEditor(m_view, m_doc, this);
         }
         break;
+        case Function::BakedShowType:
+        {
+            m_currentEditor = new BakedShowEditor(m_view, m_doc, this);
+        }
+        break;
         case Function::ShowType:
             // a Show is edited by the Show Manager
         break;
@@ -1190,7 +1199,8 @@ void FunctionManager::addFunctionTreeItem(Function *func)
         case Function::CollectionType: m_collectionCount++; break;
         case Function::RGBMatrixType: m_rgbMatrixCount++; break;
         case Function::ScriptType: m_scriptCount++; break;
-        case Function::ShowType: m_showCount++; break;
+        case Function::ShowType:
+        case Function::BakedShowType: m_showCount++; break;
         case Function::AudioType: m_audioCount++; break;
         case Function::VideoType: m_videoCount++; break;
         default:
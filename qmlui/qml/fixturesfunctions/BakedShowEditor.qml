@@ -0,0 +1,133 @@
+/*
+  Q Light Controller Plus
+  BakedShowEditor.qml
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+import QtQuick 2.0
+import QtQuick.Layouts 1.1
+import QtQuick.Dialogs 1.1
+import QtQuick.Controls 2.1
+
+import org.qlcplus.classes 1.0
+import "."
+
+Rectangle
+{
+    anchors.fill: parent
+    color: "transparent"
+
+    property int functionID: -1
+    property var streamInfo: bakedShowEditor ? bakedShowEditor.streamInfo : null
+
+    signal requestView(int ID, string qmlSrc)
+
+    EditorTopBar
+    {
+        id: topBar
+        text: bakedShowEditor.functionName
+        onTextChanged: bakedShowEditor.functionName = text
+
+        onBackClicked:
+        {
+            var prevID = bakedShowEditor.previousID
+            functionManager.setEditorFunction(prevID, false, true)
+            requestView(prevID, functionManager.getEditorResource(prevID))
+        }
+    }
+
+    FileDialog
+    {
+        id: openStreamDialog
+        visible: false
+        nameFilters: [ qsTr("Baked shows") + " (*.qxb)", qsTr("All files") + " (*)" ]
+
+        onAccepted: bakedShowEditor.sourceFileName = openStreamDialog.fileUrl
+    }
+
+    onWidthChanged: bsGrid.width = width
+
+    GridLayout
+    {
+        id: bsGrid
+        columns: 2
+        columnSpacing: 5
+        rowSpacing: 10
+        y: topBar.height
+
+        // row 1
+        RobotoText
+        {
+            height: selFileBtn.height
+            label: qsTr("File name")
+        }
+        Rectangle
+        {
+            Layout.fillWidth: true
+            height: selFileBtn.height
+            color: "transparent"
+
+            RobotoText
+            {
+                width: selFileBtn.x - 5
+                fontSize: UISettings.textSizeDefault * 0.8
+                labelColor: UISettings.fgLight
+                wrapText: true
+                label: bakedShowEditor.sourceFileName
+            }
+            IconButton
+            {
+                id: selFileBtn
+                x: parent.width - width - 3
+                RobotoText { anchors.centerIn: parent; label: "..." }
+
+                onClicked:
+                {
+                    openStreamDialog.visible = true
+                    openStreamDialog.open()
+                }
+            }
+        }
+
+        // row 2
+        RobotoText
+        {
+            label: qsTr("Duration")
+            height: UISettings.listItemHeight
+        }
+        RobotoText
+        {
+            height: UISettings.listItemHeight
+            Layout.fillWidth: true
+            label: streamInfo ? streamInfo.duration : ""
+            labelColor: UISettings.fgLight
+        }
+
+        // row 3
+        RobotoText
+        {
+            label: qsTr("Universes")
+            height: UISettings.listItemHeight
+        }
+        RobotoText
+        {
+            height: UISettings.listItemHeight
+            Layout.fillWidth: true
+            label: streamInfo ? streamInfo.universes : ""
+            labelColor: UISettings.fgLight
+        }
+    }
+}
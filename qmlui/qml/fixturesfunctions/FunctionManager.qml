@@ -171,7 +171,7 @@ Rectangle
                 checked: functionManager.functionsFilter & QLCFunction.ShowType
                 tooltip: qsTr("Shows")
                 counter: functionManager.showCount
-                onCheckedChanged: setFunctionFilter(QLCFunction.ShowType, checked)
+                onCheckedChanged: setFunctionFilter(QLCFunction.ShowType | QLCFunction.BakedShowType, checked)
             }
             IconButton
             {
@@ -18,6 +18,8 @@
 */
 
 import QtQuick 2.0
+import QtQuick.Layouts 1.1
+import QtQuick.Controls 2.1
 
 import org.qlcplus.classes 1.0
 import "."
@@ -257,6 +259,73 @@ Rectangle
             onToggled: if (universe) universe.passthrough = checked
         }
 
+        IconButton
+        {
+            id: socButton
+            anchors.top: parent.top
+            anchors.right: parent.right
+            checkedColor: UISettings.selection
+            width: UISettings.iconSizeMedium * 0.8
+            height: UISettings.iconSizeMedium * 0.8
+            faSource: FontAwesome.fa_filter
+            checked: universe ? universe.sendOnChange : false
+            tooltip: qsTr("Send on change settings")
+            onClicked: socPopup.opened ? socPopup.close() : socPopup.open()
+        }
+
+        Popup
+        {
+            id: socPopup
+            x: socButton.x
+            y: socButton.y + socButton.height
+            padding: 5
+
+            background:
+                Rectangle
+                {
+                    color: UISettings.bgStrong
+                    border.color: UISettings.bgStronger
+                }
+
+            GridLayout
+            {
+                columns: 2
+                columnSpacing: 5
+
+                CustomCheckBox
+                {
+                    id: socCheck
+                    implicitHeight: UISettings.listItemHeight
+                    implicitWidth: height
+                    checked: universe ? universe.sendOnChange : false
+                    onCheckedChanged: if (universe) universe.sendOnChange = checked
+                }
+                RobotoText
+                {
+                    height: UISettings.listItemHeight
+                    label: qsTr("Send only the changed frames")
+                }
+
+                RobotoText
+                {
+                    height: UISettings.listItemHeight
+                    label: qsTr("Keep alive")
+                }
+                CustomSpinBox
+                {
+                    enabled: socCheck.checked
+                    Layout.fillWidth: true
+                    height: UISettings.listItemHeight
+                    from: 0
+                    to: 60000
+                    stepSize: 100
+                    suffix: "ms"
+                    value: universe ? universe.keepAliveInterval : 0
+                    onValueChanged: if (universe) universe.keepAliveInterval = value
+                }
+            }
+        }
+
         IconButton
         {
             id: fbButton
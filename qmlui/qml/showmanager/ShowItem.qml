@@ -99,6 +99,20 @@ Item
             var lastTime = 0
             var xPos = 0
 
+            if (previewData[0] === ShowManager.AudioData)
+            {
+                // the peaks of the waveform, one per pixel
+                var peaks = showManager.waveformPeaks(funcRef, sfRef.duration, Math.floor(width))
+                var center = height / 2
+                for (var p = 0; p + 1 < peaks.length; p += 2)
+                {
+                    context.moveTo(p / 2 + 0.5, center - peaks[p + 1] * center)
+                    context.lineTo(p / 2 + 0.5, center - peaks[p] * center + 1)
+                }
+                context.stroke()
+                return
+            }
+
             if (previewData[0] === ShowManager.RepeatingDuration)
             {
                 var loopCount = funcRef.totalDuration ? Math.floor(sfRef.duration / funcRef.totalDuration) : 0
@@ -143,6 +157,16 @@ Item
         }
     }
 
+    Connections
+    {
+        target: showManager
+        onAudioWaveformReady:
+        {
+            if (funcRef && functionID === funcRef.id)
+                prCanvas.requestPaint()
+        }
+    }
+
     /* Body mouse area (covers the whole item) */
     MouseArea
     {
@@ -19,6 +19,7 @@
 
 import QtQuick 2.0
 import QtQuick.Layouts 1.1
+import QtQuick.Dialogs 1.1
 import QtQuick.Controls 2.1
 
 import org.qlcplus.classes 1.0
@@ -226,6 +227,45 @@ Rectangle
                 onClicked: showManager.pasteFromClipboard()
             }
 
+            IconButton
+            {
+                id: bakeBtn
+                width: parent.height - 6
+                height: width
+                imgSource: "qrc:/bakedshow.svg"
+                tooltip: showManager.bakeProgress < 0 ? qsTr("Bake the show into a baked show function") :
+                                                        qsTr("Cancel the show baking")
+                enabled: showID !== -1
+                onClicked:
+                {
+                    if (showManager.bakeProgress < 0)
+                        bakeDialog.open()
+                    else
+                        showManager.cancelBake()
+                }
+
+                FileDialog
+                {
+                    id: bakeDialog
+                    visible: false
+                    title: qsTr("Bake the show as...")
+                    selectExisting: false
+                    nameFilters: [ qsTr("Baked shows") + " (*.qxb)", qsTr("All files") + " (*)" ]
+
+                    onAccepted: showManager.bakeShow(fileUrl)
+                }
+            }
+
+            ProgressBar
+            {
+                id: bakeProgress
+                Layout.preferredWidth: UISettings.bigItemHeight * 2
+                visible: showManager.bakeProgress >= 0
+                from: 0
+                to: 100
+                value: showManager.bakeProgress
+            }
+
             RobotoText
             {
                 id: timeBox
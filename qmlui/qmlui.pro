@@ -28,6 +28,7 @@ win32:RC_FILE = qmlui.rc
 HEADERS += \
     app.h \
     audioeditor.h \
+    bakedshoweditor.h \
     chasereditor.h \
     collectioneditor.h \
     colorfilters.h \
@@ -59,6 +60,7 @@ HEADERS += \
 SOURCES += main.cpp \
     app.cpp \
     audioeditor.cpp \
+    bakedshoweditor.cpp \
     chasereditor.cpp \
     collectioneditor.cpp \
     colorfilters.cpp \
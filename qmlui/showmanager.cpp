@@ -17,7 +17,11 @@
   limitations under the License.
 */
 
+#include "audiowaveform.h"
 #include "showmanager.h"
+#include "bakedstream.h"
+#include "bakedshow.h"
+#include "audio.h"
 #include "sequence.h"
 #include "tardis.h"
 #include "chaser.h"
@@ -34,6 +38,7 @@ ShowManager::ShowManager(QQuickView *view, Doc *doc, QObject *parent)
     , m_gridEnabled(false)
     , m_currentTime(0)
     , m_selectedTrack(-1)
+    , m_baker(NULL)
     , m_itemsColor(Qt::gray)
 {
     qmlRegisterType<Track>("org.qlcplus.classes", 1, 0, "Track");
@@ -425,6 +430,11 @@ void ShowManager::setCurrentTime(int currentTime)
         return;
 
     m_currentTime = currentTime;
+
+    // a running show continues from the new cursor position
+    if (m_currentShow != NULL && m_currentShow->isRunning())
+        m_currentShow->seek(currentTime);
+
     emit currentTimeChanged(currentTime);
 }
 
@@ -449,6 +459,79 @@ void ShowManager::stopShow()
     emit currentTimeChanged(m_currentTime);
 }
 
+bool ShowManager::bakeShow(QString fileUrl)
+{
+    if (m_currentShow == NULL || m_baker != NULL)
+        return false;
+
+    QString fileName = fileUrl;
+    if (fileName.startsWith("file:"))
+        fileName = QUrl(fileUrl).toLocalFile();
+    if (fileName.endsWith(KExtBakedStream) == false)
+        fileName += KExtBakedStream;
+
+    m_bakedShowName = tr("%1 (Baked)").arg(m_currentShow->name());
+    m_baker = new BakedShowBaker(m_doc, m_currentShow->id(), fileName,
+                                 m_currentShow->totalDuration(), this);
+    connect(m_baker, SIGNAL(progressChanged(int)), this, SIGNAL(bakeProgressChanged(int)));
+    connect(m_baker, SIGNAL(finished()), this, SLOT(slotBakeFinished()));
+    m_baker->start();
+
+    emit bakeProgressChanged(0);
+
+    return true;
+}
+
+void ShowManager::cancelBake()
+{
+    if (m_baker != NULL)
+        m_baker->cancel();
+}
+
+int ShowManager::bakeProgress() const
+{
+    if (m_baker == NULL)
+        return -1;
+
+    return m_baker->progress();
+}
+
+void ShowManager::slotBakeFinished()
+{
+    BakedShowBaker *baker = m_baker;
+    if (baker == NULL)
+        return;
+
+    m_baker = NULL;
+    baker->deleteLater();
+    emit bakeProgressChanged(-1);
+
+    if (baker->isBaked() == false)
+    {
+        qWarning() << "[ShowManager] Unable to bake show into" << baker->fileName();
+        return;
+    }
+
+    BakedShow *bakedShow = new BakedShow(m_doc);
+    if (bakedShow->setSourceFileName(baker->fileName()) == false)
+    {
+        delete bakedShow;
+        return;
+    }
+
+    // setting the source file renames the function after the file
+    bakedShow->setName(m_bakedShowName);
+
+    if (m_doc->addFunction(bakedShow) == false)
+    {
+        delete bakedShow;
+        return;
+    }
+
+    Tardis::instance()->enqueueAction(Tardis::FunctionCreate, bakedShow->id(), QVariant(),
+                                      Tardis::instance()->actionToByteArray(Tardis::FunctionCreate, bakedShow->id()));
+}
+
 bool ShowManager::isPlaying() const
 {
     if (m_currentShow != NULL && m_currentShow->isRunning())
@@ -631,6 +714,11 @@ QVariantList ShowManager::previewData(Function *f) const
         }
         break;
 
+        case Function::AudioType:
+            data.append(AudioData);
+            data.append(f->totalDuration());
+        break;
+
         /* All the other Function types */
         default:
             data.append(RepeatingDuration);
@@ -641,6 +729,38 @@ QVariantList ShowManager::previewData(Function *f) const
     return data;
 }
 
+QVariantList ShowManager::waveformPeaks(Function *f, int duration, int count)
+{
+    QVariantList data;
+    Audio *audio = qobject_cast<Audio *>(f);
+    if (audio == NULL || duration <= 0 || count <= 0)
+        return data;
+
+    connect(audio, SIGNAL(waveformReady()), this, SLOT(slotAudioWaveformReady()),
+            Qt::UniqueConnection);
+
+    AudioWaveform *waveform = audio->waveform();
+    QVector<WaveformPeak> peaks;
+
+    if (waveform == NULL || waveform->peaks(-1, 0, duration, count, peaks) == false)
+        return data;
+
+    foreach (WaveformPeak peak, peaks)
+    {
+        data.append(peak.m_min / 128.0);
+        data.append(peak.m_max / 128.0);
+    }
+
+    return data;
+}
+
+void ShowManager::slotAudioWaveformReady()
+{
+    Audio *audio = qobject_cast<Audio *>(sender());
+    if (audio != NULL)
+        emit audioWaveformReady(audio->id());
+}
+
 void ShowManager::copyToClipboard()
 {
     m_clipboard.clear();
@@ -30,6 +30,7 @@ class Show;
 class Track;
 class Function;
 class ShowFunction;
+class BakedShowBaker;
 
 typedef struct
 {
@@ -51,6 +52,7 @@ class ShowManager : public PreviewContext
     Q_PROPERTY(bool gridEnabled READ gridEnabled WRITE setGridEnabled NOTIFY gridEnabledChanged)
     Q_PROPERTY(int currentTime READ currentTime WRITE setCurrentTime NOTIFY currentTimeChanged)
     Q_PROPERTY(bool isPlaying READ isPlaying NOTIFY isPlayingChanged)
+    Q_PROPERTY(int bakeProgress READ bakeProgress NOTIFY bakeProgressChanged)
     Q_PROPERTY(int showDuration READ showDuration NOTIFY showDurationChanged)
     Q_PROPERTY(QQmlListProperty<Track> tracks READ tracks NOTIFY tracksChanged)
     Q_PROPERTY(int selectedTrack READ selectedTrack WRITE setSelectedTrack NOTIFY selectedTrackChanged)
@@ -117,6 +119,17 @@ public:
     /** Pause or rewind the Show playback */
     Q_INVOKABLE void stopShow();
 
+    /** Render the current Show into $fileUrl on a worker thread and add
+     *  a BakedShow function playing it when done.
+     *  Returns false if the baking cannot be started */
+    Q_INVOKABLE bool bakeShow(QString fileUrl);
+
+    /** Stop the Show baking in progress, if any */
+    Q_INVOKABLE void cancelBake();
+
+    /** Get the progress in percent of the Show baking, -1 if not baking */
+    int bakeProgress() const;
+
     /** Flag that indicates if the Show is currently being played */
     bool isPlaying() const;
 
@@ -128,6 +141,7 @@ signals:
     void gridEnabledChanged(bool gridEnabled);
     void currentTimeChanged(int currentTime);
     void isPlayingChanged(bool playing);
+    void bakeProgressChanged(int bakeProgress);
     void showDurationChanged(int showDuration);
     void tracksChanged();
     void selectedTrackChanged(int selectedTrack);
@@ -159,6 +173,12 @@ private:
     /** The index of the currently selected track */
     int m_selectedTrack;
 
+    /** The Show baking in progress, NULL if not baking */
+    BakedShowBaker *m_baker;
+
+    /** The name of the BakedShow function created by m_baker */
+    QString m_bakedShowName;
+
     /*********************************************************************
       * Show Items
       ********************************************************************/
@@ -227,11 +247,21 @@ public:
      */
     Q_INVOKABLE QVariantList previewData(Function *f) const;
 
+    /**
+     * Returns the waveform of the Audio Function $f from 0 to $duration
+     * milliseconds, summarized in $count couples of minimum and maximum
+     * values, from -1.0 to 1.0. If the waveform is not available yet,
+     * an empty list is returned and audioWaveformReady is emitted later
+     */
+    Q_INVOKABLE QVariantList waveformPeaks(Function *f, int duration, int count);
+
     Q_INVOKABLE void copyToClipboard();
     Q_INVOKABLE void pasteFromClipboard();
 
 protected slots:
     void slotTimeChanged(quint32 msec_time);
+    void slotAudioWaveformReady();
+    void slotBakeFinished();
 
 private:
     /** Check items overlapping for the given track, ShowFunction,
@@ -243,6 +273,7 @@ private:
 signals:
     void itemsColorChanged(QColor itemsColor);
     void selectedItemsCountChanged(int count);
+    void audioWaveformReady(quint32 functionID);
 
 private:
     /** The background color for Show Items */
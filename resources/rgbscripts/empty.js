@@ -28,6 +28,9 @@ var testAlgo;
     algo.name = "Script name";
     algo.author = "Your Name";
     algo.properties = new Array();
+    // Uncomment if rgbMap() depends only on its arguments and on the
+    // properties, so that the generated maps can be cached
+    //algo.cacheable = true;
 
     /**
       * The actual "algorithm" for this RGB script. Produces a map of
@@ -35,7 +38,8 @@ var testAlgo;
       *
       * @param step The step number that is requested (0 to (algo.rgbMapStepCount - 1))
       * @param rgb Tells the color requested by user in the UI.
-      * @return A two-dimensional array[height][width].
+      * @return A two-dimensional array[height][width], or a Uint32Array
+      *         of width * height values, row by row (faster on large maps).
       */
     algo.rgbMap = function(width, height, rgb, step)
     {
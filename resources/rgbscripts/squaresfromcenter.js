@@ -27,6 +27,7 @@ var testAlgo;
         algo.apiVersion = 2;
         algo.name = "Squares From Center";
         algo.author = "David Garyga";
+        algo.cacheable = true;
         algo.acceptColors = 2;
         algo.properties = new Array();
         algo.fillSquares = 0;
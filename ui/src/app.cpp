@@ -39,8 +39,10 @@
 #include "virtualconsole.h"
 #include "fixturemanager.h"
 #include "dmxdumpfactory.h"
+#include "dmxrecorder.h"
 #include "showmanager.h"
 #include "mastertimer.h"
+#include "tickprofilerdialog.h"
 #include "addresstool.h"
 #include "simpledesk.h"
 #include "docbrowser.h"
@@ -97,6 +99,7 @@ App::App()
     , m_noGui(false)
     , m_progressDialog(NULL)
     , m_doc(NULL)
+    , m_lastSnapshotSerial(0)
 
     , m_fileNewAction(NULL)
     , m_fileOpenAction(NULL)
@@ -106,10 +109,12 @@ App::App()
     , m_modeToggleAction(NULL)
     , m_controlMonitorAction(NULL)
     , m_addressToolAction(NULL)
+    , m_tickProfilerAction(NULL)
     , m_controlFullScreenAction(NULL)
     , m_controlBlackoutAction(NULL)
     , m_controlPanicAction(NULL)
     , m_dumpDmxAction(NULL)
+    , m_recordDmxAction(NULL)
     , m_liveEditAction(NULL)
     , m_liveEditVirtualConsoleAction(NULL)
 
@@ -122,6 +127,7 @@ App::App()
     , m_toolbar(NULL)
 
     , m_dumpProperties(NULL)
+    , m_dmxRecorder(NULL)
 #if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
     , m_videoProvider(NULL)
 #endif
@@ -165,6 +171,10 @@ App::~App()
     if (m_dumpProperties != NULL)
         delete m_dumpProperties;
 
+    // the recorder must be stopped before the Doc goes away
+    if (m_dmxRecorder != NULL)
+        delete m_dmxRecorder;
+
 #if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
     if (m_videoProvider != NULL)
         delete m_videoProvider;
@@ -298,8 +308,8 @@ void App::init()
     connect(m_doc->inputOutputMap(), SIGNAL(blackoutChanged(bool)), this, SLOT(slotBlackoutChanged(bool)));
 
     // Listen to DMX value changes and update each Fixture values array
-    connect(m_doc->inputOutputMap(), SIGNAL(universesWritten(int, const QByteArray&)),
-            this, SLOT(slotUniversesWritten(int, const QByteArray&)));
+    connect(m_doc->inputOutputMap(), SIGNAL(universesSnapshotPublished()),
+            this, SLOT(slotUniversesSnapshotPublished()));
 
     // Enable/Disable panic button
     connect(m_doc->masterTimer(), SIGNAL(functionListChanged()), this, SLOT(slotRunningFunctionsChanged()));
@@ -524,15 +534,29 @@ void App::slotDocModified(bool state)
         setWindowTitle(caption);
 }
 
-void App::slotUniversesWritten(int idx, const QByteArray &ua)
+void App::slotUniversesSnapshotPublished()
 {
-    foreach(Fixture *fixture, m_doc->fixtures())
+    UniverseSnapshot snapshot = m_doc->inputOutputMap()->snapshot();
+
+    // several snapshots might have been published since the last call,
+    // so look for the universes changed since the last one processed
+    for (int idx = 0; idx < snapshot.universesCount(); idx++)
     {
-        if (fixture->universe() != (quint32)idx)
+        if (snapshot.changeSerial(idx) <= m_lastSnapshotSerial)
             continue;
 
-        fixture->setChannelValues(ua);
+        const QByteArray ua = snapshot.rawData(idx);
+
+        foreach(Fixture *fixture, m_doc->fixtures())
+        {
+            if (fixture->universe() != (quint32)idx)
+                continue;
+
+            fixture->setChannelValues(ua);
+        }
     }
+
+    m_lastSnapshotSerial = snapshot.serial();
 }
 
 /*****************************************************************************
@@ -672,6 +696,9 @@ void App::initActions()
     m_addressToolAction = new QAction(QIcon(":/diptool.png"), tr("Address Tool"), this);
     connect(m_addressToolAction, SIGNAL(triggered()), this, SLOT(slotAddressTool()));
 
+    m_tickProfilerAction = new QAction(QIcon(":/speed.png"), tr("Engine profiler"), this);
+    connect(m_tickProfilerAction, SIGNAL(triggered()), this, SLOT(slotTickProfiler()));
+
     m_controlBlackoutAction = new QAction(QIcon(":/blackout.png"), tr("Toggle &Blackout"), this);
     m_controlBlackoutAction->setCheckable(true);
     connect(m_controlBlackoutAction, SIGNAL(triggered(bool)), this, SLOT(slotControlBlackout()));
@@ -690,6 +717,10 @@ void App::initActions()
     m_dumpDmxAction->setShortcut(QKeySequence(tr("CTRL+D", "Control|Dump DMX")));
     connect(m_dumpDmxAction, SIGNAL(triggered()), this, SLOT(slotDumpDmxIntoFunction()));
 
+    m_recordDmxAction = new QAction(QIcon(":/record.png"), tr("Record the DMX output to a file"), this);
+    m_recordDmxAction->setCheckable(true);
+    connect(m_recordDmxAction, SIGNAL(triggered(bool)), this, SLOT(slotRecordDmx(bool)));
+
     m_controlPanicAction = new QAction(QIcon(":/panic.png"), tr("Stop ALL functions!"), this);
     m_controlPanicAction->setShortcut(QKeySequence("CTRL+SHIFT+ESC"));
     connect(m_controlPanicAction, SIGNAL(triggered(bool)), this, SLOT(slotControlPanic()));
@@ -753,6 +784,7 @@ void App::initToolBar()
     m_toolbar->addSeparator();
     m_toolbar->addAction(m_controlMonitorAction);
     m_toolbar->addAction(m_addressToolAction);
+    m_toolbar->addAction(m_tickProfilerAction);
     m_toolbar->addSeparator();
     m_toolbar->addAction(m_controlFullScreenAction);
     m_toolbar->addAction(m_helpIndexAction);
@@ -765,6 +797,7 @@ void App::initToolBar()
     widget->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Preferred);
     m_toolbar->addWidget(widget);
     m_toolbar->addAction(m_dumpDmxAction);
+    m_toolbar->addAction(m_recordDmxAction);
     m_toolbar->addAction(m_liveEditAction);
     m_toolbar->addAction(m_liveEditVirtualConsoleAction);
     m_toolbar->addSeparator();
@@ -1088,6 +1121,12 @@ void App::slotAddressTool()
     at.exec();
 }
 
+void App::slotTickProfiler()
+{
+    TickProfilerDialog tpd(m_doc, this);
+    tpd.exec();
+}
+
 void App::slotControlBlackout()
 {
     m_doc->inputOutputMap()->setBlackout(!m_doc->inputOutputMap()->blackout());
@@ -1126,6 +1165,56 @@ void App::slotDumpDmxIntoFunction()
         return;
 }
 
+void App::slotRecordDmx(bool record)
+{
+    if (record == false)
+    {
+        if (m_dmxRecorder != NULL)
+            m_dmxRecorder->stopRecording();
+        return;
+    }
+
+    /* Create a file save dialog */
+    QFileDialog dialog(this);
+    dialog.setWindowTitle(tr("Record DMX"));
+    dialog.setAcceptMode(QFileDialog::AcceptSave);
+    if (m_doc->getWorkspacePath().isEmpty() == false)
+        dialog.setDirectory(m_doc->getWorkspacePath());
+    dialog.selectFile(QDateTime::currentDateTime().toString("yyyyMMdd-hhmmss") + KExtDMXRecording);
+
+    /* Append file filters to the dialog */
+    QStringList filters;
+    filters << tr("DMX Recordings (*%1)").arg(KExtDMXRecording);
+#if defined(WIN32) || defined(Q_OS_WIN)
+    filters << tr("All Files (*.*)");
+#else
+    filters << tr("All Files (*)");
+#endif
+    dialog.setNameFilters(filters);
+
+    QString fn;
+    if (dialog.exec() == QDialog::Accepted)
+        fn = dialog.selectedFiles().first();
+
+    if (fn.isEmpty() == true)
+    {
+        m_recordDmxAction->setChecked(false);
+        return;
+    }
+
+    if (fn.endsWith(KExtDMXRecording) == false)
+        fn += KExtDMXRecording;
+
+    if (m_dmxRecorder == NULL)
+        m_dmxRecorder = new DMXRecorder(m_doc->inputOutputMap());
+
+    if (m_dmxRecorder->startRecording(fn, true) == false)
+    {
+        QMessageBox::warning(this, tr("Record DMX"), tr("Unable to record to %1").arg(fn));
+        m_recordDmxAction->setChecked(false);
+    }
+}
+
 void App::slotFunctionLiveEdit()
 {
     FunctionSelection fs(this, m_doc);
@@ -35,6 +35,7 @@ class QMessageBox;
 class QToolButton;
 class QFileDialog;
 class QTabWidget;
+class DMXRecorder;
 class WebAccess;
 class QToolBar;
 class QPixmap;
@@ -126,7 +127,7 @@ public:
 
 private slots:
     void slotDocModified(bool state);
-    void slotUniversesWritten(int idx, const QByteArray& ua);
+    void slotUniversesSnapshotPublished();
 
 private:
     void initDoc();
@@ -134,6 +135,9 @@ private:
 private:
     Doc* m_doc;
 
+    /** Serial of the last universe snapshot used to update the fixtures */
+    quint64 m_lastSnapshotSerial;
+
     /*********************************************************************
      * Main operating mode
      *********************************************************************/
@@ -164,6 +168,7 @@ public slots:
 
     void slotControlMonitor();
     void slotAddressTool();
+    void slotTickProfiler();
     void slotControlFullScreen();
     void slotControlFullScreen(bool usingGeometry);
     void slotControlBlackout();
@@ -172,6 +177,7 @@ public slots:
     void slotFadeAndStopAll();
     void slotRunningFunctionsChanged();
     void slotDumpDmxIntoFunction();
+    void slotRecordDmx(bool record);
     void slotFunctionLiveEdit();
     void slotLiveEditVirtualConsole();
     void slotDetachContext(int index);
@@ -191,10 +197,12 @@ private:
     QAction* m_modeToggleAction;
     QAction* m_controlMonitorAction;
     QAction* m_addressToolAction;
+    QAction* m_tickProfilerAction;
     QAction* m_controlFullScreenAction;
     QAction* m_controlBlackoutAction;
     QAction* m_controlPanicAction;
     QAction* m_dumpDmxAction;
+    QAction* m_recordDmxAction;
     QAction* m_liveEditAction;
     QAction* m_liveEditVirtualConsoleAction;
 
@@ -212,6 +220,7 @@ private:
      *********************************************************************/
 private:
     DmxDumpFactoryProperties *m_dumpProperties;
+    DMXRecorder *m_dmxRecorder;
 #if QT_VERSION >= 0x050000
     VideoProvider *m_videoProvider;
 #endif
@@ -0,0 +1,135 @@
+/*
+  Q Light Controller Plus
+  bakedshoweditor.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QFileDialog>
+#include <QLineEdit>
+#include <QLabel>
+#include <QDebug>
+#include <QUrl>
+
+#include "bakedshoweditor.h"
+#include "bakedstream.h"
+#include "bakedshow.h"
+#include "doc.h"
+
+BakedShowEditor::BakedShowEditor(QWidget* parent, BakedShow *show, Doc* doc)
+    : QWidget(parent)
+    , m_doc(doc)
+    , m_show(show)
+{
+    Q_ASSERT(doc != NULL);
+    Q_ASSERT(show != NULL);
+
+    setupUi(this);
+
+    m_nameEdit->setText(m_show->name());
+    m_nameEdit->setSelection(0, m_nameEdit->text().length());
+
+    connect(m_nameEdit, SIGNAL(textEdited(const QString&)),
+            this, SLOT(slotNameEdited(const QString&)));
+    connect(m_fileButton, SIGNAL(clicked()),
+            this, SLOT(slotSourceFileClicked()));
+    connect(m_previewButton, SIGNAL(toggled(bool)),
+            this, SLOT(slotPreviewToggled(bool)));
+
+    updateStreamInfo();
+
+    // Set focus to the editor
+    m_nameEdit->setFocus();
+}
+
+BakedShowEditor::~BakedShowEditor()
+{
+    m_show->stop(FunctionParent::master());
+}
+
+void BakedShowEditor::updateStreamInfo()
+{
+    m_filenameLabel->setText(m_show->sourceFileName());
+    m_durationLabel->setText(Function::speedToString(m_show->totalDuration()));
+    m_universesLabel->setText(QString::number(m_show->universesCount()));
+}
+
+void BakedShowEditor::slotNameEdited(const QString& text)
+{
+    m_show->setName(text);
+    m_doc->setModified();
+}
+
+void BakedShowEditor::slotSourceFileClicked()
+{
+    QString fn;
+
+    /* Create a file open dialog */
+    QFileDialog dialog(this);
+    dialog.setWindowTitle(tr("Open Baked Show File"));
+    dialog.setAcceptMode(QFileDialog::AcceptOpen);
+    if (m_doc->getWorkspacePath().isEmpty() == false)
+        dialog.setDirectory(m_doc->getWorkspacePath());
+
+    /* Append file filters to the dialog */
+    QStringList filters;
+    filters << tr("Baked Shows (*%1)").arg(KExtBakedStream);
+#if defined(WIN32) || defined(Q_OS_WIN)
+    filters << tr("All Files (*.*)");
+#else
+    filters << tr("All Files (*)");
+#endif
+    dialog.setNameFilters(filters);
+
+    /* Append useful URLs to the dialog */
+    QList <QUrl> sidebar;
+    sidebar.append(QUrl::fromLocalFile(QDir::homePath()));
+    sidebar.append(QUrl::fromLocalFile(QDir::rootPath()));
+    dialog.setSidebarUrls(sidebar);
+
+    /* Get file name */
+    if (dialog.exec() != QDialog::Accepted)
+        return;
+
+    fn = dialog.selectedFiles().first();
+    if (fn.isEmpty() == true)
+        return;
+
+    if (m_show->isRunning())
+        m_show->stopAndWait();
+
+    m_show->setSourceFileName(fn);
+    m_doc->setModified();
+
+    updateStreamInfo();
+}
+
+void BakedShowEditor::slotPreviewToggled(bool state)
+{
+    if (state == true)
+    {
+        m_show->start(m_doc->masterTimer(), FunctionParent::master());
+        connect(m_show, SIGNAL(stopped(quint32)),
+                this, SLOT(slotPreviewStopped(quint32)));
+    }
+    else
+        m_show->stop(FunctionParent::master());
+}
+
+void BakedShowEditor::slotPreviewStopped(quint32 id)
+{
+    if (id == m_show->id())
+        m_previewButton->setChecked(false);
+}
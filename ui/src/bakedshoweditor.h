@@ -0,0 +1,58 @@
+/*
+  Q Light Controller Plus
+  bakedshoweditor.h
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef BAKEDSHOWEDITOR_H
+#define BAKEDSHOWEDITOR_H
+
+#include "ui_bakedshoweditor.h"
+#include "function.h"
+
+class BakedShow;
+class Doc;
+
+/** @addtogroup ui_shows
+ * @{
+ */
+
+class BakedShowEditor : public QWidget, public Ui_BakedShowEditor
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(BakedShowEditor)
+
+public:
+    BakedShowEditor(QWidget* parent, BakedShow* show, Doc* doc);
+    ~BakedShowEditor();
+
+private:
+    void updateStreamInfo();
+
+private:
+    Doc* m_doc;
+    BakedShow* m_show; // The BakedShow function being edited
+
+private slots:
+    void slotNameEdited(const QString& text);
+    void slotSourceFileClicked();
+    void slotPreviewToggled(bool state);
+    void slotPreviewStopped(quint32 id);
+};
+
+/** @} */
+
+#endif
@@ -41,6 +41,7 @@
 #include "functionselection.h"
 #include "collectioneditor.h"
 #include "audioplugincache.h"
+#include "bakedshoweditor.h"
 #include "functionmanager.h"
 #include "rgbmatrixeditor.h"
 #include "functionwizard.h"
@@ -59,6 +60,7 @@
 #include "chaser.h"
 #include "script.h"
 #include "scene.h"
+#include "bakedshow.h"
 #include "audio.h"
 #include "show.h"
 #include "doc.h"
@@ -956,6 +958,10 @@ void FunctionManager::editFunction(Function* function)
     {
         m_editor = new ShowEditor(m_hsplitter->widget(1), qobject_cast<Show*> (function), m_doc);
     }
+    else if (function->type() == Function::BakedShowType)
+    {
+        m_editor = new BakedShowEditor(m_hsplitter->widget(1), qobject_cast<BakedShow*> (function), m_doc);
+    }
     else if (function->type() == Function::AudioType)
     {
         m_editor = new AudioEditor(m_hsplitter->widget(1), qobject_cast<Audio*> (function), m_doc);
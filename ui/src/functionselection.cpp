@@ -61,7 +61,8 @@ FunctionSelection::FunctionSelection(QWidget* parent, Doc* doc)
     , m_multiSelection(true)
     , m_runningOnlyFlag(false)
     , m_filter(Function::SceneType | Function::ChaserType | Function::SequenceType | Function::CollectionType |
-               Function::EFXType | Function::ScriptType | Function::RGBMatrixType | Function::ShowType | Function::AudioType
+               Function::EFXType | Function::ScriptType | Function::RGBMatrixType | Function::ShowType | Function::BakedShowType |
+               Function::AudioType
 #if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
                | Function::VideoType
 #endif
@@ -450,9 +451,9 @@ void FunctionSelection::slotRGBMatrixChecked(bool state)
 void FunctionSelection::slotShowChecked(bool state)
 {
     if (state == true)
-        m_filter = (m_filter | Function::ShowType);
+        m_filter = (m_filter | Function::ShowType | Function::BakedShowType);
     else
-        m_filter = (m_filter & ~Function::ShowType);
+        m_filter = (m_filter & ~(Function::ShowType | Function::BakedShowType));
     refillTree();
 }
 
@@ -25,6 +25,7 @@
 #include <QMessageBox>
 #include <QSettings>
 #include <QSplitter>
+#include <QSpinBox>
 #include <QLineEdit>
 #include <QCheckBox>
 #include <QToolBar>
@@ -63,6 +64,8 @@ InputOutputManager::InputOutputManager(QWidget* parent, Doc* doc)
     , m_deleteUniverseAction(NULL)
     , m_uniNameEdit(NULL)
     , m_uniPassthroughCheck(NULL)
+    , m_uniSendOnChangeCheck(NULL)
+    , m_uniKeepAliveSpin(NULL)
     , m_editor(NULL)
     , m_editorUniverse(UINT_MAX)
 {
@@ -122,6 +125,21 @@ InputOutputManager::InputOutputManager(QWidget* parent, Doc* doc)
     m_uniPassthroughCheck->setFont(font);
     m_toolbar->addWidget(m_uniPassthroughCheck);
 
+    m_uniSendOnChangeCheck = new QCheckBox(tr("Send on change"), this);
+    m_uniSendOnChangeCheck->setLayoutDirection(Qt::RightToLeft);
+    m_uniSendOnChangeCheck->setFont(font);
+    m_uniSendOnChangeCheck->setToolTip(tr("Let the output plugins skip the frames that did not change"));
+    m_toolbar->addWidget(m_uniSendOnChangeCheck);
+
+    m_uniKeepAliveSpin = new QSpinBox(this);
+    m_uniKeepAliveSpin->setRange(0, 60000);
+    m_uniKeepAliveSpin->setSingleStep(100);
+    m_uniKeepAliveSpin->setSuffix(" ms");
+    m_uniKeepAliveSpin->setFont(font);
+    m_uniKeepAliveSpin->setToolTip(tr("Maximum time between two frames sent in send on change mode"));
+    m_uniKeepAliveSpin->setEnabled(false);
+    m_toolbar->addWidget(m_uniKeepAliveSpin);
+
     m_splitter->widget(0)->layout()->addWidget(m_toolbar);
 
     connect(m_uniNameEdit, SIGNAL(textChanged(QString)),
@@ -130,6 +148,12 @@ InputOutputManager::InputOutputManager(QWidget* parent, Doc* doc)
     connect(m_uniPassthroughCheck, SIGNAL(toggled(bool)),
             this, SLOT(slotPassthroughChanged(bool)));
 
+    connect(m_uniSendOnChangeCheck, SIGNAL(toggled(bool)),
+            this, SLOT(slotSendOnChangeChanged(bool)));
+
+    connect(m_uniKeepAliveSpin, SIGNAL(valueChanged(int)),
+            this, SLOT(slotKeepAliveChanged(int)));
+
     /* Universes list */
     m_list = new QListWidget(this);
     m_list->setItemDelegate(new UniverseItemWidget(m_list));
@@ -212,6 +236,7 @@ void InputOutputManager::updateList()
         m_uniNameEdit->setEnabled(true);
         m_uniNameEdit->setText(m_ioMap->getUniverseNameByIndex(0));
         m_uniPassthroughCheck->setChecked(m_ioMap->getUniversePassthrough(0));
+        updateSendOnChange(0);
     }
 }
 
@@ -323,6 +348,21 @@ void InputOutputManager::slotCurrentItemChanged()
     int uniIdx = m_list->currentRow();
     m_uniNameEdit->setText(m_ioMap->getUniverseNameByIndex(uniIdx));
     m_uniPassthroughCheck->setChecked(m_ioMap->getUniversePassthrough(uniIdx));
+    updateSendOnChange(uniIdx);
+}
+
+void InputOutputManager::updateSendOnChange(int uniIdx)
+{
+    bool sendOnChange = m_ioMap->getUniverseSendOnChange(uniIdx);
+
+    m_uniSendOnChangeCheck->blockSignals(true);
+    m_uniSendOnChangeCheck->setChecked(sendOnChange);
+    m_uniSendOnChangeCheck->blockSignals(false);
+
+    m_uniKeepAliveSpin->blockSignals(true);
+    m_uniKeepAliveSpin->setValue(m_ioMap->getUniverseKeepAliveInterval(uniIdx));
+    m_uniKeepAliveSpin->setEnabled(sendOnChange);
+    m_uniKeepAliveSpin->blockSignals(false);
 }
 
 void InputOutputManager::slotMappingChanged()
@@ -422,6 +462,29 @@ void InputOutputManager::slotPassthroughChanged(bool checked)
     m_doc->inputOutputMap()->saveDefaults();
 }
 
+void InputOutputManager::slotSendOnChangeChanged(bool checked)
+{
+    QListWidgetItem *currItem = m_list->currentItem();
+    if (currItem == NULL)
+        return;
+
+    int uniIdx = m_list->currentRow();
+    m_ioMap->setUniverseSendOnChange(uniIdx, checked);
+    m_uniKeepAliveSpin->setEnabled(checked);
+    m_doc->setModified();
+}
+
+void InputOutputManager::slotKeepAliveChanged(int value)
+{
+    QListWidgetItem *currItem = m_list->currentItem();
+    if (currItem == NULL)
+        return;
+
+    int uniIdx = m_list->currentRow();
+    m_ioMap->setUniverseKeepAliveInterval(uniIdx, uint(value));
+    m_doc->setModified();
+}
+
 void InputOutputManager::showEvent(QShowEvent *ev)
 {
     Q_UNUSED(ev);
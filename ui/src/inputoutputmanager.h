@@ -29,6 +29,7 @@ class QListWidget;
 class QSplitter;
 class QLineEdit;
 class QCheckBox;
+class QSpinBox;
 class QToolBar;
 class QTimer;
 class QIcon;
@@ -72,6 +73,9 @@ private:
     /** Update the contents of the input universe to the item */
     void updateItem(QListWidgetItem *item, quint32 universe);
 
+    /** Update the send-on-change widgets with the settings of a universe */
+    void updateSendOnChange(int uniIdx);
+
 private slots:
     /** Listens to input data and displays a small icon to indicate a
         working connection between a plugin and an input device. */
@@ -94,6 +98,8 @@ private slots:
     void slotUniverseNameChanged(QString name);
     void slotUniverseAdded(quint32 universe);
     void slotPassthroughChanged(bool checked);
+    void slotSendOnChangeChanged(bool checked);
+    void slotKeepAliveChanged(int value);
 
 protected:
     /** @reimp */
@@ -107,6 +113,8 @@ private:
     QAction* m_deleteUniverseAction;
     QLineEdit *m_uniNameEdit;
     QCheckBox *m_uniPassthroughCheck;
+    QCheckBox *m_uniSendOnChangeCheck;
+    QSpinBox *m_uniKeepAliveSpin;
     QListWidget *m_list;
     QIcon m_icon;
     QTimer* m_timer;
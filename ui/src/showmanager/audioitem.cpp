@@ -17,6 +17,7 @@
   limitations under the License.
 */
 
+#include <QStyleOptionGraphicsItem>
 #include <QApplication>
 #include <QPainter>
 #include <qmath.h>
@@ -27,7 +28,6 @@
 #include "trackitem.h"
 #include "headeritems.h"
 #include "audiodecoder.h"
-#include "audioplugincache.h"
 
 AudioItem::AudioItem(Audio *aud, ShowFunction *func)
     : ShowItem(func)
@@ -35,7 +35,6 @@ AudioItem::AudioItem(Audio *aud, ShowFunction *func)
     , m_previewLeftAction(NULL)
     , m_previewRightAction(NULL)
     , m_previewStereoAction(NULL)
-    , m_preview(NULL)
 {
     Q_ASSERT(aud != NULL);
 
@@ -47,9 +46,14 @@ AudioItem::AudioItem(Audio *aud, ShowFunction *func)
     if (func->duration() == 0)
         func->setDuration(aud->totalDuration());
 
+    // the waveform is drawn only where exposed
+    setFlag(QGraphicsItem::ItemUsesExtendedStyleOption, true);
+
     calculateWidth();
     connect(m_audio, SIGNAL(changed(quint32)),
             this, SLOT(slotAudioChanged(quint32)));
+    connect(m_audio, SIGNAL(waveformReady()),
+            this, SLOT(slotWaveformReady()));
 
     /* Preview actions */
     m_previewLeftAction = new QAction(tr("Preview Left Channel"), this);
@@ -83,17 +87,30 @@ void AudioItem::calculateWidth()
 
 void AudioItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget)
 {
-    Q_UNUSED(option);
-    Q_UNUSED(widget);
-
     float timeScale = 50/(float)m_timeScale;
 
     ShowItem::paint(painter, option, widget);
 
-    if (m_preview != NULL)
+    bool left = m_previewLeftAction->isChecked() || m_previewStereoAction->isChecked();
+    bool right = m_previewRightAction->isChecked() || m_previewStereoAction->isChecked();
+    AudioWaveform *waveform = (left || right) ? m_audio->waveform() : NULL;
+
+    if (waveform != NULL && waveform->isReady())
     {
-        // show preview here
-        painter->drawPixmap(0, 0, m_preview->scaled(m_width, TRACK_HEIGHT - 4));
+        int exposedLeft = qMax(0, qFloor(option->exposedRect.left()));
+        int exposedRight = qMin(m_width, qCeil(option->exposedRect.right()));
+        int height = TRACK_HEIGHT - 4;
+
+        if (left && right && waveform->channels() > 1)
+        {
+            drawWaveform(painter, waveform, 0, exposedLeft, exposedRight, height / 4, height / 4);
+            drawWaveform(painter, waveform, 1, exposedLeft, exposedRight, (height * 3) / 4, height / 4);
+        }
+        else
+        {
+            drawWaveform(painter, waveform, (right && waveform->channels() > 1) ? 1 : 0,
+                         exposedLeft, exposedRight, height / 2, height / 2);
+        }
     }
 
     if (m_audio->fadeInSpeed() != 0)
@@ -113,6 +130,38 @@ void AudioItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *option,
     ShowItem::postPaint(painter);
 }
 
+void AudioItem::drawWaveform(QPainter *painter, AudioWaveform *waveform, int channel,
+                             int left, int right, int center, int amplitude)
+{
+    if (right <= left)
+        return;
+
+    // pixels to milliseconds
+    float msPerPixel = 1000.0 / (50 / (float)m_timeScale);
+    if (waveform->peaks(channel, qint64(left * msPerPixel), qint64(right * msPerPixel),
+                        right - left, m_peaks) == false)
+        return;
+
+    m_peakLines.resize(0);
+    m_rmsLines.resize(0);
+
+    for (int i = 0; i < m_peaks.count(); i++)
+    {
+        const WaveformPeak &peak = m_peaks.at(i);
+        int x = left + i;
+        int rms = (peak.m_rms * amplitude) / 255;
+
+        m_peakLines.append(QLine(x, center - (peak.m_max * amplitude) / 128,
+                                 x, center - (peak.m_min * amplitude) / 128));
+        m_rmsLines.append(QLine(x, center - rms, x, center + rms));
+    }
+
+    painter->setPen(QPen(QColor(0, 0, 0, 96), 1));
+    painter->drawLines(m_peakLines);
+    painter->setPen(QPen(Qt::black, 1));
+    painter->drawLines(m_rmsLines);
+}
+
 void AudioItem::setTimeScale(int val)
 {
     ShowItem::setTimeScale(val);
@@ -150,30 +199,26 @@ void AudioItem::slotAudioPreviewLeft()
 {
     m_previewRightAction->setChecked(false);
     m_previewStereoAction->setChecked(false);
-    PreviewThread *waveformThread = new PreviewThread;
-    waveformThread->setAudioItem(this);
-    connect(waveformThread, SIGNAL(finished()), waveformThread, SLOT(deleteLater()));
-    waveformThread->start();
+    update();
 }
 
 void AudioItem::slotAudioPreviewRight()
 {
     m_previewLeftAction->setChecked(false);
     m_previewStereoAction->setChecked(false);
-    PreviewThread *waveformThread = new PreviewThread;
-    waveformThread->setAudioItem(this);
-    connect(waveformThread, SIGNAL(finished()), waveformThread, SLOT(deleteLater()));
-    waveformThread->start();
+    update();
 }
 
 void AudioItem::slotAudioPreviewStereo()
 {
     m_previewLeftAction->setChecked(false);
     m_previewRightAction->setChecked(false);
-    PreviewThread *waveformThread = new PreviewThread;
-    waveformThread->setAudioItem(this);
-    connect(waveformThread, SIGNAL(finished()), waveformThread, SLOT(deleteLater()));
-    waveformThread->start();
+    update();
+}
+
+void AudioItem::slotWaveformReady()
+{
+    update();
 }
 
 void AudioItem::contextMenuEvent(QGraphicsSceneContextMenuEvent *)
@@ -205,199 +250,3 @@ void AudioItem::contextMenuEvent(QGraphicsSceneContextMenuEvent *)
 
     menu.exec(QCursor::pos());
 }
-
-void PreviewThread::setAudioItem(AudioItem *item)
-{
-    m_item = item;
-}
-
-qint32 PreviewThread::getSample(unsigned char *data, quint32 idx, int sampleSize)
-{
-    qint32 value = 0;
-    if (sampleSize == 1)
-        value = (qint32)data[idx];
-    if (sampleSize == 2)
-    {
-        qint16 *tmpdata = (qint16 *)data;
-        qint16 twobytes = tmpdata[idx];
-        value = twobytes;
-    }
-    else if (sampleSize == 3 || sampleSize == 4)
-    {
-        value = ((qint32)data[idx] << 24) + ((qint32)data[idx + 1] << 16) + ((qint32)data[idx + 2] << 8) + (qint32)data[idx + 3];
-        value = value >> 16;
-    }
-    //qDebug() << "sampleValue:" << value;
-    return value;
-}
-
-void PreviewThread::run()
-{
-    bool left = m_item->m_previewLeftAction->isChecked() | m_item->m_previewStereoAction->isChecked();
-    bool right = m_item->m_previewRightAction->isChecked() | m_item->m_previewStereoAction->isChecked();
-
-    if ((left == true || right == true) && m_item->m_audio->getAudioDecoder() != NULL)
-    {
-        AudioDecoder *ad = m_item->m_audio->doc()->audioPluginCache()->getDecoderForFile(m_item->m_audio->getSourceFileName());
-        AudioParameters ap = ad->audioParameters();
-        ad->seek(0);
-        // 1- find out how many samples have to be represented on a single pixel on a 1:1 time scale
-        int sampleSize = ap.sampleSize();
-        int channels = ap.channels();
-        int oneSecondSamples = ap.sampleRate() * channels;
-        int onePixelSamples = oneSecondSamples / 50;
-
-        qint32 maxValue = 0;
-        // 24 and 32 bit samples would produce a RMS too high, so let's
-        // work on 16bit values
-        if (sampleSize > 2)
-            sampleSize = 2;
-
-        if (left == true && right == true)
-            maxValue = 0x7F << (8 * (sampleSize - 1));
-        else
-            maxValue = 0x3F << (8 * (sampleSize - 1));
-
-        quint32 onePixelReadLen = onePixelSamples * sampleSize;
-
-        // 2- decode the whole file and fill a QPixmap with a sample block RMS value for each pixel
-        qint64 dataRead = 1;
-        unsigned char audioData[onePixelReadLen * 4];
-        quint32 audioDataOffset = 0;
-        QPixmap *preview = new QPixmap((50 * m_item->m_audio->totalDuration()) / 1000, 76);
-        preview->fill(Qt::transparent);
-        QPainter p(preview);
-        int xpos = 0;
-
-        qDebug() << "Audio duration: " << m_item->m_audio->totalDuration() <<
-                    ", pixmap width: " << preview->width() <<
-                    ", maxValue: " << maxValue << ", samples:" << sampleSize;
-        qDebug() << "Samples per second: " << oneSecondSamples << ", for one pixel: " << onePixelSamples <<
-                    ", onePixelReadLen:" << onePixelReadLen;
-
-        delete m_item->m_preview;
-        m_item->m_preview = NULL;
-        m_item->update();
-
-        while (dataRead)
-        {
-            quint32 tmpExceedData = 0;
-            if (audioDataOffset < onePixelReadLen)
-            {
-                dataRead = ad->read((char *)audioData + audioDataOffset, onePixelReadLen * 2);
-                if (dataRead > 0)
-                {
-                    if((quint32)dataRead + audioDataOffset >= onePixelReadLen)
-                    {
-                        tmpExceedData = (dataRead + audioDataOffset) - onePixelReadLen;
-                        dataRead = onePixelReadLen;
-                    }
-                    else
-                    {
-                        qDebug() << "Not enough data. Requested:" << onePixelReadLen << "got:" << dataRead;
-                        audioDataOffset = dataRead;
-                        continue;
-                    }
-                }
-            }
-            else
-            {
-                dataRead = onePixelReadLen;
-                tmpExceedData = audioDataOffset - onePixelReadLen;
-            }
-
-            if (dataRead == onePixelReadLen)
-            {
-                quint32 i = 0;
-                // calculate the RMS value (peak) for this data block
-                qint64 rmsLeft = 0;
-                qint64 rmsRight = 0;
-                bool done = false;
-                while (!done)
-                {
-                    if (left == true)
-                    {
-                        qint32 sampleVal = getSample(audioData, i, sampleSize);
-                        rmsLeft += (sampleVal * sampleVal);
-                        i+=sampleSize;
-                    }
-                    if (channels == 2)
-                    {
-                        if (right == true)
-                        {
-                            qint32 sampleVal = getSample(audioData, i, sampleSize);
-                            rmsRight += (sampleVal * sampleVal);
-                        }
-                        i+=sampleSize;
-                    }
-
-                    if (i >= dataRead)
-                    {
-                        //qDebug() << "i:" << i << "xpos:" << xpos;
-                        done = true;
-                    }
-                }
-
-                if (left == true)
-                    rmsLeft = sqrt(rmsLeft / onePixelSamples);
-                if (right == true)
-                    rmsRight = sqrt(rmsRight / onePixelSamples);
-                //qDebug() << "RMS right:" << rmsRight << ", RMS left:" << rmsLeft;
-
-                // 3- Draw the actual waveform
-                unsigned short lineHeightLeft = 0, lineHeightRight = 0;
-
-                if (left == true)
-                    lineHeightLeft = (76 * rmsLeft) / maxValue;
-                if (right == true)
-                    lineHeightRight = (76 * rmsRight) / maxValue;
-
-                if (left == true && right == true)
-                {
-                    if (lineHeightLeft > 1)
-                        p.drawLine(xpos, 19 - (lineHeightLeft / 2), xpos, 19 + (lineHeightLeft / 2));
-                    else
-                        p.drawLine(xpos, 19, xpos + 1, 19);
-
-                    if (lineHeightRight > 1)
-                        p.drawLine(xpos, 51 - (lineHeightRight / 2), xpos, 51 + (lineHeightRight / 2));
-                    else
-                        p.drawLine(xpos, 51, xpos + 1, 51);
-                }
-                else
-                {
-                    unsigned short lineHeight = 0;
-                    if (left == true)
-                        lineHeight = lineHeightLeft;
-                    else
-                        lineHeight = lineHeightRight;
-                    if (lineHeight > 1)
-                        p.drawLine(xpos, 38 - (lineHeight / 2), xpos, 38 + (lineHeight / 2));
-                    else
-                        p.drawLine(xpos, 38, xpos + 1, 38);
-                    //qDebug() << "Data read: " << dataRead << ", rms: " << rmsRight << ", line height: " << lineHeight << ", xpos = " << xpos;
-                }
-                xpos++;
-
-                if (tmpExceedData > 0)
-                {
-                    //qDebug() << "Exceed data found: " << tmpExceedData;
-                    memmove(audioData, audioData + onePixelReadLen, tmpExceedData);
-                    audioDataOffset = tmpExceedData;
-                }
-                else
-                    audioDataOffset = 0;
-            }
-        }
-        //qDebug() << "Iterations done: " << xpos;
-        delete ad;
-        m_item->m_preview = preview;
-    }
-    else // no preview selected. Delete pixmap
-    {
-        delete m_item->m_preview;
-        m_item->m_preview = NULL;
-    }
-
-    m_item->update();
-}
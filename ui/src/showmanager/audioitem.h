@@ -25,6 +25,7 @@
 #include <QAction>
 #include <QFont>
 
+#include "audiowaveform.h"
 #include "showitem.h"
 #include "audio.h"
 
@@ -71,10 +72,17 @@ protected slots:
     void slotAudioPreviewRight();
     void slotAudioPreviewStereo();
 
+    void slotWaveformReady();
+
 private:
     /** Calculate sequence width for paint() and boundingRect() */
     void calculateWidth();
 
+    /** Draw the waveform of $channel between the $left and $right pixels,
+     *  centered on $center and $amplitude pixels high at most */
+    void drawWaveform(QPainter *painter, AudioWaveform *waveform, int channel,
+                      int left, int right, int center, int amplitude);
+
 public:
     /** Reference to the actual Audio Function */
     Audio *m_audio;
@@ -84,21 +92,10 @@ public:
     QAction *m_previewRightAction;
     QAction *m_previewStereoAction;
 
-    /** Pixmap holding the waveform (if enabled) */
-    QPixmap *m_preview;
-};
-
-class PreviewThread : public QThread
-{
-public:
-    void setAudioItem(AudioItem *item);
-
-private:
-    /** Retrieve a sample value from an audio buffer, given the sample size */
-    qint32 getSample(unsigned char *data, quint32 idx, int sampleSize);
-    void run();
-
-    AudioItem *m_item;
+    /** Buffers of the waveform peaks and lines, reused at every paint */
+    QVector<WaveformPeak> m_peaks;
+    QVector<QLine> m_peakLines;
+    QVector<QLine> m_rmsLines;
 };
 
 /** @} */
@@ -17,6 +17,7 @@
   limitations under the License.
 */
 
+#include <QProgressDialog>
 #include <QInputDialog>
 #include <QColorDialog>
 #include <QMessageBox>
@@ -35,6 +36,7 @@
 
 #include "functionselection.h"
 #include "audioplugincache.h"
+#include "bakedstream.h"
 #include "rgbmatrixeditor.h"
 #include "multitrackview.h"
 #include "chasereditor.h"
@@ -47,6 +49,7 @@
 #include "sceneeditor.h"
 #include "timingstool.h"
 #include "qlcmacros.h"
+#include "bakedshow.h"
 #include "sequence.h"
 #include "chaser.h"
 
@@ -71,6 +74,7 @@ ShowManager::ShowManager(QWidget* parent, Doc* doc)
     , m_toolbar(NULL)
     , m_showsCombo(NULL)
     , m_addShowAction(NULL)
+    , m_bakeShowAction(NULL)
     , m_addTrackAction(NULL)
     , m_addSequenceAction(NULL)
     , m_addAudioAction(NULL)
@@ -117,7 +121,7 @@ ShowManager::ShowManager(QWidget* parent, Doc* doc)
     connect(m_showview, SIGNAL(showItemMoved(ShowItem*,quint32,bool)),
             this, SLOT(slotShowItemMoved(ShowItem*,quint32,bool)));
     connect(m_showview, SIGNAL(timeChanged(quint32)),
-            this, SLOT(slotUpdateTime(quint32)));
+            this, SLOT(slotCursorMoved(quint32)));
     connect(m_showview, SIGNAL(trackClicked(Track*)),
             this, SLOT(slotTrackClicked(Track*)));
     connect(m_showview, SIGNAL(trackDoubleClicked(Track*)),
@@ -202,6 +206,11 @@ void ShowManager::initActions()
     connect(m_addShowAction, SIGNAL(triggered(bool)),
             this, SLOT(slotAddShow()));
 
+    m_bakeShowAction = new QAction(QIcon(":/bakedshow.png"),
+                                   tr("&Bake the show"), this);
+    connect(m_bakeShowAction, SIGNAL(triggered(bool)),
+            this, SLOT(slotBakeShow()));
+
     m_addTrackAction = new QAction(QIcon(":/edit_add.png"),
                                    tr("Add a &track or an existing function"), this);
     m_addTrackAction->setShortcut(QKeySequence("CTRL+N"));
@@ -304,6 +313,7 @@ void ShowManager::initToolbar()
     connect(m_showsCombo, SIGNAL(currentIndexChanged(int)),
             this, SLOT(slotShowsComboChanged(int)));
     m_toolbar->addWidget(m_showsCombo);
+    m_toolbar->addAction(m_bakeShowAction);
     m_toolbar->addSeparator();
 
     m_toolbar->addAction(m_addTrackAction);
@@ -393,10 +403,12 @@ void ShowManager::updateShowsCombo()
     if (m_showsCombo->count() > 0)
     {
         m_addTrackAction->setEnabled(true);
+        m_bakeShowAction->setEnabled(true);
     }
     else
     {
         m_addTrackAction->setEnabled(false);
+        m_bakeShowAction->setEnabled(false);
         m_addSequenceAction->setEnabled(false);
         m_addAudioAction->setEnabled(false);
 #if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
@@ -599,6 +611,69 @@ void ShowManager::slotAddShow()
     }
 }
 
+void ShowManager::slotBakeShow()
+{
+    if (m_show == NULL)
+        return;
+
+    /* Create a file save dialog */
+    QFileDialog dialog(this);
+    dialog.setWindowTitle(tr("Bake Show"));
+    dialog.setAcceptMode(QFileDialog::AcceptSave);
+    dialog.setDirectory(m_doc->getWorkspacePath());
+    dialog.selectFile(m_show->name() + KExtBakedStream);
+
+    /* Append file filters to the dialog */
+    QStringList filters;
+    filters << tr("Baked Shows (*%1)").arg(KExtBakedStream);
+#if defined(WIN32) || defined(Q_OS_WIN)
+    filters << tr("All Files (*.*)");
+#else
+    filters << tr("All Files (*)");
+#endif
+    dialog.setNameFilters(filters);
+
+    /* Get file name */
+    if (dialog.exec() != QDialog::Accepted)
+        return;
+
+    QString fn = dialog.selectedFiles().first();
+    if (fn.isEmpty() == true)
+        return;
+
+    if (fn.endsWith(KExtBakedStream) == false)
+        fn += KExtBakedStream;
+
+    /* Render on a worker thread, so the UI stays responsive */
+    BakedShowBaker baker(m_doc, m_show->id(), fn, m_show->totalDuration());
+    QProgressDialog progress(tr("Baking the show..."), tr("Cancel"), 0, 100, this);
+    progress.setWindowModality(Qt::WindowModal);
+    progress.setAutoClose(false);
+
+    connect(&baker, SIGNAL(progressChanged(int)), &progress, SLOT(setValue(int)));
+    connect(&baker, SIGNAL(finished()), &progress, SLOT(accept()));
+    connect(&progress, SIGNAL(canceled()), &baker, SLOT(cancel()));
+
+    baker.start();
+    progress.exec();
+    baker.wait();
+
+    if (progress.wasCanceled())
+        return;
+
+    BakedShow *bakedShow = new BakedShow(m_doc);
+    if (baker.isBaked() == false || bakedShow->setSourceFileName(fn) == false)
+    {
+        QMessageBox::warning(this, tr("Bake error"), tr("Unable to bake the show to %1").arg(fn));
+        delete bakedShow;
+        return;
+    }
+
+    bakedShow->setName(tr("%1 (Baked)").arg(m_show->name()));
+    if (m_doc->addFunction(bakedShow) == false)
+        delete bakedShow;
+}
+
 void ShowManager::slotAddItem()
 {
     if (m_show == NULL)
@@ -1366,6 +1441,15 @@ void ShowManager::slotupdateTimeAndCursor(quint32 msec_time)
     m_showview->moveCursor(msec_time);
 }
 
+void ShowManager::slotCursorMoved(quint32 msec_time)
+{
+    // a running show continues from the new cursor position
+    if (m_show != NULL && m_show->isRunning())
+        m_show->seek(msec_time);
+
+    slotUpdateTime(msec_time);
+}
+
 void ShowManager::slotUpdateTime(quint32 msec_time)
 {
     uint h, m, s;
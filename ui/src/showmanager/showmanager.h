@@ -120,6 +120,7 @@ private:
     QComboBox* m_showsCombo;
     QLabel* m_timeLabel;
     QAction* m_addShowAction;
+    QAction* m_bakeShowAction;
     QAction* m_addTrackAction;
     QAction* m_addSequenceAction;
     QAction* m_addAudioAction;
@@ -144,6 +145,10 @@ protected slots:
     /** Slot called when the user request to add a new show */
     void slotAddShow();
 
+    /** Slot called when the user requests to bake the current show
+     *  into a Baked Show function */
+    void slotBakeShow();
+
     void slotAddItem();
     void slotAddSequence();
     void slotAddAudio();
@@ -177,6 +182,7 @@ protected slots:
 
     void slotUpdateTime(quint32 msec_time);
     void slotupdateTimeAndCursor(quint32 msec_time);
+    void slotCursorMoved(quint32 msec_time);
     void slotTrackClicked(Track *track);
     void slotTrackDoubleClicked(Track *track);
     void slotTrackMoved(Track *track, int direction);
@@ -82,6 +82,7 @@ SimpleDesk::SimpleDesk(QWidget* parent, Doc* doc)
     , m_docChanged(false)
     , m_chGroupsArea(NULL)
     , m_currentUniverse(0)
+    , m_lastSnapshotSerial(0)
     , m_channelsPerPage(DEFAULT_PAGE_CHANNELS)
     , m_selectedPlayback(UINT_MAX)
     , m_playbacksPerPage(DEFAULT_PAGE_PLAYBACKS)
@@ -133,8 +134,8 @@ SimpleDesk::SimpleDesk(QWidget* parent, Doc* doc)
     connect(m_doc->inputOutputMap(), SIGNAL(universeRemoved(quint32)),
             this, SLOT(slotDocChanged()));
 
-    connect(m_doc->inputOutputMap(), SIGNAL(universesWritten(int, const QByteArray&)),
-            this, SLOT(slotUniversesWritten(int, const QByteArray&)));
+    connect(m_doc->inputOutputMap(), SIGNAL(universesSnapshotPublished()),
+            this, SLOT(slotUniversesSnapshotPublished()));
 }
 
 SimpleDesk::~SimpleDesk()
@@ -375,14 +376,12 @@ uchar SimpleDesk::getAbsoluteChannelValue(uint address)
         return m_engine->value(address);
     else
     {
-        QList<Universe*> ua = m_doc->inputOutputMap()->claimUniverses();
+        UniverseSnapshot snapshot = m_doc->inputOutputMap()->snapshot();
         int uni = address >> 9;
         uint channel = address & 0x01FF;
-        if (uni >= ua.count())
+        if (uni >= snapshot.universesCount())
             return 0;
-        uchar value = ua.at(uni)->preGMValue(channel);
-        m_doc->inputOutputMap()->releaseUniverses(false);
-        return value;
+        return snapshot.preGMValues(uni)[channel];
     }
 }
 
@@ -900,15 +899,21 @@ void SimpleDesk::slotUniverseSliderValueChanged(quint32 fid, quint32 chan, uchar
     }
 }
 
-void SimpleDesk::slotUniversesWritten(int idx, const QByteArray& ua)
+void SimpleDesk::slotUniversesSnapshotPublished()
 {
     // If Simple Desk is not visible, don't even waste CPU
     if (isVisible() == false)
         return;
 
-    if (idx != m_currentUniverse)
+    UniverseSnapshot snapshot = m_doc->inputOutputMap()->snapshot();
+    int idx = m_currentUniverse;
+
+    if (snapshot.changeSerial(idx) <= m_lastSnapshotSerial)
         return;
 
+    m_lastSnapshotSerial = snapshot.serial();
+    const QByteArray ua = snapshot.rawData(idx);
+
     if (m_viewModeButton->isChecked() == false)
     {
         quint32 start = (m_universePageSpin->value() - 1) * m_channelsPerPage;
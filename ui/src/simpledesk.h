@@ -132,7 +132,7 @@ private slots:
     void slotAliasChanged();
     void slotUniverseSliderValueChanged(quint32, quint32, uchar value);
     void slotUpdateUniverseSliders();
-    void slotUniversesWritten(int idx, const QByteArray& ua);
+    void slotUniversesSnapshotPublished();
 
 private:
     QFrame *m_universeGroup;
@@ -161,6 +161,9 @@ private:
     /** Currently selected universe. Basically the index of m_universesCombo */
     int m_currentUniverse;
 
+    /** Serial of the last universe snapshot used to update the sliders */
+    quint64 m_lastSnapshotSerial;
+
     /** Define how many sliders will be displayed for each page */
     uint m_channelsPerPage;
 
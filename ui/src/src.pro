@@ -49,6 +49,7 @@ HEADERS += aboutbox.h \
            audiobar.h \
            audioeditor.h \
            audiotriggerwidget.h \
+           bakedshoweditor.h \
            channelmodifiereditor.h \
            channelmodifiergraphicsview.h \
            channelsselection.h \
@@ -97,6 +98,7 @@ HEADERS += aboutbox.h \
            simpledeskengine.h \
            speeddial.h \
            speeddialwidget.h \
+           tickprofilerdialog.h \
            universeitemwidget.h
 
 # Monitor headers
@@ -170,6 +172,7 @@ FORMS += aboutbox.ui \
          addrgbpanel.ui \
          assignhotkey.ui \
          audioeditor.ui \
+         bakedshoweditor.ui \
          chasereditor.ui \
          channelmodifiereditor.ui \
          channelsselection.ui \
@@ -224,6 +227,7 @@ SOURCES += aboutbox.cpp \
            audiobar.cpp \
            audioeditor.cpp \
            audiotriggerwidget.cpp \
+           bakedshoweditor.cpp \
            channelmodifiereditor.cpp \
            channelmodifiergraphicsview.cpp \
            channelsselection.cpp \
@@ -272,6 +276,7 @@ SOURCES += aboutbox.cpp \
            simpledeskengine.cpp \
            speeddial.cpp \
            speeddialwidget.cpp \
+           tickprofilerdialog.cpp \
            universeitemwidget.cpp
 
 # Monitor sources
@@ -0,0 +1,209 @@
+/*
+  Q Light Controller Plus
+  tickprofilerdialog.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QDialogButtonBox>
+#include <QTreeWidgetItem>
+#include <QPushButton>
+#include <QTreeWidget>
+#include <QVBoxLayout>
+#include <QSettings>
+#include <QSet>
+#include <QHeaderView>
+#include <QLabel>
+#include <QTimer>
+
+#include "tickprofilerdialog.h"
+#include "mastertimer.h"
+#include "dmxsource.h"
+#include "function.h"
+#include "doc.h"
+
+#define SETTINGS_GEOMETRY "tickprofiler/geometry"
+
+#define KColumnName 0
+#define KColumnP50  1
+#define KColumnP99  2
+#define KColumnMax  3
+
+#define REFRESH_INTERVAL 500
+
+TickProfilerDialog::TickProfilerDialog(Doc *doc, QWidget *parent)
+    : QDialog(parent)
+    , m_doc(doc)
+{
+    Q_ASSERT(doc != NULL);
+
+    setWindowTitle(tr("Engine profiler"));
+    setWindowIcon(QIcon(":/speed.png"));
+
+    QSettings settings;
+    QVariant var = settings.value(SETTINGS_GEOMETRY);
+    if (var.isValid() == true)
+        restoreGeometry(var.toByteArray());
+
+    QVBoxLayout *layout = new QVBoxLayout(this);
+
+    m_ticksLabel = new QLabel(this);
+    layout->addWidget(m_ticksLabel);
+
+    m_tree = new QTreeWidget(this);
+    m_tree->setRootIsDecorated(true);
+    m_tree->setAllColumnsShowFocus(true);
+    m_tree->setHeaderLabels(QStringList() << tr("Name") << tr("p50 (µs)")
+                            << tr("p99 (µs)") << tr("Max (µs)"));
+    layout->addWidget(m_tree);
+
+    m_phasesItem = new QTreeWidgetItem(m_tree);
+    m_phasesItem->setText(KColumnName, tr("Tick phases"));
+    for (int i = 0; i < TickProfiler::PhasesCount; i++)
+    {
+        QTreeWidgetItem *item = new QTreeWidgetItem(m_phasesItem);
+        item->setText(KColumnName, TickProfiler::phaseToString(TickProfiler::Phase(i)));
+    }
+    m_phasesItem->setExpanded(true);
+
+    m_jitterItem = new QTreeWidgetItem(m_tree);
+    m_jitterItem->setText(KColumnName, tr("Tick jitter"));
+
+    m_functionsItem = new QTreeWidgetItem(m_tree);
+    m_functionsItem->setText(KColumnName, tr("Functions"));
+    m_functionsItem->setExpanded(true);
+
+    m_sourcesItem = new QTreeWidgetItem(m_tree);
+    m_sourcesItem->setText(KColumnName, tr("DMX sources"));
+    m_sourcesItem->setExpanded(true);
+
+    QDialogButtonBox *buttons = new QDialogButtonBox(QDialogButtonBox::Close, this);
+    QPushButton *resetButton = buttons->addButton(tr("Reset"), QDialogButtonBox::ResetRole);
+    connect(resetButton, SIGNAL(clicked()), this, SLOT(slotReset()));
+    connect(buttons, SIGNAL(rejected()), this, SLOT(reject()));
+    layout->addWidget(buttons);
+
+    m_doc->masterTimer()->setProfilingEnabled(true);
+
+    m_refreshTimer = new QTimer(this);
+    connect(m_refreshTimer, SIGNAL(timeout()), this, SLOT(slotRefresh()));
+    m_refreshTimer->start(REFRESH_INTERVAL);
+
+    slotRefresh();
+}
+
+TickProfilerDialog::~TickProfilerDialog()
+{
+    m_doc->masterTimer()->setProfilingEnabled(false);
+
+    QSettings settings;
+    settings.setValue(SETTINGS_GEOMETRY, saveGeometry());
+}
+
+void TickProfilerDialog::setStatistics(QTreeWidgetItem *item, const TickStatistics &stats)
+{
+    item->setText(KColumnP50, QString::number(stats.m_p50));
+    item->setText(KColumnP99, QString::number(stats.m_p99));
+    item->setText(KColumnMax, QString::number(stats.m_max));
+}
+
+QTreeWidgetItem *TickProfilerDialog::childItem(QTreeWidgetItem *parent, quint64 key)
+{
+    for (int i = 0; i < parent->childCount(); i++)
+    {
+        if (parent->child(i)->data(KColumnName, Qt::UserRole).toULongLong() == key)
+            return parent->child(i);
+    }
+
+    QTreeWidgetItem *item = new QTreeWidgetItem(parent);
+    item->setData(KColumnName, Qt::UserRole, key);
+    return item;
+}
+
+void TickProfilerDialog::slotRefresh()
+{
+    TickProfiler *profiler = m_doc->masterTimer()->profiler();
+
+    m_ticksLabel->setText(tr("Ticks: %1 - Late ticks: %2")
+                          .arg(profiler->ticksCount())
+                          .arg(profiler->lateTicksCount()));
+
+    for (int i = 0; i < TickProfiler::PhasesCount; i++)
+        setStatistics(m_phasesItem->child(i), profiler->phaseStatistics(TickProfiler::Phase(i)));
+
+    setStatistics(m_jitterItem, profiler->jitterStatistics());
+
+    /* Functions */
+    QSet<QTreeWidgetItem *> updated;
+    foreach (quint32 id, profiler->functions())
+    {
+        Function *function = m_doc->function(id);
+        if (function == NULL)
+            continue;
+
+        QTreeWidgetItem *item = childItem(m_functionsItem, id);
+        item->setText(KColumnName, function->name());
+        setStatistics(item, profiler->functionStatistics(id));
+        updated << item;
+    }
+
+    for (int i = m_functionsItem->childCount() - 1; i >= 0; i--)
+    {
+        if (updated.contains(m_functionsItem->child(i)) == false)
+            delete m_functionsItem->child(i);
+    }
+
+    /* DMX sources. Dereference only the ones still registered, since
+       the profiler might know sources that have been deleted meanwhile */
+    updated.clear();
+    QList<DMXSource *> registered = m_doc->masterTimer()->registeredDMXSources();
+    foreach (const DMXSource *source, profiler->dmxSources())
+    {
+        if (registered.contains(const_cast<DMXSource *>(source)) == false)
+            continue;
+
+        QString name;
+        const QObject *object = dynamic_cast<const QObject *>(source);
+        if (object != NULL)
+        {
+            name = object->objectName();
+            if (name.isEmpty())
+                name = object->metaObject()->className();
+        }
+        else
+        {
+            name = QString("0x%1").arg(quintptr(source), 0, 16);
+        }
+
+        QTreeWidgetItem *item = childItem(m_sourcesItem, quintptr(source));
+        item->setText(KColumnName, name);
+        setStatistics(item, profiler->dmxSourceStatistics(source));
+        updated << item;
+    }
+
+    for (int i = m_sourcesItem->childCount() - 1; i >= 0; i--)
+    {
+        if (updated.contains(m_sourcesItem->child(i)) == false)
+            delete m_sourcesItem->child(i);
+    }
+
+    m_tree->header()->resizeSections(QHeaderView::ResizeToContents);
+}
+
+void TickProfilerDialog::slotReset()
+{
+    m_doc->masterTimer()->profiler()->reset();
+    slotRefresh();
+}
@@ -0,0 +1,75 @@
+/*
+  Q Light Controller Plus
+  tickprofilerdialog.h
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef TICKPROFILERDIALOG_H
+#define TICKPROFILERDIALOG_H
+
+#include <QDialog>
+
+#include "tickprofiler.h"
+
+class QTreeWidgetItem;
+class QTreeWidget;
+class QLabel;
+class QTimer;
+class Doc;
+
+/** @addtogroup ui UI
+ * @{
+ */
+
+/**
+ * A debug panel showing where the time of each MasterTimer tick goes.
+ * Profiling is enabled while the dialog is open.
+ */
+class TickProfilerDialog : public QDialog
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(TickProfilerDialog)
+
+public:
+    TickProfilerDialog(Doc *doc, QWidget *parent = 0);
+    ~TickProfilerDialog();
+
+private:
+    /** Fill $item columns with the given statistics */
+    void setStatistics(QTreeWidgetItem *item, const TickStatistics& stats);
+
+    /** Get the child of $parent identified by $key, creating it if needed */
+    QTreeWidgetItem *childItem(QTreeWidgetItem *parent, quint64 key);
+
+private slots:
+    void slotRefresh();
+    void slotReset();
+
+private:
+    Doc *m_doc;
+    QTreeWidget *m_tree;
+    QLabel *m_ticksLabel;
+    QTimer *m_refreshTimer;
+
+    QTreeWidgetItem *m_phasesItem;
+    QTreeWidgetItem *m_jitterItem;
+    QTreeWidgetItem *m_functionsItem;
+    QTreeWidgetItem *m_sourcesItem;
+};
+
+/** @} */
+
+#endif // TICKPROFILERDIALOG_H
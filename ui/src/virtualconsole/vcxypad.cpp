@@ -430,16 +430,20 @@ void VCXYPad::writeScenePositions(MasterTimer *timer, QList<Universe *> universe
         qreal x = fxMap[sc.m_fixture].x();
         qreal y = fxMap[sc.m_fixture].y();
 
+        // this runs on the timer thread, which computes the post-GM values
+
         if (sc.m_group == QLCChannel::Pan)
         {
             if (sc.m_subType == QLCChannel::MSB)
             {
                 universes.at(sc.m_universe)->writeRelative(sc.m_channel, panCoarse);
+                universes.at(sc.m_universe)->updatePostGMValues();
                 x += universes.at(sc.m_universe)->postGMValue(sc.m_channel);
             }
             else
             {
                 universes.at(sc.m_universe)->writeRelative(sc.m_channel, panFine);
+                universes.at(sc.m_universe)->updatePostGMValues();
                 x += (universes.at(sc.m_universe)->postGMValue(sc.m_channel) / 255);
             }
         }
@@ -448,11 +452,13 @@ void VCXYPad::writeScenePositions(MasterTimer *timer, QList<Universe *> universe
             if (sc.m_subType == QLCChannel::MSB)
             {
                 universes.at(sc.m_universe)->writeRelative(sc.m_channel, tiltCoarse);
+                universes.at(sc.m_universe)->updatePostGMValues();
                 y += universes.at(sc.m_universe)->postGMValue(sc.m_channel);
             }
             else
             {
                 universes.at(sc.m_universe)->writeRelative(sc.m_channel, tiltFine);
+                universes.at(sc.m_universe)->updatePostGMValues();
                 y += (universes.at(sc.m_universe)->postGMValue(sc.m_channel) / 255);
             }
         }
@@ -8,6 +8,13 @@ cd plugins\artnet\src
 IF NOT %ERRORLEVEL%==0 exit /B %ERRORLEVEL%
 popd
 
+REM E1.31 test
+pushd .
+cd plugins\E1.31\src
+..\test\e131_test.exe
+IF NOT %ERRORLEVEL%==0 exit /B %ERRORLEVEL%
+popd
+
 REM Enttec wing test
 pushd .
 cd plugins\enttecwing\src
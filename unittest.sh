@@ -175,6 +175,36 @@ if [ $RESULT != 0 ]; then
 fi
 popd
 
+#############################################################################
+# E1.31 tests
+#############################################################################
+
+$SLEEPCMD
+pushd .
+cd plugins/E1.31/test
+$TESTPREFIX ./test.sh
+RESULT=$?
+if [ $RESULT != 0 ]; then
+	echo "${RESULT} E1.31 unit tests failed. Please fix before commit."
+	exit $RESULT
+fi
+popd
+
+#############################################################################
+# OSC tests
+#############################################################################
+
+$SLEEPCMD
+pushd .
+cd plugins/osc/test
+$TESTPREFIX ./test.sh
+RESULT=$?
+if [ $RESULT != 0 ]; then
+	echo "${RESULT} OSC unit tests failed. Please fix before commit."
+	exit $RESULT
+fi
+popd
+
 #############################################################################
 # Final judgment
 #############################################################################